@@ -2,7 +2,10 @@
 #include <algorithm>
 #include <thread>
 #include <chrono>
+#include <mutex>
+#include <condition_variable>
 #include "AimRunner.h"
+#include "ArrayExecutor.h"
 #include "CodeGenerator.h"
 #include "SpiwriteCommand.h"
 #include "ArrayFactory.h"
@@ -23,8 +26,17 @@ struct AimRunner::Impl : AIM::AntennaProtocol::AntennaHandler
     DestinatedUDPPoint remote;
     AimConfig cfg;
     AimRunner::OnReceivedMessageFn on_received_message_fn;
-    
-    Impl( AimRunner& consoler ) : owner( consoler )
+    ArrayExecutor executor;
+
+    // Track 으로 받은 마지막 목표. Run() 이 꺼내 모든 panel 에 동시에 적용 (수신 thread 는 hardware 를 기다리지 않는다)
+    std::mutex target_mutex;
+    std::condition_variable target_cv;
+    bool target_pending = false;
+    bool stop = false;
+    float target_az = 0.0f;
+    float target_el = 0.0f;
+
+    Impl( AimRunner& consoler ) : owner( consoler ), executor( consoler.array_info_map_ )
     {
         on_received_message_fn = [](uint32_t msg){};
     }
@@ -101,6 +113,18 @@ typedef enum {
             INFO_LOG( "[%d] - id:%d, az:%.2f, el:%.2f, time:%s", 
                 i++, e.id, e.az/100.0, e.el/100.0, Timeval(e.tv).ToISO8601().c_str() );
         }
+
+        if( track.Entries.empty() ) return;
+
+        // 앞의 목표가 아직 적용 전이면 덮어쓴다 (가장 최근 entry 만 의미 있음)
+        auto& last = track.Entries.back();
+        {
+            std::lock_guard<std::mutex> lock( target_mutex );
+            target_az = last.az / 100.0f;
+            target_el = last.el / 100.0f;
+            target_pending = true;
+        }
+        target_cv.notify_one();
     } 
 
     virtual void OnMessage( const Header& head, const MessagePositionSummary& summy )
@@ -115,26 +139,41 @@ typedef enum {
             tv.ToISO8601().c_str() );
     }    
 
-    Runner::ArrayInfo& GetArrayInfoOrFirst( std::string name )
+    void Stop()
     {
-        if( name.empty() )
-        {
-            return std::begin(owner.array_info_map_)->second;
-        }
-
-        if( auto I = owner.array_info_map_.find( name ); I != owner.array_info_map_.end())
         {
-            return I->second;
+            std::lock_guard<std::mutex> lock( target_mutex );
+            stop = true;
         }
-        throw std::runtime_error( Common::string_format( "init failed : no array with %s found\n", name.c_str() ));
+        target_cv.notify_all();
     }
 
+    // 목표가 들어올 때마다 ArrayInfoMap 의 모든 panel 을 transport 별 worker 에서 동시에 beam
     void Run()
     {
-        using namespace std;
-        using namespace SpiBeam::Array;
+        std::vector<std::string> names;
+        for( auto& kv : owner.array_info_map_ ) names.push_back( kv.first );
 
-        Controller::CodeGenerator cgen;
+        for(;;)
+        {
+            float az, el;
+            {
+                std::unique_lock<std::mutex> lock( target_mutex );
+                target_cv.wait( lock, [this]{ return stop || target_pending; } );
+                if( stop ) return;
+
+                az = target_az;
+                el = target_el;
+                target_pending = false;
+            }
+
+            auto outcomes = executor.Steer( names, az, el );
+            for( auto& [name, o] : outcomes )
+            {
+                if( !o.error.empty() ) INFO_LOG( "array %s beam az:%.2f el:%.2f failed : %s", name.c_str(), az, el, o.error.c_str() );
+            }
+            INFO_LOG( "beam az:%.2f el:%.2f on %zu arrays : %.3f ms", az, el, outcomes.size(), ArrayExecutor::MaxElapsedMs( outcomes ) );
+        }
     }
 };
 
@@ -154,6 +193,7 @@ AimRunner::AimRunner( TransportMap& transport_map, ArrayInfoMap& arraym, const A
 
 AimRunner::~AimRunner() 
 {
+    impl_->Stop();
     delete impl_;
 }
 
@@ -167,6 +207,16 @@ void AimRunner::SetOnReceivedMessageFn( OnReceivedMessageFn fn )
     impl_->on_received_message_fn = fn;
 }
 
+void AimRunner::SetCodeFn( ArrayExecutor::CodeFn fn )
+{
+    impl_->executor.SetCodeFn( std::move(fn) );
+}
+
+void AimRunner::Stop()
+{
+    impl_->Stop();
+}
+
 
 }
 
@@ -3,6 +3,7 @@
 
 #include <functional>
 #include "Runner.h"
+#include "ArrayExecutor.h"
 
 namespace SpiBeam {
 
@@ -20,7 +21,12 @@ public:
     AimRunner( TransportMap& transport_map, ArrayInfoMap& arraym, const AimConfig& cfg );
     ~AimRunner();
  
+    // Track 목표를 모든 panel 에 동시에 적용. Stop() 까지 돌아오지 않는다
     void Run();
+    void Stop();
+
+    // panel 마다 code 를 만들 때 쓰는 함수
+    void SetCodeFn( ArrayExecutor::CodeFn fn );
 
     using OnReceivedMessageFn = std::function<void(uint32_t)>;
     void SetOnReceivedMessageFn( OnReceivedMessageFn fn );
@@ -0,0 +1,324 @@
+#include <thread>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <iterator>
+#include "string_util.hpp"
+#include "ArrayExecutor.h"
+#include "RtProfile.h"
+
+namespace SpiBeam {
+
+struct ArrayExecutor::Impl
+{
+    struct Worker
+    {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::function<void()>> tasks;
+        bool stop = false;
+        Controller::CodeGenerator cgen;     // 이 worker 의 task 에서만 쓴다
+
+        void Loop()
+        {
+            Rt::Runtime::Instance().EnterThread( Rt::Role::Array );
+
+            for(;;)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock( mutex );
+                    cv.wait( lock, [this]{ return stop || !tasks.empty(); } );
+                    if( stop && tasks.empty() ) return;
+
+                    task = std::move( tasks.front() );
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+        void Post( std::function<void()> task )
+        {
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                tasks.push_back( std::move(task) );
+            }
+            cv.notify_one();
+        }
+    };
+
+    // Dispatch 한 번에 대한 join 카운터
+    struct Join
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t remaining = 0;
+
+        void Done()
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            if( --remaining == 0 ) cv.notify_all();
+        }
+
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock( mutex );
+            cv.wait( lock, [this]{ return remaining == 0; } );
+        }
+    };
+
+    using WorkerFn = std::function<void(Worker& worker, const std::string& name, Runner::ArrayInfo& info)>;
+
+    Runner::ArrayInfoMap& arrays;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::map<std::string, Worker*> worker_of;   // array name -> worker
+
+    std::mutex cfg_mutex;
+    CodeFn code_fn;
+    int transfer_size_in_bytes = 32;
+
+    Impl( Runner::ArrayInfoMap& array_info_map ) : arrays( array_info_map )
+    {
+        std::map<const Controller::Transport*, Worker*> by_transport;
+
+        for( auto& [name, info] : arrays )
+        {
+            auto I = by_transport.find( &info.transport );
+            if( I == by_transport.end() )
+            {
+                workers.push_back( std::make_unique<Worker>() );
+                I = by_transport.emplace( &info.transport, workers.back().get() ).first;
+            }
+            worker_of[name] = I->second;
+        }
+
+        for( auto& w : workers )
+        {
+            Worker* raw = w.get();
+            w->thread = std::thread( [raw]{ raw->Loop(); } );
+        }
+    }
+
+    ~Impl()
+    {
+        for( auto& w : workers )
+        {
+            {
+                std::lock_guard<std::mutex> lock( w->mutex );
+                w->stop = true;
+            }
+            w->cv.notify_one();
+        }
+
+        for( auto& w : workers )
+        {
+            if( w->thread.joinable() ) w->thread.join();
+        }
+    }
+
+    OutcomeMap Dispatch( const std::vector<std::string>& names, const WorkerFn& fn )
+    {
+        OutcomeMap outcomes;
+        for( auto& name : names )
+        {
+            if( arrays.find( name ) == arrays.end() )
+            {
+                throw std::runtime_error( Common::string_format( "dispatch failed : no array with %s found\n", name.c_str() ));
+            }
+            outcomes[name];
+        }
+
+        Join join;
+        join.remaining = outcomes.size();
+
+        for( auto& [name, outcome] : outcomes )
+        {
+            Runner::ArrayInfo& info = arrays.find( name )->second;
+            const std::string& array_name = name;
+            Outcome& out = outcome;
+            Worker* worker = worker_of[name];
+
+            worker->Post( [&fn, worker, &info, &array_name, &out, &join]
+            {
+                auto t0 = std::chrono::steady_clock::now();
+                try
+                {
+                    fn( *worker, array_name, info );
+                }
+                catch( const std::exception& e )
+                {
+                    out.error = e.what();
+                }
+                catch( ... )
+                {
+                    out.error = "unknown error";
+                }
+                out.elapsed_ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - t0 ).count();
+                join.Done();
+            });
+        }
+
+        join.Wait();
+        return outcomes;
+    }
+
+    OutcomeMap Steer( const std::vector<std::string>& names, float az, float el )
+    {
+        CodeFn gen;
+        int transfer_size;
+        {
+            std::lock_guard<std::mutex> lock( cfg_mutex );
+            gen = code_fn;
+            transfer_size = transfer_size_in_bytes;
+        }
+
+        return Dispatch( names, [&gen, transfer_size, az, el]( Worker& worker, const std::string&, Runner::ArrayInfo& info )
+        {
+            if( !gen ) throw std::runtime_error( "no code generator set" );
+
+            FormBeam( info.array, az, el );
+            Transfer( info, gen( worker.cgen, info.array ), transfer_size );
+        });
+    }
+};
+
+ArrayExecutor::ArrayExecutor( Runner::ArrayInfoMap& array_info_map )
+    : impl_( new Impl( array_info_map ) )
+{
+}
+
+ArrayExecutor::~ArrayExecutor()
+{
+    delete impl_;
+}
+
+ArrayExecutor::OutcomeMap ArrayExecutor::Dispatch( ArrayFn fn )
+{
+    std::vector<std::string> names;
+    names.reserve( impl_->arrays.size() );
+    for( auto& kv : impl_->arrays ) names.push_back( kv.first );
+
+    return Dispatch( names, std::move(fn) );
+}
+
+ArrayExecutor::OutcomeMap ArrayExecutor::Dispatch( const std::vector<std::string>& names, ArrayFn fn )
+{
+    return impl_->Dispatch( names, [&fn]( Impl::Worker&, const std::string& name, Runner::ArrayInfo& info )
+    {
+        fn( name, info );
+    });
+}
+
+ArrayExecutor::OutcomeMap ArrayExecutor::Steer( const std::vector<std::string>& names, float az, float el )
+{
+    return impl_->Steer( names, az, el );
+}
+
+void ArrayExecutor::SetCodeFn( CodeFn fn )
+{
+    std::lock_guard<std::mutex> lock( impl_->cfg_mutex );
+    impl_->code_fn = std::move(fn);
+}
+
+void ArrayExecutor::SetMaxTransferSizeInBytes( int transfer_size )
+{
+    std::lock_guard<std::mutex> lock( impl_->cfg_mutex );
+    impl_->transfer_size_in_bytes = std::max( (int)sizeof(uint32_t), transfer_size );
+}
+
+size_t ArrayExecutor::WorkerCount() const
+{
+    return impl_->workers.size();
+}
+
+void ArrayExecutor::FormBeam( Array::ArrayBase& array, float az, float el )
+{
+    if( array.GetCfg().port.poles.Size() == 0 )
+    {
+        array.GetStatus().GetPhase() = array.GetLayoutFormer().FormPhase( az, el );
+    }
+    else
+    {
+        array.GetStatus().GetPhase() = array.GetLayoutFormer().FormCircularPhases( az, el );
+    }
+}
+
+void ArrayExecutor::Transfer( Runner::ArrayInfo& info, const std::vector<Controller::Code>& codes,
+    int transfer_size_in_bytes, std::chrono::milliseconds timeout )
+{
+    using namespace std::chrono;
+
+    int read_count = 0;
+    Controller::Transport& transport = info.transport;
+    const size_t max_words = std::max<size_t>( 1, transfer_size_in_bytes / sizeof(uint32_t) );
+
+    std::vector<uint32_t> buf;
+    buf.reserve( max_words );
+    for( auto& code : codes )
+    {
+        auto words = code.CopyWords();
+        if( !buf.empty() && buf.size() + words.size() > max_words )
+        {
+            transport.Write( buf, 0 );
+            buf.clear();
+        }
+
+        std::copy( words.begin(), words.end(), std::back_inserter(buf) );
+        read_count += code.GetReadCount();
+    }
+
+    if( !buf.empty() )
+    {
+        transport.Write( buf, 0 );
+        buf.clear();
+    }
+
+    if( read_count == 0 ) return;
+
+    auto deadline = steady_clock::now() + timeout;
+    while( transport.ReceviedCount( 0 ) < read_count )
+    {
+        if( steady_clock::now() >= deadline )
+        {
+            throw std::runtime_error( Common::string_format( "readback timeout : %d of %d words",
+                (int)transport.ReceviedCount( 0 ), read_count ));
+        }
+        std::this_thread::sleep_for( 1ms );
+    }
+
+    auto reads = transport.Read( read_count, 0 );
+    std::vector<Controller::SpiReadback> readbacks;
+    readbacks.reserve( reads.size() );
+    std::transform( reads.begin(), reads.end(), std::back_inserter(readbacks),
+        [](uint32_t r){ return Controller::SpiReadback(r); });
+
+    info.array.Readback( readbacks );
+}
+
+bool ArrayExecutor::AllSucceeded( const OutcomeMap& outcomes )
+{
+    for( auto& kv : outcomes )
+    {
+        if( !kv.second.error.empty() ) return false;
+    }
+    return true;
+}
+
+double ArrayExecutor::MaxElapsedMs( const OutcomeMap& outcomes )
+{
+    double m = 0.0;
+    for( auto& kv : outcomes )
+    {
+        m = std::max( m, kv.second.elapsed_ms );
+    }
+    return m;
+}
+
+
+}
@@ -0,0 +1,70 @@
+#ifndef __SPIBEAM_ARRAY_EXECUTOR_H__
+#define __SPIBEAM_ARRAY_EXECUTOR_H__
+
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include "Runner.h"
+#include "CodeGenerator.h"
+
+namespace SpiBeam {
+
+// ArrayInfoMap 의 array 들을 transport 별 worker 에서 동시에 실행한다.
+//   - transport 하나당 worker thread 하나 (같은 transport 를 쓰는 array 는 순차 실행)
+//   - Dispatch() 는 모든 array 가 끝날 때까지 기다린 뒤 결과를 돌려준다
+//   - 전체 소요 시간은 sum(panel) 이 아니라 max(panel)
+//   - worker 는 Rt::Role::Array 로 들어간다 (hw thread 의 cpu / SCHED_FIFO 를 같이 쓰지 않는다)
+class ArrayExecutor
+{
+public:
+    using ArrayFn = std::function<void(const std::string& name, Runner::ArrayInfo& info)>;
+
+    // panel 의 현재 status (phase 등) 로 transport 에 보낼 code 를 만든다. CodeGenerator 는 worker 마다 하나
+    using CodeFn = std::function<std::vector<Controller::Code>(Controller::CodeGenerator& cgen, Array::ArrayBase& array)>;
+
+    struct Outcome
+    {
+        std::string error;          // 비어 있으면 성공
+        double elapsed_ms = 0.0;
+    };
+
+    using OutcomeMap = std::map<std::string, Outcome>;
+
+    explicit ArrayExecutor( Runner::ArrayInfoMap& array_info_map );
+    ~ArrayExecutor();
+
+    ArrayExecutor( const ArrayExecutor& ) = delete;
+    ArrayExecutor& operator=( const ArrayExecutor& ) = delete;
+
+    OutcomeMap Dispatch( ArrayFn fn );
+    OutcomeMap Dispatch( const std::vector<std::string>& names, ArrayFn fn );
+
+    // panel 마다 FormBeam -> CodeFn -> Transfer (readback 포함) 을 동시에. CodeFn 이 없으면 모든 panel 이 실패
+    OutcomeMap Steer( const std::vector<std::string>& names, float az, float el );
+
+    void SetCodeFn( CodeFn fn );
+    void SetMaxTransferSizeInBytes( int transfer_size );
+
+    size_t WorkerCount() const;
+
+    // az/el 로 panel 의 phase 를 만든다 (pole 이 있으면 circular)
+    static void FormBeam( Array::ArrayBase& array, float az, float el );
+
+    // codes 를 transfer_size 단위로 묶어 쓰고, read 가 있으면 다 들어올 때까지 (최대 timeout) 기다려 array 에 readback
+    static void Transfer( Runner::ArrayInfo& info, const std::vector<Controller::Code>& codes,
+        int transfer_size_in_bytes, std::chrono::milliseconds timeout = std::chrono::milliseconds( 1000 ) );
+
+    static bool AllSucceeded( const OutcomeMap& outcomes );
+    static double MaxElapsedMs( const OutcomeMap& outcomes );
+
+private:
+    struct Impl;
+    Impl *impl_;
+};
+
+
+}
+
+#endif
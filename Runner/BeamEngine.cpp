@@ -0,0 +1,488 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstdarg>
+#include "string_util.hpp"
+#include "BeamEngine.h"
+#include "BeamPipeline.h"
+#include "BeamTrace.h"
+#include "SpiStats.h"
+#include "HealthMonitor.h"
+#include "WarmStart.h"
+
+namespace SpiBeam {
+
+using namespace std;
+
+void SwBeamEngine::Emit( const char* fmt, ... )
+{
+    if( !script_ ) return;
+
+    va_list ap;
+    va_start( ap, fmt );
+    vprintf( fmt, ap );
+    va_end( ap );
+}
+
+void SwBeamEngine::Pause( int ms )
+{
+    if( script_ ) std::this_thread::sleep_for( std::chrono::milliseconds( ms ) );
+}
+
+void SwBeamEngine::FinishBus( int bus, uintptr_t base_address, uint32_t length )
+{
+    // 현재 bus 종료 처리
+    writer_.writeMemory(base_address + 0x0014, length);
+    Pause(10);
+    Emit("sendln \"devmem 0x%08x 32 0x%x\"\n", base_address + 0x0014, length);
+    Emit("mpause 10\n");
+
+    // 인터럽트 상태 확인. 지우기 전에 읽어서 HealthMonitor 가 돌고 있으면 overflow bit 를 넘긴다
+    uint32_t interrupt_value = Health::LatchIsr(writer_, bus, base_address);
+    if (!Health::Active()) {
+        Emit(";base_address => 0X%08x interrupt_value => 0x%08x\n", base_address, interrupt_value);
+        Emit("mpause 10\n"); 
+    }
+
+    // 인터럽트 초기화
+    writer_.writeMemory(base_address, 0xffffffff);
+    Pause(10);
+    Emit("sendln \"devmem 0x%08x 32 0xffffffff\"\n", base_address);
+    Emit("mpause 10\n");
+
+    // 남은 FIFO DATA SIZE 확인
+    if (!Health::Active()) {
+        uint32_t remaining_fifo_data_size;
+        if (writer_.readMemory(base_address + 0xC, remaining_fifo_data_size) && remaining_fifo_data_size == 0) {
+            Stats::Inc(Stats::Counter::FifoFullStalls);
+        }
+        Emit(";remaining_fifo_data_size => 0x%08x\n", remaining_fifo_data_size);
+        Emit("mpause 10\n");
+    }
+}
+
+void SwBeamEngine::StartBus( uintptr_t base_address )
+{
+    // 새로운 bus 시작 처리
+    uint32_t init_value_ = 0x2;
+    writer_.writeMemory(base_address + 0x2C, init_value_);
+    Pause(10);
+    Emit("sendln \"devmem 0x%08x 32 0x%01X\"\n", base_address + 0x2C, init_value_);
+    Emit("mpause 10\n");
+}
+
+void SwBeamEngine::Prepare( int is_tx, float az, float el, PreparedBeam& beam, long long unsigned freq )
+{
+    beam.is_tx = is_tx;
+    beam.az = az;
+    beam.el = el;
+    beam.freq = freq ? freq : is_tx ? 29500000000ULL : 19700000000ULL;
+    beam.layout = Layout::Registry::Instance().Get(is_tx);
+    const Layout::Compiled& L = *beam.layout;
+
+    // 각 element 에 대해 Phase 계산 및 Offset 적용 (layout 의 bus 순서)
+    beam.phase_idx.resize(L.Size());
+    auto phase_t0 = Trace::NowNs();
+    BeamPipeline::ComputeIndicesFixed(L, az, el, beam.freq, beam.phase_idx.data());
+    Trace::Tracer::Instance().Record(Trace::Stage::PhaseCompute, Trace::NowNs() - phase_t0);
+
+    Pack(beam);
+}
+
+void SwBeamEngine::Pack( PreparedBeam& beam )
+{
+    const Layout::Compiled& L = *beam.layout;
+    const int is_tx = beam.is_tx;
+
+    auto pack_t0 = Trace::NowNs();
+    beam.words.resize(L.num_bus);
+    beam.bytes.assign(L.num_bus, 0);
+    for (int bus = 0; bus < L.num_bus; bus++)
+    {
+        if (L.BusSize(bus) == 0)
+        {
+            beam.words[bus].clear();
+            continue;
+        }
+        beam.bytes[bus] = (uint32_t)BeamPipeline::PackBus(L, beam.phase_idx.data(), is_tx, bus, beam.words[bus]);
+    }
+    beam.send_mask = L.SendMask();
+    Trace::Tracer::Instance().Record(Trace::Stage::Pack, Trace::NowNs() - pack_t0);
+}
+
+void SwBeamEngine::Load( const PreparedBeam& beam )
+{
+    const Layout::Compiled& L = *beam.layout;
+
+    auto fill_t0 = Trace::NowNs();
+    for (int bus = 0; bus < L.num_bus; bus++)
+    {
+        LoadBus(beam, bus);
+    }
+    Trace::Tracer::Instance().Record(Trace::Stage::FifoFill, Trace::NowNs() - fill_t0);
+
+    Emit("\nTotal unique entries: %zu\n", L.Size());
+}
+
+void SwBeamEngine::LoadBus( const PreparedBeam& beam, int bus )
+{
+    const Layout::Compiled& L = *beam.layout;
+    if (L.BusSize(bus) == 0) return;
+
+    Emit(";spi_id => %d\n", bus);
+    uintptr_t base_address = L.FifoAddress(bus);
+    StartBus(base_address);
+
+    // script 의 cnt 는 layout 전체에서의 순번
+    for (size_t k = L.bus_begin[bus]; script_ && k < L.bus_begin[bus + 1]; k++)
+    {
+        Emit(";cnt=%zu spi_id=0x%02X chip_id=0x%02X chan_id=0x%02X DATA=0x%04X\n", k,
+            bus & 0xFF, L.chip[k], L.channel[k], BeamPipeline::EncodeValue(beam.phase_idx[k], beam.is_tx) & 0xFFFF);
+    }
+
+    // script 가 없으면 FIFO word 를 한 번에 (word 마다 lock / 집계하지 않는다)
+    const std::vector<uint32_t>& words = beam.words[bus];
+    if (!script_) writer_.writeFifo(bus, base_address, words.data(), words.size());
+
+    for (size_t i = 0; script_ && i < words.size(); i++)
+    {
+        uint32_t data = words[i];
+        writer_.writeMemory(base_address + 0x0010, data);
+        Pause(1);
+        Emit(";----count : %d ----\n", count_++);
+        Emit("sendln \"devmem 0x%08x 32 0x%02x%02x%02x%02x\"\n",
+            base_address + 0x0010,
+            (data >> 24) & 0xFF,
+            (data >> 16) & 0xFF,
+            (data >> 8) & 0xFF,
+            data & 0xFF);
+        Emit("mpause 1\n");
+    }
+
+    FinishBus(bus, base_address, beam.bytes[bus]);
+}
+
+bool SwBeamEngine::Fire( const PreparedBeam& beam )
+{
+    auto trigger_t0 = Trace::NowNs();
+
+    // Send Length
+    uintptr_t length_addr = 0x43c00018; 
+    uint32_t length_value = 0x5;
+    writer_.writeMemory(length_addr, length_value);
+    Pause(10);
+    Emit("sendln \"devmem 0x%08x 32 0x%01x\"\n", length_addr, length_value);
+    Emit("mpause 10\n");
+
+    // FIFO Execute : 0x1
+    uintptr_t addr_1c = 0x43c0001c;
+    uint32_t value_1c = 0x1;
+    writer_.writeMemory(addr_1c, value_1c);
+    Pause(10);
+    Emit("sendln \"devmem 0x%08x 32 0x%01x\"\n", addr_1c, value_1c);
+    Emit("mpause 10\n");
+
+    // FIFO 1~8 SEND : 0Xff (bus 별 bit)
+    uintptr_t send_addr = 0x43c00014;
+    uint32_t send_value = beam.send_mask;
+    if (writer_.writeMemory(send_addr, send_value))
+        WarmStart::Journal::Instance().OnBeam(*beam.layout, beam.send_mask, beam.words, beam.bytes);
+    Pause(10);
+    Emit("sendln \"devmem 0x%08x 32 0x%01x\"\n", send_addr, send_value);
+    Emit("mpause 10\n");
+
+    auto completion_t0 = Trace::NowNs();
+    Trace::Tracer::Instance().Record(Trace::Stage::Trigger, completion_t0 - trigger_t0);
+
+
+    // 남은 FIFO DATA SIZE 확인
+    bool completed = false;
+    while (true)
+    {
+        uintptr_t fifo_send_check_address = 0x43c00014;
+        uint32_t fifo_send_check_value;
+        if (!writer_.readMemory(fifo_send_check_address, fifo_send_check_value)) {
+            printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(fifo_send_check_address));
+            Emit("mpause 10\n");
+            break;
+        }
+    
+        if (fifo_send_check_value == 0x0) 
+        {
+            Emit(";ok fifo send all completed !\n");
+            completed = true;
+            break;
+        }
+
+        Stats::Inc(Stats::Counter::SendBusyPolls);
+        Emit("mpause 100\n");
+        if (script_) Pause(10);
+        else std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    Trace::Tracer::Instance().Record(Trace::Stage::Completion, Trace::NowNs() - completion_t0);
+    Stats::Inc(Stats::Counter::BeamsApplied);
+    return completed;
+}
+
+bool SwBeamEngine::Apply( int is_tx, float az, float el )
+{
+    // tx : 29.5GHz / rx : 19.7GHz, pitch 와 배치는 Layout::Registry
+    freq_Hz = is_tx ? 29500000000ULL : 19700000000ULL;
+    az_value = az;
+    el_value = el;
+
+    Trace::Tracer::BeginBeam(Trace::NowNs());
+    Emit("\n++++++++++++++++++++++++\n");
+    Emit("[sch] start\n");
+    Emit("++++++++++++++++++++++++\n");
+
+    Prepare(is_tx, az, el, beam_);
+    Load(beam_);
+
+    Emit("++++++++++++++++++++++++\n");
+    Emit("=======done=====\n");
+    Emit("++++++++++++++++++++++++\n");
+
+    bool completed = Fire(beam_);
+    Trace::Tracer::EndBeam();
+
+    const Layout::Compiled& L = *beam_.layout;
+    for (int bus = 0; bus < L.num_bus && !Health::Active(); bus++)
+    {
+        uint32_t remaining_size;
+        writer_.readMemory(L.FifoAddress(bus) + 0xc, remaining_size);
+        Emit(";now fifo %d remaining size -> %d\n", bus + 1, remaining_size);
+        Emit("mpause 10\n");
+    }
+
+    return completed;
+}
+
+uint16_t HwBeamEngine::ToQ9_7( float deg )
+{
+    float d = std::fmod( deg, 360.0f );
+    if( d < 0 ) d += 360.0f;
+    return static_cast<uint16_t>( std::lround( d * 128.0f ) & 0xFFFF );
+}
+
+bool HwBeamEngine::Available()
+{
+    uint32_t version = 0;
+    if( !writer_.readMemory( base_ + REG_VERSION, version ) ) return false;
+    return version == VERSION;
+}
+
+bool HwBeamEngine::Apply( int is_tx, float az, float el )
+{
+    uint32_t ctrl = is_tx ? 0x2 : 0x0;
+
+    Trace::Tracer::BeginBeam( Trace::NowNs() );
+    auto trigger_t0 = Trace::NowNs();
+
+    // start 는 rising edge 로 동작하므로 먼저 내려 둔다
+    if( !writer_.writeMemory( base_ + REG_CTRL, ctrl ) ||
+        !writer_.writeMemory( base_ + REG_AZ, ToQ9_7( az ) ) ||
+        !writer_.writeMemory( base_ + REG_EL, ToQ9_7( el ) ) ||
+        !writer_.writeMemory( base_ + REG_CTRL, ctrl | 0x1 ) )
+    {
+        printf( ";hw beam engine trigger write failed\n" );
+        // 남은 BeginBeam 시각이 다음 beam 의 end_to_end 에 섞이지 않도록
+        Trace::Tracer::AbortBeam();
+        return false;
+    }
+
+    auto completion_t0 = Trace::NowNs();
+    Trace::Tracer::Instance().Record( Trace::Stage::Trigger, completion_t0 - trigger_t0 );
+
+    bool done = false;
+    bool read_failed = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeout_ms_ );
+    while( std::chrono::steady_clock::now() < deadline )
+    {
+        uint32_t status = 0;
+        if( !writer_.readMemory( base_ + REG_STATUS, status ) )
+        {
+            read_failed = true;
+            break;
+        }
+        if( ( status & ALL_LANES ) == ALL_LANES )
+        {
+            done = true;
+            break;
+        }
+        std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+    }
+
+    writer_.writeMemory( base_ + REG_CTRL, ctrl );
+
+    if( !done )
+    {
+        if( read_failed ) printf( ";hw beam engine status read failed\n" );
+        else printf( ";hw beam engine timeout (%d ms)\n", timeout_ms_ );
+        Trace::Tracer::AbortBeam();
+        return false;
+    }
+
+    Trace::Tracer::Instance().Record( Trace::Stage::Completion, Trace::NowNs() - completion_t0 );
+    Trace::Tracer::EndBeam();
+    Stats::Inc( Stats::Counter::BeamsApplied );
+    return true;
+}
+
+BeamEngineSet::BeamEngineSet( SpiwriteProtocol::MemoryWriter& writer )
+    : sw_( writer ), hw_( writer ), chosen_( &sw_ )
+{
+}
+
+bool BeamEngineSet::Select( const std::string& name, int is_tx, float az, float el )
+{
+    if( name == "auto" )
+    {
+        mode_ = Mode::Auto;
+        chosen_ = &sw_;
+        printf( ";%s\n", SelfBenchmark( is_tx, az, el ).c_str() );
+        return sw_ms_ >= 0;
+    }
+
+    if( name == "sw" )
+    {
+        mode_ = Mode::Sw;
+        chosen_ = &sw_;
+        return true;
+    }
+
+    if( name == "hw" )
+    {
+        if( !hw_.Available() )
+        {
+            printf( ";hw beam engine not found\n" );
+            return false;
+        }
+        std::string why;
+        for( int t = 1; t >= 0; t-- )
+        {
+            if( !HwMatchesLayout( *Layout::Registry::Instance().Get( t ), &why ) )
+                printf( ";warning : %s, hw beam differs from sw\n", why.c_str() );
+        }
+        mode_ = Mode::Hw;
+        chosen_ = &hw_;
+        return true;
+    }
+
+    return false;
+}
+
+BeamEngine& BeamEngineSet::Current()
+{
+    return chosen_ ? *chosen_ : static_cast<BeamEngine&>( sw_ );
+}
+
+bool BeamEngineSet::Apply( int is_tx, float az, float el )
+{
+    // auto 가 hw 를 고른 뒤 layout 이 바뀌었으면 pole 을 다시 본다
+    std::string why;
+    if( mode_ == Mode::Auto && chosen_ == &hw_ && !HwMatchesLayout( *Layout::Registry::Instance().Get( is_tx ), &why ) )
+    {
+        chosen_ = &sw_;
+        reason_ = why;
+        printf( ";beam engine auto : sw (%s)\n", reason_.c_str() );
+    }
+
+    if( Current().Apply( is_tx, az, el ) ) return true;
+
+    // hw 가 응답하지 않으면 sw 로 되돌아간다
+    if( &Current() == &hw_ )
+    {
+        printf( ";fallback to sw beam engine\n" );
+        chosen_ = &sw_;
+        return sw_.Apply( is_tx, az, el );
+    }
+    return false;
+}
+
+std::string BeamEngineSet::SelfBenchmark( int is_tx, float az, float el, int rounds )
+{
+    auto measure = [&]( BeamEngine& engine ) -> double
+    {
+        double total = 0;
+        for( int i = 0; i < rounds; i++ )
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            if( !engine.Apply( is_tx, az, el ) ) return -1;
+            total += std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - t0 ).count();
+        }
+        return total / rounds;
+    };
+
+    if( rounds < 1 ) rounds = 1;
+
+    // script 의 mpause sleep 이 sw 쪽 시간에 들어가지 않게
+    bool script = sw_.Script();
+    sw_.SetScript( false );
+
+    // pole 이 있는 layout 에서는 빠르더라도 hw 를 고르지 않는다 (RTL 은 pole offset 없이 계산).
+    // auto 는 고를 수 없는 hw 로 panel 에 다른 pattern 을 내보내지 않도록 재지도 않는다
+    std::string why;
+    bool match = HwMatchesLayout( *Layout::Registry::Instance().Get( 1 ), &why ) &&
+                 HwMatchesLayout( *Layout::Registry::Instance().Get( 0 ), &why );
+
+    hw_ms_ = -1;
+    bool hw_found = hw_.Available();
+    if( hw_found && ( match || mode_ != Mode::Auto ) ) hw_ms_ = measure( hw_ );
+
+    // sw 를 마지막에 돌려서 hw 가 실패했어도 panel 에는 이번 beam 이 남게 한다
+    sw_ms_ = measure( sw_ );
+    sw_.SetScript( script );
+
+    if( mode_ == Mode::Auto )
+    {
+        chosen_ = &sw_;
+        if( !hw_found ) reason_ = "hw not found";
+        else if( !match ) reason_ = why;
+        else if( hw_ms_ < 0 ) reason_ = "hw failed";
+        else if( sw_ms_ < 0 ) reason_ = "sw failed";
+        else if( hw_ms_ >= sw_ms_ ) reason_ = "hw not faster";
+        else
+        {
+            chosen_ = &hw_;
+            reason_ = "hw faster, layout poles zero";
+        }
+    }
+    return Report();
+}
+
+bool BeamEngineSet::HwMatchesLayout( const Layout::Compiled& L, std::string* why )
+{
+    size_t k = 0;
+    while( k < L.Size() && L.pole_turns[k] == 0 ) k++;
+    if( k == L.Size() ) return true;
+
+    if( why ) *why = Common::string_format( "layout %s has pole %d deg at element %u (RTL phase_calc has no pole offset)",
+        L.name.c_str(), L.poles[k], L.element[k] );
+    return false;
+}
+
+std::string BeamEngineSet::Report() const
+{
+    const char* mode = mode_ == Mode::Auto ? "auto" : mode_ == Mode::Sw ? "sw" : "hw";
+    std::string rep = Common::string_format( "beam engine %s (mode %s)", chosen_ ? chosen_->Name() : "-", mode );
+
+    if( sw_ms_ < 0 )
+    {
+        rep += " sw failed";
+    }
+    else if( sw_ms_ > 0 )
+    {
+        rep += Common::string_format( " sw %.3f ms", sw_ms_ );
+        rep += hw_ms_ >= 0 ? Common::string_format( " hw %.3f ms", hw_ms_ ) : std::string( " hw n/a" );
+    }
+    if( mode_ == Mode::Auto && !reason_.empty() ) rep += " : " + reason_;
+    return rep;
+}
+
+
+}
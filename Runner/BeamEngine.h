@@ -0,0 +1,152 @@
+#ifndef __SPIBEAM_BEAM_ENGINE_H__
+#define __SPIBEAM_BEAM_ENGINE_H__
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "SpiwriteCommand.h"
+#include "PanelLayout.h"
+
+namespace SpiBeam {
+
+// az/el 을 panel 에 적용하는 방법
+//   sw : CPU 가 Layout::Registry 의 element phase 를 계산해서 bus FIFO 에 밀어 넣음
+//   hw : beamformer_top(PL) 에 az/el 만 쓰고 done 을 기다림
+class BeamEngine
+{
+public:
+    virtual ~BeamEngine() {}
+
+    virtual const char* Name() const = 0;
+    virtual bool Available() = 0;
+    virtual bool Apply( int is_tx, float az, float el ) = 0;
+};
+
+// phase 계산과 packing 까지 끝난 beam 한 개 (FIFO 에 쓰기만 하면 되는 상태)
+struct PreparedBeam
+{
+    int is_tx = 0;
+    float az = 0;
+    float el = 0;
+    long long unsigned freq = 0;
+    std::shared_ptr<const Layout::Compiled> layout;
+    std::vector<uint8_t> phase_idx;
+    std::vector<std::vector<uint32_t>> words;   // bus 별 FIFO data word
+    std::vector<uint32_t> bytes;                // bus 별 length register 값
+    uint32_t send_mask = 0;
+};
+
+class SwBeamEngine : public BeamEngine
+{
+public:
+    SwBeamEngine( SpiwriteProtocol::MemoryWriter& writer ) : writer_( writer ) {}
+
+    const char* Name() const override { return "sw"; }
+    bool Available() override { return true; }
+    bool Apply( int is_tx, float az, float el ) override;
+
+    // Apply = Prepare -> Load -> Fire.
+    // scan 처럼 다음 beam 을 미리 계산해 두거나 FIFO 에 먼저 올려 두고 정해진 시각에 send 만 할 때 나눠 쓴다.
+    // Prepare 는 hardware 를 건드리지 않으므로 어느 thread 에서나 호출 가능
+    // freq 가 0 이면 tx 29.5GHz / rx 19.7GHz
+    static void Prepare( int is_tx, float az, float el, PreparedBeam& beam, long long unsigned freq = 0 );
+    // beam.layout / is_tx / phase_idx 가 채워진 상태에서 bus 별 word 와 length 만 만든다 (phase 를 밖에서 받은 경우)
+    static void Pack( PreparedBeam& beam );
+    void Load( const PreparedBeam& beam );   // bus 별 start / data / length / interrupt clear
+    // bus 하나만. bus 마다 다른 engine (thread) 으로 나눠 올릴 때 (FIFO 는 bus 마다 독립)
+    void LoadBus( const PreparedBeam& beam, int bus );
+    bool Fire( const PreparedBeam& beam );   // length / execute / send 후 send register 가 0 이 될 때까지 대기
+
+    // true (기본) : register 접근마다 devmem script 를 출력하고 script 의 mpause 만큼 기다린다.
+    // false : 출력과 pacing sleep 없이 바로 쓴다 (batch 처럼 beam 을 연달아 적용할 때)
+    void SetScript( bool on ) { script_ = on; }
+    bool Script() const { return script_; }
+
+private:
+    void Emit( const char* fmt, ... ) __attribute__(( format( printf, 2, 3 ) ));
+    void Pause( int ms );
+    void StartBus( uintptr_t base_address );
+    void FinishBus( int bus, uintptr_t base_address, uint32_t length );
+
+    SpiwriteProtocol::MemoryWriter& writer_;
+    int count_ = 1;
+    bool script_ = true;
+    PreparedBeam beam_;     // Apply 용, beam 마다 buffer 재사용
+};
+
+// beamforming_calc IP register map (hdl/beamforming_calc_v1_0_S00_AXI.v user logic)
+class HwBeamEngine : public BeamEngine
+{
+public:
+    static constexpr uintptr_t DEFAULT_BASE = 0x43C30000;
+    static constexpr uint32_t  REG_CTRL    = 0x00;  // [0] start, [1] is_tx
+    static constexpr uint32_t  REG_AZ      = 0x04;  // Q9.7
+    static constexpr uint32_t  REG_EL      = 0x08;  // Q9.7
+    static constexpr uint32_t  REG_STATUS  = 0x0C;  // [7:0] done(sticky), [15:8] busy
+    static constexpr uint32_t  REG_VERSION = 0x10;
+    static constexpr uint32_t  VERSION     = 0xBEA00001;
+    static constexpr uint32_t  ALL_LANES   = 0xFF;
+
+    HwBeamEngine( SpiwriteProtocol::MemoryWriter& writer, uintptr_t base = DEFAULT_BASE )
+        : writer_( writer ), base_( base ) {}
+
+    const char* Name() const override { return "hw"; }
+    bool Available() override;
+    bool Apply( int is_tx, float az, float el ) override;
+
+    // 0..360 으로 wrap 한 degree 를 unsigned Q9.7 로
+    static uint16_t ToQ9_7( float deg );
+
+    void SetTimeoutMs( int ms ) { timeout_ms_ = ms; }
+
+private:
+    SpiwriteProtocol::MemoryWriter& writer_;
+    uintptr_t base_;
+    int timeout_ms_ = 100;
+};
+
+// sw/hw engine 을 들고 있다가 선택된 쪽으로 beam 을 적용한다.
+// 기본은 sw. RTL phase_calc 에는 pole offset 이 없어 hw 는 다른 pattern 을 만들므로 hw / auto 는 명시적으로 고를 때만
+// (console "engine hw|auto", 시작 시 $SPIBEAM_BEAM_ENGINE).
+// auto 는 고르는 시점에 주어진 beam 으로 두 engine 을 돌려 보고 빠른 쪽을 고른다. 사용자 beam 적용 중에는 benchmark 하지 않는다.
+// 단 tx/rx layout 의 pole 이 모두 0 (360 의 배수) 일 때만 hw 를 고르고, 적용할 때 layout 이 바뀌어 pole 이 생겼으면 sw 로 돌아간다
+class BeamEngineSet
+{
+public:
+    enum class Mode { Auto, Sw, Hw };
+
+    BeamEngineSet( SpiwriteProtocol::MemoryWriter& writer );
+
+    // "auto" 는 (is_tx, az, el) 로 SelfBenchmark 를 돌린다 (panel 의 현재 beam 을 주면 끝난 뒤 panel 상태는 그대로).
+    // benchmark 에서 sw 가 실패하면 false
+    bool Select( const std::string& name, int is_tx = 0, float az = 0, float el = 0 );
+    BeamEngine& Current();
+
+    bool Apply( int is_tx, float az, float el );
+
+    // 각 engine 으로 rounds 번 적용해 보고 (script 출력 / pacing 없이) 평균을 잰다, 결과 문자열 반환.
+    // mode 가 auto 일 때만 빠른 쪽으로 바꾼다
+    std::string SelfBenchmark( int is_tx, float az, float el, int rounds = 1 );
+
+    std::string Report() const;
+
+    void SetScript( bool on ) { sw_.SetScript( on ); }
+
+    // hw 가 sw 와 같은 pattern 을 만드는 layout 인지 (모든 element 의 pole 이 0). 아니면 why 에 이유
+    static bool HwMatchesLayout( const Layout::Compiled& L, std::string* why = nullptr );
+
+private:
+    SwBeamEngine sw_;
+    HwBeamEngine hw_;
+    Mode mode_ = Mode::Sw;
+    BeamEngine* chosen_ = nullptr;
+    double sw_ms_ = 0;
+    double hw_ms_ = 0;
+    std::string reason_;    // auto 가 지금 engine 을 고른 이유
+};
+
+
+}
+
+#endif
@@ -0,0 +1,377 @@
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include "string_util.hpp"
+#include "BeamPattern.h"
+
+namespace SpiBeam {
+namespace Pattern {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double DEG = PI / 180.0;
+
+// BeamPipeline 과 같은 c (3e8 m/s), mm 단위
+constexpr double SPEED_OF_LIGHT_MM = 300000000.0 * 1000.0;
+
+double ToDb( double ratio )
+{
+    return ratio > 0 ? 10.0 * std::log10( ratio ) : -300.0;
+}
+
+}
+
+void ToUV( double az, double el, double& u, double& v )
+{
+    double c_el = std::cos( el * DEG );
+    u = c_el * std::cos( az * DEG );
+    v = -c_el * std::sin( az * DEG );
+}
+
+void FromUV( double u, double v, double& az, double& el )
+{
+    double r = std::min( 1.0, std::sqrt( u * u + v * v ) );
+    el = std::acos( r ) / DEG;
+    az = r > 0 ? std::atan2( -v, u ) / DEG : 0.0;
+    if( az < 0 ) az += 360.0;
+    if( az >= 360.0 ) az -= 360.0;
+}
+
+double AngleBetween( double az0, double el0, double az1, double el1 )
+{
+    double u0, v0, u1, v1;
+    ToUV( az0, el0, u0, v0 );
+    ToUV( az1, el1, u1, v1 );
+    double dot = u0 * u1 + v0 * v1 + std::sin( el0 * DEG ) * std::sin( el1 * DEG );
+    return std::acos( std::max( -1.0, std::min( 1.0, dot ) ) ) / DEG;
+}
+
+std::string Metrics::Report() const
+{
+    return Common::string_format( "az %7.2f el %6.2f -> peak az %7.2f el %6.2f, error %.3f deg, loss %.2f dB, psl %.2f dB",
+        az, el, peak_az, peak_el, pointing_error_deg, pointing_loss_db, psl_db );
+}
+
+Evaluator::Evaluator( const Layout::Compiled& layout, int is_tx, const Config& config )
+    : grid_( std::max( 16, config.grid ) )
+    , rows_( layout.rows )
+    , cols_( layout.cols )
+    , dx_( layout.dx )
+    , dy_( layout.dy )
+    , gain_max_( config.gain_max )
+    , layout_( layout )
+{
+    long long unsigned freq = config.freq ? config.freq : ( is_tx ? 29500000000ULL : 19700000000ULL );
+    k_ = 2.0 * PI * (double)freq / SPEED_OF_LIGHT_MM;
+
+    pole_rad_.resize( layout.Size() );
+    for( size_t e = 0; e < layout.Size(); e++ ) pole_rad_[e] = (float)( layout.poles[e] * DEG );
+
+    w_re_.assign( (size_t)rows_ * cols_, 0.0f );
+    w_im_.assign( (size_t)rows_ * cols_, 0.0f );
+    row_used_.assign( rows_, 0 );
+
+    eu_re_.resize( (size_t)cols_ * grid_ );
+    eu_im_.resize( (size_t)cols_ * grid_ );
+    for( int c = 0; c < cols_; c++ )
+    {
+        for( int i = 0; i < grid_; i++ )
+        {
+            double a = k_ * c * dx_ * GridValue( i );
+            eu_re_[(size_t)c * grid_ + i] = (float)std::cos( a );
+            eu_im_[(size_t)c * grid_ + i] = (float)std::sin( a );
+        }
+    }
+
+    ev_re_.resize( (size_t)rows_ * grid_ );
+    ev_im_.resize( (size_t)rows_ * grid_ );
+    for( int r = 0; r < rows_; r++ )
+    {
+        for( int j = 0; j < grid_; j++ )
+        {
+            double a = k_ * r * dy_ * GridValue( j );
+            ev_re_[(size_t)r * grid_ + j] = (float)std::cos( a );
+            ev_im_[(size_t)r * grid_ + j] = (float)std::sin( a );
+        }
+    }
+
+    s_re_.resize( (size_t)rows_ * grid_ );
+    s_im_.resize( (size_t)rows_ * grid_ );
+    power_.resize( (size_t)grid_ * grid_ );
+    visited_.resize( (size_t)grid_ * grid_ );
+}
+
+void Evaluator::SetWeights( const uint8_t* phase_idx, const uint8_t* gain )
+{
+    std::fill( w_re_.begin(), w_re_.end(), 0.0f );
+    std::fill( w_im_.begin(), w_im_.end(), 0.0f );
+    std::fill( row_used_.begin(), row_used_.end(), 0 );
+
+    for( size_t e = 0; e < layout_.Size(); e++ )
+    {
+        float amp = ( gain && gain_max_ > 0 ) ? (float)gain[e] / gain_max_ : 1.0f;
+        float ph = ( phase_idx[e] & 0x3f ) * (float)( 2.0 * PI / 64.0 ) - pole_rad_[e];
+
+        size_t at = (size_t)layout_.gy[e] * cols_ + layout_.gx[e];
+        w_re_[at] = amp * std::cos( ph );
+        w_im_[at] = amp * std::sin( ph );
+        if( amp != 0.0f ) row_used_[layout_.gy[e]] = 1;
+    }
+}
+
+void Evaluator::ComputeGrid()
+{
+    const int n = grid_;
+
+    // S[r][i] = sum_c w[r][c] e^{j k x_c u_i}
+    for( int r = 0; r < rows_; r++ )
+    {
+        if( !row_used_[r] ) continue;
+
+        float* sr = &s_re_[(size_t)r * n];
+        float* si = &s_im_[(size_t)r * n];
+        std::fill( sr, sr + n, 0.0f );
+        std::fill( si, si + n, 0.0f );
+
+        for( int c = 0; c < cols_; c++ )
+        {
+            const float wr = w_re_[(size_t)r * cols_ + c];
+            const float wi = w_im_[(size_t)r * cols_ + c];
+            if( wr == 0.0f && wi == 0.0f ) continue;
+
+            const float* er = &eu_re_[(size_t)c * n];
+            const float* ei = &eu_im_[(size_t)c * n];
+            for( int i = 0; i < n; i++ )
+            {
+                sr[i] += wr * er[i] - wi * ei[i];
+                si[i] += wr * ei[i] + wi * er[i];
+            }
+        }
+    }
+
+    // AF[j][i] = sum_r e^{j k y_r v_j} S[r][i]
+    std::vector<float> acc_re( n ), acc_im( n );
+    for( int j = 0; j < n; j++ )
+    {
+        std::fill( acc_re.begin(), acc_re.end(), 0.0f );
+        std::fill( acc_im.begin(), acc_im.end(), 0.0f );
+
+        for( int r = 0; r < rows_; r++ )
+        {
+            if( !row_used_[r] ) continue;
+
+            const float a = ev_re_[(size_t)r * n + j];
+            const float b = ev_im_[(size_t)r * n + j];
+            const float* sr = &s_re_[(size_t)r * n];
+            const float* si = &s_im_[(size_t)r * n];
+            for( int i = 0; i < n; i++ )
+            {
+                acc_re[i] += a * sr[i] - b * si[i];
+                acc_im[i] += a * si[i] + b * sr[i];
+            }
+        }
+
+        const double v = GridValue( j );
+        float* p = &power_[(size_t)j * n];
+        for( int i = 0; i < n; i++ )
+        {
+            const double u = GridValue( i );
+            p[i] = ( u * u + v * v <= 1.0 ) ? acc_re[i] * acc_re[i] + acc_im[i] * acc_im[i] : 0.0f;
+        }
+    }
+}
+
+double Evaluator::PowerAt( double u, double v ) const
+{
+    // e^{j k x_c u} 를 column 마다 한 번만
+    const double cu = std::cos( k_ * dx_ * u ), su = std::sin( k_ * dx_ * u );
+    const double cv = std::cos( k_ * dy_ * v ), sv = std::sin( k_ * dy_ * v );
+
+    double re = 0, im = 0;
+    double vr = 1, vi = 0;
+    for( int r = 0; r < rows_; r++ )
+    {
+        if( row_used_[r] )
+        {
+            double sr = 0, si = 0;
+            double er = 1, ei = 0;
+            for( int c = 0; c < cols_; c++ )
+            {
+                const double wr = w_re_[(size_t)r * cols_ + c];
+                const double wi = w_im_[(size_t)r * cols_ + c];
+                sr += wr * er - wi * ei;
+                si += wr * ei + wi * er;
+
+                const double t = er * cu - ei * su;
+                ei = er * su + ei * cu;
+                er = t;
+            }
+
+            re += vr * sr - vi * si;
+            im += vr * si + vi * sr;
+        }
+
+        const double t = vr * cv - vi * sv;
+        vi = vr * sv + vi * cv;
+        vr = t;
+    }
+    return re * re + im * im;
+}
+
+Metrics Evaluator::Evaluate( float az, float el, const uint8_t* phase_idx, const uint8_t* gain )
+{
+    const int n = grid_;
+
+    SetWeights( phase_idx, gain );
+    ComputeGrid();
+
+    size_t peak = std::max_element( power_.begin(), power_.end() ) - power_.begin();
+
+    // grid 최대점에서 시작해 간격을 줄여 가며 직접 계산으로 peak 를 찾는다
+    double pu = GridValue( (int)( peak % n ) );
+    double pv = GridValue( (int)( peak / n ) );
+    double best = PowerAt( pu, pv );
+    for( double step = 1.0 / ( n - 1 ); step > 1e-7; )
+    {
+        bool moved = false;
+        const double cand[4][2] = { { pu + step, pv }, { pu - step, pv }, { pu, pv + step }, { pu, pv - step } };
+        for( auto& c : cand )
+        {
+            if( c[0] * c[0] + c[1] * c[1] > 1.0 ) continue;
+            double p = PowerAt( c[0], c[1] );
+            if( p > best )
+            {
+                best = p;
+                pu = c[0];
+                pv = c[1];
+                moved = true;
+            }
+        }
+        if( !moved ) step *= 0.5;
+    }
+
+    const float norm = best > 0 ? (float)( 1.0 / best ) : 0.0f;
+    for( auto& p : power_ ) p *= norm;
+
+    // main lobe : peak 에서 값이 커지지 않는 이웃으로만 퍼진 영역 (첫 null 까지). 나머지에서 최대가 sidelobe
+    // peak 가 grid 사이에 있으면 주변 cell 들 값이 같아서 float 오차만큼은 커져도 이어 간다
+    constexpr float FLAT = 1e-4f;
+    std::fill( visited_.begin(), visited_.end(), 0 );
+    std::vector<size_t> stack { peak };
+    visited_[peak] = 1;
+    while( !stack.empty() )
+    {
+        size_t at = stack.back();
+        stack.pop_back();
+        int i = (int)( at % n ), j = (int)( at / n );
+
+        const int nb[4][2] = { { i + 1, j }, { i - 1, j }, { i, j + 1 }, { i, j - 1 } };
+        for( auto& q : nb )
+        {
+            if( q[0] < 0 || q[0] >= n || q[1] < 0 || q[1] >= n ) continue;
+            size_t to = (size_t)q[1] * n + q[0];
+            if( visited_[to] || power_[to] <= 0.0f || power_[to] > power_[at] * ( 1.0f + FLAT ) ) continue;
+            visited_[to] = 1;
+            stack.push_back( to );
+        }
+    }
+
+    float sidelobe = 0.0f;
+    for( size_t at = 0; at < power_.size(); at++ )
+    {
+        if( !visited_[at] ) sidelobe = std::max( sidelobe, power_[at] );
+    }
+
+    Metrics m;
+    m.az = az;
+    m.el = el;
+    FromUV( pu, pv, m.peak_az, m.peak_el );
+    m.pointing_error_deg = AngleBetween( az, el, m.peak_az, m.peak_el );
+
+    double u0, v0;
+    ToUV( az, el, u0, v0 );
+    m.pointing_loss_db = best > 0 ? ToDb( PowerAt( u0, v0 ) / best ) : -300.0;
+    m.psl_db = ToDb( sidelobe );
+    return m;
+}
+
+std::vector<Metrics> EvaluateCodebook( const Layout::Compiled& layout, int is_tx, const std::vector<Beam>& beams,
+                                       const Config& config, int threads, BeamPipeline::IndexKernel kernel )
+{
+    const long long unsigned freq = is_tx ? 29500000000ULL : 19700000000ULL;
+
+    std::vector<Metrics> out( beams.size() );
+    if( threads <= 0 ) threads = (int)std::thread::hardware_concurrency();
+    threads = std::max( 1, std::min( threads, (int)beams.size() ) );
+
+    // beam 단위로 나눈다. thread 마다 Evaluator (table, scratch) 하나
+    std::atomic<size_t> next { 0 };
+    auto worker = [&]()
+    {
+        Evaluator ev( layout, is_tx, config );
+        std::vector<uint8_t> idx( layout.Size() );
+        for( size_t i = next++; i < beams.size(); i = next++ )
+        {
+            kernel( layout, beams[i].az, beams[i].el, freq, idx.data() );
+            out[i] = ev.Evaluate( beams[i].az, beams[i].el, idx.data() );
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for( int t = 1; t < threads; t++ ) pool.emplace_back( worker );
+    worker();
+    for( auto& t : pool ) t.join();
+    return out;
+}
+
+std::string Summary::Report() const
+{
+    if( beams == 0 ) return "no beams";
+
+    return Common::string_format( "%zu beams : pointing error mean %.3f p99 %.3f max %.3f deg (#%zu), "
+        "psl mean %.2f worst %.2f dB (#%zu), pointing loss worst %.2f dB",
+        beams, pointing_error_mean, pointing_error_p99, pointing_error_max, worst_pointing,
+        psl_mean_db, psl_worst_db, worst_psl, pointing_loss_worst_db );
+}
+
+Summary Summarize( const std::vector<Metrics>& metrics )
+{
+    Summary s;
+    s.beams = metrics.size();
+    if( metrics.empty() ) return s;
+
+    std::vector<double> errors;
+    errors.reserve( metrics.size() );
+    s.psl_worst_db = -300.0;
+    for( size_t i = 0; i < metrics.size(); i++ )
+    {
+        const Metrics& m = metrics[i];
+        errors.push_back( m.pointing_error_deg );
+        s.pointing_error_mean += m.pointing_error_deg;
+        s.psl_mean_db += m.psl_db;
+        s.pointing_loss_worst_db = std::min( s.pointing_loss_worst_db, m.pointing_loss_db );
+
+        if( m.pointing_error_deg > s.pointing_error_max )
+        {
+            s.pointing_error_max = m.pointing_error_deg;
+            s.worst_pointing = i;
+        }
+        if( m.psl_db > s.psl_worst_db )
+        {
+            s.psl_worst_db = m.psl_db;
+            s.worst_psl = i;
+        }
+    }
+    s.pointing_error_mean /= metrics.size();
+    s.psl_mean_db /= metrics.size();
+
+    std::sort( errors.begin(), errors.end() );
+    s.pointing_error_p99 = errors[std::min( errors.size() - 1, (size_t)( errors.size() * 0.99 ) )];
+    return s;
+}
+
+
+}
+}
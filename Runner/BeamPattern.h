@@ -0,0 +1,120 @@
+#ifndef __SPIBEAM_BEAM_PATTERN_H__
+#define __SPIBEAM_BEAM_PATTERN_H__
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "PanelLayout.h"
+#include "BeamPipeline.h"
+
+namespace SpiBeam {
+namespace Pattern {
+
+// BeamPipeline::PhaseOf 와 같은 좌표계의 direction cosine (el 90 = boresight)
+//   u = cos(el) cos(az), v = -cos(el) sin(az)
+void ToUV( double az, double el, double& u, double& v );
+void FromUV( double u, double v, double& az, double& el );
+
+// 두 방향 사이의 각도 (degree)
+double AngleBetween( double az0, double el0, double az1, double el1 );
+
+struct Config
+{
+    int grid = 256;                     // u, v 각각의 점 수 ([-1, 1] 구간)
+    long long unsigned freq = 0;        // 0 이면 tx 29.5GHz / rx 19.7GHz
+    int gain_max = 0;                   // gain code 의 최대값. amplitude = code / gain_max (0 이면 gain 무시, 균일)
+};
+
+struct Metrics
+{
+    float az = 0;                       // 요청 방향
+    float el = 0;
+    double peak_az = 0;                 // 실제 main beam 방향
+    double peak_el = 0;
+    double pointing_error_deg = 0;
+    double pointing_loss_db = 0;        // 요청 방향의 gain - peak gain (<= 0)
+    double psl_db = 0;                  // peak 대비 가장 큰 sidelobe (<= 0)
+
+    std::string Report() const;
+};
+
+// 양자화된 phase index (와 gain code) 로 array factor 를 계산한다.
+//   AF(u,v) = sum_r e^{j k y_r v} sum_c w_rc e^{j k x_c u}
+// element 가 (gx, gy) 격자 위에 있으므로 column 방향 합을 row 마다 먼저 하고 (rows x grid),
+// 그 결과를 row 방향으로 누적한다 (grid x grid). 안쪽 loop 는 모두 u 축 float 배열이라 SIMD 로 돈다.
+// element 가 poles 만큼 돌아가 배치되어 있어 (sequential rotation) 복사되는 phase 는 phase_idx - poles 로 본다
+class Evaluator
+{
+public:
+    Evaluator( const Layout::Compiled& layout, int is_tx, const Config& config = Config() );
+
+    // phase_idx / gain 은 layout 순서 (BeamPipeline::ComputeIndices 출력과 같은 순서). gain 이 nullptr 이면 균일
+    Metrics Evaluate( float az, float el, const uint8_t* phase_idx, const uint8_t* gain = nullptr );
+
+    // 마지막 Evaluate 의 |AF|^2 (peak = 1). grid x grid, v 행 우선, 보이지 않는 영역 (u^2 + v^2 > 1) 은 0
+    const std::vector<float>& Power() const { return power_; }
+    double GridValue( int i ) const { return -1.0 + 2.0 * i / ( grid_ - 1 ); }
+    int Grid() const { return grid_; }
+
+private:
+    void SetWeights( const uint8_t* phase_idx, const uint8_t* gain );
+    void ComputeGrid();
+    double PowerAt( double u, double v ) const;     // 한 방향만 직접 계산 (정규화 전)
+
+    int grid_;
+    int rows_;
+    int cols_;
+    double k_;                          // 2 pi / lambda [rad/mm]
+    double dx_;
+    double dy_;
+    int gain_max_;
+
+    const Layout::Compiled& layout_;
+    std::vector<float> pole_rad_;       // element (layout 순서) 별 poles [rad]
+
+    // row 우선 element weight (없는 element 는 0)
+    std::vector<float> w_re_, w_im_;
+    std::vector<uint8_t> row_used_;
+
+    // e^{j k x_c u_i} : cols x grid, e^{j k y_r v_j} : rows x grid
+    std::vector<float> eu_re_, eu_im_;
+    std::vector<float> ev_re_, ev_im_;
+
+    std::vector<float> s_re_, s_im_;    // rows x grid
+    std::vector<float> power_;          // grid x grid
+    std::vector<uint8_t> visited_;
+};
+
+// codebook 전체를 thread 로 나눠 검증. beam 마다 kernel 로 phase index 를 내고 Evaluate
+struct Beam
+{
+    float az;
+    float el;
+};
+
+std::vector<Metrics> EvaluateCodebook( const Layout::Compiled& layout, int is_tx, const std::vector<Beam>& beams,
+                                       const Config& config = Config(), int threads = 0,
+                                       BeamPipeline::IndexKernel kernel = BeamPipeline::ComputeIndicesFixed );
+
+struct Summary
+{
+    size_t beams = 0;
+    double pointing_error_mean = 0;
+    double pointing_error_p99 = 0;
+    double pointing_error_max = 0;
+    size_t worst_pointing = 0;          // index
+    double psl_mean_db = 0;
+    double psl_worst_db = 0;            // 가장 높은 (나쁜) sidelobe
+    size_t worst_psl = 0;
+    double pointing_loss_worst_db = 0;
+
+    std::string Report() const;
+};
+
+Summary Summarize( const std::vector<Metrics>& metrics );
+
+
+}
+}
+
+#endif
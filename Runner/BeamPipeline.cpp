@@ -0,0 +1,518 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#include "BeamPipeline.h"
+#include "TrigTable.h"
+
+namespace SpiBeam {
+
+using namespace std;
+
+// 전역 변수들 초기화
+float az_value = 0.0f;
+float el_value = 0.0f;
+long long unsigned freq_Hz = 1000000000ULL;  // 기본값 1GHz
+
+constexpr float INTELLIAN_PI = 3.14159265359f;  // 더 정확한 PI 값
+
+inline float to_radian(float deg)
+{
+    return deg * INTELLIAN_PI / 180.0f;
+}
+
+inline float to_degree(float rad)
+{
+    return rad * 180.0f / INTELLIAN_PI;
+}
+
+inline float normalize_degrees(float degrees)
+{
+    if(degrees >= 0.0 && degrees < 360.0)
+    {
+        return degrees;
+    }
+
+    float norm = std::fmod(degrees, 360.0);
+    if(norm < 0)
+    {
+        norm += 360.0;
+    }
+
+    return norm;
+}
+
+float phase(float xi, float yi)
+{
+    // 입력값 검증
+    if(isnan(az_value) || isnan(el_value) || freq_Hz == 0) {
+        cout << "Error: Invalid input values - az:" << az_value
+             << " el:" << el_value << " freq:" << freq_Hz << endl;
+        return 0.0f;
+    }
+
+    return BeamPipeline::PhaseOf(az_value, el_value, freq_Hz, xi, yi);
+}
+
+namespace BeamPipeline {
+
+bool ValidSteering( double az, double el, std::string* err )
+{
+    auto fail = [err]( const char* msg )
+    {
+        if( err ) *err = msg;
+        return false;
+    };
+
+    if( !std::isfinite( az ) || !std::isfinite( el ) ) return fail( "az/el must be finite" );
+    if( std::fabs( az ) > MAX_ABS_AZ_DEG ) return fail( "az must be within -360 ~ 360" );
+    if( el < MIN_EL_DEG || el > MAX_EL_DEG ) return fail( "el must be within 0 ~ 90" );
+    return true;
+}
+
+bool ValidFreqGHz( double freq_ghz, std::string* err )
+{
+    if( std::isfinite( freq_ghz ) && freq_ghz > 0 && freq_ghz <= MAX_FREQ_GHZ ) return true;
+    if( err ) *err = "freq must be within 0 ~ 100 GHz";
+    return false;
+}
+
+float PhaseOf( float az, float el, long long unsigned freq, float xi, float yi )
+{
+    float impl_phi = - az;
+    float phi_rad = to_radian(impl_phi);
+
+    float c_theta = std::cos(to_radian(el));
+    float c_phi = std::cos(phi_rad);
+    float s_phi = std::sin(phi_rad);
+
+    const float SPEED_OF_LIGHT = 300000000;
+    float lambda = SPEED_OF_LIGHT / freq;
+    float k0 = -2.0f * INTELLIAN_PI / lambda / 1000;
+
+    float p = to_degree(k0 * (xi * c_theta * c_phi + yi * c_theta * s_phi));
+    float p_nor = normalize_degrees(p);
+
+    return p_nor;
+}
+
+std::vector<Entry> BuildEntries( int is_tx, float dx, float dy )
+{
+    auto layout = Layout::Registry::Instance().Get( is_tx );
+    const Layout::Compiled& L = *layout;
+
+    std::vector<Entry> entries( L.Size() );
+
+    for (size_t k = 0; k < L.Size(); ++k)
+    {
+        int row = L.element[k] / L.cols;
+        int col = L.element[k] % L.cols;
+
+        // x_offset, y_offset 계산
+        double x_offset_ = col * dx;
+        double y_offset_ = row * dy;
+
+        entries[L.element[k]] = {L.bus[k], L.chip[k], L.channel[k], x_offset_, y_offset_, L.poles[k]};
+    }
+
+    return entries;
+}
+
+void ComputePhases( std::vector<Entry>& entries )
+{
+    for (auto& e : entries)
+    {
+        // 1. 위상(phase) 계산
+        e.calculated_phase = phase(e.x_offset, e.y_offset);
+        ApplyPoles( e );
+    }
+}
+
+void ComputePhases( std::vector<Entry>& entries, float az, float el, long long unsigned freq )
+{
+    for (auto& e : entries)
+    {
+        e.calculated_phase = PhaseOf(az, el, freq, e.x_offset, e.y_offset);
+        ApplyPoles( e );
+    }
+}
+
+void ApplyPoles( Entry& e )
+{
+
+    // 2. 최종 Phase 계산: calculated_phase + offset_value
+    e.final_phase = e.calculated_phase + e.poles;
+
+    // 3. 0-360 범위 유지
+    e.final_phase = std::fmod(e.final_phase, 360.0);
+    if (e.final_phase < 0) {
+        e.final_phase += 360.0;
+    }
+}
+
+void SortByBus( std::vector<Entry>& entries )
+{
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return std::tie(a.spi_id, a.chip_id, a.channel_id) <
+                std::tie(b.spi_id, b.chip_id, b.channel_id);
+    });
+}
+
+int PhaseIndex( double final_phase )
+{
+    return int(fmod(final_phase + 360.0, 360.0) / 5.625);
+}
+
+uint16_t EncodeValue( int int_phase, int is_tx )
+{
+    if(is_tx == 1)
+    {
+        return \
+        (( 0 & 0x01 ) << 0 ) \
+        | ((127 & 0x7f ) << 1) \
+        | ((3 & 0x03) << 8 ) \
+        | ((int_phase & 0x3f)<<10);
+    }
+
+    return \
+    (( 0 & 0x01 ) << 0 ) \
+    | ((1 & 0x1) << 3 ) \
+    | ((63 & 0x3f ) << 4) \
+    | ((int_phase & 0x3f)<<10);
+}
+
+void ComputeIndices( const Layout::Compiled& layout, float az, float el, long long unsigned freq, uint8_t* phase_idx )
+{
+    // PhaseOf 의 az/el/freq 항을 한 번만 계산. element 마다의 연산 순서는 PhaseOf + ApplyPoles 와 같다
+    // sin/cos 는 libm 대신 Q9.7 table (Trig::Check 참고)
+    float s_theta, c_theta, c_phi, s_phi;
+    Trig::SinCos(el, s_theta, c_theta);
+    Trig::SinCos(-az, s_phi, c_phi);
+
+    const float SPEED_OF_LIGHT = 300000000;
+    float lambda = SPEED_OF_LIGHT / freq;
+    float k0 = -2.0f * INTELLIAN_PI / lambda / 1000;
+
+    const float* x = layout.x.data();
+    const float* y = layout.y.data();
+    const int16_t* poles = layout.poles.data();
+    const size_t n = layout.Size();
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        float p = to_degree(k0 * (x[k] * c_theta * c_phi + y[k] * c_theta * s_phi));
+        double final_phase = std::fmod((double)normalize_degrees(p) + poles[k], 360.0);
+        if (final_phase < 0) final_phase += 360.0;
+        phase_idx[k] = (uint8_t)PhaseIndex(final_phase);
+    }
+}
+
+TurnSteps TurnStepsOf( const Layout::Compiled& layout, float az, float el, long long unsigned freq )
+{
+    // ComputeIndices 와 같은 식 : turns/mm = k0 / 2pi = -f / c, c = 3e8 m/s
+    float s_theta, c_theta, c_phi, s_phi;
+    Trig::SinCos(el, s_theta, c_theta);
+    Trig::SinCos(-az, s_phi, c_phi);
+
+    const double SPEED_OF_LIGHT_MM = 300000000.0 * 1000.0;
+    double k = -(double)freq / SPEED_OF_LIGHT_MM;
+
+    // element 하나 당 turn 증가량을 2^32 단위로. 정수 곱의 overflow 가 그대로 turn wrap
+    // nan / inf (freq 나 pitch 가 비정상) 는 llround 에 넘기지 않고 0 turn
+    auto to_fixed = [](double turns) {
+        if (!std::isfinite(turns)) return (uint32_t)0;
+        turns -= std::floor(turns);
+        return (uint32_t)(uint64_t)std::llround(std::ldexp(turns, 32));
+    };
+
+    TurnSteps t;
+    t.x = to_fixed(k * c_theta * c_phi * layout.dx);
+    t.y = to_fixed(k * c_theta * s_phi * layout.dy);
+    return t;
+}
+
+namespace {
+
+// phase_idx = (gx * step_x + gy * step_y + pole) 의 상위 6 bit
+void FixedScalar( const int32_t* gx, const int32_t* gy, const uint32_t* pole, size_t begin, size_t n,
+                  uint32_t sx, uint32_t sy, uint8_t* out )
+{
+    for (size_t k = begin; k < n; ++k)
+    {
+        uint32_t acc = (uint32_t)gx[k] * sx + (uint32_t)gy[k] * sy + pole[k];
+        out[k] = (uint8_t)(acc >> 26);
+    }
+}
+
+#if defined(__AVX2__)
+
+const char* FIXED_KERNEL = "avx2";
+
+size_t FixedSimd( const int32_t* gx, const int32_t* gy, const uint32_t* pole, size_t n,
+                  uint32_t sx, uint32_t sy, uint8_t* out )
+{
+    const __m256i vx = _mm256_set1_epi32((int)sx);
+    const __m256i vy = _mm256_set1_epi32((int)sy);
+    // packus 가 128bit lane 단위라 마지막에 dword 순서를 되돌린다
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    auto idx8 = [&](size_t k) {
+        __m256i ax = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(gx + k)), vx);
+        __m256i ay = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(gy + k)), vy);
+        __m256i acc = _mm256_add_epi32(_mm256_add_epi32(ax, ay), _mm256_loadu_si256((const __m256i*)(pole + k)));
+        return _mm256_srli_epi32(acc, 26);
+    };
+
+    size_t k = 0;
+    for (; k + 32 <= n; k += 32)
+    {
+        __m256i w01 = _mm256_packus_epi32(idx8(k), idx8(k + 8));
+        __m256i w23 = _mm256_packus_epi32(idx8(k + 16), idx8(k + 24));
+        __m256i b = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(w01, w23), order);
+        _mm256_storeu_si256((__m256i*)(out + k), b);
+    }
+    return k;
+}
+
+#elif defined(__SSE4_1__)
+
+const char* FIXED_KERNEL = "sse4.1";
+
+size_t FixedSimd( const int32_t* gx, const int32_t* gy, const uint32_t* pole, size_t n,
+                  uint32_t sx, uint32_t sy, uint8_t* out )
+{
+    const __m128i vx = _mm_set1_epi32((int)sx);
+    const __m128i vy = _mm_set1_epi32((int)sy);
+
+    auto idx4 = [&](size_t k) {
+        __m128i ax = _mm_mullo_epi32(_mm_loadu_si128((const __m128i*)(gx + k)), vx);
+        __m128i ay = _mm_mullo_epi32(_mm_loadu_si128((const __m128i*)(gy + k)), vy);
+        __m128i acc = _mm_add_epi32(_mm_add_epi32(ax, ay), _mm_loadu_si128((const __m128i*)(pole + k)));
+        return _mm_srli_epi32(acc, 26);
+    };
+
+    size_t k = 0;
+    for (; k + 16 <= n; k += 16)
+    {
+        __m128i w01 = _mm_packus_epi32(idx4(k), idx4(k + 4));
+        __m128i w23 = _mm_packus_epi32(idx4(k + 8), idx4(k + 12));
+        _mm_storeu_si128((__m128i*)(out + k), _mm_packus_epi16(w01, w23));
+    }
+    return k;
+}
+
+#elif defined(__ARM_NEON)
+
+const char* FIXED_KERNEL = "neon";
+
+size_t FixedSimd( const int32_t* gx, const int32_t* gy, const uint32_t* pole, size_t n,
+                  uint32_t sx, uint32_t sy, uint8_t* out )
+{
+    const uint32x4_t vx = vdupq_n_u32(sx);
+    const uint32x4_t vy = vdupq_n_u32(sy);
+
+    auto idx4 = [&](size_t k) {
+        uint32x4_t acc = vld1q_u32(pole + k);
+        acc = vmlaq_u32(acc, vreinterpretq_u32_s32(vld1q_s32(gx + k)), vx);
+        acc = vmlaq_u32(acc, vreinterpretq_u32_s32(vld1q_s32(gy + k)), vy);
+        return vmovn_u32(vshrq_n_u32(acc, 26));
+    };
+
+    size_t k = 0;
+    for (; k + 16 <= n; k += 16)
+    {
+        uint8x8_t lo = vmovn_u16(vcombine_u16(idx4(k), idx4(k + 4)));
+        uint8x8_t hi = vmovn_u16(vcombine_u16(idx4(k + 8), idx4(k + 12)));
+        vst1q_u8(out + k, vcombine_u8(lo, hi));
+    }
+    return k;
+}
+
+#else
+
+const char* FIXED_KERNEL = "scalar";
+
+size_t FixedSimd( const int32_t*, const int32_t*, const uint32_t*, size_t, uint32_t, uint32_t, uint8_t* )
+{
+    return 0;
+}
+
+#endif
+
+}
+
+const char* FixedKernelName()
+{
+    return FIXED_KERNEL;
+}
+
+void ComputeIndicesFixed( const Layout::Compiled& layout, float az, float el, long long unsigned freq, uint8_t* phase_idx )
+{
+    TurnSteps t = TurnStepsOf(layout, az, el, freq);
+    const size_t n = layout.Size();
+
+    size_t done = FixedSimd(layout.gx.data(), layout.gy.data(), layout.pole_turns.data(), n, t.x, t.y, phase_idx);
+    FixedScalar(layout.gx.data(), layout.gy.data(), layout.pole_turns.data(), done, n, t.x, t.y, phase_idx);
+}
+
+size_t CompareIndices( const Layout::Compiled& layout, int is_tx, float az_step, float el_step, size_t* total, IndexKernel kernel )
+{
+    const long long unsigned freq = is_tx ? 29500000000ULL : 19700000000ULL;
+    std::vector<uint8_t> idx(layout.Size());
+    size_t mismatch = 0, count = 0;
+
+    if (!(az_step > 0) || !(el_step > 0))
+    {
+        if (total) *total = 0;
+        return 0;
+    }
+
+    // 각도를 누적하지 않고 index 로 계산 (작은 step 이 float 반올림에 묻혀 멈추지 않도록)
+    for (int i = 0; i * el_step <= 90.0f; i++)
+    {
+        const float el = i * el_step;
+        for (int j = 0; j * az_step < 360.0f; j++)
+        {
+            const float az = j * az_step;
+            kernel(layout, az, el, freq, idx.data());
+            for (size_t k = 0; k < layout.Size(); ++k)
+            {
+                Entry e {};
+                e.calculated_phase = PhaseOf(az, el, freq, layout.x[k], layout.y[k]);
+                e.poles = layout.poles[k];
+                ApplyPoles(e);
+
+                // 5.625 도 경계에서 한 칸 어긋난 것 (63 <-> 0 wrap 포함) 도 다른 것으로 센다
+                if (PhaseIndex(e.final_phase) != idx[k]) mismatch++;
+                count++;
+            }
+        }
+    }
+
+    if (total) *total = count;
+    return mismatch;
+}
+
+namespace {
+
+template <typename ValueFn>
+size_t PackFrames( const Layout::Compiled& layout, int bus, std::vector<uint32_t>& words, ValueFn value_of )
+{
+    const size_t begin = layout.bus_begin[bus];
+    const size_t end = layout.bus_begin[bus + 1];
+    const size_t bytes = (end - begin) * 5;
+
+    words.assign((bytes + 3) / 4, 0);
+
+    // 5 byte frame 을 big-endian word 열로 그대로 이어 붙인다 (BytePacker 와 같은 byte 순서)
+    size_t pos = 0;
+    auto put = [&](uint8_t b)
+    {
+        words[pos >> 2] |= uint32_t(b) << (24 - 8 * (pos & 3));
+        pos++;
+    };
+
+    for (size_t k = begin; k < end; ++k)
+    {
+        uint16_t value = value_of(k);
+        put(0x28);
+        put(layout.chip[k]);
+        put(layout.channel[k]);
+        put(static_cast<uint8_t>((value >> 8) & 0xFF));
+        put(static_cast<uint8_t>(value & 0xFF));
+    }
+    return bytes;
+}
+
+}
+
+size_t PackBus( const Layout::Compiled& layout, const uint8_t* phase_idx, int is_tx, int bus, std::vector<uint32_t>& words )
+{
+    return PackFrames(layout, bus, words, [&](size_t k) { return EncodeValue(phase_idx[k], is_tx); });
+}
+
+size_t PackBusValues( const Layout::Compiled& layout, const uint8_t* values, int bus, std::vector<uint32_t>& words )
+{
+    return PackFrames(layout, bus, words, [&](size_t k) { return static_cast<uint16_t>(values[2 * k] << 8 | values[2 * k + 1]); });
+}
+
+void PackPhases6( const uint8_t* phase_idx, size_t n, uint8_t* out )
+{
+    // 4 element = 3 byte
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4, out += 3)
+    {
+        uint32_t bits = (uint32_t)(phase_idx[k] & 0x3f) << 18 | (uint32_t)(phase_idx[k + 1] & 0x3f) << 12
+                      | (uint32_t)(phase_idx[k + 2] & 0x3f) << 6 | (phase_idx[k + 3] & 0x3f);
+        out[0] = (uint8_t)(bits >> 16);
+        out[1] = (uint8_t)(bits >> 8);
+        out[2] = (uint8_t)bits;
+    }
+
+    // 나머지 element 는 남는 bit 를 0 으로
+    uint32_t bits = 0;
+    for (size_t i = 0; k + i < n; i++) bits |= (uint32_t)(phase_idx[k + i] & 0x3f) << (18 - 6 * i);
+    for (size_t i = 0; i < Phase6Bytes(n - k); i++) out[i] = (uint8_t)(bits >> (16 - 8 * i));
+}
+
+void UnpackPhases6( const uint8_t* in, size_t n, uint8_t* phase_idx )
+{
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4, in += 3)
+    {
+        uint32_t bits = (uint32_t)in[0] << 16 | (uint32_t)in[1] << 8 | in[2];
+        phase_idx[k]     = (uint8_t)((bits >> 18) & 0x3f);
+        phase_idx[k + 1] = (uint8_t)((bits >> 12) & 0x3f);
+        phase_idx[k + 2] = (uint8_t)((bits >> 6) & 0x3f);
+        phase_idx[k + 3] = (uint8_t)(bits & 0x3f);
+    }
+
+    uint32_t bits = 0;
+    for (size_t i = 0; i < Phase6Bytes(n - k); i++) bits |= (uint32_t)in[i] << (16 - 8 * i);
+    for (size_t i = 0; k + i < n; i++) phase_idx[k + i] = (uint8_t)((bits >> (18 - 6 * i)) & 0x3f);
+}
+
+void BytePacker::Push( int bus, uint8_t chip, uint8_t reg, uint16_t value )
+{
+    auto& q = queues_[bus];
+    q.push_back(0x28);
+    q.push_back(chip);
+    q.push_back(reg);
+    q.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+    q.push_back(static_cast<uint8_t>(value & 0xFF));
+}
+
+bool BytePacker::PopWord( int bus, uint32_t& word )
+{
+    auto& q = queues_[bus];
+    if (q.size() < 4) return false;
+
+    uint32_t data = 0;
+    for (int i = 0; i < 4; ++i) {
+        data <<= 8;
+        data |= q.front();
+        q.pop_front();
+    }
+    word = data;
+    return true;
+}
+
+size_t BytePacker::Pending( int bus ) const
+{
+    auto I = queues_.find( bus );
+    return I == queues_.end() ? 0 : I->second.size();
+}
+
+void BytePacker::Clear()
+{
+    queues_.clear();
+}
+
+
+}
+}
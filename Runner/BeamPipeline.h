@@ -0,0 +1,121 @@
+#ifndef __SPIBEAM_BEAM_PIPELINE_H__
+#define __SPIBEAM_BEAM_PIPELINE_H__
+
+#include <map>
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "PanelLayout.h"
+
+namespace SpiBeam {
+
+// 현재 beam 입력 (phase() 가 참조)
+extern float az_value;
+extern float el_value;
+extern long long unsigned freq_Hz;
+
+float phase(float xi, float yi);
+
+namespace BeamPipeline {
+
+// remote / console / scan 에서 받는 steering 입력의 허용 범위
+constexpr double MAX_ABS_AZ_DEG = 360.0;
+constexpr double MIN_EL_DEG = 0.0;
+constexpr double MAX_EL_DEG = 90.0;
+constexpr double MAX_FREQ_GHZ = 100.0;
+
+// az/el 이 유한하고 |az| <= 360, 0 <= el <= 90 이면 true. 아니면 err 에 이유
+bool ValidSteering( double az, double el, std::string* err = nullptr );
+// 0 < freq <= 100 GHz
+bool ValidFreqGHz( double freq_ghz, std::string* err = nullptr );
+
+// phase() 와 같은 계산. 전역 az/el/freq 를 쓰지 않으므로 thread 에서 사용 가능
+float PhaseOf( float az, float el, long long unsigned freq, float xi, float yi );
+
+struct Entry
+{
+    int spi_id;
+    int chip_id;
+    int channel_id;
+    double x_offset;
+    double y_offset;
+    int poles;
+    double calculated_phase; // 계산된 phase 값
+    double final_phase;      // offset 적용 후 최종 phase 값
+};
+
+// Layout::Registry 의 panel element 목록 (row/col 순서)
+std::vector<Entry> BuildEntries( int is_tx, float dx, float dy );
+
+// phase() + poles, 0~360 범위로 wrap
+void ComputePhases( std::vector<Entry>& entries );
+void ComputePhases( std::vector<Entry>& entries, float az, float el, long long unsigned freq );
+void ApplyPoles( Entry& e );
+
+// (spi_id, chip_id, channel_id) 순 정렬 : FIFO 에 쓰는 순서
+void SortByBus( std::vector<Entry>& entries );
+
+int PhaseIndex( double final_phase );
+uint16_t EncodeValue( int int_phase, int is_tx );
+
+// compiled layout 을 그대로 훑는 flat kernel. Entry 경로와 같은 식을 layout 의 bus 순서로 낸다.
+// element 당 비용이 일정해서 tile / bus 수에 선형
+void ComputeIndices( const Layout::Compiled& layout, float az, float el, long long unsigned freq, uint8_t* phase_idx );
+
+// 정수 kernel : phase 를 2^32 = 1 turn 인 uint32 로 누적한다.
+//   acc = gx * step.x + gy * step.y + pole_turns  (overflow 가 곧 360 도 wrap)
+//   phase_idx = acc >> 26  (상위 6 bit = floor(phase / 5.625))
+// fmod / float 변환 없이 element 당 곱 2 번, 덧셈 2 번. AVX2 / SSE4.1 / NEON 이면 SIMD 로 돈다
+struct TurnSteps
+{
+    uint32_t x;   // col 하나 당 turn * 2^32
+    uint32_t y;   // row 하나 당
+};
+TurnSteps TurnStepsOf( const Layout::Compiled& layout, float az, float el, long long unsigned freq );
+
+void ComputeIndicesFixed( const Layout::Compiled& layout, float az, float el, long long unsigned freq, uint8_t* phase_idx );
+
+// build flag 로 선택된 구현 : "avx2" | "sse4.1" | "neon" | "scalar"
+const char* FixedKernelName();
+
+// az/el grid 를 훑으며 kernel 과 float 경로 (PhaseOf + ApplyPoles) 의 phase index 가 다른 element 수.
+// step 이 0 이하 (또는 NaN) 이면 아무것도 비교하지 않는다 (total 0)
+using IndexKernel = void (*)( const Layout::Compiled&, float, float, long long unsigned, uint8_t* );
+size_t CompareIndices( const Layout::Compiled& layout, int is_tx, float az_step, float el_step, size_t* total = nullptr,
+                       IndexKernel kernel = ComputeIndices );
+
+// bus 하나의 frame(0x28, chip, channel, hi, lo) 을 FIFO word 로 pack.
+// 마지막 word 의 남는 byte 는 0, 반환값은 frame byte 수 (bus length register 값)
+size_t PackBus( const Layout::Compiled& layout, const uint8_t* phase_idx, int is_tx, int bus, std::vector<uint32_t>& words );
+// 위와 같지만 register 값을 그대로 받는다 (BINARY payload : layout 순서로 element 마다 big-endian 2 byte)
+size_t PackBusValues( const Layout::Compiled& layout, const uint8_t* values, int bus, std::vector<uint32_t>& words );
+
+// compact phase payload : "BINARY:" + mode byte + element 마다 6 bit phase_idx (layout 의 bus 순서, MSB first).
+// 1024 element 면 768 byte. gain / control bit 는 보내지 않고 EncodeValue 로 mode 에 맞춰 채운다
+constexpr uint8_t PHASE6_MODE_RX = 0xA0;
+constexpr uint8_t PHASE6_MODE_TX = 0xA1;
+
+inline size_t Phase6Bytes( size_t elements ) { return ( elements * 6 + 7 ) / 8; }
+void PackPhases6( const uint8_t* phase_idx, size_t n, uint8_t* out );
+void UnpackPhases6( const uint8_t* in, size_t n, uint8_t* phase_idx );
+
+// 5 byte SPI frame(0x28, chip, reg, hi, lo) 을 bus 별 byte queue 에 쌓고
+// FIFO data register 에 쓸 32bit word 단위로 꺼낸다
+class BytePacker
+{
+public:
+    void Push( int bus, uint8_t chip, uint8_t reg, uint16_t value );
+    bool PopWord( int bus, uint32_t& word );
+    size_t Pending( int bus ) const;
+    void Clear();
+
+private:
+    std::map<int, std::deque<uint8_t>> queues_;
+};
+
+
+}
+}
+
+#endif
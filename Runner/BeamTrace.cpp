@@ -0,0 +1,230 @@
+#include <limits>
+#include <algorithm>
+#include <sys/resource.h>
+#include "string_util.hpp"
+#include "BeamTrace.h"
+
+namespace SpiBeam {
+namespace Trace {
+
+static thread_local uint64_t t_beam_start_ns = 0;
+static thread_local uint64_t t_received_ns = 0;
+
+static std::atomic<bool> s_rusage_enabled { false };
+static thread_local bool t_rusage_valid = false;
+static thread_local rusage t_rusage_start;
+
+const char* StageName( Stage s )
+{
+    switch( s )
+    {
+        case Stage::UdpReceive:   return "udp_receive";
+        case Stage::FrameDecode:  return "frame_decode";
+        case Stage::Decompress:   return "decompress";
+        case Stage::PhaseCompute: return "phase_compute";
+        case Stage::Pack:         return "pack";
+        case Stage::FifoFill:     return "fifo_fill";
+        case Stage::Trigger:      return "trigger";
+        case Stage::Completion:   return "completion";
+        case Stage::EndToEnd:     return "end_to_end";
+        default:                  return "NA";
+    }
+}
+
+int Histogram::BucketOf( uint64_t v )
+{
+    if( v < (uint64_t)SUB_COUNT ) return (int)v;
+
+    int msb = 63 - __builtin_clzll( v );
+    int shift = msb - SUB_BITS;
+    return ((shift + 1) << SUB_BITS) + (int)((v >> shift) & (SUB_COUNT - 1));
+}
+
+uint64_t Histogram::BucketLowerBound( int idx )
+{
+    if( idx < SUB_COUNT ) return (uint64_t)idx;
+
+    int shift = (idx >> SUB_BITS) - 1;
+    uint64_t sub = (uint64_t)(idx & (SUB_COUNT - 1));
+    return (SUB_COUNT + sub) << shift;
+}
+
+void Histogram::Record( uint64_t ns )
+{
+    buckets_[BucketOf( ns )].fetch_add( 1, std::memory_order_relaxed );
+    count_.fetch_add( 1, std::memory_order_relaxed );
+    sum_.fetch_add( ns, std::memory_order_relaxed );
+
+    uint64_t cur = min_.load( std::memory_order_relaxed );
+    while( ns < cur && !min_.compare_exchange_weak( cur, ns, std::memory_order_relaxed ) ) {}
+
+    cur = max_.load( std::memory_order_relaxed );
+    while( ns > cur && !max_.compare_exchange_weak( cur, ns, std::memory_order_relaxed ) ) {}
+}
+
+void Histogram::Reset()
+{
+    for( auto& b : buckets_ ) b.store( 0, std::memory_order_relaxed );
+    count_.store( 0, std::memory_order_relaxed );
+    sum_.store( 0, std::memory_order_relaxed );
+    min_.store( std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed );
+    max_.store( 0, std::memory_order_relaxed );
+}
+
+uint64_t Histogram::Min() const
+{
+    return Count() ? min_.load( std::memory_order_relaxed ) : 0;
+}
+
+double Histogram::Mean() const
+{
+    uint64_t n = Count();
+    return n ? (double)sum_.load( std::memory_order_relaxed ) / n : 0.0;
+}
+
+uint64_t Histogram::Percentile( double p ) const
+{
+    uint64_t n = Count();
+    if( n == 0 ) return 0;
+
+    uint64_t target = (uint64_t)(p / 100.0 * n);
+    if( target >= n ) target = n - 1;
+
+    uint64_t seen = 0;
+    for( int i = 0; i < BUCKETS; i++ )
+    {
+        seen += buckets_[i].load( std::memory_order_relaxed );
+        if( seen > target )
+        {
+            // bucket 중간값으로 보고
+            uint64_t lo = BucketLowerBound( i );
+            uint64_t hi = (i + 1 < BUCKETS) ? BucketLowerBound( i + 1 ) : lo;
+            return std::min( lo + (hi - lo) / 2, Max() );
+        }
+    }
+    return Max();
+}
+
+Tracer& Tracer::Instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::~Tracer()
+{
+    // 종료 시점 dump
+    if( hist_[(int)Stage::UdpReceive].Count() || hist_[(int)Stage::PhaseCompute].Count() )
+    {
+        Dump( stdout );
+    }
+}
+
+void Tracer::BeginBeam( uint64_t t0_ns )
+{
+    t_beam_start_ns = t0_ns;
+    t_rusage_valid = s_rusage_enabled.load( std::memory_order_relaxed ) && getrusage( RUSAGE_THREAD, &t_rusage_start ) == 0;
+}
+
+void Tracer::EndBeam()
+{
+    if( t_beam_start_ns == 0 ) return;
+
+    Tracer& tracer = Instance();
+    tracer.Record( Stage::EndToEnd, NowNs() - t_beam_start_ns );
+    t_beam_start_ns = 0;
+
+    rusage ru;
+    if( t_rusage_valid && getrusage( RUSAGE_THREAD, &ru ) == 0 )
+    {
+        tracer.faults_.Record( ( ru.ru_minflt - t_rusage_start.ru_minflt ) + ( ru.ru_majflt - t_rusage_start.ru_majflt ) );
+        tracer.switches_.Record( ( ru.ru_nvcsw - t_rusage_start.ru_nvcsw ) + ( ru.ru_nivcsw - t_rusage_start.ru_nivcsw ) );
+    }
+    t_rusage_valid = false;
+}
+
+void Tracer::AbortBeam()
+{
+    t_beam_start_ns = 0;
+    t_rusage_valid = false;
+}
+
+bool Tracer::InBeam()
+{
+    return t_beam_start_ns != 0;
+}
+
+uint64_t Tracer::BeamStart()
+{
+    return t_beam_start_ns;
+}
+
+void Tracer::SetReceived( uint64_t t_ns )
+{
+    t_received_ns = t_ns;
+}
+
+uint64_t Tracer::Received()
+{
+    return t_received_ns;
+}
+
+void Tracer::EnableResourceUsage( bool on )
+{
+    s_rusage_enabled = on;
+}
+
+bool Tracer::ResourceUsageEnabled()
+{
+    return s_rusage_enabled.load( std::memory_order_relaxed );
+}
+
+std::string Tracer::Report() const
+{
+    // spiterm 응답 한 줄에 들어가도록 us 단위로 짧게
+    std::string rep = "stage         count    p50us    p99us    maxus";
+    for( int i = 0; i < (int)Stage::Count; i++ )
+    {
+        auto& h = hist_[i];
+        if( h.Count() == 0 ) continue;
+
+        rep += Common::string_format( "\r\n%-13s %5llu %8.1f %8.1f %8.1f",
+            StageName( (Stage)i ),
+            (unsigned long long)h.Count(),
+            h.Percentile( 50.0 ) / 1000.0,
+            h.Percentile( 99.0 ) / 1000.0,
+            h.Max() / 1000.0 );
+    }
+    return rep;
+}
+
+void Tracer::Dump( FILE* fp ) const
+{
+    fprintf( fp, "=== beam latency trace (ns) ===\n" );
+    for( int i = 0; i < (int)Stage::Count; i++ )
+    {
+        auto& h = hist_[i];
+        fprintf( fp, "%-13s count=%llu min=%llu mean=%.0f p50=%llu p90=%llu p99=%llu p999=%llu max=%llu\n",
+            StageName( (Stage)i ),
+            (unsigned long long)h.Count(),
+            (unsigned long long)h.Min(),
+            h.Mean(),
+            (unsigned long long)h.Percentile( 50.0 ),
+            (unsigned long long)h.Percentile( 90.0 ),
+            (unsigned long long)h.Percentile( 99.0 ),
+            (unsigned long long)h.Percentile( 99.9 ),
+            (unsigned long long)h.Max() );
+    }
+    fflush( fp );
+}
+
+void Tracer::Reset()
+{
+    for( auto& h : hist_ ) h.Reset();
+    faults_.Reset();
+    switches_.Reset();
+}
+
+
+}
+}
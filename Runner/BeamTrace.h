@@ -0,0 +1,141 @@
+#ifndef __SPIBEAM_BEAM_TRACE_H__
+#define __SPIBEAM_BEAM_TRACE_H__
+
+#include <atomic>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+
+namespace SpiBeam {
+namespace Trace {
+
+// datagram 수신부터 FIFO drain 까지의 구간
+enum class Stage : int
+{
+    UdpReceive = 0,     // receive callback 전체 (datagram in -> reply out)
+    FrameDecode,        // DecodeFrame
+    Decompress,         // zlib inflate
+    PhaseCompute,       // element 별 phase 계산
+    Pack,               // byte queue -> 32bit word packing
+    FifoFill,           // FIFO data/length/interrupt register write
+    Trigger,            // length/execute/send register write
+    Completion,         // send register 가 0 이 될 때까지 polling
+    EndToEnd,           // beam 의 첫 datagram (start / BINARY) 수신 -> done 의 Completion 관측
+
+    Count
+};
+
+const char* StageName( Stage s );
+
+inline uint64_t NowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+// lock-free log-linear (HDR 방식) histogram, 단위 ns
+//   2^k 구간마다 16 개 sub bucket -> 상대 오차 ~6%
+class Histogram
+{
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    Histogram() { Reset(); }
+
+    void Record( uint64_t ns );
+    void Reset();
+
+    uint64_t Count() const { return count_.load( std::memory_order_relaxed ); }
+    uint64_t Min() const;
+    uint64_t Max() const { return max_.load( std::memory_order_relaxed ); }
+    double Mean() const;
+    uint64_t Percentile( double p ) const;
+
+    static int BucketOf( uint64_t v );
+    static uint64_t BucketLowerBound( int idx );
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKETS];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> min_;
+    std::atomic<uint64_t> max_;
+};
+
+class Tracer
+{
+public:
+    static Tracer& Instance();
+
+    void Record( Stage s, uint64_t ns ) { hist_[(int)s].Record( ns ); }
+    const Histogram& Get( Stage s ) const { return hist_[(int)s]; }
+
+    // 현재 thread 에서 처리 중인 beam 의 시작 시각 (EndToEnd 용)
+    static void BeginBeam( uint64_t t0_ns );
+    static void EndBeam();
+    // 끝나지 않은 beam (거부, 중단) 은 기록하지 않고 버린다
+    static void AbortBeam();
+    static bool InBeam();
+    // 열린 beam 의 시작 시각, 없으면 0
+    static uint64_t BeamStart();
+
+    // 원격 명령이 든 datagram 의 수신 시각 (session worker 가 datagram 마다 설정, 없으면 0).
+    // start .. done 처럼 여러 datagram 에 걸친 beam 은 첫 datagram 의 이 시각부터 잰다
+    static void SetReceived( uint64_t t_ns );
+    static uint64_t Received();
+
+    // 켜 두면 BeginBeam .. EndBeam 사이의 page fault / context switch 수 (getrusage RUSAGE_THREAD) 도 기록
+    static void EnableResourceUsage( bool on );
+    static bool ResourceUsageEnabled();
+    const Histogram& PageFaults() const { return faults_; }
+    const Histogram& ContextSwitches() const { return switches_; }
+
+    std::string Report() const;
+    void Dump( FILE* fp ) const;
+    void Reset();
+
+private:
+    Tracer() {}
+    ~Tracer();
+    Histogram hist_[(int)Stage::Count];
+    Histogram faults_;      // beam 당 minor + major fault
+    Histogram switches_;    // beam 당 voluntary + involuntary switch
+};
+
+// scope 동안의 경과 시간을 stage 에 기록
+class Probe
+{
+public:
+    explicit Probe( Stage s ) : stage_( s ), t0_( NowNs() ) {}
+    ~Probe() { Tracer::Instance().Record( stage_, NowNs() - t0_ ); }
+
+    Probe( const Probe& ) = delete;
+    Probe& operator=( const Probe& ) = delete;
+
+private:
+    Stage stage_;
+    uint64_t t0_;
+};
+
+// 여러 번 끊어서 측정한 시간을 모아 한 번에 기록 (interleave 된 구간용)
+class Span
+{
+public:
+    void Start() { t0_ = NowNs(); }
+    void Stop() { total_ += NowNs() - t0_; }
+    uint64_t Total() const { return total_; }
+    void Commit( Stage s ) const { Tracer::Instance().Record( s, total_ ); }
+
+private:
+    uint64_t t0_ = 0;
+    uint64_t total_ = 0;
+};
+
+
+}
+}
+
+#endif
@@ -0,0 +1,187 @@
+#include <cstdlib>
+#include <algorithm>
+#include <zlib.h>
+#include "string_util.hpp"
+#include "BusStreams.h"
+#include "RtProfile.h"
+#include "ZDict.h"
+
+namespace SpiBeam {
+namespace BusStreams {
+
+bool Parse( const uint8_t* payload, size_t size, int num_bus, std::vector<Stream>& streams, std::string* err )
+{
+    auto fail = [err]( const std::string& msg )
+    {
+        if( err ) *err = msg;
+        return false;
+    };
+
+    if( size < 2 || payload[0] != MAGIC ) return fail( "not a bus stream payload" );
+    if( payload[1] != num_bus ) return fail( Common::string_format( "bus count %d, layout has %d", payload[1], num_bus ) );
+
+    size_t table = 2 + 4 * (size_t)num_bus;
+    if( size < table ) return fail( "offset table truncated" );
+
+    streams.resize( num_bus );
+    size_t begin = 0;
+    for( int bus = 0; bus < num_bus; bus++ )
+    {
+        const uint8_t* p = payload + 2 + 4 * bus;
+        size_t end = (size_t)p[0] << 24 | (size_t)p[1] << 16 | (size_t)p[2] << 8 | p[3];
+        if( end < begin || table + end > size ) return fail( Common::string_format( "bad offset for bus %d", bus ) );
+
+        streams[bus].data = payload + table + begin;
+        streams[bus].size = end - begin;
+        begin = end;
+    }
+
+    if( table + begin != size ) return fail( "trailing bytes after last stream" );
+    return true;
+}
+
+std::vector<uint8_t> Encode( const Layout::Compiled& layout, const std::vector<uint8_t>& raw, int level )
+{
+    std::vector<uint8_t> out( 2 + 4 * layout.num_bus, 0 );
+    out[0] = MAGIC;
+    out[1] = (uint8_t)layout.num_bus;
+
+    size_t table = out.size();
+    for( int bus = 0; bus < layout.num_bus; bus++ )
+    {
+        size_t n = layout.BusSize( bus ) * 2;
+        size_t src = 3 + layout.bus_begin[bus] * 2;
+        if( n > 0 && src + n <= raw.size() )
+        {
+            uLongf len = compressBound( n );
+            size_t at = out.size();
+            out.resize( at + len );
+            compress2( out.data() + at, &len, raw.data() + src, n, level );
+            out.resize( at + len );
+        }
+
+        uint32_t end = (uint32_t)( out.size() - table );
+        uint8_t* p = out.data() + 2 + 4 * bus;
+        p[0] = end >> 24;
+        p[1] = end >> 16;
+        p[2] = end >> 8;
+        p[3] = end;
+    }
+    return out;
+}
+
+bool Inflate( const Stream& stream, uint8_t* out, size_t out_size )
+{
+    if( out_size == 0 ) return stream.size == 0;
+
+    // FDICT 가 켜진 stream 은 preset dictionary 로
+    uint32_t id;
+    if( ZDict::StreamDictId( stream.data, stream.size, id ) )
+        return ZDict::Dictionary::Instance().Inflate( stream.data, stream.size, out, out_size );
+
+    uLongf len = out_size;
+    return uncompress( out, &len, stream.data, stream.size ) == Z_OK && len == out_size;
+}
+
+Pool& Pool::Instance()
+{
+    static Pool pool;
+    return pool;
+}
+
+Pool::Pool()
+{
+    // bus 당 하나, 단 core 수보다 많으면 inflate 가 서로 기다리기만 한다
+    int workers = std::max( 1, std::min( 8, (int)std::thread::hardware_concurrency() ) );
+    const char* env = getenv( "SPIBEAM_BUS_WORKERS" );
+    if( env && atoi( env ) > 0 ) workers = atoi( env );
+
+    // 호출한 thread 도 하나로 센다
+    for( int i = 1; i < workers; i++ ) threads_.emplace_back( [this]{ Loop(); } );
+}
+
+Pool::~Pool()
+{
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for( auto& t : threads_ ) t.join();
+}
+
+void Pool::Run( int n, const std::function<void(int)>& fn )
+{
+    std::lock_guard<std::mutex> run_lock( run_mutex_ );
+
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        job_ = &fn;
+        job_size_ = n;
+        next_ = 0;
+        finished_ = 0;
+        error_ = nullptr;
+        generation_++;
+    }
+    cv_.notify_all();
+
+    Drain();
+
+    // 일을 잡은 worker 가 모두 빠져나간 뒤에 다음 job 을 받는다
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        done_cv_.wait( lock, [this]{ return finished_ == job_size_ && active_ == 0; } );
+        job_ = nullptr;
+        std::swap( error, error_ );
+    }
+    if( error ) std::rethrow_exception( error );
+}
+
+void Pool::Drain()
+{
+    for( int i; ( i = next_.fetch_add( 1 ) ) < job_size_; )
+    {
+        // worker thread 밖으로 새면 std::terminate. 잡아서 Run 이 넘겨준다
+        std::exception_ptr error;
+        try
+        {
+            (*job_)( i );
+        }
+        catch( ... )
+        {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock( mutex_ );
+        if( error && !error_ ) error_ = error;
+        if( ++finished_ == job_size_ ) done_cv_.notify_all();
+    }
+}
+
+void Pool::Loop()
+{
+    // FIFO 를 채우는 thread 이므로 hardware cpu / priority 로
+    Rt::Runtime::Instance().EnterThread( Rt::Role::Hardware );
+
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock( mutex_ );
+    while( true )
+    {
+        cv_.wait( lock, [&]{ return stop_ || ( job_ && generation_ != seen ); } );
+        if( stop_ ) break;
+
+        seen = generation_;
+        active_++;
+        lock.unlock();
+
+        Drain();
+
+        lock.lock();
+        if( --active_ == 0 ) done_cv_.notify_all();
+    }
+}
+
+
+}
+}
@@ -0,0 +1,83 @@
+#ifndef __SPIBEAM_BUS_STREAMS_H__
+#define __SPIBEAM_BUS_STREAMS_H__
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+#include "PanelLayout.h"
+
+namespace SpiBeam {
+namespace BusStreams {
+
+// bus 별로 따로 압축한 BINARY payload
+//   "BINARY:" + MAGIC + N(bus 수) + N x uint32 big-endian (각 stream 의 끝 offset, stream 영역 시작 기준) + stream 들
+// bus i 의 stream 은 zlib 하나이고, 풀면 그 bus element 의 register 값 (layout 순서, big-endian 2 byte) 이다.
+// element 가 없는 bus 는 길이 0. MAGIC 은 zlib CMF (0x78 등, CINFO <= 7) 나 compact phase mode byte 와 겹치지 않는다.
+// 첫 byte 가 MAGIC 인 BINARY 는 항상 이 형식으로 읽는다 (Parse 가 실패하면 raw 로 보지 않고 error)
+constexpr uint8_t MAGIC = 0xB8;
+
+struct Stream
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// header 와 offset table 검사. num_bus 가 다르거나 offset 이 payload 를 벗어나면 false
+bool Parse( const uint8_t* payload, size_t size, int num_bus, std::vector<Stream>& streams, std::string* err = nullptr );
+
+// raw BINARY payload (3 byte header + element 마다 2 byte, layout 순서) 를 bus 별 stream payload 로 (client / bench 용)
+std::vector<uint8_t> Encode( const Layout::Compiled& layout, const std::vector<uint8_t>& raw, int level = 9 );
+
+// stream 하나를 풀어 out (bus element 수 x 2 byte) 에. 길이가 정확히 맞아야 true. FDICT stream 은 ZDict::Dictionary 로
+bool Inflate( const Stream& stream, uint8_t* out, size_t out_size );
+
+// bus 별 작업을 나눠 도는 고정 worker. 매 beam 마다 thread 를 만들지 않는다.
+// worker 수는 $SPIBEAM_BUS_WORKERS, 없으면 min(8 bus, core 수). Run 은 한 번에 하나씩.
+// register write 는 MemoryWriter 의 mutex 를 거치므로 worker 끼리 겹치는 것은 inflate / pack 뿐 (FIFO 적재는 직렬)
+class Pool
+{
+public:
+    static Pool& Instance();
+
+    // fn(0) .. fn(n-1) 을 worker 들이 나눠 실행하고 모두 끝나면 돌아온다 (호출한 thread 도 같이 돈다).
+    // fn 이 던진 예외는 task 마다 잡아 두고 나머지 task 는 그대로 돈다. 모두 끝난 뒤 첫 번째 예외를 호출한 thread 에서 다시 던진다
+    void Run( int n, const std::function<void(int)>& fn );
+
+    int Workers() const { return (int)threads_.size() + 1; }
+
+private:
+    Pool();
+    ~Pool();
+    Pool( const Pool& ) = delete;
+    Pool& operator=( const Pool& ) = delete;
+
+    void Loop();
+    void Drain();
+
+    std::mutex run_mutex_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(int)>* job_ = nullptr;
+    int job_size_ = 0;
+    uint64_t generation_ = 0;
+    std::atomic<int> next_ { 0 };
+    int finished_ = 0;
+    int active_ = 0;            // 지금 job 을 돌고 있는 worker 수
+    std::exception_ptr error_;  // 이번 job 에서 처음 난 예외
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+
+}
+}
+
+#endif
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <thread>
 #include <chrono>
@@ -8,8 +10,20 @@
 #include "SpiwriteCommand.h"
 #include "ArrayFactory.h"
 #include "JsonHelper.hpp"
+#include "ArrayExecutor.h"
+#include "BeamTrace.h"
+#include "BeamPipeline.h"
+#include "SpiStats.h"
+#include "BeamEngine.h"
+#include "HardwareContext.h"
+#include "WarmStart.h"
+#include "ScanEngine.h"
+#include "HardwareArbiter.h"
+#include "HealthMonitor.h"
+#include "RtProfile.h"
 
 #include <cstdio>
+#include <cstdlib>
 #include <vector>
 #include <cmath>
 #include <tuple>
@@ -23,784 +37,1029 @@ namespace SpiBeam {
 
 using namespace std;
 
-// 전역 변수들 초기화
-float az_value = 0.0f;
-float el_value = 0.0f;
-long long unsigned freq_Hz = 1000000000ULL;  // 기본값 1GHz
-
-constexpr float INTELLIAN_PI = 3.14159265359f;  // 더 정확한 PI 값
-
-inline float to_radian(float deg)
+struct ConsoleRunner::Impl
 {
-    return deg * INTELLIAN_PI / 180.0f;
-}
+    ConsoleRunner& owner;
+    Controller::Transport* current_transport;
+    ArrayExecutor executor;
 
-inline float to_degree(float rad)
-{
-    return rad * 180.0f / INTELLIAN_PI;
-}
+    Impl( ConsoleRunner& consoler ) : owner( consoler ), executor( consoler.array_info_map_ )
+    {
+        current_transport = &owner.array_info_map_.begin()->second.transport; 
+    }
 
-inline float normalize_degrees(float degrees)
-{
-    if(degrees >= 0.0 && degrees < 360.0)
+    // "all" 이나 빈 문자열이면 전체, 아니면 ',' 로 구분한 array 이름
+    std::vector<std::string> SelectArrays( const std::string& names )
     {
-        return degrees;
+        std::vector<std::string> selected;
+        if( names.empty() || names == "all" )
+        {
+            for( auto& kv : owner.array_info_map_ ) selected.push_back( kv.first );
+            return selected;
+        }
+
+        std::stringstream ss( names );
+        std::string name;
+        while( std::getline( ss, name, ',' ) )
+        {
+            if( owner.array_info_map_.find( name ) == owner.array_info_map_.end() )
+            {
+                throw std::runtime_error( Common::string_format( "no array with %s found", name.c_str() ));
+            }
+            selected.push_back( name );
+        }
+        return selected;
     }
 
-    float norm = std::fmod(degrees, 360.0);
-    if(norm < 0)
+
+    int cnt77 = 1;
+
+
+    void Print( Array::ArrayBase& array, std::string name )
     {
-        norm += 360.0;
+        if( name == "amplitude" || name == "phase")
+        {
+            auto& m = array.GetStatus().Get<Math::MatFloat>( name );
+            m.Dump( "%4.1f ");
+        }
+        else
+        {
+            auto& m = array.GetStatus().Get<Math::MatInt>( name );
+            m.Dump( "%3d ");
+        }
     }
 
-    return norm;
-}
+    // 선택한 panel 에 같은 az/el 을 transport 별 worker 에서 동시에 적용 : phase -> code -> 전송 -> readback (소요 시간 = max(panel))
+    ArrayExecutor::OutcomeMap BeamAll( const std::vector<std::string>& names, float az, float el )
+    {
+        auto outcomes = executor.Steer( names, az, el );
 
-float phase(float xi, float yi) 
-{
-    // 입력값 검증
-    if(isnan(az_value) || isnan(el_value) || freq_Hz == 0) {
-        cout << "Error: Invalid input values - az:" << az_value 
-             << " el:" << el_value << " freq:" << freq_Hz << endl;
-        return 0.0f;
+        for( auto& [name, o] : outcomes )
+        {
+            if( !o.error.empty() ) printf(";array %s beam failed : %s\n", name.c_str(), o.error.c_str());
+            else printf(";array %s beam : %.3f ms\n", name.c_str(), o.elapsed_ms);
+        }
+        printf(";beam arrays(%zu) on %zu workers : %.3f ms\n",
+            outcomes.size(), executor.WorkerCount(), ArrayExecutor::MaxElapsedMs( outcomes ));
+        return outcomes;
     }
 
-    float impl_phi = - az_value;
-    float phi_rad = to_radian(impl_phi);
+    // tx 패널 초기화 : VAIC reset, FIFO init, 8 bus broadcast
+    void InitTxPanel(SpiwriteProtocol::MemoryWriter& writer)
+    {
+        printf("\n@@@ tx 패널 초기화 시작 @@@\n");
+
+        // VAIC RESET OFF
+        uintptr_t vaic_reset_addr = 0x43c28004;
+        uint32_t reset_off = 0xff;
+        writer.writeMemory(vaic_reset_addr, reset_off);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", vaic_reset_addr, reset_off);
+        printf("mpause 10\n");
+
+        // VAIC RESET ON
+        uint32_t reset_on = 0x0;
+        writer.writeMemory(vaic_reset_addr, reset_on);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", vaic_reset_addr, reset_on);
+        printf("mpause 10\n");
+
+        // FIFO init
+        for (int i = 0; i < 8; i++) 
+        {
+            uintptr_t fifo_addr = FIFO_ADDR + (i * 0x10000);
 
-    float c_theta = std::cos(to_radian(el_value));
-    float c_phi = std::cos(phi_rad);
-    float s_phi = std::sin(phi_rad);
+            // 인터럽트 상태 확인
+            uint32_t interrupt_value;
+            writer.readMemory(fifo_addr, interrupt_value);
+            printf(";interrupt check addr -> 0x%08x, value -> 0x%08x\n", fifo_addr, interrupt_value);
+            printf("mpause 10\n");
 
-    const float SPEED_OF_LIGHT = 300000000;
-    float lambda = SPEED_OF_LIGHT / freq_Hz;
-    float k0 = -2.0f * INTELLIAN_PI / lambda / 1000;
+            // while (true)
+            // {
+            //     uint32_t interrupt_value;
+            //     if (!writer.readMemory(fifo_addr, interrupt_value)) {
+            //         printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(fifo_addr));
+            //         break;
+            //     }
+
+            //     if (interrupt_value == 0) 
+            //     {
+            //         printf(";interrupt check ok !\n");
+            //         break;
+            //     }
+
+            //     printf("mpause 100\n");
+            //     std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // }
+
+            // 인터럽트 클리어
+            uint32_t interrup_clear_value = 0xffffffff;
+            writer.writeMemory(fifo_addr, interrup_clear_value);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_addr, interrup_clear_value);
+            printf("mpause 10\n");
+        }
 
-    float p = to_degree(k0 * (xi * c_theta * c_phi + yi * c_theta * s_phi));
-    float p_nor = normalize_degrees(p);
+        for(int i = 0; i < 8; i++)
+        {
+            // start address
+            uintptr_t start_address_ = FIFO_ADDR + (i * 0x10000) + 0x2C;
+            uint32_t start_address_value__ = 0x2;
+            writer.writeMemory(start_address_, start_address_value__);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", start_address_, start_address_value__);
+            printf("mpause 10\n");
 
-    // 각 변수들을 출력
-    // std::cout << "===============" << std::endl;
-    // std::cout << "k0 = " << k0 << std::endl;
-    // std::cout << "xi = " << xi << std::endl;
-    // std::cout << "yi = " << yi << std::endl;
-    // std::cout << "c_theta = " << c_theta << std::endl;
-    // std::cout << "c_phi = " << c_phi << std::endl;
-    // std::cout << "s_phi = " << s_phi << std::endl;
 
-    // std::cout << "p =  " << p << std::endl;
-    // std::cout << "p_nor  = " << p_nor << std::endl;
-    // std::cout << "===============" << std::endl;
+            uintptr_t fifo_1_address_ = FIFO_ADDR + (i * 0x10000) + 0x10;
+            uint32_t broadcast_value1 = 0x60000000;
+            writer.writeMemory(fifo_1_address_, broadcast_value1);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value1);
+            printf("mpause 10\n");
+            uint32_t broadcast_value2 = 0x60010688;
+            writer.writeMemory(fifo_1_address_, broadcast_value2);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value2);
+            printf("mpause 10\n");
 
-    return p_nor;
-}
+            ////////////////////////////////////
+            // 0x25, 3D, 45, 5D
+            ////////////////////////////////////
+            uint32_t broadcast_value3 = 0x6025A91A;
+            writer.writeMemory(fifo_1_address_, 0x6025A91A);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value3);
+            printf("mpause 10\n");
+            uint32_t broadcast_value4 = 0x603DA91A;
+            writer.writeMemory(fifo_1_address_, 0x603DA91A);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value4);
+            printf("mpause 10\n");
+            uint32_t broadcast_value5 = 0x6045A91A;
+            writer.writeMemory(fifo_1_address_, 0x6045A91A);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value5);
+            printf("mpause 10\n");
+            uint32_t broadcast_value6 = 0x605DA91A;
+            writer.writeMemory(fifo_1_address_, 0x605DA91A);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value6);
+            printf("mpause 10\n");
 
+            ////////////////////////////////////
+            // 0x26, 3E, 46, 5E
+            ////////////////////////////////////
+            uint32_t broadcast_value7 = 0x60260E7F;
+            writer.writeMemory(fifo_1_address_, 0x60260E7F);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value7);
+            printf("mpause 10\n");
+            uint32_t broadcast_value8 = 0x603E0E7F;
+            writer.writeMemory(fifo_1_address_, 0x603E0E7F);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value8);
+            printf("mpause 10\n");
+            uint32_t broadcast_value9 = 0x60460E7F;
+            writer.writeMemory(fifo_1_address_, 0x60460E7F);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value9);
+            printf("mpause 10\n");
+            uint32_t broadcast_value10 = 0x605E0E7F;
+            writer.writeMemory(fifo_1_address_, 0x605E0E7F);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value10);
+            printf("mpause 10\n");
 
-struct ConsoleRunner::Impl
-{
-    ConsoleRunner& owner;
-    int transfer_size_in_bytes = 32;
-    Controller::Transport* current_transport;
+            ////////////////////////////////////
+            // 0x27, 0x3F, 0x47,  0x5F
+            ////////////////////////////////////
+            uint32_t broadcast_value11 = 0x602703FE;
+            writer.writeMemory(fifo_1_address_, 0x602703FE);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value11);
+            printf("mpause 10\n");
+            uint32_t broadcast_value12 = 0x603F03FE;
+            writer.writeMemory(fifo_1_address_, 0x603F03FE);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value12);
+            printf("mpause 10\n");
+            uint32_t broadcast_value13 = 0x604703FE;
+            writer.writeMemory(fifo_1_address_, 0x604703FE);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value13);
+            printf("mpause 10\n");
+            uint32_t broadcast_value14 = 0x605F03FE;
+            writer.writeMemory(fifo_1_address_, 0x605F03FE);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value14);
+            printf("mpause 10\n");
 
-    Impl( ConsoleRunner& consoler ) : owner( consoler )
-    {
-        current_transport = &owner.array_info_map_.begin()->second.transport; 
-    }
+            // length : 56 Byte (0x38)
+            uintptr_t fifo_send_length = FIFO_ADDR + (i * 0x10000) + 0x14;
+            uint32_t fifo_send_length____ = 0x38;
+            writer.writeMemory(fifo_send_length, fifo_send_length____);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_send_length, fifo_send_length____);
+            printf("mpause 10\n");
 
-    Runner::ArrayInfo& GetArrayInfoOrFirst( std::string name )
-    {
-        if( name.empty() )
+            // 인터럽트 상태 확인
+            uintptr_t intrerrupt_addr___ = FIFO_ADDR + (i * 0x10000);
+            uint32_t interrupt_value;
+            writer.readMemory(intrerrupt_addr___, interrupt_value);
+            printf(";interrupt check addr -> 0x%08x, value -> 0x%08x\n", intrerrupt_addr___, interrupt_value);
+            printf("mpause 10\n");
+
+            // while (true)
+            // {
+            //     uintptr_t intrerrupt_addr = 0x43c40000;
+            //     uint32_t interrupt_value;
+            //     if (!writer.readMemory(intrerrupt_addr, interrupt_value)) {
+            //         printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(intrerrupt_addr));
+            //         break;
+            //     }
+
+            //     if (interrupt_value == 0) 
+            //     {
+            //         printf(";interrupt check ok !\n");
+            //         break;
+            //     }
+
+            //     printf("mpause 10\n");
+            //     std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // }
+
+            // 인터럽트 클리어
+            uintptr_t intrerrupt_addr_ = FIFO_ADDR + (i * 0x10000);
+            uint32_t interrup_clear_value = 0xffffffff;
+            writer.writeMemory(intrerrupt_addr_, interrup_clear_value);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", intrerrupt_addr_, interrup_clear_value);
+            printf("mpause 10\n");
+
+
+        }
+
+
+        // Send Length
+        uintptr_t length_addr = 0x43c00018; 
+        uint32_t length_value = 0x4;
+        writer.writeMemory(length_addr, length_value);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", length_addr, length_value);
+        printf("mpause 10\n");
+
+        // FIFO Execute : 0x1
+        uintptr_t addr_1c = 0x43c0001c;
+        uint32_t value_1c = 0x1;
+        writer.writeMemory(addr_1c, value_1c);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", addr_1c, value_1c);
+        printf("mpause 10\n");
+
+        // FIFO 1~8 SEND : 0x1
+        uintptr_t send_addr = 0x43c00014;
+        uint32_t send_value = 0xff;
+        writer.writeMemory(send_addr, send_value);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", send_addr, send_value);
+        printf("mpause 10\n");
+
+
+        // SEND FIFO CHECK !!!
+        while (true)
         {
-            return std::begin(owner.array_info_map_)->second;
+            uintptr_t fifo_send_check_address = 0x43c00014;
+            uint32_t fifo_send_check_value;
+            if (!writer.readMemory(fifo_send_check_address, fifo_send_check_value)) {
+                printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(fifo_send_check_address));
+                printf("mpause 10\n");
+                break;
+            }
+
+            if (fifo_send_check_value == 0x0) 
+            {
+                printf(";ok. fifo send completed\n");
+                break;
+            }
+
+            printf("mpause 100\n");
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
 
-        if( auto I = owner.array_info_map_.find( name ); I != owner.array_info_map_.end())
+
+        // 남은 FIFO DATA SIZE 확인
+        uintptr_t remaining_fifo_address = 0x43c50000 + 0xc;
+        uint32_t remaining_fifo_data_size;
+        if (!writer.readMemory(remaining_fifo_address, remaining_fifo_data_size)) {
+            printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(remaining_fifo_address + 0xC));
+            printf("mpause 10\n");
+        }
+        else
         {
-            return I->second;
+            printf("@@@ remaining size => 0x%08x @@@\n", remaining_fifo_data_size);
         }
-        throw std::runtime_error( Common::string_format( "init failed : no array with %s found\n", name.c_str() ));
-    }
 
+        remaining_fifo_address = 0x43c40000 + 0xc;
+        if (!writer.readMemory(remaining_fifo_address, remaining_fifo_data_size)) {
+            printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(remaining_fifo_address + 0xC));
+            printf("mpause 10\n");
+        }
+        else
+        {
+            printf("@@@ remaining size => 0x%08x @@@\n", remaining_fifo_data_size);
+        }
 
-    int cnt77 = 1;
 
+        printf("@@@ tx 패널 초기화 끝 @@@\n");
+    }
 
-    void Execute( Runner::ArrayInfo& arrayinfo, std::vector<Controller::Code> codes)
+    // rx 패널 초기화 : tx 와 순서는 같고 broadcast 값만 다르다
+    void InitRxPanel(SpiwriteProtocol::MemoryWriter& writer)
     {
-        using namespace std::chrono;
+        printf("rx 패널 초기화 시작 !!!!\n");
+
+        // VAIC RESET OFF
+        uintptr_t vaic_reset_addr = 0x43c28004;
+        uint32_t reset_off = 0xff;
+        writer.writeMemory(vaic_reset_addr, reset_off);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", vaic_reset_addr, reset_off);
+        printf("mpause 10\n");
+
+        // VAIC RESET ON
+        uint32_t reset_on = 0x0;
+        writer.writeMemory(vaic_reset_addr, reset_on);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", vaic_reset_addr, reset_on);
+        printf("mpause 10\n");
+
+        // FIFO init
+        for (int i = 0; i < 8; i++) 
+        {
+            uintptr_t fifo_addr = FIFO_ADDR + (i * 0x10000);
+
+            // 인터럽트 상태 확인
+            uint32_t interrupt_value;
+            writer.readMemory(fifo_addr, interrupt_value);
+            printf(";interrupt check addr -> 0x%08x, value -> 0x%08x\n", fifo_addr, interrupt_value);
+            printf("mpause 10\n");
+
+            // while (true)
+            // {
+            //     uint32_t interrupt_value;
+            //     if (!writer.readMemory(fifo_addr, interrupt_value)) {
+            //         printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(fifo_addr));
+            //         break;
+            //     }
+
+            //     if (interrupt_value == 0) 
+            //     {
+            //         printf(";interrupt check ok !\n");
+            //         break;
+            //     }
+
+            //     printf("mpause 100\n");
+            //     std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // }
+
+            // 인터럽트 클리어
+            uint32_t interrup_clear_value = 0xffffffff;
+            writer.writeMemory(fifo_addr, interrup_clear_value);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_addr, interrup_clear_value);
+            printf("mpause 10\n");
+        }
+
+
+        for(int j = 0; j < 8; j++)
+        {
+            // start address
+            uintptr_t start_address_ = FIFO_ADDR + (j * 0x10000) + 0x2C;
+            uint32_t start_address_value__ = 0x2;
+            writer.writeMemory(start_address_, start_address_value__);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", start_address_, start_address_value__);
+            printf("mpause 10\n");
+
+
+            uintptr_t fifo_1_address_ = FIFO_ADDR + (j * 0x10000) + 0x10;
+            uint32_t broadcast_value1 = 0x60000000;
+            writer.writeMemory(fifo_1_address_, broadcast_value1);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value1);
+            printf("mpause 10\n");
+            uint32_t broadcast_value2 = 0x6001068A;
+            writer.writeMemory(fifo_1_address_, broadcast_value2);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value2);
+            printf("mpause 10\n");
+
+            ////////////////////////////////////
+            // 0x25, 3D, 45, 5D
+            ////////////////////////////////////
+            uint32_t broadcast_value3 = 0x60206CDB;
+            writer.writeMemory(fifo_1_address_, broadcast_value3);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value3);
+            printf("mpause 10\n");
+            uint32_t broadcast_value4 = 0x60386CDB;
+            writer.writeMemory(fifo_1_address_, broadcast_value4);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value4);
+            printf("mpause 10\n");
+            uint32_t broadcast_value5 = 0x60406CDB;
+            writer.writeMemory(fifo_1_address_, broadcast_value5);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value5);
+            printf("mpause 10\n");
+            uint32_t broadcast_value6 = 0x60586CDB;
+            writer.writeMemory(fifo_1_address_, broadcast_value6);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value6);
+            printf("mpause 10\n");
+
+            ////////////////////////////////////
+            // 0x26, 3E, 46, 5E
+            ////////////////////////////////////
+            uint32_t broadcast_value7 = 0x60212FFF;
+            writer.writeMemory(fifo_1_address_, broadcast_value7);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value7);
+            printf("mpause 10\n");
+            uint32_t broadcast_value8 = 0x60392FFF;
+            writer.writeMemory(fifo_1_address_, broadcast_value8);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value8);
+            printf("mpause 10\n");
+            uint32_t broadcast_value9 = 0x60412FFF;
+            writer.writeMemory(fifo_1_address_, broadcast_value9);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value9);
+            printf("mpause 10\n");
+            uint32_t broadcast_value10 = 0x60592FFF;
+            writer.writeMemory(fifo_1_address_, broadcast_value10);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value10);
+            printf("mpause 10\n");
+
+            ////////////////////////////////////
+            // 0x27, 0x3F, 0x47,  0x5F
+            ////////////////////////////////////
+            uint32_t broadcast_value11 = 0x602203F8;
+            writer.writeMemory(fifo_1_address_, broadcast_value11);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value11);
+            printf("mpause 10\n");
+            uint32_t broadcast_value12 = 0x603A03F8;
+            writer.writeMemory(fifo_1_address_, broadcast_value12);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value12);
+            printf("mpause 10\n");
+            uint32_t broadcast_value13 = 0x604203F8;
+            writer.writeMemory(fifo_1_address_, broadcast_value13);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value13);
+            printf("mpause 10\n");
+            uint32_t broadcast_value14 = 0x605A03F8;
+            writer.writeMemory(fifo_1_address_, broadcast_value14);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value14);
+            printf("mpause 10\n");
+
+            // length : 56 Byte (0x38)
+            uintptr_t fifo_send_length = FIFO_ADDR + (j * 0x10000) + 0x14;
+            uint32_t fifo_send_length____ = 0x38;
+            writer.writeMemory(fifo_send_length, fifo_send_length____);
+            printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_send_length, fifo_send_length____);
+            printf("mpause 10\n");
+
+            // 인터럽트 상태 확인
+            uintptr_t intrerrupt_addr___ = FIFO_ADDR + (j * 0x10000);
+            uint32_t interrupt_value;
+            writer.readMemory(intrerrupt_addr___, interrupt_value);
+            printf(";interrupt check addr -> 0x%08x, value -> 0x%08x\n", intrerrupt_addr___, interrupt_value);
+            printf("mpause 10\n");
+
+            // while (true)
+            // {
+            //     uintptr_t intrerrupt_addr = 0x43c40000;
+            //     uint32_t interrupt_value;
+            //     if (!writer.readMemory(intrerrupt_addr, interrupt_value)) {
+            //         printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(intrerrupt_addr));
+            //         break;
+            //     }
+
+            //     if (interrupt_value == 0) 
+            //     {
+            //         printf(";interrupt check ok !\n");
+            //         break;
+            //     }
+
+            //     printf("mpause 10\n");
+            //     std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // }
+
+            // 인터럽트 클리어
+            uintptr_t intrerrupt_addr_ = FIFO_ADDR + (j * 0x10000);
+            uint32_t interrup_clear_value = 0xffffffff;
+            writer.writeMemory(intrerrupt_addr_, interrup_clear_value);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", intrerrupt_addr_, interrup_clear_value);
+            printf("mpause 10\n");
+
+
+        }
 
-        int read_count = 0;
-        Controller::Transport& array_transport = arrayinfo.transport;
 
-        std::vector<uint32_t> buf;
-        buf.reserve( transfer_size_in_bytes );
-        for( auto& code : codes )
+        // Send Length
+        uintptr_t length_addr = 0x43c00018; 
+        uint32_t length_value = 0x4;
+        writer.writeMemory(length_addr, length_value);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", length_addr, length_value);
+        printf("mpause 10\n");
+
+        // FIFO Execute : 0x1
+        uintptr_t addr_1c = 0x43c0001c;
+        uint32_t value_1c = 0x1;
+        writer.writeMemory(addr_1c, value_1c);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", addr_1c, value_1c);
+        printf("mpause 10\n");
+
+        // FIFO 1~8 SEND : 0x1
+        uintptr_t send_addr = 0x43c00014;
+        uint32_t send_value = 0xff;
+        writer.writeMemory(send_addr, send_value);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", send_addr, send_value);
+        printf("mpause 10\n");
+
+
+        // SEND FIFO CHECK !!!
+        while (true)
         {
-            auto words = code.CopyWords();
-            if( (buf.size() + words.size() * sizeof(uint32_t)) > transfer_size_in_bytes )
+            uintptr_t fifo_send_check_address = 0x43c00014;
+            uint32_t fifo_send_check_value;
+            if (!writer.readMemory(fifo_send_check_address, fifo_send_check_value)) {
+                printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(fifo_send_check_address));
+                printf("mpause 10\n");
+                break;
+            }
+
+            if (fifo_send_check_value == 0x0) 
             {
-                array_transport.Write( buf, 0 );
-                buf.clear();                
+                printf(";ok. fifo send completed\n");
+                break;
             }
 
-            std::copy( words.begin(), words.end(), std::back_inserter(buf) );
-            read_count += code.GetReadCount();
+            printf("mpause 100\n");
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
 
-        if( buf.size() > 0 )
+        // 남은 FIFO DATA SIZE 확인
+        uintptr_t remaining_fifo_address = 0x43c50000 + 0xc;
+        uint32_t remaining_fifo_data_size;
+        if (!writer.readMemory(remaining_fifo_address, remaining_fifo_data_size)) {
+            printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(remaining_fifo_address + 0xC));
+            printf("mpause 10\n");
+        }
+        else
         {
-            array_transport.Write( buf, 0 );
-            buf.clear();
+            printf("@@@ remaining size => 0x%08x @@@\n", remaining_fifo_data_size);
         }
 
-        if( read_count > 0 )
+        remaining_fifo_address = 0x43c40000 + 0xc;
+        if (!writer.readMemory(remaining_fifo_address, remaining_fifo_data_size)) {
+            printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(remaining_fifo_address + 0xC));
+            printf("mpause 10\n");
+        }
+        else
         {
-            while( array_transport.ReceviedCount( 0 ) < read_count )
-            {
-                std::this_thread::sleep_for( 1ms );
-            }
+            printf("@@@ remaining size => 0x%08x @@@\n", remaining_fifo_data_size);
+        }
 
-            auto reads = array_transport.Read( read_count, 0 );
-            std::vector<Controller::SpiReadback> readbacks;
-            readbacks.reserve( reads.size());
-            std::transform( reads.begin(), reads.end(), std::back_inserter(readbacks), 
-                [](uint32_t r){ return Controller::SpiReadback(r); });
+        printf("rx 패널 초기화 끝 !!!!\n");
+    }
 
-            arrayinfo.array.Readback( readbacks );
+    // journal 에 기록된 panel 과 mode 가 다를 때만 초기화 (warm start / batch 공용)
+    void EnsurePanel(SpiwriteProtocol::MemoryWriter& writer, int is_tx)
+    {
+        HardwareArbiter::Lease lease(HardwareArbiter::Priority::Console);
+        auto& journal = WarmStart::Journal::Instance();
+        if(journal.PanelMode() == is_tx)
+        {
+            printf(";%s panel already initialized, skip\n", is_tx ? "tx" : "rx");
+            return;
         }
+
+        if(is_tx) InitTxPanel(writer);
+        else      InitRxPanel(writer);
+        journal.MarkPanel(is_tx);
     }
 
-    void Print( Array::ArrayBase& array, std::string name )
+    // warm start : 직전 process 가 남긴 상태가 지금 hardware 와 같으면 panel 초기화를 건너뛴다
+    void RestoreWarmState(SpiwriteProtocol::MemoryWriter& writer, const std::string& warm_path, int& is_tx)
     {
-        if( name == "amplitude" || name == "phase")
+        auto& journal = WarmStart::Journal::Instance();
+        journal.Enable(true);
+
+        WarmStart::Snapshot snap;
+        std::string why;
+        if(!WarmStart::Load(warm_path, snap)) return;
+
+        if(WarmStart::Matches(snap, writer, &why))
         {
-            auto& m = array.GetStatus().Get<Math::MatFloat>( name );
-            m.Dump( "%4.1f ");
+            journal.Restore(snap);
+            is_tx = snap.panel_mode;
+            az_value = snap.az;
+            el_value = snap.el;
+            printf(";warm start : %s\n", snap.Report().c_str());
         }
         else
         {
-            auto& m = array.GetStatus().Get<Math::MatInt>( name );
-            m.Dump( "%3d ");
+            printf(";warm start skipped : %s\n", why.c_str());
         }
     }
 
-    void Beam( Array::ArrayBase& array, float az, float el )
+    // $SPIBEAM_BEAM_ENGINE=hw|auto 일 때만 sw 가 아닌 engine. auto 는 시작할 때 현재 beam 으로 한 번 재 본다
+    void SelectEngineAtStartup(SpiwriteProtocol::MemoryWriter& writer, BeamEngineSet& engines, int is_tx)
     {
-        if( array.GetCfg().port.poles.Size() == 0 )
+        const char* env = getenv("SPIBEAM_BEAM_ENGINE");
+        if(!env || !*env || std::string(env) == "sw") return;
+
+        bool ok = false;
+        if(std::string(env) == "auto")
         {
-            auto m = array.GetLayoutFormer().FormPhase( az, el );
-            array.GetStatus().GetPhase() = m;
-        } 
+            EnsurePanel(writer, is_tx);
+            ok = HardwareArbiter::Instance().Run(HardwareArbiter::Priority::Console,
+                [&]{ return engines.Select(env, is_tx, az_value, el_value); });
+        }
         else
         {
-            auto m = array.GetLayoutFormer().FormCircularPhases( az, el );
-            array.GetStatus().GetPhase() = m;
+            ok = engines.Select(env);
         }
+        printf(";%s%s\n", engines.Report().c_str(), ok ? "" : " (SPIBEAM_BEAM_ENGINE ignored)");
     }
 
-    void Run() 
+    struct BatchStep
     {
-        owner.Run(owner.writer);
+        int is_tx;
+        float az;
+        float el;
+        int dwell_ms;   // beam 시작부터 다음 beam 시작까지 최소 간격
+    };
+
+    // 한 줄에 "tx|rx az el [dwell_ms]". '#' 뒤는 주석, 빈 줄은 무시
+    static bool ParseBatch(std::istream& in, std::vector<BatchStep>& steps, std::string& err)
+    {
+        std::string line;
+        for(int line_no = 1; std::getline(in, line); line_no++)
+        {
+            if(auto hash = line.find('#'); hash != std::string::npos) line.erase(hash);
+
+            std::istringstream is(line);
+            std::string mode;
+            if(!(is >> mode)) continue;
+
+            BatchStep step { 0, 0, 0, 0 };
+            if(mode == "tx") step.is_tx = 1;
+            else if(mode != "rx")
+            {
+                err = Common::string_format("line %d : unknown mode '%s'", line_no, mode.c_str());
+                return false;
+            }
+
+            if(!(is >> step.az >> step.el))
+            {
+                err = Common::string_format("line %d : expected 'tx|rx az el [dwell_ms]'", line_no);
+                return false;
+            }
+            if(std::string range_err; !BeamPipeline::ValidSteering(step.az, step.el, &range_err))
+            {
+                err = Common::string_format("line %d : %s", line_no, range_err.c_str());
+                return false;
+            }
+            if(!(is >> step.dwell_ms)) step.dwell_ms = 0;
+            if(step.dwell_ms < 0)
+            {
+                err = Common::string_format("line %d : negative dwell", line_no);
+                return false;
+            }
+            steps.push_back(step);
+        }
+        return true;
     }
 
-    void Run(SpiwriteProtocol::MemoryWriter& writer)
+    // steps 를 쉬지 않고 연달아 적용. panel 초기화는 mode 가 바뀔 때만, devmem script 출력은 끈다.
+    // latency 는 engine Apply 한 번 (panel 초기화 제외), beams/s 는 초기화와 dwell 을 포함한 전체 시간 기준
+    // 모든 beam 이 적용되면 true
+    bool RunBatch(SpiwriteProtocol::MemoryWriter& writer, BeamEngineSet& engines,
+                  const std::vector<BatchStep>& steps, const std::string& warm_path, int& is_tx, std::string& report)
     {
-        using namespace std;
-        using namespace SpiBeam::Array;
+        using clock = std::chrono::steady_clock;
+        auto ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
 
-        Parser::LineParser parser;
-        Controller::CodeGenerator cgen;
+        std::vector<double> latency;
+        latency.reserve(steps.size());
+        int failed = 0;
+        int switches = 0;
+        double init_ms = 0;
+        bool saved_pending = false;
 
-        float dx = 5.0f;
-        float dy = 5.0f;
+        engines.SetScript(false);
+        auto batch_t0 = clock::now();
 
-        int is_tx = 0;
+        for(const auto& step : steps)
+        {
+            auto beam_t0 = clock::now();
+            bool ok = false;
+            {
+                // 초기화 + beam 을 한 transaction 으로. 우선순위가 높은 경로는 beam 사이에 끼어든다
+                HardwareArbiter::Lease lease(HardwareArbiter::Priority::Console);
+                auto init_t0 = clock::now();
+                if(WarmStart::Journal::Instance().PanelMode() != step.is_tx)
+                {
+                    EnsurePanel(writer, step.is_tx);
+                    switches++;
+                    init_ms += ms(clock::now() - init_t0);
+                }
+                is_tx = step.is_tx;
+                freq_Hz = is_tx ? 29500000000ULL : 19700000000ULL;
 
-        std::map<int, std::deque<uint8_t>> byte_queues;
-        std::map<int, std::mutex> queue_mutexes;
+                auto apply_t0 = clock::now();
+                ok = engines.Apply(step.is_tx, step.az, step.el);
+                latency.push_back(ms(clock::now() - apply_t0));
+            }
 
-        uintptr_t base_address;
-        static int count__ = 1;
+            if(ok)
+            {
+                az_value = step.az;
+                el_value = step.el;
+                saved_pending = true;
+            }
+            else
+            {
+                failed++;
+            }
 
-        auto change_bus_process = [&](int spi_id) -> void
+            if(step.dwell_ms > 0)
+            {
+                std::this_thread::sleep_until(beam_t0 + std::chrono::milliseconds(step.dwell_ms));
+            }
+        }
+
+        double total_ms = ms(clock::now() - batch_t0);
+        engines.SetScript(true);
+
+        // 상태 파일은 beam 마다 fsync 하지 않고 마지막에 한 번
+        if(saved_pending)
         {
-            printf(";spi_id => %d\n", spi_id);
+            WarmStart::Save(warm_path, WarmStart::Journal::Instance().Capture(az_value, el_value));
+        }
 
+        if(latency.empty())
+        {
+            report = "batch : no beams";
+            return true;
+        }
 
-            // 현재 bus 종료 처리
-            writer.writeMemory(base_address + 0x0014, 0x280);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            printf("sendln \"devmem 0x%08x 32 0x280\"\n", base_address + 0x0014);
-            printf("mpause 10\n");
+        std::vector<double> sorted(latency);
+        std::sort(sorted.begin(), sorted.end());
+        auto pct = [&](double p) { return sorted[std::min(sorted.size() - 1, (size_t)std::ceil(p * sorted.size()) - 1)]; };
+        double sum = 0;
+        for(double v : latency) sum += v;
+
+        report = Common::string_format(
+            "batch : %zu beams (%d failed, %d mode switches, init %.3f ms) in %.3f ms -> %.1f beams/s (apply only %.1f beams/s)\n"
+            "apply latency ms : min %.3f avg %.3f p50 %.3f p99 %.3f max %.3f",
+            latency.size(), failed, switches, init_ms, total_ms,
+            total_ms > 0 ? latency.size() * 1000.0 / total_ms : 0.0,
+            sum > 0 ? latency.size() * 1000.0 / sum : 0.0,
+            sorted.front(), sum / latency.size(), pct(0.50), pct(0.99), sorted.back());
+        return failed == 0;
+    }
 
-            // 인터럽트 상태 확인
-            uint32_t interrupt_value;
-            writer.readMemory(base_address, interrupt_value);
-            printf(";base_address => 0X%08x interrupt_value => 0x%08x\n", base_address, interrupt_value);
-            printf("mpause 10\n"); 
+    // "-" 이면 stdin 을 끝까지 읽는다
+    bool RunBatchFile(SpiwriteProtocol::MemoryWriter& writer, BeamEngineSet& engines,
+                      const std::string& path, const std::string& warm_path, int& is_tx, std::string& report)
+    {
+        std::vector<BatchStep> steps;
+        std::string err;
+        bool parsed = false;
+        if(path == "-")
+        {
+            parsed = ParseBatch(std::cin, steps, err);
+        }
+        else
+        {
+            std::ifstream file(path);
+            if(!file)
+            {
+                report = "batch : cannot open " + path;
+                return false;
+            }
+            parsed = ParseBatch(file, steps, err);
+        }
+        if(!parsed)
+        {
+            report = "batch : " + err;
+            return false;
+        }
 
-            // 인터럽트 초기화
-            writer.writeMemory(base_address, 0xffffffff);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            printf("sendln \"devmem 0x%08x 32 0xffffffff\"\n", base_address);
-            printf("mpause 10\n");
+        return RunBatch(writer, engines, steps, warm_path, is_tx, report);
+    }
 
-            // 남은 FIFO DATA SIZE 확인
-            uint32_t remaining_fifo_data_size;
-            writer.readMemory(base_address + 0xC, remaining_fifo_data_size);
-            printf(";remaining_fifo_data_size => 0x%08x\n", remaining_fifo_data_size);
-            printf("mpause 10\n");
+    int RunBatch(SpiwriteProtocol::MemoryWriter& writer, const std::string& path)
+    {
+        int is_tx = 0;
+        BeamEngineSet engines(writer);
+        std::string warm_path = WarmStart::DefaultPath();
+        RestoreWarmState(writer, warm_path, is_tx);
+        SelectEngineAtStartup(writer, engines, is_tx);
+
+        std::string report;
+        bool ok = RunBatchFile(writer, engines, path, warm_path, is_tx, report);
+        printf("%s\n", report.c_str());
+        return ok ? 0 : 1;
+    }
 
+    void Run() 
+    {
+        owner.Run(owner.writer);
+    }
 
-            // 새로운 bus 시작 처리
-            if(spi_id == 7)
-            {
+    void Run(SpiwriteProtocol::MemoryWriter& writer)
+    {
+        using namespace std;
+        using namespace SpiBeam::Array;
 
+        Parser::LineParser parser;
+        Controller::CodeGenerator cgen;
 
-            }
-            else
-            {
-                base_address = 0x43c40000 + (spi_id * 0x10000);
-                uint32_t init_value_ = 0x2;
-                writer.writeMemory(base_address + 0x2C, init_value_);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01X\"\n", base_address + 0x2C, init_value_);
-                printf("mpause 10\n");
-            }
-        };
+        int is_tx = 0;
+
+        // SPIBEAM_RT 가 설정돼 있으면 memory lock / prefault 후 이 thread 를 hardware cpu 에
+        Rt::Runtime::Instance().Setup(writer);
+        Rt::Runtime::Instance().EnterThread(Rt::Role::Hardware);
+
+        BeamEngineSet engines(writer);
+        Scan::Scanner scanner(writer);
+
+        auto& journal = WarmStart::Journal::Instance();
+        std::string warm_path = WarmStart::DefaultPath();
+        RestoreWarmState(writer, warm_path, is_tx);
+        SelectEngineAtStartup(writer, engines, is_tx);
 
         for(;;)
         {
             // 1단계: tx 또는 rx 입력 받기
             cout << "Enter tx or rx > ";
             string txrx_input;
-            getline(std::cin, txrx_input);
+            if(!getline(std::cin, txrx_input)) break;
             
             // 빈 입력 처리
             if(txrx_input.empty()) continue;
-            
-            // tx/rx 처리
-            if(txrx_input == "tx")
-            {
-                dx = 5.0f;
-                dy = 5.0f;
-                freq_Hz = 29500000000ULL;
-                is_tx = 1;
 
-                #if 1
-                printf("\n@@@ tx 패널 초기화 시작 @@@\n");
-            
-                // VAIC RESET OFF
-                uintptr_t vaic_reset_addr = 0x43c28004;
-                uint32_t reset_off = 0xff;
-                writer.writeMemory(vaic_reset_addr, reset_off);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", vaic_reset_addr, reset_off);
-                printf("mpause 10\n");
-            
-                // VAIC RESET ON
-                uint32_t reset_on = 0x0;
-                writer.writeMemory(vaic_reset_addr, reset_on);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", vaic_reset_addr, reset_on);
-                printf("mpause 10\n");
-            
-                // FIFO init
-                for (int i = 0; i < 8; i++) 
+            // engine [sw|hw|auto|bench] : beam 적용 engine 선택
+            if(txrx_input.rfind("engine", 0) == 0)
+            {
+                auto args = txrx_input.size() > 7 ? txrx_input.substr(7) : std::string();
+                if(args == "bench")
                 {
-                    uintptr_t fifo_addr = FIFO_ADDR + (i * 0x10000);
-            
-                    // 인터럽트 상태 확인
-                    uint32_t interrupt_value;
-                    writer.readMemory(fifo_addr, interrupt_value);
-                    printf(";interrupt check addr -> 0x%08x, value -> 0x%08x\n", fifo_addr, interrupt_value);
-                    printf("mpause 10\n");
-            
-                    // while (true)
-                    // {
-                    //     uint32_t interrupt_value;
-                    //     if (!writer.readMemory(fifo_addr, interrupt_value)) {
-                    //         printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(fifo_addr));
-                    //         break;
-                    //     }
-                    
-                    //     if (interrupt_value == 0) 
-                    //     {
-                    //         printf(";interrupt check ok !\n");
-                    //         break;
-                    //     }
-            
-                    //     printf("mpause 100\n");
-                    //     std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    // }
-            
-                    // 인터럽트 클리어
-                    uint32_t interrup_clear_value = 0xffffffff;
-                    writer.writeMemory(fifo_addr, interrup_clear_value);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_addr, interrup_clear_value);
-                    printf("mpause 10\n");
+                    cout << HardwareArbiter::Instance().Run(HardwareArbiter::Priority::Console,
+                        [&]{ return engines.SelfBenchmark(is_tx, az_value, el_value); }) << endl;
                 }
-            
-                for(int i = 0; i < 8; i++)
+                else if(!args.empty() && !HardwareArbiter::Instance().Run(HardwareArbiter::Priority::Console,
+                    [&]{ return engines.Select(args, is_tx, az_value, el_value); }))
                 {
-                    // start address
-                    uintptr_t start_address_ = FIFO_ADDR + (i * 0x10000) + 0x2C;
-                    uint32_t start_address_value__ = 0x2;
-                    writer.writeMemory(start_address_, start_address_value__);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", start_address_, start_address_value__);
-                    printf("mpause 10\n");
-            
-            
-                    uintptr_t fifo_1_address_ = FIFO_ADDR + (i * 0x10000) + 0x10;
-                    uint32_t broadcast_value1 = 0x60000000;
-                    writer.writeMemory(fifo_1_address_, broadcast_value1);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value1);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value2 = 0x60010688;
-                    writer.writeMemory(fifo_1_address_, broadcast_value2);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value2);
-                    printf("mpause 10\n");
-            
-                    ////////////////////////////////////
-                    // 0x25, 3D, 45, 5D
-                    ////////////////////////////////////
-                    uint32_t broadcast_value3 = 0x6025A91A;
-                    writer.writeMemory(fifo_1_address_, 0x6025A91A);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value3);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value4 = 0x603DA91A;
-                    writer.writeMemory(fifo_1_address_, 0x603DA91A);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value4);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value5 = 0x6045A91A;
-                    writer.writeMemory(fifo_1_address_, 0x6045A91A);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value5);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value6 = 0x605DA91A;
-                    writer.writeMemory(fifo_1_address_, 0x605DA91A);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value6);
-                    printf("mpause 10\n");
-            
-                    ////////////////////////////////////
-                    // 0x26, 3E, 46, 5E
-                    ////////////////////////////////////
-                    uint32_t broadcast_value7 = 0x60260E7F;
-                    writer.writeMemory(fifo_1_address_, 0x60260E7F);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value7);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value8 = 0x603E0E7F;
-                    writer.writeMemory(fifo_1_address_, 0x603E0E7F);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value8);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value9 = 0x60460E7F;
-                    writer.writeMemory(fifo_1_address_, 0x60460E7F);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value9);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value10 = 0x605E0E7F;
-                    writer.writeMemory(fifo_1_address_, 0x605E0E7F);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value10);
-                    printf("mpause 10\n");
-            
-                    ////////////////////////////////////
-                    // 0x27, 0x3F, 0x47,  0x5F
-                    ////////////////////////////////////
-                    uint32_t broadcast_value11 = 0x602703FE;
-                    writer.writeMemory(fifo_1_address_, 0x602703FE);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value11);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value12 = 0x603F03FE;
-                    writer.writeMemory(fifo_1_address_, 0x603F03FE);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value12);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value13 = 0x604703FE;
-                    writer.writeMemory(fifo_1_address_, 0x604703FE);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value13);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value14 = 0x605F03FE;
-                    writer.writeMemory(fifo_1_address_, 0x605F03FE);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value14);
-                    printf("mpause 10\n");
-            
-                    // length : 56 Byte (0x38)
-                    uintptr_t fifo_send_length = FIFO_ADDR + (i * 0x10000) + 0x14;
-                    uint32_t fifo_send_length____ = 0x38;
-                    writer.writeMemory(fifo_send_length, fifo_send_length____);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_send_length, fifo_send_length____);
-                    printf("mpause 10\n");
-            
-                    // 인터럽트 상태 확인
-                    uintptr_t intrerrupt_addr___ = FIFO_ADDR + (i * 0x10000);
-                    uint32_t interrupt_value;
-                    writer.readMemory(intrerrupt_addr___, interrupt_value);
-                    printf(";interrupt check addr -> 0x%08x, value -> 0x%08x\n", intrerrupt_addr___, interrupt_value);
-                    printf("mpause 10\n");
-            
-                    // while (true)
-                    // {
-                    //     uintptr_t intrerrupt_addr = 0x43c40000;
-                    //     uint32_t interrupt_value;
-                    //     if (!writer.readMemory(intrerrupt_addr, interrupt_value)) {
-                    //         printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(intrerrupt_addr));
-                    //         break;
-                    //     }
-                    
-                    //     if (interrupt_value == 0) 
-                    //     {
-                    //         printf(";interrupt check ok !\n");
-                    //         break;
-                    //     }
-                    
-                    //     printf("mpause 10\n");
-                    //     std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    // }
-            
-                    // 인터럽트 클리어
-                    uintptr_t intrerrupt_addr_ = FIFO_ADDR + (i * 0x10000);
-                    uint32_t interrup_clear_value = 0xffffffff;
-                    writer.writeMemory(intrerrupt_addr_, interrup_clear_value);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                    printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", intrerrupt_addr_, interrup_clear_value);
-                    printf("mpause 10\n");
-            
-            
+                    cout << "Invalid engine. Please enter 'sw', 'hw' or 'auto'." << endl;
                 }
-            
-            
-                // Send Length
-                uintptr_t length_addr = 0x43c00018; 
-                uint32_t length_value = 0x4;
-                writer.writeMemory(length_addr, length_value);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", length_addr, length_value);
-                printf("mpause 10\n");
-            
-                // FIFO Execute : 0x1
-                uintptr_t addr_1c = 0x43c0001c;
-                uint32_t value_1c = 0x1;
-                writer.writeMemory(addr_1c, value_1c);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", addr_1c, value_1c);
-                printf("mpause 10\n");
-            
-                // FIFO 1~8 SEND : 0x1
-                uintptr_t send_addr = 0x43c00014;
-                uint32_t send_value = 0xff;
-                writer.writeMemory(send_addr, send_value);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", send_addr, send_value);
-                printf("mpause 10\n");
-            
-            
-                // SEND FIFO CHECK !!!
-                while (true)
+                cout << engines.Report() << endl;
+                continue;
+            }
+
+            // scan <raster|spiral|conical> ... | scan stop | scan status : 전용 thread 에서 pattern 을 dwell 간격으로 적용
+            if(txrx_input.rfind("scan", 0) == 0)
+            {
+                auto args = txrx_input.size() > 5 ? txrx_input.substr(5) : std::string("status");
+                if(args == "stop")
                 {
-                    uintptr_t fifo_send_check_address = 0x43c00014;
-                    uint32_t fifo_send_check_value;
-                    if (!writer.readMemory(fifo_send_check_address, fifo_send_check_value)) {
-                        printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(fifo_send_check_address));
-                        printf("mpause 10\n");
-                        break;
-                    }
-                
-                    if (fifo_send_check_value == 0x0) 
-                    {
-                        printf(";ok. fifo send completed\n");
-                        break;
-                    }
-                
-                    printf("mpause 100\n");
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    scanner.Stop();
+                    cout << scanner.Wait().Report() << endl;
                 }
-            
-            
-                // 남은 FIFO DATA SIZE 확인
-                uintptr_t remaining_fifo_address = 0x43c50000 + 0xc;
-                uint32_t remaining_fifo_data_size;
-                if (!writer.readMemory(remaining_fifo_address, remaining_fifo_data_size)) {
-                    printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(remaining_fifo_address + 0xC));
-                    printf("mpause 10\n");
-                }
-                else
+                else if(args == "status")
                 {
-                    printf("@@@ remaining size => 0x%08x @@@\n", remaining_fifo_data_size);
-                }
-                
-                remaining_fifo_address = 0x43c40000 + 0xc;
-                if (!writer.readMemory(remaining_fifo_address, remaining_fifo_data_size)) {
-                    printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(remaining_fifo_address + 0xC));
-                    printf("mpause 10\n");
+                    cout << scanner.Status() << endl;
                 }
                 else
                 {
-                    printf("@@@ remaining size => 0x%08x @@@\n", remaining_fifo_data_size);
+                    Scan::Spec spec;
+                    std::string err;
+                    if(scanner.Running())
+                    {
+                        err = "scan already running";
+                    }
+                    else if(Scan::ParseSpec(args, spec, &err))
+                    {
+                        // engine 명령으로 고른 engine 을 따른다 (기본 sw)
+                        spec.use_hw = std::string(engines.Current().Name()) == "hw";
+                        EnsurePanel(writer, spec.is_tx);
+                        is_tx = spec.is_tx;
+                        if(scanner.Start(spec, &err))
+                        {
+                            cout << "scan started : " << spec.Describe() << endl;
+                            continue;
+                        }
+                    }
+                    cout << "scan : " << err << endl;
                 }
-            
-            
-                printf("@@@ tx 패널 초기화 끝 @@@\n");
-            #endif
-                
+                continue;
             }
-            else if(txrx_input == "rx")
-            {
-                dx = 7.5f;
-                dy = 7.5f;
-                freq_Hz = 19700000000ULL;
-                is_tx = 0;
 
-                #if 1
-                printf("rx 패널 초기화 시작 !!!!\n");
-            
-                // VAIC RESET OFF
-                uintptr_t vaic_reset_addr = 0x43c28004;
-                uint32_t reset_off = 0xff;
-                writer.writeMemory(vaic_reset_addr, reset_off);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", vaic_reset_addr, reset_off);
-                printf("mpause 10\n");
-            
-                // VAIC RESET ON
-                uint32_t reset_on = 0x0;
-                writer.writeMemory(vaic_reset_addr, reset_on);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", vaic_reset_addr, reset_on);
-                printf("mpause 10\n");
-            
-                // FIFO init
-                for (int i = 0; i < 8; i++) 
+            // health [start [hz]|stop] : FIFO / send register 감시 thread 와 마지막 snapshot
+            if(txrx_input.rfind("health", 0) == 0)
+            {
+                auto args = txrx_input.size() > 7 ? txrx_input.substr(7) : std::string();
+                auto& monitor = Health::Monitor::Instance();
+                if(args.rfind("start", 0) == 0)
                 {
-                    uintptr_t fifo_addr = FIFO_ADDR + (i * 0x10000);
-            
-                    // 인터럽트 상태 확인
-                    uint32_t interrupt_value;
-                    writer.readMemory(fifo_addr, interrupt_value);
-                    printf(";interrupt check addr -> 0x%08x, value -> 0x%08x\n", fifo_addr, interrupt_value);
-                    printf("mpause 10\n");
-            
-                    // while (true)
-                    // {
-                    //     uint32_t interrupt_value;
-                    //     if (!writer.readMemory(fifo_addr, interrupt_value)) {
-                    //         printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(fifo_addr));
-                    //         break;
-                    //     }
-                    
-                    //     if (interrupt_value == 0) 
-                    //     {
-                    //         printf(";interrupt check ok !\n");
-                    //         break;
-                    //     }
-            
-                    //     printf("mpause 100\n");
-                    //     std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    // }
-            
-                    // 인터럽트 클리어
-                    uint32_t interrup_clear_value = 0xffffffff;
-                    writer.writeMemory(fifo_addr, interrup_clear_value);
+                    Health::Config cfg;
+                    if(args.size() > 6) cfg.rate_hz = std::max(1, std::atoi(args.c_str() + 6));
+                    if(!monitor.Start(writer, cfg)) cout << "health monitor already running" << endl;
                     std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_addr, interrup_clear_value);
-                    printf("mpause 10\n");
                 }
-            
-            
-                for(int j = 0; j < 8; j++)
+                else if(args == "stop")
                 {
-                    // start address
-                    uintptr_t start_address_ = FIFO_ADDR + (j * 0x10000) + 0x2C;
-                    uint32_t start_address_value__ = 0x2;
-                    writer.writeMemory(start_address_, start_address_value__);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", start_address_, start_address_value__);
-                    printf("mpause 10\n");
-            
-            
-                    uintptr_t fifo_1_address_ = FIFO_ADDR + (j * 0x10000) + 0x10;
-                    uint32_t broadcast_value1 = 0x60000000;
-                    writer.writeMemory(fifo_1_address_, broadcast_value1);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value1);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value2 = 0x6001068A;
-                    writer.writeMemory(fifo_1_address_, broadcast_value2);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value2);
-                    printf("mpause 10\n");
-            
-                    ////////////////////////////////////
-                    // 0x25, 3D, 45, 5D
-                    ////////////////////////////////////
-                    uint32_t broadcast_value3 = 0x60206CDB;
-                    writer.writeMemory(fifo_1_address_, broadcast_value3);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value3);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value4 = 0x60386CDB;
-                    writer.writeMemory(fifo_1_address_, broadcast_value4);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value4);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value5 = 0x60406CDB;
-                    writer.writeMemory(fifo_1_address_, broadcast_value5);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value5);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value6 = 0x60586CDB;
-                    writer.writeMemory(fifo_1_address_, broadcast_value6);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value6);
-                    printf("mpause 10\n");
-            
-                    ////////////////////////////////////
-                    // 0x26, 3E, 46, 5E
-                    ////////////////////////////////////
-                    uint32_t broadcast_value7 = 0x60212FFF;
-                    writer.writeMemory(fifo_1_address_, broadcast_value7);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value7);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value8 = 0x60392FFF;
-                    writer.writeMemory(fifo_1_address_, broadcast_value8);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value8);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value9 = 0x60412FFF;
-                    writer.writeMemory(fifo_1_address_, broadcast_value9);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value9);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value10 = 0x60592FFF;
-                    writer.writeMemory(fifo_1_address_, broadcast_value10);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value10);
-                    printf("mpause 10\n");
-            
-                    ////////////////////////////////////
-                    // 0x27, 0x3F, 0x47,  0x5F
-                    ////////////////////////////////////
-                    uint32_t broadcast_value11 = 0x602203F8;
-                    writer.writeMemory(fifo_1_address_, broadcast_value11);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value11);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value12 = 0x603A03F8;
-                    writer.writeMemory(fifo_1_address_, broadcast_value12);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value12);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value13 = 0x604203F8;
-                    writer.writeMemory(fifo_1_address_, broadcast_value13);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value13);
-                    printf("mpause 10\n");
-                    uint32_t broadcast_value14 = 0x605A03F8;
-                    writer.writeMemory(fifo_1_address_, broadcast_value14);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_1_address_, broadcast_value14);
-                    printf("mpause 10\n");
-            
-                    // length : 56 Byte (0x38)
-                    uintptr_t fifo_send_length = FIFO_ADDR + (j * 0x10000) + 0x14;
-                    uint32_t fifo_send_length____ = 0x38;
-                    writer.writeMemory(fifo_send_length, fifo_send_length____);
-                    printf("sendln \"devmem 0x%08x 32 0x%08x\"\n", fifo_send_length, fifo_send_length____);
-                    printf("mpause 10\n");
-            
-                    // 인터럽트 상태 확인
-                    uintptr_t intrerrupt_addr___ = FIFO_ADDR + (j * 0x10000);
-                    uint32_t interrupt_value;
-                    writer.readMemory(intrerrupt_addr___, interrupt_value);
-                    printf(";interrupt check addr -> 0x%08x, value -> 0x%08x\n", intrerrupt_addr___, interrupt_value);
-                    printf("mpause 10\n");
-            
-                    // while (true)
-                    // {
-                    //     uintptr_t intrerrupt_addr = 0x43c40000;
-                    //     uint32_t interrupt_value;
-                    //     if (!writer.readMemory(intrerrupt_addr, interrupt_value)) {
-                    //         printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(intrerrupt_addr));
-                    //         break;
-                    //     }
-                    
-                    //     if (interrupt_value == 0) 
-                    //     {
-                    //         printf(";interrupt check ok !\n");
-                    //         break;
-                    //     }
-                    
-                    //     printf("mpause 10\n");
-                    //     std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    // }
-            
-                    // 인터럽트 클리어
-                    uintptr_t intrerrupt_addr_ = FIFO_ADDR + (j * 0x10000);
-                    uint32_t interrup_clear_value = 0xffffffff;
-                    writer.writeMemory(intrerrupt_addr_, interrup_clear_value);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                    printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", intrerrupt_addr_, interrup_clear_value);
-                    printf("mpause 10\n");
-            
-            
+                    monitor.Stop();
                 }
-            
-            
-                // Send Length
-                uintptr_t length_addr = 0x43c00018; 
-                uint32_t length_value = 0x4;
-                writer.writeMemory(length_addr, length_value);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", length_addr, length_value);
-                printf("mpause 10\n");
-            
-                // FIFO Execute : 0x1
-                uintptr_t addr_1c = 0x43c0001c;
-                uint32_t value_1c = 0x1;
-                writer.writeMemory(addr_1c, value_1c);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", addr_1c, value_1c);
-                printf("mpause 10\n");
-            
-                // FIFO 1~8 SEND : 0x1
-                uintptr_t send_addr = 0x43c00014;
-                uint32_t send_value = 0xff;
-                writer.writeMemory(send_addr, send_value);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", send_addr, send_value);
-                printf("mpause 10\n");
-            
-            
-                // SEND FIFO CHECK !!!
-                while (true)
+                cout << monitor.Report() << endl;
+                continue;
+            }
+
+            // array <name[,name..]|all> <az> <el> : ArrayInfoMap 의 panel 을 transport 별로 동시에 beam (code 전송, readback 까지)
+            // array <name|all> print <phase|amplitude|...> : panel status 출력
+            if(txrx_input.rfind("array", 0) == 0)
+            {
+                std::stringstream ss(txrx_input.substr(5));
+                std::string names, arg1, arg2;
+                ss >> names >> arg1 >> arg2;
+                try
                 {
-                    uintptr_t fifo_send_check_address = 0x43c00014;
-                    uint32_t fifo_send_check_value;
-                    if (!writer.readMemory(fifo_send_check_address, fifo_send_check_value)) {
-                        printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(fifo_send_check_address));
-                        printf("mpause 10\n");
-                        break;
+                    auto selected = SelectArrays(names);
+                    if(arg1 == "print")
+                    {
+                        for(auto& name : selected) Print(owner.array_info_map_.at(name).array, arg2.empty() ? "phase" : arg2);
                     }
-                
-                    if (fifo_send_check_value == 0x0) 
+                    else if(!arg1.empty() && !arg2.empty())
                     {
-                        printf(";ok. fifo send completed\n");
-                        break;
+                        float az = stof(arg1);
+                        float el = stof(arg2);
+                        std::string range_err;
+                        if(!BeamPipeline::ValidSteering(az, el, &range_err)) throw std::invalid_argument(range_err);
+                        if(!ArrayExecutor::AllSucceeded(BeamAll(selected, az, el))) cout << "array beam failed" << endl;
+                    }
+                    else
+                    {
+                        cout << "usage : array <name[,name..]|all> <az> <el> | array <name|all> print <name>" << endl;
                     }
-                
-                    printf("mpause 100\n");
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
                 }
-            
-                // 남은 FIFO DATA SIZE 확인
-                uintptr_t remaining_fifo_address = 0x43c50000 + 0xc;
-                uint32_t remaining_fifo_data_size;
-                if (!writer.readMemory(remaining_fifo_address, remaining_fifo_data_size)) {
-                    printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(remaining_fifo_address + 0xC));
-                    printf("mpause 10\n");
+                catch(const std::exception& e)
+                {
+                    cout << "array : " << e.what() << endl;
                 }
-                else
+                continue;
+            }
+
+            // rt : 실시간 profile 적용 상태와 beam 당 page fault / context switch
+            if(txrx_input == "rt")
+            {
+                cout << Rt::Runtime::Instance().Report() << endl;
+                continue;
+            }
+
+            // batch <file|-> : "tx|rx az el [dwell_ms]" 줄을 연달아 적용하고 beams/s, latency 보고
+            if(txrx_input.rfind("batch", 0) == 0)
+            {
+                auto args = txrx_input.size() > 6 ? txrx_input.substr(6) : std::string("-");
+                std::string report;
+                RunBatchFile(writer, engines, args, warm_path, is_tx, report);
+                cout << report << endl;
+                if(args == "-") std::cin.clear();
+                continue;
+            }
+
+            // warm [show|save|clear|replay] : warm start 상태 파일 관리
+            if(txrx_input.rfind("warm", 0) == 0)
+            {
+                auto args = txrx_input.size() > 5 ? txrx_input.substr(5) : std::string();
+                if(args == "save")
                 {
-                    printf("@@@ remaining size => 0x%08x @@@\n", remaining_fifo_data_size);
+                    WarmStart::Save(warm_path, journal.Capture(az_value, el_value));
                 }
-                
-                remaining_fifo_address = 0x43c40000 + 0xc;
-                if (!writer.readMemory(remaining_fifo_address, remaining_fifo_data_size)) {
-                    printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(remaining_fifo_address + 0xC));
-                    printf("mpause 10\n");
+                else if(args == "clear")
+                {
+                    // 다음 tx/rx 에서 panel 을 다시 초기화
+                    journal.Reset();
+                    WarmStart::Remove(warm_path);
                 }
-                else
+                else if(args == "replay")
                 {
-                    printf("@@@ remaining size => 0x%08x @@@\n", remaining_fifo_data_size);
+                    HardwareArbiter::Lease lease(HardwareArbiter::Priority::Console);
+                    cout << (WarmStart::Replay(journal.Capture(az_value, el_value), writer) ? "replayed" : "replay failed") << endl;
                 }
+                cout << warm_path << " : " << journal.Capture(az_value, el_value).Report() << endl;
+                continue;
+            }
             
-                printf("rx 패널 초기화 끝 !!!!\n");
-            #endif
+            // tx/rx 처리
+            if(txrx_input == "tx")
+            {
+                freq_Hz = 29500000000ULL;
+                is_tx = 1;
+
+                EnsurePanel(writer, is_tx);
+                
+            }
+            else if(txrx_input == "rx")
+            {
+                freq_Hz = 19700000000ULL;
+                is_tx = 0;
+
+                EnsurePanel(writer, is_tx);
 
             }
             else
@@ -814,8 +1073,9 @@ struct ConsoleRunner::Impl
             string az_input;
             getline(std::cin, az_input);
             
+            float az_input_value;
             try {
-                az_value = stof(az_input);
+                az_input_value = stof(az_input);
             }
             catch(const std::exception& e) {
                 cout << "Invalid az value. Please enter a number." << endl;
@@ -827,321 +1087,35 @@ struct ConsoleRunner::Impl
             string el_input;
             getline(std::cin, el_input);
 
-            try 
-            {
-                el_value = stof(el_input);
-                printf("\n++++++++++++++++++++++++\n");
-                printf("[sch] start\n");
-                printf("++++++++++++++++++++++++\n");
-                uintptr_t base_addr = 0x43c40000;
-                uintptr_t init_addr = 0x43c4002c;
-                uint32_t init_value = 0x2;
-                writer.writeMemory(init_addr, init_value);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", init_addr, init_value);
-                printf("mpause 10\n");
- 
-                const int ROWS = 32;
-                const int COLS = 32;
-            
-
-                struct Entry {
-                    int spi_id;
-                    int chip_id;
-                    int channel_id;
-                    double x_offset;
-                    double y_offset;
-                    int poles;
-                    double calculated_phase; // 계산된 phase 값 추가
-                    double final_phase;      // offset 적용 후 최종 phase 값 추가
-                };
-    
-                std::vector<Entry> entries;
-                std::set<std::tuple<int, int, int>> unique_keys;  // for validation
-            
-                std::vector<int> channel_pattern_even, channel_pattern_odd;
-
-                if(is_tx == 1)
-                {
-                    channel_pattern_even = {0x27, 0x3F, 0x47, 0x5F}; // 짝수 col
-                    channel_pattern_odd  = {0x5F, 0x47, 0x3F, 0x27}; // 홀수 col
-                }
-                else
-                {
-                    channel_pattern_even = {0x22, 0x3A, 0x42, 0x5A}; // 짝수 col
-                    channel_pattern_odd  = {0x5A, 0x42, 0x3A, 0x22}; // 홀수 col
-                }
-
-                for (int row = 0; row < ROWS; ++row) {
-                    for (int col = 0; col < COLS; ++col) 
-                    {
-                        // spi_id 패턴
-                        int spi_id = 7 - (col / 4);
-            
-                        // chip_id 패턴
-                        int chip_id = (col % 4 < 2) ? (16 + row / 2) : (row / 2);
-
-                        // channel_id 패턴
-                        int channel_id = (col % 2 == 0)
-                            ? channel_pattern_even[row % 4]
-                            : channel_pattern_odd[row % 4];
-
-                        // poles 패턴
-                        int poles;
-                        if (row % 2 == 0) {  // 짝수 row
-                            poles = (col % 2 == 0) ? 120 : 30;
-                        } else {  // 홀수 row
-                            poles = (col % 2 == 0) ? 210 : 300;
-                        }
-
-                        // x_offset, y_offset 계산
-                        double x_offset_ = col * dx;
-                        double y_offset_ = row * dy;
-
-                        unique_keys.insert(key);
-                        entries.push_back({spi_id, chip_id, channel_id, x_offset_, y_offset_, poles});
-                    }
-                }
-
-                // // 정렬: (spi_id, chip_id, channel_id)
-                // std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
-                //     return std::tie(a.spi_id, a.chip_id, a.channel_id) <
-                //             std::tie(b.spi_id, b.chip_id, b.channel_id);
-                // });
-
-                // 각 Entry에 대해 Phase 계산 및 Offset 적용
-                cnt77 = 0;
-                for (auto& e : entries) { // entries를 참조로 순회하여 값 변경
-                    // 1. 위상(phase) 계산
-                    // std::cout << "=====" << endl; 
-                    // std::cout << "x = " << e.x_offset
-                    //           << ", y = " << e.y_offset << endl;
-
-                    int row_ = e.y_offset / dy;
-                    int col_ = e.x_offset / dx;
-
-                    // std::cout << "!!!!! cnt=" << cnt77
-                    //           << " row=" << row_
-                    //           << " col=" << col_
-                    //           << " x=" << e.x_offset
-                    //           << " y=" << e.y_offset;
-
-                    cnt77++;
-
-                    std::cout.flush(); // 버퍼 강제 플러시
-
-                    e.calculated_phase = phase(e.x_offset, e.y_offset);
-
-                    std::cout.flush();
-
-                    // std::cout << "phase = " << e.calculated_phase ;
-                              
-     
-                    // 2. 최종 Phase 계산: calculated_phase + offset_value
-                    e.final_phase = e.calculated_phase + e.poles;
-
-                    // std::cout << "e.poles = " << e.poles << endl;
-                    // std::cout << "e.final_phase1 = " << e.final_phase << endl;
-   
-                    // 3. 360을 넘으면 360을 뺍니다. (0-360 범위 유지)
-                    // std::fmod를 사용하여 부동 소수점 나머지 연산을 수행합니다.
-                    e.final_phase = std::fmod(e.final_phase, 360.0);
-                    if (e.final_phase < 0) { // 음수 값이 될 수도 있으므로 0 미만인 경우 360을 더해줍니다.
-                        e.final_phase += 360.0;
-                    }
-
-                    // std::cout << " phase = " << e.final_phase << endl;
-                    // std::cout << "=====" << endl;
-    
+            float el_input_value;
+            try {
+                el_input_value = stof(el_input);
+            }
+            catch(const std::exception& e) {
+                cout << "Invalid el value. Please enter a number." << endl;
+                continue;
+            }
 
-                }
-    
-                // 결과 출력
-                // std::cout << "--- Calculated Phases with Offset ---\n";
-                std::cout << std::fixed << std::setprecision(2); // 소수점 두 자리까지 출력
-    
-                cnt77 = 0;
-
-                int prev_bus_id = 0;
-    
-                // 정렬: (spi_id, chip_id, channel_id)
-                std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
-                    return std::tie(a.spi_id, a.chip_id, a.channel_id) <
-                            std::tie(b.spi_id, b.chip_id, b.channel_id);
-                });
-
-                for (const auto& e : entries) {
-                    // x,y 오프셋으로부터 원래의 row, col을 다시 계산
-                    int original_row = e.y_offset / dy;
-                    int original_col = e.x_offset / dx;
-    
-                    // std::cout << ";Row: " << std::setw(2) << original_row
-                    //         << ", Col: " << std::setw(2) << original_col
-                    //         << " | SPI: " << e.spi_id
-                    //         << ", CHIP: " << std::setw(2) << e.chip_id
-                    //         << ", CHAN: 0x" << std::hex << std::uppercase << e.channel_id << std::dec
-                    //         << ", X: " << std::setw(3) << e.x_offset
-                    //         << ", Y: " << std::setw(3) << e.y_offset
-                    //         << ", Poles: " << std::setw(3) << e.poles
-                    //         << ", Calc Phase: " << std::setw(6) << e.calculated_phase
-                    //         << ", Final Phase: " << std::setw(6) << e.final_phase
-                    //         << std::endl;
-
-                    int int_phase = int(fmod(e.final_phase + 360.0, 360.0) / 5.625);
-                    uint16_t value = 0;
-
-                    if(is_tx == 1)
-                    {
-                        value = \
-                        (( 0 & 0x01 ) << 0 ) \
-                        | ((127 & 0x7f ) << 1) \
-                        | ((3 & 0x03) << 8 ) \
-                        | ((int_phase & 0x3f)<<10);
-                    }
-                    else
-                    {
-                        value = \
-                        (( 0 & 0x01 ) << 0 ) \
-                        | ((1 & 0x1) << 3 ) \
-                        | ((63 & 0x3f ) << 4) \
-                        | ((int_phase & 0x3f)<<10);
-                    }
+            // stof 는 nan / inf 도 받는다. 범위 밖이면 전역 az/el 을 바꾸지 않는다
+            if(std::string range_err; !BeamPipeline::ValidSteering(az_input_value, el_input_value, &range_err))
+            {
+                cout << "Invalid az/el : " << range_err << endl;
+                continue;
+            }
 
-                    printf(";cnt=%d spi_id=0x%02X chip_id=0x%02X chan_id=0x%02X DATA=0x%04X\n", cnt77,
-                        e.spi_id & 0xFF, e.chip_id & 0xFF, e.channel_id, value & 0xFFFF);
-
-                    base_address = 0x43c40000 + (e.spi_id * 0x10000);
-                    // printf(";bus_id(%d), base_address(0x%08X)\n", e.spi_id, base_address);
-
-                    byte_queues[e.spi_id].push_back(0x28);
-                    byte_queues[e.spi_id].push_back(e.chip_id);
-                    byte_queues[e.spi_id].push_back(e.channel_id);
-                    byte_queues[e.spi_id].push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
-                    byte_queues[e.spi_id].push_back(static_cast<uint8_t>(value & 0xFF));
-    
-                    // 현재 bus의 큐 처리
-                    auto& q = byte_queues[e.spi_id];
-                    while (q.size() >= 4) 
-                    {
-                        uint32_t data = 0;
-                        for (int i = 0; i < 4; ++i) {
-                            data <<= 8;
-                            data |= q.front();
-                            q.pop_front();
-                        }
-                        
-                        writer.writeMemory(base_address + 0x0010, data);
-                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                        printf(";----count : %d ----\n", count__++);
-                        printf("sendln \"devmem 0x%08x 32 0x%02x%02x%02x%02x\"\n",
-                            base_address + 0x0010,
-                            (data >> 24) & 0xFF,
-                            (data >> 16) & 0xFF,
-                            (data >> 8) & 0xFF,
-                            data & 0xFF);
-                        printf("mpause 1\n");
-                    }
-    
-                    if(prev_bus_id != e.spi_id)
-                    {
-                        change_bus_process(e.spi_id);
-                    }
-    
-                    prev_bus_id = e.spi_id;
-    
-                }
-        
-                change_bus_process(prev_bus_id);
-    
-                std::cout << "\nTotal unique entries: " << entries.size() << std::endl;
-    
-                printf("++++++++++++++++++++++++\n");
-                printf("=======done=====\n");
-                printf("++++++++++++++++++++++++\n");
-        
-                // Send Length
-                uintptr_t length_addr = 0x43c00018; 
-                uint32_t length_value = 0x5;
-                writer.writeMemory(length_addr, length_value);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", length_addr, length_value);
-                printf("mpause 10\n");
-        
-                // FIFO Execute : 0x1
-                uintptr_t addr_1c = 0x43c0001c;
-                uint32_t value_1c = 0x1;
-                writer.writeMemory(addr_1c, value_1c);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", addr_1c, value_1c);
-                printf("mpause 10\n");
-        
-                // FIFO 1~8 SEND : 0Xff
-                uintptr_t send_addr = 0x43c00014;
-                uint32_t send_value = 0xff;
-                writer.writeMemory(send_addr, send_value);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", send_addr, send_value);
-                printf("mpause 10\n");
-        
-        
-                // 남은 FIFO DATA SIZE 확인
-                while (true)
+            try 
+            {
+                az_value = az_input_value;
+                el_value = el_input_value;
+                if(HardwareArbiter::Instance().Run(HardwareArbiter::Priority::Console,
+                    [&]{ return engines.Apply(is_tx, az_value, el_value); }))
                 {
-                    uintptr_t fifo_send_check_address = 0x43c00014;
-                    uint32_t fifo_send_check_value;
-                    if (!writer.readMemory(fifo_send_check_address, fifo_send_check_value)) {
-                        printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(fifo_send_check_address));
-                        printf("mpause 10\n");
-                        break;
-                    }
-                
-                    if (fifo_send_check_value == 0x0) 
-                    {
-                        printf(";ok fifo send all completed !\n");
-                        break;
-                    }
-                
-                    printf("mpause 100\n");
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    WarmStart::Save(warm_path, journal.Capture(az_value, el_value));
                 }
-        
-                uint32_t fifo_1_remaining_size;
-                uint32_t fifo_2_remaining_size;
-                uint32_t fifo_3_remaining_size;
-                uint32_t fifo_4_remaining_size;
-                uint32_t fifo_5_remaining_size;
-                uint32_t fifo_6_remaining_size;
-                uint32_t fifo_7_remaining_size;
-                uint32_t fifo_8_remaining_size;
-                writer.readMemory(0x43c4000c, fifo_1_remaining_size);
-                printf(";now fifo 1 remaining size -> %d\n", fifo_1_remaining_size);
-                printf("mpause 10\n");
-                writer.readMemory(0x43c5000c, fifo_2_remaining_size);
-                printf(";now fifo 2 remaining size -> %d\n", fifo_2_remaining_size);
-                printf("mpause 10\n");
-                writer.readMemory(0x43c6000c, fifo_3_remaining_size);
-                printf(";now fifo 3 remaining size -> %d\n", fifo_3_remaining_size);
-                printf("mpause 10\n");
-                writer.readMemory(0x43c7000c, fifo_4_remaining_size);
-                printf(";now fifo 4 remaining size -> %d\n", fifo_4_remaining_size);
-                printf("mpause 10\n");
-                writer.readMemory(0x43c8000c, fifo_5_remaining_size);
-                printf(";now fifo 5 remaining size -> %d\n", fifo_5_remaining_size);
-                printf("mpause 10\n");
-                writer.readMemory(0x43c9000c, fifo_6_remaining_size);
-                printf(";now fifo 6 remaining size -> %d\n", fifo_6_remaining_size);
-                printf("mpause 10\n");
-                writer.readMemory(0x43ca000c, fifo_7_remaining_size);
-                printf(";now fifo 7 remaining size -> %d\n", fifo_7_remaining_size);
-                printf("mpause 10\n");
-                writer.readMemory(0x43cb000c, fifo_8_remaining_size);
-                printf(";now fifo 8 remaining size -> %d\n", fifo_8_remaining_size);
-                printf("mpause 10\n");
-    
                 cout << "Processing completed." << endl << endl;
             }
             catch(const std::exception& e) {
-                cout << "Invalid el value. Please enter a number." << endl;
+                cout << "beam failed : " << e.what() << endl;
                 continue;
             }
 
@@ -1152,12 +1126,9 @@ struct ConsoleRunner::Impl
 
 ConsoleRunner::ConsoleRunner( TransportMap& transport_map, ArrayInfoMap& arraym ) : 
     Runner(transport_map, arraym), 
+    writer(HardwareContext::Instance().Writer()),
     impl_(new Impl(*this)) 
 {
-        // Address total 0x43c00000 => 0x43c40000(bus0) ~ 0x43cb0000(bus7)
-        writer.initialize(BASE_ADDR, 0xC0000);
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));    
-
 }
 
 ConsoleRunner::~ConsoleRunner() 
@@ -1175,9 +1146,19 @@ void ConsoleRunner::Run(SpiwriteProtocol::MemoryWriter& wr)
     impl_->Run(wr);
 }
 
+int ConsoleRunner::RunBatch(const std::string& path)
+{
+    return impl_->RunBatch(writer, path);
+}
+
 void ConsoleRunner::SetMaxTransferSizeInBytes( int transfer_size )
 {
-    impl_->transfer_size_in_bytes = transfer_size;
+    impl_->executor.SetMaxTransferSizeInBytes( transfer_size );
+}
+
+void ConsoleRunner::SetCodeFn( ArrayExecutor::CodeFn fn )
+{
+    impl_->executor.SetCodeFn( std::move(fn) );
 }
 
 
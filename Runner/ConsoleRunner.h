@@ -1,8 +1,10 @@
 #ifndef __SPIBEAM_CONSOLE_RUNNER_H__
 #define __SPIBEAM_CONSOLE_RUNNER_H__
 
+#include <string>
 #include "Runner.h"
 #include "SpiwriteCommand.h"
+#include "ArrayExecutor.h"
 
 namespace SpiBeam {
 
@@ -15,13 +17,18 @@ public:
  
     virtual void Run() override;
     void Run(SpiwriteProtocol::MemoryWriter& writer);
+
+    // "tx|rx az el [dwell_ms]" 줄을 읽어 연달아 적용 ("-" 는 stdin). 모두 적용되면 0
+    int RunBatch(const std::string& path);
     void SetMaxTransferSizeInBytes( int transfer_size );
+    // 'array' 명령이 panel 마다 code 를 만들 때 쓰는 함수
+    void SetCodeFn( ArrayExecutor::CodeFn fn );
 
 
 private:
     struct Impl;
     friend class ConsoleRunner::Impl;
-    SpiwriteProtocol::MemoryWriter writer;
+    SpiwriteProtocol::MemoryWriter& writer;   // HardwareContext 공유
     Impl *impl_;
     
 };
@@ -0,0 +1,177 @@
+#include <chrono>
+#include "string_util.hpp"
+#include "HardwareArbiter.h"
+#include "SpiStats.h"
+
+namespace SpiBeam {
+
+const char* HardwareArbiter::PriorityName( Priority p )
+{
+    switch( p )
+    {
+        case Priority::Tracking: return "tracking";
+        case Priority::Remote:   return "remote";
+        case Priority::Console:  return "console";
+        default:                 return "NA";
+    }
+}
+
+HardwareArbiter& HardwareArbiter::Instance()
+{
+    static HardwareArbiter arbiter;
+    return arbiter;
+}
+
+HardwareArbiter::HardwareArbiter()
+{
+    for( auto& o : overtakes_ ) o = 0;
+    Stats::Registry::Instance().AddSection( "arbiter", [this]{ return Report(); } );
+}
+
+HardwareArbiter::Lease::Lease( Priority p, int expire_ms, HardwareArbiter& arbiter )
+    : arbiter_( arbiter )
+{
+    serial_ = arbiter_.Acquire( p, expire_ms );
+}
+
+HardwareArbiter::Lease::~Lease()
+{
+    arbiter_.Release( serial_ );
+}
+
+bool HardwareArbiter::Lease::Valid() const
+{
+    return arbiter_.Holds( serial_ );
+}
+
+uint64_t HardwareArbiter::Acquire( Priority p, int expire_ms )
+{
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    if( busy_ && owner_ == std::this_thread::get_id() )
+    {
+        // 안쪽 Lease 가 일하는 동안은 회수하지 않고, 만료 시각도 지금부터 다시 센다
+        depth_++;
+        if( expires_at_ != 0 ) expires_at_ = Trace::NowNs() + expire_ns_;
+        return serial_;
+    }
+
+    auto t0 = Trace::NowNs();
+    auto key = std::make_pair( (int)p, next_ticket_++ );
+    waiting_.insert( key );
+    while( busy_ || *waiting_.begin() != key )
+    {
+        // 회수는 바깥 Lease 만 남아 쉬고 있는 holder 만. 안쪽 Lease 가 있으면 register 를 쓰는 중이다
+        if( !busy_ || expires_at_ == 0 || depth_ > 1 )
+        {
+            cv_.wait( lock );
+            continue;
+        }
+
+        // 만료 시각까지 기다려도 안 놓으면 회수
+        auto deadline = std::chrono::steady_clock::time_point( std::chrono::nanoseconds( expires_at_ ) );
+        if( cv_.wait_until( lock, deadline ) == std::cv_status::timeout && busy_ && expires_at_ != 0 && depth_ == 1 && Trace::NowNs() >= expires_at_ )
+        {
+            busy_ = false;
+            owner_ = std::thread::id();
+            depth_ = 0;
+            expires_at_ = 0;
+            expire_ns_ = 0;
+            expired_++;
+            cv_.notify_all();
+        }
+    }
+
+    // 먼저 와서 기다리는 중인 낮은 priority 를 앞질렀는지
+    for( auto& w : waiting_ )
+    {
+        if( w.first > key.first && w.second < key.second )
+        {
+            overtakes_[(int)p].fetch_add( 1, std::memory_order_relaxed );
+            break;
+        }
+    }
+
+    waiting_.erase( key );
+    busy_ = true;
+    owner_ = std::this_thread::get_id();
+    depth_ = 1;
+    holder_ = p;
+    acquired_at_ = Trace::NowNs();
+    expire_ns_ = expire_ms > 0 ? (uint64_t)expire_ms * 1000000 : 0;
+    expires_at_ = expire_ns_ > 0 ? acquired_at_ + expire_ns_ : 0;
+
+    wait_[(int)p].Record( acquired_at_ - t0 );
+    return ++serial_;
+}
+
+void HardwareArbiter::Release( uint64_t serial )
+{
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+
+        // 이미 회수된 Lease
+        if( !busy_ || serial != serial_ || owner_ != std::this_thread::get_id() ) return;
+        if( --depth_ > 0 )
+        {
+            // 바깥 Lease 만 남으면 만료 시각을 다시 세고, 기다리는 쪽이 새 시각으로 다시 기다리게 깨운다
+            if( depth_ > 1 || expires_at_ == 0 ) return;
+            expires_at_ = Trace::NowNs() + expire_ns_;
+        }
+        else
+        {
+            busy_ = false;
+            owner_ = std::thread::id();
+            expires_at_ = 0;
+            expire_ns_ = 0;
+            hold_[(int)holder_].Record( Trace::NowNs() - acquired_at_ );
+        }
+    }
+    cv_.notify_all();
+}
+
+bool HardwareArbiter::Holds( uint64_t serial ) const
+{
+    // 회수된 뒤 다른 Lease 가 잡으면 serial_ 이 바뀐다
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return busy_ && serial == serial_;
+}
+
+std::string HardwareArbiter::Report() const
+{
+    std::string rep;
+    for( int i = 0; i < (int)Priority::Count; i++ )
+    {
+        const auto& w = wait_[i];
+        const auto& h = hold_[i];
+        if( w.Count() == 0 ) continue;
+
+        if( !rep.empty() ) rep += "\r\n";
+        rep += Common::string_format( "%-9s n=%llu wait us mean %.1f p99 %.1f max %.1f, hold us mean %.1f max %.1f, overtakes %llu",
+            PriorityName( (Priority)i ), (unsigned long long)w.Count(),
+            w.Mean() / 1000.0, w.Percentile( 99.0 ) / 1000.0, w.Max() / 1000.0,
+            h.Mean() / 1000.0, h.Max() / 1000.0,
+            (unsigned long long)overtakes_[i].load( std::memory_order_relaxed ) );
+    }
+
+    if( uint64_t expired = expired_.load(); expired > 0 )
+    {
+        if( !rep.empty() ) rep += "\r\n";
+        rep += Common::string_format( "expired leases %llu", (unsigned long long)expired );
+    }
+    return rep;
+}
+
+void HardwareArbiter::ResetStats()
+{
+    for( int i = 0; i < (int)Priority::Count; i++ )
+    {
+        wait_[i].Reset();
+        hold_[i].Reset();
+        overtakes_[i] = 0;
+    }
+    expired_ = 0;
+}
+
+
+}
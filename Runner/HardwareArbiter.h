@@ -0,0 +1,103 @@
+#ifndef __SPIBEAM_HARDWARE_ARBITER_H__
+#define __SPIBEAM_HARDWARE_ARBITER_H__
+
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <cstdint>
+#include <condition_variable>
+#include "BeamTrace.h"
+
+namespace SpiBeam {
+
+// FIFO / 제어 register 를 쓰는 모든 경로 (console, spiterm, scan) 가 beam 단위로 잡는 우선순위 lock.
+//   - Lease 를 들고 있는 동안의 register access 는 다른 경로와 섞이지 않는다 (beam 하나 = transaction 하나)
+//   - 기다리는 Lease 는 priority 순 (같으면 먼저 온 순) 으로 받는다.
+//     먼저 줄 선 낮은 priority 의 load 보다 나중에 온 높은 priority 의 beam 이 먼저 나간다
+//   - 이미 잡은 transaction 을 중간에 끊지는 않는다
+//   - 같은 thread 안에서 겹쳐 잡으면 바깥 Lease 하나로 센다
+//   - 여러 datagram 에 걸친 원격 beam (start .. done) 처럼 오래 들고 있을 수 있는 Lease 는 expire_ms 를 준다.
+//     그 시간이 지나도록 놓지 않으면 기다리던 쪽이 회수하고, 회수된 Lease 의 해제는 아무 일도 하지 않는다.
+//     안쪽 Lease 가 잡혀 있는 동안은 회수하지 않으며, 안쪽 Lease 를 잡고 놓을 때마다 만료 시각을 다시 센다
+// 작업은 호출한 thread 에서 그대로 실행되므로 thread 전환이 없다 (scan 의 RT thread 도 그대로)
+class HardwareArbiter
+{
+public:
+    enum class Priority : int
+    {
+        Tracking = 0,   // scan / tracking
+        Remote,         // spiterm 등 원격 명령
+        Console,
+
+        Count
+    };
+
+    static const char* PriorityName( Priority p );
+
+    static HardwareArbiter& Instance();
+
+    class Lease
+    {
+    public:
+        explicit Lease( Priority p, int expire_ms = 0, HardwareArbiter& arbiter = HardwareArbiter::Instance() );
+        ~Lease();
+
+        Lease( const Lease& ) = delete;
+        Lease& operator=( const Lease& ) = delete;
+
+        // 이 transaction 의 번호. 다음 번 Lease 의 Serial() 이 +1 이 아니면 그 사이 다른 경로가 register 를 썼다
+        uint64_t Serial() const { return serial_; }
+
+        // 만료로 회수되지 않고 아직 이 Lease 가 hardware 를 잡고 있으면 true (어느 thread 에서나 확인 가능)
+        bool Valid() const;
+
+    private:
+        HardwareArbiter& arbiter_;
+        uint64_t serial_ = 0;
+    };
+
+    template <typename Fn>
+    auto Run( Priority p, Fn&& fn ) -> decltype( fn() )
+    {
+        Lease lease( p, 0, *this );
+        return fn();
+    }
+
+    std::string Report() const;
+    void ResetStats();
+
+private:
+    HardwareArbiter();
+    HardwareArbiter( const HardwareArbiter& ) = delete;
+    HardwareArbiter& operator=( const HardwareArbiter& ) = delete;
+
+    uint64_t Acquire( Priority p, int expire_ms );
+    void Release( uint64_t serial );
+    bool Holds( uint64_t serial ) const;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::set<std::pair<int, uint64_t>> waiting_;   // (priority, ticket)
+    uint64_t next_ticket_ = 0;
+    uint64_t serial_ = 0;
+    bool busy_ = false;
+    std::thread::id owner_;
+    int depth_ = 0;
+    Priority holder_ = Priority::Console;
+    uint64_t acquired_at_ = 0;
+    uint64_t expires_at_ = 0;   // 0 이면 만료 없음 (Trace::NowNs 기준)
+    uint64_t expire_ns_ = 0;    // 바깥 Lease 의 expire_ms
+    std::atomic<uint64_t> expired_ { 0 };
+
+    Trace::Histogram wait_[(int)Priority::Count];
+    Trace::Histogram hold_[(int)Priority::Count];
+    std::atomic<uint64_t> overtakes_[(int)Priority::Count];   // 먼저 기다리던 낮은 priority 를 앞지른 횟수
+};
+
+
+}
+
+#endif
@@ -0,0 +1,23 @@
+#include <algorithm>
+#include "HardwareContext.h"
+#include "PanelLayout.h"
+
+namespace SpiBeam {
+
+HardwareContext& HardwareContext::Instance()
+{
+    static HardwareContext context;
+    return context;
+}
+
+HardwareContext::HardwareContext()
+{
+    // bus 가 8 개보다 많은 layout 이면 FIFO register 영역까지 늘려서 mapping
+    auto& layouts = Layout::Registry::Instance();
+    map_size_ = std::max( MAP_SIZE, layouts.AddressSpan( BASE_ADDR ) );
+    writer_.initializeLazy( BASE_ADDR, map_size_ );
+    layouts.SetAddressWindow( BASE_ADDR, map_size_ );
+}
+
+
+}
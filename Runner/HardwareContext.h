@@ -0,0 +1,36 @@
+#ifndef __SPIBEAM_HARDWARE_CONTEXT_H__
+#define __SPIBEAM_HARDWARE_CONTEXT_H__
+
+#include "SpiwriteCommand.h"
+
+namespace SpiBeam {
+
+// process 전체에서 register 영역을 한 번만 mapping 해서 공유한다.
+// 모든 SpiwriteCommand / ConsoleRunner 가 같은 MemoryWriter(같은 fd, mapping, mutex)를 쓴다.
+// mapping 은 첫 read/write 때 만들어지므로 생성 시점에 /dev/mem 접근이나 sleep 이 없다.
+class HardwareContext
+{
+public:
+    // Address total 0x43c00000 => 0x43c40000(bus0) ~ 0x43cb0000(bus7)
+    static constexpr uintptr_t BASE_ADDR = 0x43C00000;
+    static constexpr size_t    MAP_SIZE  = 0xC0000;
+
+    static HardwareContext& Instance();
+
+    SpiwriteProtocol::MemoryWriter& Writer() { return writer_; }
+    // 시작할 때의 layout 으로 정한 mapping 크기. 이후 이 밖을 쓰는 layout 은 Layout::Registry 가 거부한다
+    size_t MapSize() const { return map_size_; }
+
+private:
+    HardwareContext();
+    HardwareContext( const HardwareContext& ) = delete;
+    HardwareContext& operator=( const HardwareContext& ) = delete;
+
+    SpiwriteProtocol::MemoryWriter writer_;
+    size_t map_size_ = MAP_SIZE;
+};
+
+
+}
+
+#endif
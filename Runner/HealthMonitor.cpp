@@ -0,0 +1,211 @@
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include "string_util.hpp"
+#include "HealthMonitor.h"
+#include "PanelLayout.h"
+#include "BeamTrace.h"
+#include "SpiStats.h"
+
+namespace SpiBeam {
+namespace Health {
+
+namespace {
+
+constexpr uintptr_t SEND_ADDR = 0x43c00014;
+
+// bus 별로 sample 사이에 들고 있는 상태 (monitor thread 전용)
+struct BusTrack
+{
+    uint32_t last_vacancy = 0;
+    uint64_t unchanged_since_ns = 0;
+    bool busy = false;
+};
+
+}
+
+std::string Snapshot::Report() const
+{
+    if( samples == 0 ) return "health : no samples";
+
+    std::string rep = Common::string_format( "health : %llu samples, send 0x%02x%s, events stuck %llu overflow %llu timeout %llu",
+        (unsigned long long)samples, send, send_timeout ? " TIMEOUT" : "",
+        (unsigned long long)stuck_events, (unsigned long long)overflow_events, (unsigned long long)timeout_events );
+
+    for( int b = 0; b < num_bus; b++ )
+    {
+        const BusSample& s = bus[b];
+        rep += Common::string_format( "\r\n bus %d: isr 0x%08x vacancy %u%s%s%s", b, s.isr, s.vacancy,
+            ( s.flags & FLAG_FULL ) ? " FULL" : "",
+            ( s.flags & FLAG_STUCK ) ? " STUCK" : "",
+            ( s.flags & FLAG_OVERFLOW ) ? " OVERFLOW" : "" );
+    }
+    return rep;
+}
+
+Monitor& Monitor::Instance()
+{
+    static Monitor monitor;
+    return monitor;
+}
+
+Monitor::Monitor()
+{
+    Stats::Registry::Instance().AddSection( "health", [this]
+    {
+        return Running() ? Read().Report() : std::string();
+    });
+}
+
+Monitor::~Monitor()
+{
+    Stop();
+}
+
+bool Monitor::Start( SpiwriteProtocol::MemoryWriter& writer, const Config& config )
+{
+    if( Running() ) return false;
+    if( thread_.joinable() ) thread_.join();
+
+    stop_ = false;
+    running_ = true;
+    thread_ = std::thread( [this, &writer, config]{ Loop( &writer, config ); } );
+    return true;
+}
+
+void Monitor::Stop()
+{
+    stop_ = true;
+    if( thread_.joinable() ) thread_.join();
+}
+
+void Monitor::Publish( const Snapshot& s )
+{
+    static_assert( std::is_trivially_copyable<Snapshot>::value, "snapshot is copied word by word" );
+    uint64_t words[SNAPSHOT_WORDS] = {};
+    memcpy( words, &s, sizeof( Snapshot ) );
+
+    uint64_t seq = seq_.load( std::memory_order_relaxed );
+    seq_.store( seq + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    for( size_t i = 0; i < SNAPSHOT_WORDS; i++ ) snapshot_[i].store( words[i], std::memory_order_relaxed );
+    seq_.store( seq + 2, std::memory_order_release );
+}
+
+Snapshot Monitor::Read() const
+{
+    uint64_t words[SNAPSHOT_WORDS];
+    for( ;; )
+    {
+        uint64_t before = seq_.load( std::memory_order_acquire );
+        if( before & 1 ) continue;
+
+        for( size_t i = 0; i < SNAPSHOT_WORDS; i++ ) words[i] = snapshot_[i].load( std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_acquire );
+        if( seq_.load( std::memory_order_relaxed ) == before ) break;
+    }
+
+    Snapshot s;
+    memcpy( &s, words, sizeof( Snapshot ) );
+    return s;
+}
+
+void Monitor::Latch( int bus, uint32_t isr )
+{
+    if( bus >= 0 && bus < Snapshot::MAX_BUS && isr != 0 )
+        latched_[bus].fetch_or( isr, std::memory_order_relaxed );
+}
+
+uint32_t LatchIsr( SpiwriteProtocol::MemoryWriter& writer, int bus, uintptr_t base )
+{
+    uint32_t isr = 0;
+    writer.readMemory( base, isr );
+    if( Active() ) Monitor::Instance().Latch( bus, isr );
+    return isr;
+}
+
+std::string Monitor::Report() const
+{
+    return Running() ? Read().Report() : std::string( "health : monitor stopped" );
+}
+
+void Monitor::Loop( SpiwriteProtocol::MemoryWriter* writer, Config config )
+{
+    using namespace std::chrono;
+
+    const auto period = nanoseconds( 1000000000LL / std::max( 1, config.rate_hz ) );
+    const uint64_t stuck_ns = (uint64_t)config.stuck_ms * 1000000;
+    const uint64_t timeout_ns = (uint64_t)config.send_timeout_ms * 1000000;
+
+    Snapshot s;
+    BusTrack track[Snapshot::MAX_BUS];
+    uint64_t send_busy_since = 0;
+    auto next = steady_clock::now();
+
+    while( !stop_ )
+    {
+        auto layout = Layout::Registry::Instance().Get( 1 );
+        uint64_t now = Trace::NowNs();
+
+        uint32_t send = 0;
+        writer->readMemory( SEND_ADDR, send );
+
+        s.num_bus = std::min( layout->num_bus, Snapshot::MAX_BUS );
+        for( int b = 0; b < s.num_bus; b++ )
+        {
+            BusSample& bs = s.bus[b];
+            BusTrack& t = track[b];
+            uintptr_t base = layout->FifoAddress( b );
+            uint32_t prev_flags = bs.flags;
+
+            writer->readMemory( base, bs.isr );
+            writer->readMemory( base + 0xC, bs.vacancy );
+            // 지난 sample 이후 beam 경로가 지운 bit
+            bs.isr |= latched_[b].exchange( 0, std::memory_order_relaxed );
+
+            // send 가 시작되면 그때부터 vacancy 변화를 본다
+            bool busy = ( send >> b ) & 1;
+            if( bs.vacancy != t.last_vacancy || busy != t.busy || t.unchanged_since_ns == 0 )
+            {
+                t.last_vacancy = bs.vacancy;
+                t.unchanged_since_ns = now;
+            }
+            t.busy = busy;
+
+            bs.flags = 0;
+            if( bs.vacancy == 0 ) bs.flags |= FLAG_FULL;
+            if( busy && now - t.unchanged_since_ns >= stuck_ns ) bs.flags |= FLAG_STUCK;
+            if( bs.isr & ISR_OVERFLOW ) bs.flags |= FLAG_OVERFLOW;
+
+            // 켜지는 순간만 센다
+            uint32_t rising = bs.flags & ~prev_flags;
+            if( rising & FLAG_FULL ) Stats::Inc( Stats::Counter::FifoFullStalls );
+            if( rising & FLAG_STUCK ) s.stuck_events++;
+            if( rising & FLAG_OVERFLOW ) s.overflow_events++;
+        }
+
+        if( send == 0 ) send_busy_since = 0;
+        else if( send_busy_since == 0 ) send_busy_since = now;
+
+        bool timeout = send_busy_since != 0 && now - send_busy_since >= timeout_ns;
+        if( timeout && !s.send_timeout ) s.timeout_events++;
+        s.send_timeout = timeout;
+        s.send = send;
+        s.t_ns = now;
+        s.samples++;
+
+        Publish( s );
+
+        next += period;
+        auto late = steady_clock::now();
+        if( next < late ) next = late;   // 밀린 주기는 건너뛴다
+        std::this_thread::sleep_until( next );
+    }
+
+    running_ = false;
+}
+
+
+}
+}
@@ -0,0 +1,114 @@
+#ifndef __SPIBEAM_HEALTH_MONITOR_H__
+#define __SPIBEAM_HEALTH_MONITOR_H__
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include "SpiwriteCommand.h"
+#include "PanelLayout.h"
+
+namespace SpiBeam {
+namespace Health {
+
+// bus FIFO 는 AXI4-Stream FIFO : +0x0 ISR, +0x0C TDFV (transmit vacancy)
+constexpr uint32_t ISR_TPOE = 1u << 28;    // transmit packet overrun
+constexpr uint32_t ISR_TSE  = 1u << 25;    // transmit size error
+constexpr uint32_t ISR_OVERFLOW = ISR_TPOE | ISR_TSE;
+
+struct Config
+{
+    int rate_hz = 1000;
+    int stuck_ms = 50;          // send 중인데 vacancy 가 이 시간 동안 그대로면 stuck
+    int send_timeout_ms = 100;  // send register (0x43c00014) 가 이 시간 넘게 0 이 아니면 timeout
+};
+
+enum Flag : uint32_t
+{
+    FLAG_FULL     = 1u << 0,    // vacancy 0
+    FLAG_STUCK    = 1u << 1,
+    FLAG_OVERFLOW = 1u << 2,
+};
+
+struct BusSample
+{
+    uint32_t isr;
+    uint32_t vacancy;
+    uint32_t flags;
+};
+
+struct Snapshot
+{
+    static constexpr int MAX_BUS = Layout::MAX_BUS;
+
+    uint64_t t_ns = 0;          // 마지막 sample 시각 (Trace::NowNs)
+    uint64_t samples = 0;
+    int num_bus = 0;
+    uint32_t send = 0;          // 0x43c00014
+    bool send_timeout = false;
+    BusSample bus[MAX_BUS] {};
+
+    // 시작 후 발생 (flag 가 켜진 횟수)
+    uint64_t stuck_events = 0;
+    uint64_t overflow_events = 0;
+    uint64_t timeout_events = 0;
+
+    std::string Report() const;
+};
+
+// 별도 thread 에서 모든 bus 의 ISR / vacancy 와 send register 를 주기적으로 읽어
+// seqlock snapshot 으로 내놓는다. 읽기만 하므로 HardwareArbiter 는 잡지 않는다.
+// 돌고 있는 동안 beam 경로 (SwBeamEngine, BINARY, done) 는 remaining size 를 직접 읽지 않는다.
+// ISR 은 beam 경로가 bus 마다 지우므로, 지우기 직전에 읽은 값을 Latch 로 넘겨 다음 sample 에 합친다 (LatchIsr)
+class Monitor
+{
+public:
+    static Monitor& Instance();
+
+    bool Start( SpiwriteProtocol::MemoryWriter& writer, const Config& config = Config() );
+    void Stop();
+    bool Running() const { return running_.load( std::memory_order_relaxed ); }
+
+    // lock-free. writer 가 쓰는 중이면 다시 읽는다
+    Snapshot Read() const;
+
+    std::string Report() const;
+
+    // ISR 을 지우기 전에 읽은 값. 다음 sample 의 isr 에 OR 된다
+    void Latch( int bus, uint32_t isr );
+
+private:
+    Monitor();
+    ~Monitor();
+    Monitor( const Monitor& ) = delete;
+    Monitor& operator=( const Monitor& ) = delete;
+
+    void Loop( SpiwriteProtocol::MemoryWriter* writer, Config config );
+    void Publish( const Snapshot& s );
+
+    std::thread thread_;
+    std::atomic<bool> running_ { false };
+    std::atomic<bool> stop_ { false };
+
+    // seqlock. snapshot 은 word 단위 atomic 으로 복사해서 읽기와 쓰기가 겹쳐도 data race 가 아니다
+    static constexpr size_t SNAPSHOT_WORDS = ( sizeof( Snapshot ) + 7 ) / 8;
+    std::atomic<uint64_t> seq_ { 0 };   // 홀수 = 쓰는 중
+    std::atomic<uint64_t> snapshot_[SNAPSHOT_WORDS] {};
+
+    std::atomic<uint32_t> latched_[Snapshot::MAX_BUS] {};
+};
+
+// beam 경로에서 inline health read 를 건너뛸지
+inline bool Active()
+{
+    return Monitor::Instance().Running();
+}
+
+// bus FIFO ISR 을 읽고 monitor 가 돌고 있으면 넘긴다. 0xffffffff 로 지우기 직전에 부를 것
+uint32_t LatchIsr( SpiwriteProtocol::MemoryWriter& writer, int bus, uintptr_t base );
+
+
+}
+}
+
+#endif
@@ -0,0 +1,434 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <set>
+#include <tuple>
+#include "string_util.hpp"
+#include "PanelLayout.h"
+
+namespace SpiBeam {
+namespace Layout {
+
+namespace {
+
+std::string Trim( const std::string& s )
+{
+    size_t b = s.find_first_not_of( " \t\r\n" );
+    if( b == std::string::npos ) return "";
+    size_t e = s.find_last_not_of( " \t\r\n" );
+    return s.substr( b, e - b + 1 );
+}
+
+bool ParseInts( const std::string& value, std::vector<long long>& out )
+{
+    out.clear();
+    std::istringstream ss( value );
+    std::string tok;
+    while( ss >> tok )
+    {
+        char* end = nullptr;
+        long long v = strtoll( tok.c_str(), &end, 0 );
+        if( end == tok.c_str() || *end != '\0' ) return false;
+        out.push_back( v );
+    }
+    return !out.empty();
+}
+
+bool ParseFloats( const std::string& value, std::vector<float>& out )
+{
+    out.clear();
+    std::istringstream ss( value );
+    std::string tok;
+    while( ss >> tok )
+    {
+        char* end = nullptr;
+        float v = strtof( tok.c_str(), &end );
+        if( end == tok.c_str() || *end != '\0' ) return false;
+        out.push_back( v );
+    }
+    return !out.empty();
+}
+
+bool Apply( Spec& spec, const std::string& key, const std::string& value, std::string& err )
+{
+    std::vector<long long> n;
+    std::vector<float> f;
+
+    auto ints = [&]( size_t count ) -> bool
+    {
+        if( !ParseInts( value, n ) || ( count && n.size() != count ) )
+        {
+            err = Common::string_format( "%s : expected %zu integer(s)", key.c_str(), count );
+            return false;
+        }
+        return true;
+    };
+    auto list = [&]( std::vector<int>& dst ) -> bool
+    {
+        if( !ints( 0 ) ) return false;
+        dst.assign( n.begin(), n.end() );
+        return true;
+    };
+
+    if( key == "name" ) { spec.name = value; return true; }
+    if( key == "tile" )
+    {
+        if( !ints( 2 ) ) return false;
+        spec.tile_rows = (int)n[0];
+        spec.tile_cols = (int)n[1];
+        return true;
+    }
+    if( key == "tiles" )
+    {
+        if( !ints( 2 ) ) return false;
+        spec.tiles_y = (int)n[0];
+        spec.tiles_x = (int)n[1];
+        return true;
+    }
+    if( key == "pitch" )
+    {
+        if( !ParseFloats( value, f ) || f.size() != 2 )
+        {
+            err = "pitch : expected dx dy";
+            return false;
+        }
+        spec.dx = f[0];
+        spec.dy = f[1];
+        return true;
+    }
+    if( key == "bus_cols" )      { if( !ints( 1 ) ) return false; spec.bus_cols = (int)n[0]; return true; }
+    if( key == "rows_per_chip" ) { if( !ints( 1 ) ) return false; spec.rows_per_chip = (int)n[0]; return true; }
+    if( key == "fifo_base" )     { if( !ints( 1 ) ) return false; spec.fifo_base = (uintptr_t)n[0]; return true; }
+    if( key == "fifo_stride" )   { if( !ints( 1 ) ) return false; spec.fifo_stride = (uintptr_t)n[0]; return true; }
+    if( key == "bus_order" )
+    {
+        if( value != "reverse" && value != "forward" )
+        {
+            err = "bus_order : reverse | forward";
+            return false;
+        }
+        spec.bus_reverse = value == "reverse";
+        return true;
+    }
+    if( key == "chip_base" )    return list( spec.chip_base );
+    if( key == "channel_even" ) return list( spec.channel_even );
+    if( key == "channel_odd" )  return list( spec.channel_odd );
+    if( key == "poles" )
+    {
+        if( !ints( 4 ) ) return false;
+        spec.poles.assign( n.begin(), n.end() );
+        return true;
+    }
+
+    err = "unknown key " + key;
+    return false;
+}
+
+}
+
+Spec DefaultSpec( int is_tx )
+{
+    Spec spec;
+    if( is_tx == 1 )
+    {
+        spec.name = "tx_32x32";
+        spec.dx = spec.dy = 5.0f;
+        spec.channel_even = { 0x27, 0x3F, 0x47, 0x5F }; // 짝수 col
+        spec.channel_odd  = { 0x5F, 0x47, 0x3F, 0x27 }; // 홀수 col
+    }
+    else
+    {
+        spec.name = "rx_32x32";
+        spec.dx = spec.dy = 7.5f;
+        spec.channel_even = { 0x22, 0x3A, 0x42, 0x5A }; // 짝수 col
+        spec.channel_odd  = { 0x5A, 0x42, 0x3A, 0x22 }; // 홀수 col
+    }
+    return spec;
+}
+
+bool ParseSpecs( const std::string& text, Spec& tx, Spec& rx, std::string* err )
+{
+    std::istringstream in( text );
+    std::string line;
+    int line_no = 0;
+    int section = -1;   // -1 : 둘 다, 1 : tx, 0 : rx
+    std::string e;
+
+    while( std::getline( in, line ) )
+    {
+        line_no++;
+        auto hash = line.find( '#' );
+        if( hash != std::string::npos ) line.resize( hash );
+        line = Trim( line );
+        if( line.empty() ) continue;
+
+        if( line == "[tx]" ) { section = 1; continue; }
+        if( line == "[rx]" ) { section = 0; continue; }
+
+        auto eq = line.find( '=' );
+        if( eq == std::string::npos )
+        {
+            e = "expected key = value";
+        }
+        else
+        {
+            std::string key = Trim( line.substr( 0, eq ) );
+            std::string value = Trim( line.substr( eq + 1 ) );
+            bool ok = true;
+            if( section != 0 ) ok = Apply( tx, key, value, e );
+            if( ok && section != 1 ) ok = Apply( rx, key, value, e );
+            if( ok ) continue;
+        }
+
+        if( err ) *err = Common::string_format( "line %d : %s", line_no, e.c_str() );
+        return false;
+    }
+    return true;
+}
+
+Compiled Compile( const Spec& spec )
+{
+    auto fail = [&spec]( const std::string& what )
+    {
+        return std::runtime_error( Common::string_format( "layout %s : %s", spec.name.c_str(), what.c_str() ) );
+    };
+
+    if( spec.tile_rows <= 0 || spec.tile_cols <= 0 || spec.tiles_y <= 0 || spec.tiles_x <= 0 )
+        throw fail( "tile size must be positive" );
+    if( spec.bus_cols <= 0 || spec.tile_cols % spec.bus_cols != 0 )
+        throw fail( "tile cols must be a multiple of bus_cols" );
+    if( spec.rows_per_chip <= 0 || (int)spec.chip_base.size() != spec.bus_cols )
+        throw fail( "chip_base needs one entry per bus column" );
+    if( spec.channel_even.empty() || spec.channel_odd.empty() || spec.poles.size() != 4 )
+        throw fail( "channel_even / channel_odd / poles missing" );
+    if( spec.NumBus() > MAX_BUS )
+        throw fail( Common::string_format( "%d buses, the 32 bit send register (0x43c00014) triggers at most %d", spec.NumBus(), MAX_BUS ) );
+
+    const int rows = spec.Rows();
+    const int cols = spec.Cols();
+    const int bus_per_tile = spec.tile_cols / spec.bus_cols;
+    const size_t n = (size_t)rows * cols;
+
+    struct Item
+    {
+        int bus, chip, channel;
+        uint32_t element;
+    };
+    std::vector<Item> items;
+    items.reserve( n );
+
+    for( int row = 0; row < rows; ++row )
+    {
+        for( int col = 0; col < cols; ++col )
+        {
+            int r = row % spec.tile_rows;
+            int c = col % spec.tile_cols;
+            int tile = ( row / spec.tile_rows ) * spec.tiles_x + col / spec.tile_cols;
+
+            int local_bus = c / spec.bus_cols;
+            if( spec.bus_reverse ) local_bus = bus_per_tile - 1 - local_bus;
+
+            auto& pattern = ( c % 2 == 0 ) ? spec.channel_even : spec.channel_odd;
+
+            Item it;
+            it.bus = tile * bus_per_tile + local_bus;
+            it.chip = spec.chip_base[c % spec.bus_cols] + r / spec.rows_per_chip;
+            it.channel = pattern[r % pattern.size()];
+            it.element = (uint32_t)( row * cols + col );
+
+            if( it.chip < 0 || it.chip > 0xFF || it.channel < 0 || it.channel > 0xFF )
+                throw fail( Common::string_format( "row %d col %d : chip 0x%x / channel 0x%x out of range", row, col, it.chip, it.channel ) );
+            items.push_back( it );
+        }
+    }
+
+    // FIFO 에 쓰는 순서
+    std::sort( items.begin(), items.end(), []( const Item& a, const Item& b ) {
+        return std::tie( a.bus, a.chip, a.channel ) < std::tie( b.bus, b.chip, b.channel );
+    });
+
+    Compiled L;
+    L.name = spec.name;
+    L.rows = rows;
+    L.cols = cols;
+    L.num_bus = spec.NumBus();
+    L.dx = spec.dx;
+    L.dy = spec.dy;
+    L.fifo_base = spec.fifo_base;
+    L.fifo_stride = spec.fifo_stride;
+
+    L.x.resize( n );
+    L.y.resize( n );
+    L.poles.resize( n );
+    L.gx.resize( n );
+    L.gy.resize( n );
+    L.pole_turns.resize( n );
+    L.bus.resize( n );
+    L.chip.resize( n );
+    L.channel.resize( n );
+    L.element.resize( n );
+    L.bus_begin.assign( L.num_bus + 1, 0 );
+
+    for( size_t k = 0; k < n; k++ )
+    {
+        const Item& it = items[k];
+        if( k > 0 && it.bus == items[k - 1].bus && it.chip == items[k - 1].chip && it.channel == items[k - 1].channel )
+            throw fail( Common::string_format( "bus %d chip 0x%x channel 0x%x used twice", it.bus, it.chip, it.channel ) );
+
+        int row = it.element / cols;
+        int col = it.element % cols;
+        L.x[k] = col * spec.dx;
+        L.y[k] = row * spec.dy;
+        L.poles[k] = (int16_t)spec.poles[( row % 2 ) * 2 + ( col % 2 )];
+        L.gx[k] = col;
+        L.gy[k] = row;
+        L.pole_turns[k] = (uint32_t)(int64_t)std::llround( std::ldexp( L.poles[k] / 360.0, 32 ) );
+        L.bus[k] = (uint16_t)it.bus;
+        L.chip[k] = (uint8_t)it.chip;
+        L.channel[k] = (uint8_t)it.channel;
+        L.element[k] = it.element;
+        L.bus_begin[it.bus + 1]++;
+    }
+    std::partial_sum( L.bus_begin.begin(), L.bus_begin.end(), L.bus_begin.begin() );
+
+    return L;
+}
+
+Registry& Registry::Instance()
+{
+    static Registry registry;
+    return registry;
+}
+
+Registry::Registry()
+{
+    layouts_[0] = std::make_shared<const Compiled>( Compile( DefaultSpec( 0 ) ) );
+    layouts_[1] = std::make_shared<const Compiled>( Compile( DefaultSpec( 1 ) ) );
+    PublishFifo();
+
+    const char* env = getenv( "SPIBEAM_LAYOUT" );
+    if( env && *env )
+    {
+        std::string err;
+        if( !Load( env, &err ) )
+            printf( ";layout %s ignored : %s\n", env, err.c_str() );
+    }
+}
+
+std::shared_ptr<const Compiled> Registry::Get( int is_tx ) const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return layouts_[is_tx == 1 ? 1 : 0];
+}
+
+bool Registry::Load( const std::string& path, std::string* err )
+{
+    std::ifstream in( path );
+    if( !in )
+    {
+        if( err ) *err = "cannot open " + path;
+        return false;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+
+    Spec tx = DefaultSpec( 1 );
+    Spec rx = DefaultSpec( 0 );
+    if( !ParseSpecs( ss.str(), tx, rx, err ) ) return false;
+
+    try
+    {
+        auto ctx = std::make_shared<const Compiled>( Compile( tx ) );
+        auto crx = std::make_shared<const Compiled>( Compile( rx ) );
+
+        std::lock_guard<std::mutex> lock( mutex_ );
+        if( !InWindow( *ctx, err ) || !InWindow( *crx, err ) ) return false;
+        layouts_[1] = ctx;
+        layouts_[0] = crx;
+        PublishFifo();
+    }
+    catch( const std::exception& e )
+    {
+        if( err ) *err = e.what();
+        return false;
+    }
+    return true;
+}
+
+void Registry::Set( int is_tx, const Spec& spec )
+{
+    auto compiled = std::make_shared<const Compiled>( Compile( spec ) );
+    std::lock_guard<std::mutex> lock( mutex_ );
+    std::string err;
+    if( !InWindow( *compiled, &err ) ) throw std::runtime_error( err );
+    layouts_[is_tx == 1 ? 1 : 0] = compiled;
+    PublishFifo();
+}
+
+void Registry::PublishFifo()
+{
+    auto map = std::make_unique<FifoMap>();
+    for( int is_tx = 0; is_tx < 2; is_tx++ )
+    {
+        const Compiled& L = *layouts_[is_tx];
+        map->range[is_tx] = { L.fifo_base, L.fifo_stride, L.num_bus };
+    }
+    fifo_.store( map.get(), std::memory_order_release );
+    fifo_maps_.push_back( std::move( map ) );
+}
+
+void Registry::SetAddressWindow( uintptr_t base, size_t size )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    window_base_ = base;
+    window_size_ = size;
+}
+
+bool Registry::InWindow( const Compiled& L, std::string* err ) const
+{
+    // 이미 만든 mapping 은 그대로이므로 그 밖의 register 를 쓰는 layout 은 받지 않는다
+    if( window_size_ == 0 ) return true;
+    if( L.fifo_base >= window_base_ && L.FifoAddress( L.num_bus ) <= window_base_ + window_size_ ) return true;
+
+    if( err ) *err = Common::string_format( "%s : fifo 0x%08lx ~ 0x%08lx (%d buses) is outside the register mapping 0x%08lx ~ 0x%08lx",
+        L.name.c_str(), (unsigned long)L.fifo_base, (unsigned long)L.FifoAddress( L.num_bus ), L.num_bus,
+        (unsigned long)window_base_, (unsigned long)( window_base_ + window_size_ ) );
+    return false;
+}
+
+size_t Registry::AddressSpan( uintptr_t base ) const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    size_t span = 0;
+    for( auto& L : layouts_ )
+    {
+        uintptr_t end = L->FifoAddress( L->num_bus );
+        if( end > base ) span = std::max( span, (size_t)( end - base ) );
+    }
+    return span;
+}
+
+std::string Registry::Report() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    std::string rep;
+    for( int is_tx = 1; is_tx >= 0; is_tx-- )
+    {
+        auto& L = layouts_[is_tx];
+        if( !rep.empty() ) rep += "\r\n";
+        rep += Common::string_format( "%s : %s %dx%d, %zu elements, %d buses, pitch %.2fx%.2f mm, fifo 0x%08lx+%lx",
+            is_tx ? "tx" : "rx", L->name.c_str(), L->rows, L->cols, L->Size(), L->num_bus, L->dx, L->dy,
+            (unsigned long)L->fifo_base, (unsigned long)L->fifo_stride );
+    }
+    return rep;
+}
+
+
+}
+}
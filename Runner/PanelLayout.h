@@ -0,0 +1,183 @@
+#ifndef __SPIBEAM_PANEL_LAYOUT_H__
+#define __SPIBEAM_PANEL_LAYOUT_H__
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace SpiBeam {
+namespace Layout {
+
+// send register (0x43c00014) 가 32 bit 라 한 번에 trigger 할 수 있는 bus 수
+constexpr int MAX_BUS = 32;
+
+// panel 구성 기술. 기본값은 32x32 tile 하나, bus 8 개 (기존 hard-coded 배치와 동일)
+//
+// layout file (key = value, '#' 주석, [tx] / [rx] section) 예:
+//   [tx]
+//   name          = tx_2x2
+//   tile          = 32 32            # tile 하나의 rows cols
+//   tiles         = 2 2              # tile 배치 rows cols
+//   pitch         = 5.0 5.0          # dx dy [mm]
+//   bus_cols      = 4                # bus 하나가 맡는 element column 수
+//   bus_order     = reverse          # tile 안 bus 번호 : reverse (7 - col/4) | forward
+//   rows_per_chip = 2
+//   chip_base     = 16 16 0 0        # (col % bus_cols) 별 chip 시작 번호
+//   channel_even  = 0x27 0x3F 0x47 0x5F   # 짝수 col, row % n
+//   channel_odd   = 0x5F 0x47 0x3F 0x27   # 홀수 col, row % n
+//   poles         = 120 30 210 300   # (row%2, col%2) = (0,0) (0,1) (1,0) (1,1)
+//   fifo_base     = 0x43c40000
+//   fifo_stride   = 0x10000
+//
+// bus 번호는 tile 순서 (tile row 우선) 로 이어진다 : bus = tile * (tile cols / bus_cols) + local bus
+struct Spec
+{
+    std::string name;
+    int tile_rows = 32;
+    int tile_cols = 32;
+    int tiles_y = 1;
+    int tiles_x = 1;
+    float dx = 5.0f;
+    float dy = 5.0f;
+    int bus_cols = 4;
+    bool bus_reverse = true;
+    int rows_per_chip = 2;
+    std::vector<int> chip_base { 16, 16, 0, 0 };
+    std::vector<int> channel_even;
+    std::vector<int> channel_odd;
+    std::vector<int> poles { 120, 30, 210, 300 };
+    uintptr_t fifo_base = 0x43c40000;
+    uintptr_t fifo_stride = 0x10000;
+
+    int Rows() const { return tile_rows * tiles_y; }
+    int Cols() const { return tile_cols * tiles_x; }
+    int NumBus() const { return tiles_y * tiles_x * ( tile_cols / bus_cols ); }
+};
+
+// tx : 29.5GHz 5mm / rx : 19.7GHz 7.5mm, 32x32
+Spec DefaultSpec( int is_tx );
+
+// text 를 읽어 tx/rx spec 을 갱신. section 이 없으면 두 spec 모두에 적용
+bool ParseSpecs( const std::string& text, Spec& tx, Spec& rx, std::string* err = nullptr );
+
+// phase 계산과 packing 이 그대로 훑는 flat table.
+// element 는 (bus, chip, channel) 순으로 정렬되어 있고 bus_begin[b] ~ bus_begin[b+1] 이 bus b
+struct Compiled
+{
+    std::string name;
+    int rows = 0;
+    int cols = 0;
+    int num_bus = 0;
+    float dx = 0;
+    float dy = 0;
+    uintptr_t fifo_base = 0;
+    uintptr_t fifo_stride = 0;
+
+    std::vector<float>    x;        // mm
+    std::vector<float>    y;
+    std::vector<int16_t>  poles;    // degree
+    std::vector<int32_t>  gx;       // col (x = gx * dx)
+    std::vector<int32_t>  gy;       // row (y = gy * dy)
+    std::vector<uint32_t> pole_turns;   // poles / 360 * 2^32
+    std::vector<uint16_t> bus;
+    std::vector<uint8_t>  chip;
+    std::vector<uint8_t>  channel;
+    std::vector<uint32_t> element;  // row * cols + col
+    std::vector<uint32_t> bus_begin;
+
+    size_t Size() const { return x.size(); }
+    size_t BusSize( int b ) const { return bus_begin[b + 1] - bus_begin[b]; }
+    uintptr_t FifoAddress( int b ) const { return fifo_base + (uintptr_t)b * fifo_stride; }
+    // address 가 이 layout 의 FIFO register 이면 bus 번호 (reg 에 bus 안 offset), 아니면 -1
+    int FifoBus( uintptr_t address, uint32_t& reg ) const
+    {
+        if( address < fifo_base || fifo_stride == 0 ) return -1;
+        uintptr_t b = ( address - fifo_base ) / fifo_stride;
+        if( b >= (uintptr_t)num_bus ) return -1;
+        reg = (uint32_t)( ( address - fifo_base ) % fifo_stride );
+        return (int)b;
+    }
+    // send register (0x43c00014) 에 쓰는 전체 bus mask
+    uint32_t SendMask() const { return num_bus >= MAX_BUS ? 0xffffffff : ( 1u << num_bus ) - 1; }
+};
+
+// 두 layout 의 FIFO register 범위만 모아 둔 불변 table. write 마다 쓰는 bus decode 용 (lock / shared_ptr 복사 없음)
+struct FifoMap
+{
+    struct Range
+    {
+        uintptr_t base = 0;
+        uintptr_t stride = 0;
+        int num_bus = 0;
+    };
+    Range range[2];     // [is_tx]
+
+    // tx 먼저. FIFO register 이면 bus 번호 (reg 에 bus 안 offset, is_tx 에 어느 layout), 아니면 -1
+    int Decode( uintptr_t address, uint32_t& reg, int* is_tx = nullptr ) const
+    {
+        for( int t = 1; t >= 0; t-- )
+        {
+            const Range& r = range[t];
+            if( address < r.base || r.stride == 0 ) continue;
+            uintptr_t b = ( address - r.base ) / r.stride;
+            if( b >= (uintptr_t)r.num_bus ) continue;
+            reg = (uint32_t)( ( address - r.base ) % r.stride );
+            if( is_tx ) *is_tx = t;
+            return (int)b;
+        }
+        return -1;
+    }
+};
+
+// 잘못된 spec (chip/channel 중복, 범위 초과, bus 가 MAX_BUS 보다 많음 등) 이면 std::runtime_error
+Compiled Compile( const Spec& spec );
+
+// process 전체에서 쓰는 tx/rx layout.
+// 처음 사용할 때 $SPIBEAM_LAYOUT 이 있으면 그 파일을, 없으면 DefaultSpec 을 compile 한다.
+class Registry
+{
+public:
+    static Registry& Instance();
+
+    std::shared_ptr<const Compiled> Get( int is_tx ) const;
+
+    // 지금 layout 의 FIFO 범위. lock 없이 읽고, Load / Set 이 새 table 로 바꾼다 (이전 table 은 계속 유효)
+    const FifoMap& Fifo() const { return *fifo_.load( std::memory_order_acquire ); }
+
+    // FIFO register 가 address window 밖으로 나가는 layout 은 Load 에서 false, Set 에서 std::runtime_error
+    bool Load( const std::string& path, std::string* err = nullptr );
+    void Set( int is_tx, const Spec& spec );
+
+    // base 부터 두 layout 의 FIFO register 를 모두 덮는 크기
+    size_t AddressSpan( uintptr_t base ) const;
+
+    // register mapping 이 덮는 범위 (HardwareContext 가 mapping 크기를 정할 때 설정). size 0 이면 검사하지 않는다
+    void SetAddressWindow( uintptr_t base, size_t size );
+
+    std::string Report() const;
+
+private:
+    Registry();
+
+    bool InWindow( const Compiled& L, std::string* err ) const;
+    // mutex_ 를 잡은 채로 layouts_ 가 바뀐 뒤에 부른다
+    void PublishFifo();
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<const Compiled> layouts_[2];
+    // 읽는 쪽이 참조를 들고 있을 수 있으므로 바뀐 table 은 지우지 않는다 (layout 교체는 드물다)
+    std::vector<std::unique_ptr<const FifoMap>> fifo_maps_;
+    std::atomic<const FifoMap*> fifo_ { nullptr };
+    uintptr_t window_base_ = 0;
+    size_t window_size_ = 0;
+};
+
+
+}
+}
+
+#endif
@@ -0,0 +1,151 @@
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "string_util.hpp"
+#include "PayloadCache.h"
+#include "PanelLayout.h"
+#include "SpiStats.h"
+
+namespace SpiBeam {
+namespace Cache {
+
+namespace {
+
+inline uint64_t Mix( uint64_t h )
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+}
+
+uint64_t Hash64( const uint8_t* data, size_t size )
+{
+    const uint64_t k = 0x9e3779b97f4a7c15ULL;
+    uint64_t h = size * k;
+
+    size_t i = 0;
+    for( ; i + 8 <= size; i += 8 )
+    {
+        uint64_t v;
+        memcpy( &v, data + i, 8 );
+        h = ( h ^ Mix( v ) ) * k;
+    }
+
+    uint64_t tail = 0;
+    for( size_t j = 0; i + j < size; j++ ) tail |= (uint64_t)data[i + j] << ( 8 * j );
+    return Mix( h ^ Mix( tail ) );
+}
+
+PayloadCache& PayloadCache::Instance()
+{
+    static PayloadCache cache;
+    return cache;
+}
+
+PayloadCache::PayloadCache()
+{
+    const char* env = getenv( "SPIBEAM_BINARY_CACHE" );
+    if( env && *env ) capacity_ = (size_t)std::clamp<long>( atol( env ), 0, (long)MAX_CAPACITY );
+
+    Stats::Registry::Instance().AddSection( "binary_cache", [this]
+    {
+        return Enabled() ? Report() : std::string();
+    });
+}
+
+bool PayloadCache::Enabled() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return capacity_ > 0;
+}
+
+std::shared_ptr<const PreparedBeam> PayloadCache::Find( uint64_t hash, const uint8_t* payload, size_t size )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    if( capacity_ == 0 ) return nullptr;
+
+    auto it = index_.find( hash );
+    if( it != index_.end() )
+    {
+        Entry& e = *it->second;
+        bool same = e.payload.size() == size && memcmp( e.payload.data(), payload, size ) == 0 &&
+                    e.beam->layout == Layout::Registry::Instance().Get( e.beam->is_tx );
+        if( same )
+        {
+            lru_.splice( lru_.begin(), lru_, it->second );
+            hits_++;
+            wire_bytes_saved_ += size;
+            decoded_bytes_saved_ += e.decoded_bytes;
+            Stats::Inc( Stats::Counter::CacheHits );
+            return e.beam;
+        }
+    }
+
+    misses_++;
+    Stats::Inc( Stats::Counter::CacheMisses );
+    return nullptr;
+}
+
+void PayloadCache::Insert( uint64_t hash, const uint8_t* payload, size_t size, size_t decoded_bytes, std::shared_ptr<const PreparedBeam> beam )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    if( capacity_ == 0 || !beam ) return;
+
+    // 같은 hash (다른 payload 나 옛 layout) 는 새 것으로 바꾼다
+    auto it = index_.find( hash );
+    if( it != index_.end() )
+    {
+        lru_.erase( it->second );
+        index_.erase( it );
+    }
+
+    lru_.push_front( Entry{ hash, std::vector<uint8_t>( payload, payload + size ), decoded_bytes, std::move( beam ) } );
+    index_[hash] = lru_.begin();
+    Trim();
+}
+
+void PayloadCache::Trim()
+{
+    while( lru_.size() > capacity_ )
+    {
+        index_.erase( lru_.back().hash );
+        lru_.pop_back();
+        evictions_++;
+    }
+}
+
+void PayloadCache::SetCapacity( size_t entries )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    capacity_ = std::min( entries, MAX_CAPACITY );
+    Trim();
+}
+
+void PayloadCache::Clear()
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    lru_.clear();
+    index_.clear();
+    hits_ = misses_ = evictions_ = 0;
+    wire_bytes_saved_ = decoded_bytes_saved_ = 0;
+}
+
+std::string PayloadCache::Report() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    uint64_t lookups = hits_ + misses_;
+    return Common::string_format( "binary cache : %zu / %zu entries, hits %llu, misses %llu (hit rate %.1f%%), evictions %llu"
+        "\r\n saved : %llu payload bytes, %llu decoded bytes not inflated / parsed",
+        lru_.size(), capacity_, (unsigned long long)hits_, (unsigned long long)misses_,
+        lookups ? 100.0 * hits_ / lookups : 0.0, (unsigned long long)evictions_,
+        (unsigned long long)wire_bytes_saved_, (unsigned long long)decoded_bytes_saved_ );
+}
+
+
+}
+}
@@ -0,0 +1,75 @@
+#ifndef __SPIBEAM_PAYLOAD_CACHE_H__
+#define __SPIBEAM_PAYLOAD_CACHE_H__
+
+#include <list>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include "BeamEngine.h"
+
+namespace SpiBeam {
+namespace Cache {
+
+// 비암호 64 bit hash (8 byte 단위 multiply-xorshift). payload 구분용
+uint64_t Hash64( const uint8_t* data, size_t size );
+
+// BINARY payload ("BINARY:" 뒤 byte 그대로, 압축 / compact 포함) -> bus 별 FIFO word.
+// 같은 payload 가 다시 오면 inflate / parse / pack 없이 바로 FIFO 에 쓴다.
+// hash 가 같아도 payload 를 비교해서 같을 때만 hit, layout 이 다시 읽히면 그 전 entry 는 miss.
+// 용량은 $SPIBEAM_BINARY_CACHE (entry 수, 기본 32, 0 이면 끔, 최대 MAX_CAPACITY), 넘으면 가장 오래 안 쓴 entry 를 버린다
+class PayloadCache
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 32;
+    // entry 하나가 payload + bus 별 FIFO word 라 수 KB. 원격 'cache size' 로도 이 이상은 잡지 않는다
+    static constexpr size_t MAX_CAPACITY = 4096;
+
+    static PayloadCache& Instance();
+
+    bool Enabled() const;
+
+    // 없으면 nullptr. 돌려준 beam 은 evict 되어도 쓰는 동안 유효
+    std::shared_ptr<const PreparedBeam> Find( uint64_t hash, const uint8_t* payload, size_t size );
+    // decoded_bytes : inflate 후 크기 (hit 때 절약한 byte 로 센다)
+    void Insert( uint64_t hash, const uint8_t* payload, size_t size, size_t decoded_bytes, std::shared_ptr<const PreparedBeam> beam );
+
+    // MAX_CAPACITY 보다 크면 MAX_CAPACITY
+    void SetCapacity( size_t entries );
+    void Clear();
+    std::string Report() const;
+
+private:
+    PayloadCache();
+    PayloadCache( const PayloadCache& ) = delete;
+    PayloadCache& operator=( const PayloadCache& ) = delete;
+
+    struct Entry
+    {
+        uint64_t hash;
+        std::vector<uint8_t> payload;
+        size_t decoded_bytes;
+        std::shared_ptr<const PreparedBeam> beam;
+    };
+
+    void Trim();
+
+    mutable std::mutex mutex_;
+    size_t capacity_ = DEFAULT_CAPACITY;
+    std::list<Entry> lru_;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+    uint64_t wire_bytes_saved_ = 0;     // hit 한 payload 크기 합
+    uint64_t decoded_bytes_saved_ = 0;  // hit 으로 inflate / parse 하지 않은 byte 합
+};
+
+
+}
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef __SPIBEAM_REGISTER_BACKEND_H__
+#define __SPIBEAM_REGISTER_BACKEND_H__
+
+#include <cstdint>
+
+namespace SpiBeam {
+namespace SpiwriteProtocol {
+
+// MemoryWriter 가 /dev/mem 대신 register access 를 넘기는 대상 (co-simulation 등)
+// 여러 MemoryWriter 가 공유할 수 있으므로 구현 쪽에서 동기화한다
+class RegisterBackend
+{
+public:
+    virtual ~RegisterBackend() {}
+
+    virtual bool Write( uintptr_t address, uint32_t value ) = 0;
+    virtual bool Read( uintptr_t address, uint32_t& value ) = 0;
+};
+
+
+}
+}
+
+#endif
@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <alloca.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include "string_util.hpp"
+#include "RtProfile.h"
+#include "BeamTrace.h"
+#include "SpiStats.h"
+#include "PanelLayout.h"
+#include "TrigTable.h"
+#include "HardwareArbiter.h"
+
+namespace SpiBeam {
+namespace Rt {
+
+namespace {
+
+thread_local bool t_entered = false;
+thread_local bool t_realtime = false;
+thread_local Role t_role = Role::Count;
+
+// RoleScope : 처음 들어갈 때의 설정을 두었다가 마지막 scope 가 끝나면 되돌린다
+thread_local int t_scope_depth = 0;
+thread_local bool t_saved_cpus_valid = false;
+thread_local cpu_set_t t_saved_cpus;
+thread_local int t_saved_policy = SCHED_OTHER;
+thread_local sched_param t_saved_param {};
+
+bool ParseCpus( const std::string& text, std::vector<int>& cpus )
+{
+    cpus.clear();
+    std::istringstream is( text );
+    std::string item;
+    while( std::getline( is, item, ',' ) )
+    {
+        char* end = nullptr;
+        long cpu = strtol( item.c_str(), &end, 10 );
+        if( item.empty() || *end != '\0' || cpu < 0 || cpu >= CPU_SETSIZE ) return false;
+        cpus.push_back( (int)cpu );
+    }
+    return true;
+}
+
+std::string CpuList( const std::vector<int>& cpus )
+{
+    if( cpus.empty() ) return "any";
+
+    std::string s;
+    for( int cpu : cpus ) s += ( s.empty() ? "" : "," ) + std::to_string( cpu );
+    return s;
+}
+
+// 새로 자라는 stack 이 hot path 에서 fault 나지 않도록 미리 써 둔다 (mlockall 뒤면 그대로 잠김)
+__attribute__((noinline)) void PrefaultStack( size_t bytes )
+{
+    volatile uint8_t* p = static_cast<volatile uint8_t*>( alloca( bytes ) );
+    size_t page_size = sysconf( _SC_PAGESIZE );
+    for( size_t off = 0; off < bytes; off += page_size ) p[off] = 0;
+}
+
+}
+
+const char* RoleName( Role r )
+{
+    switch( r )
+    {
+        case Role::Hardware: return "hardware";
+        case Role::Network:  return "network";
+        case Role::Array:    return "array";
+        default:             return "NA";
+    }
+}
+
+std::string Profile::Describe() const
+{
+    if( !enabled ) return "off";
+
+    return Common::string_format( "hw cpu %s prio %d, net cpu %s prio %d, array cpu %s prio %d, mlockall %s, heap %zu KB, stack %zu KB",
+        CpuList( hw_cpus ).c_str(), hw_priority, CpuList( net_cpus ).c_str(), net_priority,
+        CpuList( array_cpus ).c_str(), array_priority,
+        lock_memory ? "on" : "off", heap_kb, stack_kb );
+}
+
+bool ParseProfile( const std::string& text, Profile& profile, std::string* err )
+{
+    auto fail = [err]( const std::string& msg )
+    {
+        if( err ) *err = msg;
+        return false;
+    };
+
+    Profile p;
+    std::istringstream is( text );
+    std::string item;
+    while( is >> item )
+    {
+        if( item == "off" ) { profile = Profile(); return true; }
+        if( item == "on" ) continue;
+
+        auto eq = item.find( '=' );
+        if( eq == std::string::npos ) return fail( "expected key=value, got '" + item + "'" );
+        std::string key = item.substr( 0, eq );
+        std::string value = item.substr( eq + 1 );
+
+        char* end = nullptr;
+        long n = strtol( value.c_str(), &end, 10 );
+        bool numeric = !value.empty() && *end == '\0' && n >= 0;
+
+        if( key == "hw" || key == "net" || key == "array" )
+        {
+            auto& cpus = key == "hw" ? p.hw_cpus : key == "net" ? p.net_cpus : p.array_cpus;
+            if( !ParseCpus( value, cpus ) ) return fail( "bad cpu list '" + value + "'" );
+        }
+        else if( !numeric ) return fail( "bad value for " + key + " '" + value + "'" );
+        else if( key == "hw_prio" ) p.hw_priority = (int)n;
+        else if( key == "net_prio" ) p.net_priority = (int)n;
+        else if( key == "array_prio" ) p.array_priority = (int)n;
+        else if( key == "lock" ) p.lock_memory = n != 0;
+        else if( key == "heap_kb" ) p.heap_kb = (size_t)n;
+        else if( key == "stack_kb" ) p.stack_kb = (size_t)n;
+        else return fail( "unknown key '" + key + "'" );
+    }
+
+    p.enabled = true;
+    profile = p;
+    return true;
+}
+
+Runtime& Runtime::Instance()
+{
+    static Runtime runtime;
+    return runtime;
+}
+
+Runtime::Runtime()
+{
+    for( int i = 0; i < (int)Role::Count; i++ )
+    {
+        threads_[i] = 0;
+        realtime_threads_[i] = 0;
+        scopes_[i] = 0;
+    }
+
+    const char* env = getenv( "SPIBEAM_RT" );
+    if( env && *env )
+    {
+        std::string err;
+        if( !ParseProfile( env, profile_, &err ) )
+            printf( ";SPIBEAM_RT ignored : %s\n", err.c_str() );
+    }
+    enabled_ = profile_.enabled;
+
+    Stats::Registry::Instance().AddSection( "rt", [this]
+    {
+        return Enabled() ? Report() : std::string();
+    });
+}
+
+Profile Runtime::Get() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return profile_;
+}
+
+void Runtime::Note( const std::string& msg )
+{
+    // RoleScope 는 beam 마다 다시 적용하므로 같은 실패는 한 번만
+    if( std::find( notes_.begin(), notes_.end(), msg ) != notes_.end() ) return;
+    notes_.push_back( msg );
+    printf( ";rt : %s\n", msg.c_str() );
+}
+
+bool Runtime::Setup( SpiwriteProtocol::MemoryWriter& writer )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    if( !profile_.enabled || setup_done_ ) return setup_done_;
+    setup_done_ = true;
+
+    // free 한 heap 을 OS 에 돌려주지 않고, 큰 할당도 mmap 대신 (이미 잠긴) heap 에서
+    mallopt( M_TRIM_THRESHOLD, -1 );
+    mallopt( M_MMAP_MAX, 0 );
+
+    if( profile_.lock_memory )
+    {
+        locked_ = mlockall( MCL_CURRENT | MCL_FUTURE ) == 0;
+        if( !locked_ ) Note( std::string( "mlockall failed : " ) + strerror( errno ) );
+    }
+
+    if( profile_.heap_kb > 0 )
+    {
+        size_t bytes = profile_.heap_kb * 1024;
+        size_t page_size = sysconf( _SC_PAGESIZE );
+        volatile uint8_t* p = static_cast<volatile uint8_t*>( malloc( bytes ) );
+        if( p )
+        {
+            for( size_t off = 0; off < bytes; off += page_size ) p[off] = 0;
+            free( (void*)p );
+        }
+    }
+
+    if( !writer.prefault() ) Note( "register mapping prefault failed" );
+
+    // 처음 부를 때 만들어지는 것들을 beam 전에 만들어 둔다
+    Trace::Tracer::Instance();
+    HardwareArbiter::Instance();
+    Layout::Registry::Instance().Get( 0 );
+    Layout::Registry::Instance().Get( 1 );
+    Trig::SinQ( 0 );
+
+    Trace::Tracer::EnableResourceUsage( true );
+    return true;
+}
+
+bool Runtime::EnterThread( Role role, int priority )
+{
+    if( !Enabled() ) return false;
+    if( t_entered ) return t_realtime;
+    t_entered = true;
+    t_role = role;
+
+    Profile p = Get();
+    t_realtime = ApplyRole( role, priority );
+    if( p.stack_kb > 0 ) PrefaultStack( p.stack_kb * 1024 );
+
+    threads_[(int)role]++;
+    if( t_realtime ) realtime_threads_[(int)role]++;
+    return t_realtime;
+}
+
+bool Runtime::EnterScope( Role role )
+{
+    if( !Enabled() ) return false;
+    if( t_entered && t_role == role ) return false;
+    if( t_scope_depth++ > 0 ) return true;
+
+    t_saved_cpus_valid = pthread_getaffinity_np( pthread_self(), sizeof(t_saved_cpus), &t_saved_cpus ) == 0;
+    if( pthread_getschedparam( pthread_self(), &t_saved_policy, &t_saved_param ) != 0 )
+    {
+        t_saved_policy = SCHED_OTHER;
+        t_saved_param = sched_param {};
+    }
+
+    ApplyRole( role, 0 );
+    scopes_[(int)role]++;
+    return true;
+}
+
+void Runtime::LeaveScope()
+{
+    if( t_scope_depth == 0 || --t_scope_depth > 0 ) return;
+
+    if( t_saved_cpus_valid ) pthread_setaffinity_np( pthread_self(), sizeof(t_saved_cpus), &t_saved_cpus );
+    pthread_setschedparam( pthread_self(), t_saved_policy, &t_saved_param );
+}
+
+bool Runtime::ApplyRole( Role role, int priority )
+{
+    Profile p = Get();
+    const std::vector<int>& cpus = role == Role::Network ? p.net_cpus : role == Role::Array ? p.array_cpus : p.hw_cpus;
+    if( priority <= 0 ) priority = role == Role::Network ? p.net_priority : role == Role::Array ? p.array_priority : p.hw_priority;
+
+    if( !cpus.empty() )
+    {
+        cpu_set_t set;
+        CPU_ZERO( &set );
+        for( int cpu : cpus ) CPU_SET( cpu, &set );
+        if( int rc = pthread_setaffinity_np( pthread_self(), sizeof(set), &set ); rc != 0 )
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            Note( Common::string_format( "%s thread affinity (%s) failed : %s", RoleName( role ), CpuList( cpus ).c_str(), strerror( rc ) ) );
+        }
+    }
+
+    bool realtime = false;
+    if( priority > 0 )
+    {
+        sched_param sp {};
+        sp.sched_priority = std::min( priority, sched_get_priority_max( SCHED_FIFO ) );
+        int rc = pthread_setschedparam( pthread_self(), SCHED_FIFO, &sp );
+        realtime = rc == 0;
+        if( rc != 0 )
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            Note( Common::string_format( "%s thread SCHED_FIFO %d failed : %s", RoleName( role ), priority, strerror( rc ) ) );
+        }
+    }
+    return realtime;
+}
+
+std::string Runtime::Report() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    if( !profile_.enabled ) return "rt : off";
+
+    std::string rep = "rt : " + profile_.Describe();
+    rep += Common::string_format( "\r\n setup %s, memory %s",
+        setup_done_ ? "done" : "pending", locked_ ? "locked" : "not locked" );
+
+    for( int i = 0; i < (int)Role::Count; i++ )
+    {
+        rep += Common::string_format( "\r\n %-8s threads %llu (SCHED_FIFO %llu), scoped %llu", RoleName( (Role)i ),
+            (unsigned long long)threads_[i].load(), (unsigned long long)realtime_threads_[i].load(),
+            (unsigned long long)scopes_[i].load() );
+    }
+
+    auto& faults = Trace::Tracer::Instance().PageFaults();
+    auto& switches = Trace::Tracer::Instance().ContextSwitches();
+    if( faults.Count() > 0 )
+    {
+        rep += Common::string_format( "\r\n per beam (n=%llu) : page faults mean %.2f p99 %llu max %llu, context switches mean %.2f p99 %llu max %llu",
+            (unsigned long long)faults.Count(),
+            faults.Mean(), (unsigned long long)faults.Percentile( 99.0 ), (unsigned long long)faults.Max(),
+            switches.Mean(), (unsigned long long)switches.Percentile( 99.0 ), (unsigned long long)switches.Max() );
+    }
+
+    rusage ru;
+    if( getrusage( RUSAGE_SELF, &ru ) == 0 )
+    {
+        rep += Common::string_format( "\r\n process : minor faults %ld, major faults %ld, voluntary switches %ld, involuntary switches %ld",
+            ru.ru_minflt, ru.ru_majflt, ru.ru_nvcsw, ru.ru_nivcsw );
+    }
+
+    for( auto& n : notes_ ) rep += "\r\n " + n;
+    return rep;
+}
+
+
+}
+}
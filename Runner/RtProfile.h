@@ -0,0 +1,110 @@
+#ifndef __SPIBEAM_RT_PROFILE_H__
+#define __SPIBEAM_RT_PROFILE_H__
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "SpiwriteCommand.h"
+
+namespace SpiBeam {
+namespace Rt {
+
+enum class Role
+{
+    Hardware,   // register 를 쓰는 thread : console, scan
+    Network,    // spiterm UDP 수신 thread
+    Array,      // ArrayExecutor worker (panel 마다 동시에 돌아야 하므로 hw cpu 와 따로 둔다)
+
+    Count
+};
+
+const char* RoleName( Role r );
+
+// 실시간 실행 설정. enabled 가 아니면 아무것도 바꾸지 않는다 (기존 동작 그대로)
+struct Profile
+{
+    bool enabled = false;
+    std::vector<int> hw_cpus;       // 비어 있으면 affinity 그대로
+    std::vector<int> net_cpus;
+    std::vector<int> array_cpus;
+    int hw_priority = 80;           // SCHED_FIFO priority, 0 이면 기본 scheduler
+    int net_priority = 70;
+    int array_priority = 0;         // worker 끼리 한 cpu 에서 서로 막지 않도록 기본은 SCHED_FIFO 없음
+    bool lock_memory = true;        // mlockall( MCL_CURRENT | MCL_FUTURE )
+    size_t heap_kb = 8192;          // 시작할 때 미리 잡아 두는 heap (free 해도 process 에 남는다)
+    size_t stack_kb = 256;          // thread 마다 미리 touch 하는 stack
+
+    std::string Describe() const;
+};
+
+// "hw=2,3 net=1 array=4,5 hw_prio=80 net_prio=70 array_prio=0 lock=1 heap_kb=8192 stack_kb=256" (순서 무관, 빠진 항목은 기본값)
+// "off" 면 enabled = false
+bool ParseProfile( const std::string& text, Profile& profile, std::string* err = nullptr );
+
+// process 에 하나. 환경 변수 SPIBEAM_RT 가 있으면 그 profile 로 켜진다
+class Runtime
+{
+public:
+    static Runtime& Instance();
+
+    bool Enabled() const { return enabled_.load( std::memory_order_relaxed ); }
+    Profile Get() const;
+
+    // process 단위로 한 번 : mlockall, malloc 설정 + heap prefault, register mapping prefault,
+    // hot path 가 처음 쓰는 singleton / table 초기화, beam 당 rusage 기록 시작
+    bool Setup( SpiwriteProtocol::MemoryWriter& writer );
+
+    // 호출한 thread 를 role 에 맞춘다 (affinity, SCHED_FIFO, stack prefault). thread 마다 처음 한 번만 실제로 적용
+    // priority > 0 이면 profile 대신 그 값. 실시간 priority 가 적용됐으면 true
+    bool EnterThread( Role role, int priority = 0 );
+
+    // RoleScope 용. EnterScope 가 true 면 같은 thread 에서 LeaveScope 를 한 번
+    bool EnterScope( Role role );
+    void LeaveScope();
+
+    std::string Report() const;
+
+private:
+    Runtime();
+    Runtime( const Runtime& ) = delete;
+    Runtime& operator=( const Runtime& ) = delete;
+
+    void Note( const std::string& msg );
+    // affinity / SCHED_FIFO 만 적용. 실시간 priority 가 적용됐으면 true
+    bool ApplyRole( Role role, int priority );
+
+    mutable std::mutex mutex_;
+    Profile profile_;
+    std::atomic<bool> enabled_ { false };
+    bool setup_done_ = false;
+    bool locked_ = false;
+    std::vector<std::string> notes_;    // 적용 실패 등 (권한 부족 ...)
+
+    std::atomic<uint64_t> threads_[(int)Role::Count];
+    std::atomic<uint64_t> realtime_threads_[(int)Role::Count];
+    std::atomic<uint64_t> scopes_[(int)Role::Count];
+};
+
+// 호출한 thread 를 잠시 role 의 cpu / priority 로 올렸다가 소멸할 때 원래 설정으로 되돌린다.
+// 보통 thread 인 spiterm session worker 가 원격 Lease 를 든 동안만 hardware 로 돌게 할 때 쓴다.
+// EnterThread 로 이미 그 role 인 thread 에서는 아무것도 하지 않고, 겹치면 (소멸 순서와 무관하게) 바깥 하나로 센다
+class RoleScope
+{
+public:
+    explicit RoleScope( Role role ) : entered_( Runtime::Instance().EnterScope( role ) ) {}
+    ~RoleScope() { if( entered_ ) Runtime::Instance().LeaveScope(); }
+
+    RoleScope( const RoleScope& ) = delete;
+    RoleScope& operator=( const RoleScope& ) = delete;
+
+private:
+    bool entered_;
+};
+
+
+}
+}
+
+#endif
@@ -0,0 +1,500 @@
+#include <cmath>
+#include <ctime>
+#include <cerrno>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <sstream>
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+#include "string_util.hpp"
+#include "ScanEngine.h"
+#include "BeamEngine.h"
+#include "BeamPipeline.h"
+#include "BeamTrace.h"
+#include "SpiTimingModel.h"
+#include "HardwareArbiter.h"
+#include "RtProfile.h"
+
+namespace SpiBeam {
+namespace Scan {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+constexpr size_t MAX_POINTS = 1000000;
+constexpr size_t CODEBOOK_BYTES = 64u << 20;   // 1024 element 기준 약 10000 beam
+constexpr uint64_t SPIN_NS = 100000;           // 마지막 100us 는 sleep 대신 spin (wakeup 지연 제거)
+
+const char* PatternName( Pattern p )
+{
+    switch( p )
+    {
+    case Pattern::Raster:  return "raster";
+    case Pattern::Spiral:  return "spiral";
+    case Pattern::Conical: return "conical";
+    }
+    return "?";
+}
+
+bool SetRealtime( int priority )
+{
+    if( priority <= 0 ) return false;
+
+    sched_param sp {};
+    sp.sched_priority = std::min( priority, sched_get_priority_max( SCHED_FIFO ) );
+    return pthread_setschedparam( pthread_self(), SCHED_FIFO, &sp ) == 0;
+}
+
+// CLOCK_MONOTONIC (= steady_clock, Trace::NowNs) 절대 시각까지 대기
+void SleepUntil( uint64_t t_ns )
+{
+    if( t_ns > Trace::NowNs() + SPIN_NS )
+    {
+        uint64_t wake = t_ns - SPIN_NS;
+        timespec ts;
+        ts.tv_sec = (time_t)( wake / 1000000000ULL );
+        ts.tv_nsec = (long)( wake % 1000000000ULL );
+        while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr ) == EINTR ) {}
+    }
+    while( Trace::NowNs() < t_ns ) {}
+}
+
+// 실제 적용 시각 간격 / 예정 대비 지연. hot path 에서 할당 없이 누적만
+struct Timeline
+{
+    uint64_t last_ns = 0;
+    size_t intervals = 0;
+    double sum_us = 0;
+    double min_us = 0;
+    double max_us = 0;
+    double late_max_us = 0;
+
+    void Applied( uint64_t applied_ns, uint64_t apply_at_ns )
+    {
+        if( applied_ns > apply_at_ns )
+            late_max_us = std::max( late_max_us, ( applied_ns - apply_at_ns ) / 1000.0 );
+
+        if( last_ns != 0 )
+        {
+            double us = ( applied_ns - last_ns ) / 1000.0;
+            min_us = intervals == 0 ? us : std::min( min_us, us );
+            max_us = std::max( max_us, us );
+            sum_us += us;
+            intervals++;
+        }
+        last_ns = applied_ns;
+    }
+
+    void Fill( Result& r ) const
+    {
+        r.dwell_mean_us = intervals ? sum_us / intervals : 0;
+        r.dwell_min_us = min_us;
+        r.dwell_max_us = max_us;
+        r.late_max_us = late_max_us;
+    }
+};
+
+}
+
+std::string Spec::Describe() const
+{
+    std::string rep = Common::string_format( "%s %s ", PatternName( pattern ), is_tx ? "tx" : "rx" );
+    if( pattern == Pattern::Raster )
+        rep += Common::string_format( "az %.2f~%.2f el %.2f~%.2f", az_min, az_max, el_min, el_max );
+    else
+        rep += Common::string_format( "center %.2f/%.2f radius %.2f", center_az, center_el, radius );
+
+    rep += Common::string_format( " step %.3f dwell %d us", step, dwell_us );
+    rep += repeat > 0 ? Common::string_format( " x%d", repeat ) : std::string( " continuous" );
+    rep += use_hw ? " engine hw" : " engine sw";
+    return rep;
+}
+
+std::vector<Point> Generate( const Spec& spec, size_t max_points )
+{
+    std::vector<Point> points;
+    if( !( spec.step > 0 ) ) return points;
+
+    // 넘치는 pattern 은 limit 개에서 멈춘다. 개수는 double 로 먼저 세어 reserve 도 limit 이하
+    const size_t limit = max_points < SIZE_MAX ? max_points + 1 : max_points;
+    auto clamp = [limit]( double n ) { return n >= (double)limit ? limit : (size_t)n; };
+
+    switch( spec.pattern )
+    {
+    case Pattern::Raster:
+    {
+        double d_az = std::floor( ( spec.az_max - spec.az_min ) / spec.step + 1e-4 ) + 1;
+        double d_el = std::floor( ( spec.el_max - spec.el_min ) / spec.step + 1e-4 ) + 1;
+        if( !( d_az >= 1 && d_el >= 1 ) ) break;
+
+        size_t n_az = clamp( d_az );
+        size_t n_el = clamp( d_el );
+        points.reserve( clamp( d_az * d_el ) );
+        for( size_t r = 0; r < n_el && points.size() < limit; r++ )
+        {
+            float el = spec.el_min + r * spec.step;
+            for( size_t c = 0; c < n_az && points.size() < limit; c++ )
+            {
+                size_t cc = ( r % 2 == 0 ) ? c : n_az - 1 - c;
+                points.push_back( { spec.az_min + cc * spec.step, el } );
+            }
+        }
+        break;
+    }
+
+    case Pattern::Spiral:
+    {
+        // r = step * theta / 2pi, 호 길이가 step 이 되도록 theta 를 증가 (중심 근처는 step 만큼)
+        double theta = 0;
+        while( points.size() < limit )
+        {
+            double r = spec.step * theta / ( 2 * PI );
+            if( !( r <= spec.radius ) ) break;
+            points.push_back( { (float)( spec.center_az + r * std::cos( theta ) ),
+                                (float)( spec.center_el + r * std::sin( theta ) ) } );
+            theta += spec.step / std::max( r, (double)spec.step );
+        }
+        break;
+    }
+
+    case Pattern::Conical:
+    {
+        double d_n = std::max( 4.0, std::round( 2 * PI * spec.radius / spec.step ) );
+        if( !( d_n >= 4 ) ) break;
+
+        size_t n = clamp( d_n );
+        points.reserve( n );
+        for( size_t k = 0; k < n; k++ )
+        {
+            double theta = 2 * PI * k / d_n;
+            points.push_back( { (float)( spec.center_az + spec.radius * std::cos( theta ) ),
+                                (float)( spec.center_el + spec.radius * std::sin( theta ) ) } );
+        }
+        break;
+    }
+    }
+    return points;
+}
+
+bool ParseSpec( const std::string& text, Spec& spec, std::string* err )
+{
+    auto fail = [err]( const std::string& msg )
+    {
+        if( err ) *err = msg;
+        return false;
+    };
+
+    std::istringstream is( text );
+    std::string pattern, mode;
+    if( !( is >> pattern >> mode ) ) return fail( "expected '<raster|spiral|conical> <tx|rx> ...'" );
+
+    Spec s = spec;
+    if( pattern == "raster" ) s.pattern = Pattern::Raster;
+    else if( pattern == "spiral" ) s.pattern = Pattern::Spiral;
+    else if( pattern == "conical" ) s.pattern = Pattern::Conical;
+    else return fail( "unknown pattern '" + pattern + "'" );
+
+    if( mode == "tx" ) s.is_tx = 1;
+    else if( mode == "rx" ) s.is_tx = 0;
+    else return fail( "unknown mode '" + mode + "'" );
+
+    if( s.pattern == Pattern::Raster )
+    {
+        if( !( is >> s.az_min >> s.az_max >> s.el_min >> s.el_max >> s.step >> s.dwell_us ) )
+            return fail( "expected 'raster <tx|rx> <az_min> <az_max> <el_min> <el_max> <step> <dwell_us> [repeat]'" );
+        if( s.az_min > s.az_max || s.el_min > s.el_max ) return fail( "min > max" );
+    }
+    else
+    {
+        if( !( is >> s.center_az >> s.center_el >> s.radius >> s.step >> s.dwell_us ) )
+            return fail( "expected '" + pattern + " <tx|rx> <az> <el> <radius> <step> <dwell_us> [repeat]'" );
+        if( s.radius <= 0 ) return fail( "radius must be > 0" );
+    }
+
+    if( !( is >> s.repeat ) ) s.repeat = 1;
+
+    // pattern 이 지나는 모든 점이 beam 명령과 같은 범위 안이어야 한다 (nan / inf 포함 거절)
+    std::string range_err;
+    if( s.pattern == Pattern::Raster )
+    {
+        if( !BeamPipeline::ValidSteering( s.az_min, s.el_min, &range_err ) ||
+            !BeamPipeline::ValidSteering( s.az_max, s.el_max, &range_err ) )
+            return fail( range_err );
+    }
+    else
+    {
+        if( !std::isfinite( s.radius ) ||
+            !BeamPipeline::ValidSteering( s.center_az - s.radius, s.center_el - s.radius, &range_err ) ||
+            !BeamPipeline::ValidSteering( s.center_az + s.radius, s.center_el + s.radius, &range_err ) )
+            return fail( range_err.empty() ? std::string( "radius must be finite" ) : "center +- radius : " + range_err );
+    }
+
+    if( !( s.step > 0 ) || !std::isfinite( s.step ) ) return fail( "step must be > 0" );
+    if( s.dwell_us <= 0 ) return fail( "dwell must be > 0" );
+    if( s.repeat < 0 ) return fail( "repeat must be >= 0" );
+
+    spec = s;
+    return true;
+}
+
+std::string Result::Report() const
+{
+    std::string rep = Common::string_format( "scan : engine %s%s%s, %zu beams (pattern %zu, failed %zu)%s",
+        engine.c_str(), codebook ? " codebook" : "", realtime ? " SCHED_FIFO" : "",
+        beams, points, failed, stopped ? " stopped" : "" );
+
+    rep += Common::string_format( "\r\ndwell requested %.1f us, achieved mean %.1f min %.1f max %.1f us",
+        requested_dwell_us, dwell_mean_us, dwell_min_us, dwell_max_us );
+    rep += Common::string_format( "\r\nlate max %.1f us, overruns %zu, reloads %zu", late_max_us, overruns, reloads );
+    if( codebook ) rep += Common::string_format( "\r\ncodebook prepare %.3f ms", prepare_ms );
+    return rep;
+}
+
+struct Scanner::Impl
+{
+    SwBeamEngine sw;
+    HwBeamEngine hw;
+
+    std::thread thread;
+    std::atomic<bool> stop { false };
+    std::atomic<bool> running { false };
+    std::atomic<size_t> beams_done { 0 };
+    std::atomic<size_t> overruns { 0 };
+
+    Spec spec;
+    std::vector<Point> points;
+
+    mutable std::mutex mutex;
+    Result result;
+    bool has_result = false;
+
+    Impl( SpiwriteProtocol::MemoryWriter& writer ) : sw( writer ), hw( writer )
+    {
+        sw.SetScript( false );
+    }
+
+    // repeat == 0 이면 끝이 없다
+    uint64_t Total() const
+    {
+        return spec.repeat > 0 ? (uint64_t)spec.repeat * points.size() : UINT64_MAX;
+    }
+
+    void RunSw( Result& r )
+    {
+        size_t n = points.size();
+        const uint64_t dwell_ns = (uint64_t)spec.dwell_us * 1000;
+
+        std::vector<PreparedBeam> book( 2 );
+        SwBeamEngine::Prepare( spec.is_tx, points[0].az, points[0].el, book[0] );
+
+        size_t beam_bytes = book[0].phase_idx.size();
+        for( auto& w : book[0].words ) beam_bytes += w.size() * sizeof(uint32_t);
+
+        // pattern 전체가 들어가면 시작 전에 다 계산해 두고, 아니면 beam 마다 직전 beam 의 dwell 동안 계산
+        r.codebook = n * beam_bytes <= CODEBOOK_BYTES;
+        if( r.codebook )
+        {
+            auto t0 = Trace::NowNs();
+            book.resize( n );
+            for( size_t i = 1; i < n && !stop; i++ )
+                SwBeamEngine::Prepare( spec.is_tx, points[i].az, points[i].el, book[i] );
+            r.prepare_ms = ( Trace::NowNs() - t0 ) / 1e6;
+        }
+        auto slot = [&]( uint64_t k ) -> PreparedBeam& { return r.codebook ? book[k % n] : book[k & 1]; };
+
+        // fire 부터 적용까지 (trigger + SPI). FIFO 채우기는 fire 전에 끝나 있으므로 빠진다
+        std::map<int, size_t> bytes_per_bus;
+        for( size_t b = 0; b < book[0].bytes.size(); b++ )
+            if( book[0].bytes[b] > 0 ) bytes_per_bus[(int)b] = book[0].bytes[b];
+        Timing::Prediction fire = Timing::Model().Predict( bytes_per_bus );
+        fire.fill_ns = 0;
+        fire.total_ns = fire.trigger_ns + fire.spi_ns;
+
+        Timeline timeline;
+        uint64_t total = Total();
+
+        // load 와 fire 는 따로 잡는다. fire 의 Serial 이 load 다음 번호가 아니면 그 사이 다른 경로가 FIFO 를 썼으므로 다시 load
+        uint64_t loaded_serial;
+        {
+            HardwareArbiter::Lease lease( HardwareArbiter::Priority::Tracking );
+            sw.Load( slot( 0 ) );
+            loaded_serial = lease.Serial();
+        }
+        uint64_t t0 = Trace::NowNs() + dwell_ns;
+
+        for( uint64_t k = 0; k < total && !stop; k++ )
+        {
+            uint64_t apply_at = t0 + k * dwell_ns;
+            uint64_t issue = Timing::Model::IssueDeadline( apply_at, fire );
+            if( Trace::NowNs() > issue ) overruns++;
+
+            SleepUntil( issue );
+            {
+                HardwareArbiter::Lease lease( HardwareArbiter::Priority::Tracking );
+                if( lease.Serial() != loaded_serial + 1 )
+                {
+                    sw.Load( slot( k ) );
+                    r.reloads++;
+                }
+                if( !sw.Fire( slot( k ) ) ) r.failed++;
+            }
+            timeline.Applied( Trace::NowNs(), apply_at );
+            beams_done++;
+
+            if( k + 1 == total ) break;
+            if( !r.codebook )
+            {
+                const Point& p = points[( k + 1 ) % n];
+                SwBeamEngine::Prepare( spec.is_tx, p.az, p.el, slot( k + 1 ) );
+            }
+
+            HardwareArbiter::Lease lease( HardwareArbiter::Priority::Tracking );
+            sw.Load( slot( k + 1 ) );
+            loaded_serial = lease.Serial();
+        }
+
+        timeline.Fill( r );
+    }
+
+    // PL 이 계산하므로 미리 할 일이 없다. 측정한 적용 시간 (EWMA) 만큼 앞당겨 시작
+    void RunHw( Result& r )
+    {
+        size_t n = points.size();
+        const uint64_t dwell_ns = (uint64_t)spec.dwell_us * 1000;
+
+        Timeline timeline;
+        uint64_t total = Total();
+        uint64_t lead_ns = 0;
+        uint64_t t0 = Trace::NowNs() + dwell_ns;
+
+        for( uint64_t k = 0; k < total && !stop; k++ )
+        {
+            uint64_t apply_at = t0 + k * dwell_ns;
+            uint64_t issue = apply_at > lead_ns ? apply_at - lead_ns : 0;
+            if( Trace::NowNs() > issue ) overruns++;
+
+            SleepUntil( issue );
+            uint64_t start = Trace::NowNs();
+            const Point& p = points[k % n];
+            if( !HardwareArbiter::Instance().Run( HardwareArbiter::Priority::Tracking, [&]{ return hw.Apply( spec.is_tx, p.az, p.el ); } ) )
+                r.failed++;
+            uint64_t applied = Trace::NowNs();
+
+            timeline.Applied( applied, apply_at );
+            lead_ns = lead_ns == 0 ? applied - start : ( lead_ns * 7 + ( applied - start ) ) / 8;
+            beams_done++;
+        }
+
+        timeline.Fill( r );
+    }
+
+    void Loop()
+    {
+        Result r;
+        r.points = points.size();
+        r.requested_dwell_us = spec.dwell_us;
+        // rt profile 이 켜져 있으면 hardware cpu 에 pin 하고 stack 도 미리 채운다 (priority 는 spec 값)
+        r.realtime = Rt::Runtime::Instance().Enabled()
+            ? Rt::Runtime::Instance().EnterThread( Rt::Role::Hardware, spec.rt_priority )
+            : SetRealtime( spec.rt_priority );
+
+        if( spec.use_hw && hw.Available() )
+        {
+            r.engine = "hw";
+            RunHw( r );
+        }
+        else
+        {
+            r.engine = spec.use_hw ? "sw load-then-fire (hw unavailable)" : "sw load-then-fire";
+            RunSw( r );
+        }
+
+        r.beams = beams_done;
+        r.overruns = overruns;
+        r.stopped = stop;
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            result = r;
+            has_result = true;
+        }
+        running = false;
+    }
+};
+
+Scanner::Scanner( SpiwriteProtocol::MemoryWriter& writer )
+    : impl_( new Impl( writer ) )
+{
+}
+
+Scanner::~Scanner()
+{
+    Stop();
+    Wait();
+    delete impl_;
+}
+
+bool Scanner::Start( const Spec& spec, std::string* err )
+{
+    if( impl_->running )
+    {
+        if( err ) *err = "scan already running";
+        return false;
+    }
+    if( impl_->thread.joinable() ) impl_->thread.join();
+
+    auto points = Generate( spec, MAX_POINTS );
+    if( points.empty() || points.size() > MAX_POINTS )
+    {
+        if( err ) *err = points.empty() ? std::string( "pattern has no points" )
+                                        : Common::string_format( "pattern has more than %zu points", MAX_POINTS );
+        return false;
+    }
+
+    impl_->spec = spec;
+    impl_->points = std::move( points );
+    impl_->stop = false;
+    impl_->beams_done = 0;
+    impl_->overruns = 0;
+    impl_->running = true;
+
+    Impl* raw = impl_;
+    impl_->thread = std::thread( [raw]{ raw->Loop(); } );
+    return true;
+}
+
+void Scanner::Stop()
+{
+    impl_->stop = true;
+}
+
+bool Scanner::Running() const
+{
+    return impl_->running;
+}
+
+Result Scanner::Wait()
+{
+    if( impl_->thread.joinable() ) impl_->thread.join();
+
+    std::lock_guard<std::mutex> lock( impl_->mutex );
+    return impl_->result;
+}
+
+std::string Scanner::Status() const
+{
+    if( impl_->running )
+    {
+        return Common::string_format( "scan running : %s, %zu beams, overruns %zu",
+            impl_->spec.Describe().c_str(), impl_->beams_done.load(), impl_->overruns.load() );
+    }
+
+    std::lock_guard<std::mutex> lock( impl_->mutex );
+    return impl_->has_result ? impl_->result.Report() : std::string( "scan : idle" );
+}
+
+
+}
+}
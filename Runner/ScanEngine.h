@@ -0,0 +1,114 @@
+#ifndef __SPIBEAM_SCAN_ENGINE_H__
+#define __SPIBEAM_SCAN_ENGINE_H__
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "SpiwriteCommand.h"
+
+namespace SpiBeam {
+namespace Scan {
+
+enum class Pattern { Raster, Spiral, Conical };
+
+// 한 번의 scan 설정. 각도는 degree
+struct Spec
+{
+    Pattern pattern = Pattern::Raster;
+    int is_tx = 1;
+
+    // raster : el 행마다 az 를 step 간격으로 훑고 다음 행은 반대 방향 (boustrophedon)
+    float az_min = -30.0f;
+    float az_max = 30.0f;
+    float el_min = 0.0f;
+    float el_max = 30.0f;
+
+    // spiral : center 에서 radius 까지 감기는 archimedean spiral (감긴 간격 = step)
+    // conical : center 둘레 radius 원 위를 step 간격으로
+    float center_az = 0.0f;
+    float center_el = 30.0f;
+    float radius = 10.0f;
+
+    float step = 1.0f;      // 이웃 beam 사이 각도
+    int dwell_us = 1000;    // beam 하나를 유지하는 시간 = 적용 시각 간격
+    int repeat = 1;         // pattern 반복 횟수, 0 이면 Stop 까지 계속
+    int rt_priority = 80;   // scan thread 의 SCHED_FIFO priority, 0 이면 기본 scheduler
+    // true 면 HwBeamEngine (RTL phase_calc, pole offset 없음) 으로, 아니면 sw load-then-fire.
+    // console 은 BeamEngineSet 에서 고른 engine 을 따른다
+    bool use_hw = false;
+
+    std::string Describe() const;
+};
+
+struct Point
+{
+    float az;
+    float el;
+};
+
+// pattern 이 max_points 보다 많으면 max_points + 1 개에서 멈춘다 (크기 검사용, 그 이상 할당하지 않음)
+std::vector<Point> Generate( const Spec& spec, size_t max_points = SIZE_MAX );
+
+// console 입력 형식
+//   raster  <tx|rx> <az_min> <az_max> <el_min> <el_max> <step> <dwell_us> [repeat]
+//   spiral  <tx|rx> <az> <el> <radius> <step> <dwell_us> [repeat]
+//   conical <tx|rx> <az> <el> <radius> <step> <dwell_us> [repeat]
+// 각도 범위는 BeamPipeline::ValidSteering 과 같다 (spiral / conical 은 center +- radius 전체)
+bool ParseSpec( const std::string& text, Spec& spec, std::string* err = nullptr );
+
+struct Result
+{
+    std::string engine;             // "sw load-then-fire" | "hw"
+    bool codebook = false;          // pattern 전체를 시작 전에 미리 계산했는지
+    bool realtime = false;          // SCHED_FIFO 적용 여부
+    bool stopped = false;           // Stop 으로 중단
+    size_t points = 0;              // pattern 한 바퀴의 beam 수
+    size_t beams = 0;               // 적용한 beam 수
+    size_t failed = 0;
+    size_t overruns = 0;            // fire 시각까지 다음 beam 을 FIFO 에 올리지 못한 횟수
+    size_t reloads = 0;             // load 와 fire 사이에 다른 경로가 hardware 를 써서 다시 load 한 횟수
+    double prepare_ms = 0;          // codebook 계산 시간
+    double requested_dwell_us = 0;
+    double dwell_mean_us = 0;       // 실제 적용 (send 완료) 시각 간격
+    double dwell_min_us = 0;
+    double dwell_max_us = 0;
+    double late_max_us = 0;         // 예정 적용 시각 대비 최대 지연
+
+    std::string Report() const;
+};
+
+// 전용 thread 에서 pattern 을 dwell 간격으로 적용한다.
+//   hw : beamformer_top 이 있으면 az/el 만 쓰고 PL 이 계산 (측정한 적용 시간만큼 앞당겨 시작)
+//   sw : 다음 beam 을 미리 계산 (가능하면 pattern 전체를 codebook 으로) 해서 직전 beam 이 끝나자마자
+//        FIFO 에 올려 두고, Timing::Model 의 IssueDeadline 에 send 만 한다 (load-then-fire)
+// panel 초기화는 하지 않으므로 호출 쪽에서 spec.is_tx 에 맞게 해 둔다.
+// hardware 접근은 HardwareArbiter 의 Tracking priority 로 beam 마다 잡는다
+class Scanner
+{
+public:
+    explicit Scanner( SpiwriteProtocol::MemoryWriter& writer );
+    ~Scanner();
+
+    Scanner( const Scanner& ) = delete;
+    Scanner& operator=( const Scanner& ) = delete;
+
+    bool Start( const Spec& spec, std::string* err = nullptr );
+    void Stop();
+    bool Running() const;
+
+    // scan thread 가 끝날 때까지 기다린 뒤 결과
+    Result Wait();
+
+    // 진행 중이면 진행 상황, 끝났으면 마지막 결과
+    std::string Status() const;
+
+private:
+    struct Impl;
+    Impl *impl_;
+};
+
+
+}
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include "string_util.hpp"
+#include "SpiStats.h"
+
+namespace SpiBeam {
+namespace Stats {
+
+const char* CounterName( Counter c )
+{
+    switch( c )
+    {
+        case Counter::CommandsExecuted: return "commands";
+        case Counter::BeamsApplied:     return "beams";
+        case Counter::FifoFullStalls:   return "fifo_full_stalls";
+        case Counter::SendBusyPolls:    return "send_busy_polls";
+        case Counter::DecodeErrors:     return "decode_errors";
+        case Counter::DuplicateFrames:  return "duplicate_frames";
+        case Counter::CacheHits:        return "cache_hits";
+        case Counter::CacheMisses:      return "cache_misses";
+        case Counter::BeamReuseHits:    return "beam_reuse_hits";
+        case Counter::BeamReuseMisses:  return "beam_reuse_misses";
+        default:                        return "NA";
+    }
+}
+
+Registry& Registry::Instance()
+{
+    static Registry registry;
+    return registry;
+}
+
+uint64_t Registry::WordsWritten( int bus ) const
+{
+    if( bus < 0 || bus >= MAX_BUS ) return 0;
+    return words_[bus].value.load( std::memory_order_relaxed );
+}
+
+void Registry::AddSection( const std::string& name, SectionFn fn )
+{
+    std::lock_guard<std::mutex> lock( section_mutex_ );
+    for( auto& s : sections_ )
+    {
+        if( s.first == name )
+        {
+            s.second = fn;
+            return;
+        }
+    }
+    sections_.emplace_back( name, fn );
+}
+
+void Registry::RemoveSection( const std::string& name )
+{
+    std::lock_guard<std::mutex> lock( section_mutex_ );
+    sections_.erase( std::remove_if( sections_.begin(), sections_.end(),
+        [&]( const std::pair<std::string, SectionFn>& s ){ return s.first == name; } ), sections_.end() );
+}
+
+std::string Registry::Report() const
+{
+    std::string rep;
+    for( int i = 0; i < (int)Counter::Count; i++ )
+    {
+        if( !rep.empty() ) rep += "\r\n";
+        rep += Common::string_format( "%-17s %llu", CounterName( (Counter)i ), (unsigned long long)Get( (Counter)i ) );
+    }
+
+    // 사용한 bus 만 출력
+    std::string words;
+    for( int bus = 0; bus < MAX_BUS; bus++ )
+    {
+        uint64_t n = WordsWritten( bus );
+        if( n == 0 ) continue;
+        words += Common::string_format( " %d:%llu", bus, (unsigned long long)n );
+    }
+    rep += "\r\nwords_written    " + (words.empty() ? std::string(" -") : words);
+
+    std::lock_guard<std::mutex> lock( section_mutex_ );
+    for( auto& s : sections_ )
+    {
+        std::string body = s.second();
+        if( body.empty() ) continue;
+        rep += "\r\n[" + s.first + "]\r\n" + body;
+    }
+    return rep;
+}
+
+void Registry::Reset()
+{
+    for( auto& c : counters_ ) c.value.store( 0, std::memory_order_relaxed );
+    for( auto& w : words_ ) w.value.store( 0, std::memory_order_relaxed );
+}
+
+
+}
+}
@@ -0,0 +1,88 @@
+#ifndef __SPIBEAM_SPI_STATS_H__
+#define __SPIBEAM_SPI_STATS_H__
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <functional>
+#include "PanelLayout.h"
+
+namespace SpiBeam {
+namespace Stats {
+
+enum class Counter : int
+{
+    CommandsExecuted = 0,
+    BeamsApplied,
+    FifoFullStalls,     // remaining size 0 관측
+    SendBusyPolls,      // send register polling 중 busy 로 읽힌 횟수
+    DecodeErrors,       // frame decode / decompress 실패
+    DuplicateFrames,    // 직전과 같은 sequence 로 다시 들어온 frame
+    CacheHits,          // BINARY payload cache (Cache::PayloadCache)
+    CacheMisses,
+    BeamReuseHits,      // 원격 beam 명령이 직전 beam 의 FIFO word 를 그대로 쓴 횟수
+    BeamReuseMisses,
+
+    Count
+};
+
+const char* CounterName( Counter c );
+
+// 항상 켜 두는 counter 모음. 모두 relaxed atomic 이라 hot path 에서도 부담 없음
+class Registry
+{
+public:
+    static constexpr int MAX_BUS = Layout::MAX_BUS;
+
+    static Registry& Instance();
+
+    void Add( Counter c, uint64_t n = 1 )
+    {
+        counters_[(int)c].value.fetch_add( n, std::memory_order_relaxed );
+    }
+
+    void AddWordsWritten( int bus, uint64_t n = 1 )
+    {
+        if( bus < 0 || bus >= MAX_BUS ) return;
+        words_[bus].value.fetch_add( n, std::memory_order_relaxed );
+    }
+
+    uint64_t Get( Counter c ) const { return counters_[(int)c].value.load( std::memory_order_relaxed ); }
+    uint64_t WordsWritten( int bus ) const;
+
+    // 다른 모듈이 stats 출력에 section 을 덧붙일 때 사용
+    using SectionFn = std::function<std::string()>;
+    void AddSection( const std::string& name, SectionFn fn );
+    // 진행 중인 Report 가 끝날 때까지 기다렸다가 뺀다. 돌아온 뒤에는 fn 이 불리지 않는다
+    void RemoveSection( const std::string& name );
+
+    std::string Report() const;
+    void Reset();
+
+private:
+    Registry() {}
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> value { 0 };
+    };
+
+    Slot counters_[(int)Counter::Count];
+    Slot words_[MAX_BUS];
+
+    mutable std::mutex section_mutex_;
+    std::vector<std::pair<std::string, SectionFn>> sections_;
+};
+
+inline void Inc( Counter c, uint64_t n = 1 )
+{
+    Registry::Instance().Add( c, n );
+}
+
+
+}
+}
+
+#endif
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include "string_util.hpp"
+#include "SpiTimingModel.h"
+
+namespace SpiBeam {
+namespace Timing {
+
+std::string Prediction::Report() const
+{
+    std::string rep = Common::string_format( "total %.1f us (fill %.1f, trigger %.1f, spi %.1f) bus %d",
+        total_ns / 1000.0, fill_ns / 1000.0, trigger_ns / 1000.0, spi_ns / 1000.0, critical_bus );
+
+    if( total_ns > 0 )
+        rep += Common::string_format( "\r\nmax rate %.1f beams/s", 1e9 / total_ns );
+
+    for( auto& b : buses )
+    {
+        rep += Common::string_format( "\r\n bus %d: bytes %zu words %zu frames %zu cycles %llu fill %.1f us spi %.1f us",
+            b.bus, b.bytes, b.words, b.frames, (unsigned long long)b.spi_cycles, b.fill_ns / 1000.0, b.spi_ns / 1000.0 );
+    }
+
+    if( overflow ) rep += "\r\nwarning: FIFO depth exceeded";
+    return rep;
+}
+
+Model::Model( const Params& params )
+    : params_( params )
+{
+    params_.div = std::clamp( params_.div, MIN_DIV, MAX_DIV );
+    if( !( params_.clk_hz > 0 ) ) params_.clk_hz = Params().clk_hz;
+    if( params_.frame_bytes < 1 ) params_.frame_bytes = 1;
+    if( params_.source_latency < 0 ) params_.source_latency = 0;
+
+    frame_cycles_.resize( params_.frame_bytes + 1, 0 );
+    for( int n = 1; n <= params_.frame_bytes; n++ )
+        frame_cycles_[n] = SimulateFrame( n );
+}
+
+// spi_master_stream.sv 의 always_ff 블록들을 그대로 옮긴 것.
+// 모든 값은 현재 cycle 값으로 다음 cycle 값을 계산한다 (non-blocking 과 동일).
+// IDLE 에서 시작해 frame 마지막 byte 후 IDLE 로 돌아오는 시점까지의 cycle 수를 센다.
+uint64_t Model::SimulateFrame( int bytes ) const
+{
+    enum State { ST_IDLE, ST_LOAD, ST_SHIFT };
+
+    const int DIV = params_.div;
+
+    State state = ST_IDLE;
+    int  cdiv = 0;
+    bool tick = false;
+    bool sclk = false;          // CPOL = 0
+    int  bits_left = 0;
+    bool last_byte = false;
+
+    int  sent = 0;
+    uint64_t entered = 0;       // IDLE/LOAD 에 들어온 cycle (wready 가 올라가는 시점)
+
+    for( uint64_t t = 0; ; t++ )
+    {
+        bool wvalid = state != ST_SHIFT && sent < bytes && t >= entered + params_.source_latency;
+        bool edge_pos = tick && state == ST_SHIFT && sclk;
+        bool edge_neg = tick && state == ST_SHIFT && !sclk;
+        (void)edge_neg;  // shift register 만 움직이므로 timing 에는 영향 없음
+
+        State n_state = state;
+        int   n_cdiv = 0;
+        bool  n_tick = false;
+        bool  n_sclk = false;
+
+        // divider, SCLK : ST_SHIFT 에서만 동작
+        if( state == ST_SHIFT )
+        {
+            if( cdiv == DIV - 1 ) { n_cdiv = 0; n_tick = true; }
+            else                  { n_cdiv = cdiv + 1; n_tick = false; }
+            n_sclk = tick ? !sclk : sclk;
+        }
+
+        switch( state )
+        {
+            case ST_IDLE:
+            case ST_LOAD:
+                if( wvalid )
+                {
+                    last_byte = ( sent == bytes - 1 );
+                    bits_left = 8;
+                    sent++;
+                    n_state = ST_SHIFT;
+                }
+                break;
+
+            case ST_SHIFT:
+                if( edge_pos )
+                {
+                    if( bits_left == 1 ) n_state = last_byte ? ST_IDLE : ST_LOAD;
+                    else                 bits_left--;
+                }
+                break;
+        }
+
+        if( n_state != state && n_state != ST_SHIFT ) entered = t + 1;
+
+        state = n_state;
+        cdiv  = n_cdiv;
+        tick  = n_tick;
+        sclk  = n_sclk;
+
+        if( state == ST_IDLE && sent == bytes ) return t + 1;
+    }
+}
+
+uint64_t Model::FrameCycles( int bytes ) const
+{
+    if( bytes <= 0 ) return 0;
+    if( bytes < (int)frame_cycles_.size() ) return frame_cycles_[bytes];
+    return SimulateFrame( bytes );
+}
+
+uint64_t Model::LaneCycles( size_t bytes ) const
+{
+    const size_t fb = params_.frame_bytes;
+    return ( bytes / fb ) * FrameCycles( (int)fb ) + FrameCycles( (int)( bytes % fb ) );
+}
+
+Prediction Model::Predict( const std::map<int, size_t>& bytes_per_bus ) const
+{
+    Prediction p;
+    const size_t fb = params_.frame_bytes;
+
+    for( auto& kv : bytes_per_bus )
+    {
+        if( kv.second == 0 ) continue;
+
+        BusPrediction b;
+        b.bus        = kv.first;
+        b.bytes      = kv.second;
+        b.words      = ( b.bytes + 3 ) / 4;
+        b.frames     = ( b.bytes + fb - 1 ) / fb;
+        b.spi_cycles = LaneCycles( b.bytes );
+        b.spi_ns     = CyclesToNs( b.spi_cycles );
+        // data word + send length(0x14) + start(0x2C)
+        b.fill_ns    = ( b.words + 2 ) * params_.axi_write_ns;
+
+        if( b.words > (size_t)params_.fifo_depth_words ) p.overflow = true;
+
+        p.fill_ns += b.fill_ns;
+        if( b.spi_ns > p.spi_ns )
+        {
+            p.spi_ns = b.spi_ns;
+            p.critical_bus = b.bus;
+        }
+        p.buses.push_back( b );
+    }
+
+    if( !p.buses.empty() )
+    {
+        // length(0x43c00018) / execute(0x43c0001c) / send(0x43c00014)
+        p.trigger_ns = 3 * params_.axi_write_ns;
+    }
+
+    p.total_ns = p.fill_ns + p.trigger_ns + p.spi_ns;
+    return p;
+}
+
+Prediction Model::PredictElements( int elements, int elements_per_bus ) const
+{
+    std::map<int, size_t> counts;
+    if( elements_per_bus <= 0 ) return Predict( counts );
+    elements = std::min( elements, MAX_ELEMENTS );
+
+    for( int bus = 0; elements > 0; bus++ )
+    {
+        int n = std::min( elements, elements_per_bus );
+        counts[bus] = (size_t)n * params_.frame_bytes;
+        elements -= n;
+    }
+    return Predict( counts );
+}
+
+uint64_t Model::IssueDeadline( uint64_t apply_at_ns, const Prediction& p )
+{
+    uint64_t need = (uint64_t)p.total_ns;
+    return apply_at_ns > need ? apply_at_ns - need : 0;
+}
+
+
+}
+}
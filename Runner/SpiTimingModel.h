@@ -0,0 +1,94 @@
+#ifndef __SPIBEAM_SPI_TIMING_MODEL_H__
+#define __SPIBEAM_SPI_TIMING_MODEL_H__
+
+#include <map>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace SpiBeam {
+namespace Timing {
+
+// 원격 predict 로 받을 수 있는 범위. SimulateFrame 이 DIV x byte 수만큼 cycle 을 돌므로 DIV 는 위로도 막는다
+constexpr int    MIN_DIV      = 2;          // spi_master_stream.sv : DIV >= 2
+constexpr int    MAX_DIV      = 256;        // SCLK = clk/512 보다 느린 bus 는 쓰지 않는다
+constexpr double MAX_CLK_MHZ  = 1000.0;
+constexpr int    MAX_ELEMENTS = 1 << 16;
+
+// spi_master_stream.sv + bus 별 AXI FIFO 의 timing parameter
+struct Params
+{
+    double clk_hz        = 100e6;  // PL clock (tb 기준 100MHz)
+    int    div           = 4;      // SCLK = clk/(2*DIV), beamformer_top 은 4
+    int    frame_bytes   = 5;      // CS 한 번에 보내는 byte 수 (0x43c00018 send length)
+    int    source_latency = 1;     // wready 이후 FIFO 가 다음 byte 를 내기까지의 cycle
+    int    fifo_depth_words = 512; // bus 당 FIFO 깊이 (word)
+    double axi_write_ns  = 150.0;  // CPU -> AXI-Lite register write 1 회 비용
+};
+
+struct BusPrediction
+{
+    int      bus;
+    size_t   bytes;     // send length register 값 (마지막 word 의 padding 제외)
+    size_t   words;
+    size_t   frames;
+    uint64_t spi_cycles;
+    double   fill_ns;   // data word + length + start write
+    double   spi_ns;    // send 이후 SPI 로 다 빠지기까지
+};
+
+struct Prediction
+{
+    std::vector<BusPrediction> buses;
+
+    double fill_ns     = 0;   // bus 를 순서대로 채우는 시간의 합
+    double trigger_ns  = 0;   // length / execute / send write
+    double spi_ns      = 0;   // 가장 늦게 끝나는 bus 기준
+    double total_ns    = 0;
+    int    critical_bus = -1;
+    bool   overflow    = false; // FIFO 깊이를 넘는 bus 가 있음
+
+    std::string Report() const;
+};
+
+// spi_master_stream 의 FSM(IDLE/LOAD/SHIFT) 을 cycle 단위로 따라가서
+// frame 당 cycle 수를 구하고, 이를 bus 별 word stream 에 적용한다.
+// FIFO 채우기는 CPU 가 bus 순서대로 하고, SPI 전송은 send 이후 모든 bus 가 동시에 진행된다.
+class Model
+{
+public:
+    explicit Model( const Params& params = Params() );
+
+    const Params& GetParams() const { return params_; }
+
+    // byte 수 n 인 frame 하나 (CS low ~ IDLE 복귀) 의 cycle 수
+    uint64_t FrameCycles( int bytes ) const;
+
+    // lane 하나가 bytes 만큼 보내는 데 걸리는 cycle 수 (frame_bytes 단위로 CS 토글)
+    uint64_t LaneCycles( size_t bytes ) const;
+
+    double CyclesToNs( uint64_t cycles ) const { return cycles * 1e9 / params_.clk_hz; }
+
+    // bus 별 byte 수 (length register 로 보내는 값, 5 byte frame x element) 로 beam 한 번의 완료 시간 예측.
+    // FIFO 에는 4 byte word 로 들어가지만 SPI 로는 length 만큼만 나가므로 마지막 word 의 padding 은 세지 않는다
+    Prediction Predict( const std::map<int, size_t>& bytes_per_bus ) const;
+
+    // element 수 기준 (bus 당 elements_per_bus 씩 앞 bus 부터 채움)
+    Prediction PredictElements( int elements, int elements_per_bus ) const;
+
+    // 시각 apply_at_ns 에 beam 이 적용되어 있으려면 늦어도 언제 시작해야 하는지
+    static uint64_t IssueDeadline( uint64_t apply_at_ns, const Prediction& p );
+
+private:
+    uint64_t SimulateFrame( int bytes ) const;
+
+    Params params_;
+    std::vector<uint64_t> frame_cycles_;  // index = frame byte 수
+};
+
+
+}
+}
+
+#endif
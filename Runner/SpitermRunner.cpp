@@ -1,5 +1,18 @@
 #include <string.h>
 #include <algorithm>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <condition_variable>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 #include "UDPPoint.h"
 #include "SpitermRunner.h"
 #include "SpiwriteProtocol.h"
@@ -7,34 +20,97 @@
 #include "LineParser.h"
 #include "SpiwriteCommand.h"
 #include "Instruction.h"
+#include "BeamTrace.h"
+#include "SpiStats.h"
+#include "RtProfile.h"
+#include "HardwareContext.h"
 
 namespace SpiBeam {
 
+namespace {
 
-class SpitermRunner::Impl : public SpiwriteProtocol::FrameHandler
+constexpr size_t DEFAULT_MAX_SESSIONS = 8;
+constexpr size_t MAX_QUEUED_DATAGRAMS = 64;
+
+// peer (sender address) 하나의 상태.
+// sequence / 중복 검사 (FrameHandler), 명령 실행 상태 (SpiwriteCommand 의 원격 transaction, beam buffer),
+// 수신 datagram buffer 를 peer 마다 따로 가지고, 자기 worker thread 에서 처리한다.
+// Lease 는 thread 단위이므로 한 peer 의 start .. done 이 다른 peer 의 datagram 과 섞이지 않고,
+// 다른 peer 의 긴 명령이 이 peer 의 수신을 막지 않는다.
+// worker 는 보통 thread 이고, 원격 Lease 를 든 FIFO / trigger 구간에서만 hardware cpu / priority 로 돈다 (SpiwriteCommand)
+class Session : public SpiwriteProtocol::FrameHandler
 {
 public:
-    Impl(SpitermRunner* owner) 
-        : owner_(owner), spi_command_( owner_->transport_, &code_gen_, &parser_)
+    Session( const std::string& ip, int port, Controller::Transport& transport )
+        : ip_( ip ), port_( port ), key_( ip + ":" + std::to_string( port ) )
+        , spi_command_( transport, &code_gen_, &parser_ )
     {
-        SetOnSend( [this](const uint8_t*buf, int len){ udp_point_.Send( (const char*)buf, len); } );
+        worker_ = std::thread( [this]{ Loop(); } );
     }
 
-public:
-    UDPConfig udp_config_;
-    Common::DestinatedUDPPoint udp_point_;
-    Parser::LineParser parser_;
-    SpitermRunner *owner_;
-    Controller::CodeGenerator code_gen_;
-    SpiwriteProtocol::SpiwriteCommand spi_command_;
+    ~Session() { Stop(); }
+
+    const std::string& Ip() const { return ip_; }
+    int Port() const { return port_; }
+    const std::string& Key() const { return key_; }
+
+    // 수신 thread 에서 호출. queue 가 가득 차면 버린다 (client 가 재전송)
+    bool Post( const char* msg, int len, uint64_t t0_ns )
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        if( stop_ || queue_.size() >= MAX_QUEUED_DATAGRAMS ) return false;
+
+        // 처리가 끝난 buffer 를 다시 쓴다
+        std::vector<uint8_t> data;
+        if( !free_.empty() )
+        {
+            data = std::move( free_.back() );
+            free_.pop_back();
+        }
+        data.assign( msg, msg + len );
+        queue_.push_back( Datagram{ std::move( data ), t0_ns } );
+        received_++;
+        cv_.notify_one();
+        return true;
+    }
+
+    // 받아 둔 datagram 은 다 처리하고 끝낸다. Stop 은 worker 가 끝날 때까지 기다린다
+    void RequestStop()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            stop_ = true;
+        }
+        cv_.notify_one();
+    }
 
-    void OnMessage( const SpiwriteProtocol::Header& head, const SpiwriteProtocol::MessageLines& msg)
+    void Stop()
     {
-        std::string rep = "";
-        
+        RequestStop();
+        if( worker_.joinable() ) worker_.join();
+    }
+
+    bool Finished() const { return finished_.load(); }
+
+    // start .. done 사이 (원격 transaction 을 들고 있음). 처리한 datagram 마다 worker 가 갱신
+    bool HoldsLease() const { return holds_lease_.load(); }
+
+    std::string Report() const
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        return Common::string_format( "%-21s datagrams %llu, queued %zu", key_.c_str(),
+            (unsigned long long)received_, queue_.size() );
+    }
+
+    void OnMessage( const SpiwriteProtocol::Header& head, const SpiwriteProtocol::MessageLines& msg ) override
+    {
+        // reply buffer 는 session 마다 재사용
+        std::string& rep = reply_;
+        rep.clear();
+
         // string_view를 string으로 변환
         std::string full_message(msg.GetStringLines());
-        
+
         // 바이너리 명령어인지 체크
         if (full_message.length() >= 7 && full_message.substr(0, 7) == "BINARY:") {
             // 바이너리 데이터는 라인 분할 없이 전체를 처리
@@ -44,7 +120,7 @@ public:
                     Controller::SpiReadback rb(v);
                     rep += Common::string_format("%04x[%d]\r\n", rb.Value(), rb.Length());
                 }
-                
+
                 if(!r.message.empty()) {
                     rep += (r.message + "\r\n");
                 }
@@ -61,12 +137,12 @@ public:
                 {
                     //auto r = spi_command_.Execute( parser_.Tokenize( line ) );
                     auto r = spi_command_.Execute( std::string(line) );
-                    for( uint32_t v : r.responses ) 
+                    for( uint32_t v : r.responses )
                     {
                         Controller::SpiReadback rb( v );
                         rep += Common::string_format( "%04x[%d]\r\n", rb.Value(), rb.Length() );
                     }
-    
+
                     if( !r.message.empty() )
                     {
                         rep += (r.message + "\r\n");
@@ -85,31 +161,270 @@ public:
 
         MessageLines rmsg( rep.c_str() );
 
-        Send( Frame{ 
-            Header{ 
+        Send( Frame{
+            Header{
                 MSG_STRAT_CODE, GetSequenceAndIncrement(), MSG_LINES, (uint32_t)rmsg.lines.size()
             }.ToNetwork(),
             MessageRaw( std::move(rmsg.lines))
         });
     }
+
+private:
+    struct Datagram
+    {
+        std::vector<uint8_t> data;
+        uint64_t t0_ns;
+    };
+
+    void Loop()
+    {
+        // 처음 보는 sender 마다 생기는 thread 이므로 SCHED_FIFO 로 올리지 않는다.
+        // hardware role 은 Lease 를 받은 구간에서만 (SpiwriteCommand::RemoteLease)
+        std::unique_lock<std::mutex> lock( mutex_ );
+        while( true )
+        {
+            cv_.wait( lock, [this]{ return stop_ || !queue_.empty(); } );
+            if( queue_.empty() ) break;
+
+            Datagram d = std::move( queue_.front() );
+            queue_.pop_front();
+            lock.unlock();
+
+            // end_to_end 는 beam 의 첫 datagram (start / BINARY) 수신 시각부터 done 이 끝날 때까지 (queue 대기 포함).
+            // beam 구간은 SpiwriteCommand 가 열고 닫는다. stats 같은 다른 datagram 은 기록하지 않는다
+            Trace::Tracer::SetReceived( d.t0_ns );
+            try
+            {
+                Trace::Probe probe( Trace::Stage::UdpReceive );
+                OnReceive( d.data.data(), (int)d.data.size() );
+            }
+            catch( const std::exception& e )
+            {
+                printf( ";session %s : %s\n", key_.c_str(), e.what() );
+            }
+            Trace::Tracer::SetReceived( 0 );
+            holds_lease_ = spi_command_.HoldsRemote();
+
+            lock.lock();
+            free_.push_back( std::move( d.data ) );
+        }
+        lock.unlock();
+
+        // start .. done 사이에 끝난 session 의 transaction 은 잡은 이 thread 에서 놓아야 바로 풀린다
+        spi_command_.AbortRemote();
+        holds_lease_ = false;
+        finished_ = true;
+    }
+
+    std::string ip_;
+    int port_;
+    std::string key_;
+
+    Parser::LineParser parser_;
+    Controller::CodeGenerator code_gen_;
+    SpiwriteProtocol::SpiwriteCommand spi_command_;
+    std::string reply_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Datagram> queue_;
+    std::vector<std::vector<uint8_t>> free_;
+    uint64_t received_ = 0;
+    bool stop_ = false;
+    std::atomic<bool> finished_ { false };
+    std::atomic<bool> holds_lease_ { false };
+    std::thread worker_;
 };
 
-SpitermRunner::SpitermRunner( TransportMap& transport_map, ArrayInfoMap& arraym, const UDPConfig& cfg ) : 
+// sender 주소 -> ip, port. 모르는 family 면 false
+bool PeerAddress( const sockaddr* sender, std::string& ip, int& port )
+{
+    char buf[INET6_ADDRSTRLEN] = {};
+    if( sender->sa_family == AF_INET )
+    {
+        auto in = reinterpret_cast<const sockaddr_in*>( sender );
+        inet_ntop( AF_INET, &in->sin_addr, buf, sizeof(buf) );
+        port = ntohs( in->sin_port );
+    }
+    else if( sender->sa_family == AF_INET6 )
+    {
+        auto in6 = reinterpret_cast<const sockaddr_in6*>( sender );
+        inet_ntop( AF_INET6, &in6->sin6_addr, buf, sizeof(buf) );
+        port = ntohs( in6->sin6_port );
+    }
+    else
+    {
+        return false;
+    }
+    ip = buf;
+    return true;
+}
+
+}
+
+
+class SpitermRunner::Impl
+{
+public:
+    Impl(SpitermRunner* owner)
+        : owner_(owner)
+    {
+        const char* env = getenv( "SPIBEAM_MAX_SESSIONS" );
+        if( env && atoi( env ) > 0 ) max_sessions_ = (size_t)atoi( env );
+
+        Stats::Registry::Instance().AddSection( "sessions", [this]{ return Report(); } );
+    }
+
+    // 수신을 먼저 끊고 (새 session 없음), worker 를 모두 기다린 뒤에 stats section 을 뺀다
+    ~Impl()
+    {
+        {
+            std::lock_guard<std::mutex> lock( sessions_mutex_ );
+            closing_ = true;
+        }
+        {
+            // 처리 중인 worker 의 응답은 더 보내지 않는다
+            std::lock_guard<std::mutex> lock( send_mutex_ );
+            udp_point_.reset();
+        }
+
+        // worker 가 stats 명령으로 Report 를 부를 수 있으므로 lock 밖에서 기다린다
+        std::list<std::shared_ptr<Session>> sessions;
+        std::vector<std::shared_ptr<Session>> retired;
+        {
+            std::lock_guard<std::mutex> lock( sessions_mutex_ );
+            sessions.swap( lru_ );
+            retired.swap( retired_ );
+            sessions_.clear();
+        }
+        for( auto& s : sessions ) s->Stop();
+        for( auto& s : retired ) s->Stop();
+
+        Stats::Registry::Instance().RemoveSection( "sessions" );
+    }
+
+public:
+    UDPConfig udp_config_;
+    std::unique_ptr<Common::DestinatedUDPPoint> udp_point_ = std::make_unique<Common::DestinatedUDPPoint>();
+    SpitermRunner *owner_;
+
+    // 수신 thread : sender 의 session 을 찾아 (없으면 만들고) datagram 을 넘긴다
+    void OnDatagram( const char* msg, int len, const sockaddr* sender )
+    {
+        auto t0 = Trace::NowNs();
+
+        std::string ip = udp_config_.remote_ip;
+        int port = udp_config_.remote_port;
+        if( sender && !PeerAddress( sender, ip, port ) )
+        {
+            Stats::Inc( Stats::Counter::DecodeErrors );
+            return;
+        }
+
+        auto session = Find( ip, port );
+        if( !session || !session->Post( msg, len, t0 ) )
+        {
+            std::lock_guard<std::mutex> lock( sessions_mutex_ );
+            dropped_++;
+        }
+    }
+
+    std::string Report() const
+    {
+        std::lock_guard<std::mutex> lock( sessions_mutex_ );
+        if( opened_ == 0 ) return std::string();
+
+        std::string rep = Common::string_format( "sessions : %zu / %zu active, opened %llu, evicted %llu, dropped datagrams %llu",
+            lru_.size(), max_sessions_, (unsigned long long)opened_, (unsigned long long)evicted_, (unsigned long long)dropped_ );
+        for( auto& s : lru_ ) rep += "\r\n " + s->Report();
+        return rep;
+    }
+
+private:
+    std::shared_ptr<Session> Find( const std::string& ip, int port )
+    {
+        std::string key = ip + ":" + std::to_string( port );
+
+        std::lock_guard<std::mutex> lock( sessions_mutex_ );
+        if( closing_ ) return nullptr;
+        auto it = sessions_.find( key );
+        if( it != sessions_.end() )
+        {
+            // 가장 최근에 쓴 session 을 앞으로
+            lru_.splice( lru_.begin(), lru_, it->second );
+            return *it->second;
+        }
+
+        // 내보낸 session 중 끝난 것만 정리 (처리 중인 session 을 수신 thread 가 기다리지 않게).
+        // 가득 차 있으면 원격 transaction 을 들고 있지 않은 session 중 가장 오래 안 쓴 것을 내보낸다 (받아 둔 것은 마저 처리).
+        // 모두 들고 있으면 새 sender 의 datagram 은 버린다
+        retired_.erase( std::remove_if( retired_.begin(), retired_.end(),
+            []( const std::shared_ptr<Session>& s ){ return s->Finished(); } ), retired_.end() );
+        while( lru_.size() >= max_sessions_ )
+        {
+            auto it_victim = std::find_if( lru_.rbegin(), lru_.rend(),
+                []( const std::shared_ptr<Session>& s ){ return !s->HoldsLease(); } );
+            if( it_victim == lru_.rend() ) return nullptr;
+
+            auto victim = *it_victim;
+            lru_.erase( std::next( it_victim ).base() );
+            sessions_.erase( victim->Key() );
+            evicted_++;
+            printf( ";session %s evicted\n", victim->Key().c_str() );
+            victim->RequestStop();
+            retired_.push_back( victim );
+        }
+
+        auto session = std::make_shared<Session>( ip, port, owner_->transport_ );
+        Session* s = session.get();
+        session->SetOnSend( [this, s]( const uint8_t* buf, int len ){ SendTo( *s, buf, len ); } );
+
+        lru_.push_front( session );
+        sessions_[key] = lru_.begin();
+        opened_++;
+        return session;
+    }
+
+    // 보낸 peer 로 응답. UDP point 의 destination 을 바꿔 보내므로 session 끼리 직렬화
+    void SendTo( const Session& s, const uint8_t* buf, int len )
+    {
+        std::lock_guard<std::mutex> lock( send_mutex_ );
+        if( !udp_point_ ) return;
+        udp_point_->SetDestination( s.Ip().c_str(), s.Port() );
+        udp_point_->Send( (const char*)buf, len );
+    }
+
+    mutable std::mutex sessions_mutex_;
+    std::list<std::shared_ptr<Session>> lru_;
+    std::unordered_map<std::string, std::list<std::shared_ptr<Session>>::iterator> sessions_;
+    std::vector<std::shared_ptr<Session>> retired_;
+    size_t max_sessions_ = DEFAULT_MAX_SESSIONS;
+    uint64_t opened_ = 0;
+    uint64_t evicted_ = 0;
+    uint64_t dropped_ = 0;
+    bool closing_ = false;
+
+    std::mutex send_mutex_;
+};
+
+SpitermRunner::SpitermRunner( TransportMap& transport_map, ArrayInfoMap& arraym, const UDPConfig& cfg ) :
     Runner(transport_map, arraym)
-    , impl_( new Impl(this) ) 
+    , impl_( new Impl(this) )
 {
     impl_->udp_config_ = cfg;
 
+    Rt::Runtime::Instance().Setup( HardwareContext::Instance().Writer() );
 
-
-    auto& up = impl_->udp_point_;
+    auto& up = *impl_->udp_point_;
     up.SetDestination( cfg.remote_ip.c_str(), cfg.remote_port);
-    up.Bind( cfg.local_port, [this](const char*msg, int len, const sockaddr* sender) { 
-        this->impl_->OnReceive( (const uint8_t*) msg, len );
+    up.Bind( cfg.local_port, [this](const char*msg, int len, const sockaddr* sender) {
+        // 수신 thread 는 처음 한 번만 network cpu / priority 로
+        Rt::Runtime::Instance().EnterThread( Rt::Role::Network );
+        this->impl_->OnDatagram( msg, len, sender );
     });
 }
 
-SpitermRunner::~SpitermRunner() 
+SpitermRunner::~SpitermRunner()
 {
     delete impl_;
 }
@@ -117,7 +432,7 @@ SpitermRunner::~SpitermRunner()
 
 void SpitermRunner::Run()
 {
-    // ...    
+    // ...
 }
 
 }
@@ -9,10 +9,13 @@ namespace SpiBeam {
 struct UDPConfig
 {
     int local_port;
-    std::string remote_ip;
+    std::string remote_ip;      // 응답은 보낸 peer 로 간다. sender 주소를 모를 때만 여기로
     int remote_port;
 };
 
+// peer (sender ip:port) 마다 session 을 두고 각자 worker thread 에서 명령을 처리한다.
+// session 수는 $SPIBEAM_MAX_SESSIONS (기본 8), 넘으면 원격 lease 를 들고 있지 않은 session 중 가장 오래 안 쓴 것을 닫는다
+
 class SpitermRunner : public Runner
 {
 public:
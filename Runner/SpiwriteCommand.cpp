@@ -2,6 +2,20 @@
 #include <charconv>
 #include "string_util.hpp"
 #include "SpiwriteCommand.h"
+#include "BeamTrace.h"
+#include "SpiStats.h"
+#include "SpiTimingModel.h"
+#include "HardwareContext.h"
+#include "WarmStart.h"
+#include "PanelLayout.h"
+#include "TrigTable.h"
+#include "BeamPipeline.h"
+#include "HealthMonitor.h"
+#include "BeamEngine.h"
+#include "PayloadCache.h"
+#include "BusStreams.h"
+#include "ZDict.h"
+#include "RtProfile.h"
 
 
 #include <iostream>
@@ -78,6 +92,19 @@ bool writeMemoryDirect(uintptr_t target_address, uint32_t value) {
 namespace SpiBeam {
 namespace SpiwriteProtocol {
 
+// 원격 명령의 hardware 구간. Lease 를 받은 뒤에만 이 thread 를 hardware cpu / priority 로 올리고 (기다리는 동안은
+// session worker 의 보통 scheduling), 놓기 전에 되돌린다
+struct SpiwriteCommand::RemoteLease
+{
+    explicit RemoteLease(int expire_ms = 0)
+        : lease(HardwareArbiter::Priority::Remote, expire_ms), rt(Rt::Role::Hardware) {}
+
+    bool Valid() const { return lease.Valid(); }
+
+    HardwareArbiter::Lease lease;
+    Rt::RoleScope rt;
+};
+
 // 16진수 문자열을 주소로 변환하는 함수
 uintptr_t hexStringToAddress(const std::string_view& hex_str) {
     uintptr_t address;
@@ -154,31 +181,143 @@ void busyWaitUsingValue(uintptr_t BUSY_CHECK) {
 }
 
 
+static RegisterBackend* default_backend = nullptr;
+
+void MemoryWriter::setDefaultBackend(RegisterBackend* backend) {
+    default_backend = backend;
+}
+
+void MemoryWriter::initializeLazy(uintptr_t base_addr, size_t size) {
+    lazy_address = base_addr;
+    lazy_size = size;
+    lazy_mapped = false;
+    lazy_requested = true;
+}
+
+bool MemoryWriter::ensureInitialized() {
+    if (!lazy_requested.load(std::memory_order_acquire)) return true;
+    if (lazy_mapped.load(std::memory_order_acquire)) return true;
+
+    std::lock_guard<std::mutex> lock(lazy_mutex);
+    if (lazy_mapped.load(std::memory_order_relaxed)) return true;
+
+    if (!mapRegion(lazy_address, lazy_size)) {
+        fprintf(stderr, "register mapping 0x%08lx (+0x%zx) failed, access rejected\n",
+            static_cast<unsigned long>(lazy_address), lazy_size);
+        return false;
+    }
+    lazy_mapped.store(true, std::memory_order_release);
+    return true;
+}
+
+bool MemoryWriter::initializeBackend(uintptr_t base_addr, size_t size, RegisterBackend* backend_) {
+    lazy_requested = false;
+    return attachBackend(base_addr, size, backend_);
+}
+
+bool MemoryWriter::attachBackend(uintptr_t base_addr, size_t size, RegisterBackend* backend_) {
+    if (backend_ == nullptr) return false;
+
+    backend = backend_;
+    mapped_address = base_addr;
+    mapped_size = size;
+    return true;
+}
+
 bool MemoryWriter::initialize(uintptr_t base_addr, size_t size) {
+    lazy_requested = false;
+    return mapRegion(base_addr, size);
+}
+
+bool MemoryWriter::mapRegion(uintptr_t base_addr, size_t size) {
+    if (default_backend != nullptr) {
+        return attachBackend(base_addr, size, default_backend);
+    }
+
     size_t page_size = sysconf(_SC_PAGESIZE);
     uintptr_t page_base = base_addr & ~(page_size - 1);
-    mapped_size = ((size + page_size - 1) / page_size) * page_size;
+    size_t new_size = ((size + (base_addr - page_base) + page_size - 1) / page_size) * page_size;
     
-    mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (mem_fd == -1) {
+    int fd = open("/dev/mem", O_RDWR | O_SYNC);
+    if (fd == -1) {
         std::cerr << "Failed to open /dev/mem: " << strerror(errno) << std::endl;
         return false;
     }
     
-    mapped_base = mmap(0, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, page_base);
-    if (mapped_base == MAP_FAILED) {
+    void* base = mmap(0, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, page_base);
+    if (base == MAP_FAILED) {
         std::cerr << "Failed to mmap: " << strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    if (mapped_base != nullptr) {
+        munmap(mapped_base, mapped_size);
+    }
+    if (mem_fd != -1) {
         close(mem_fd);
-        mem_fd = -1;
+    }
+
+    mem_fd = fd;
+    mapped_base = base;
+    mapped_size = new_size;
+    mapped_address = page_base;
+    backend = nullptr;
+    return true;
+}
+
+bool MemoryWriter::initializeAnonymous(uintptr_t base_addr, size_t size) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t page_base = base_addr & ~(page_size - 1);
+    size_t new_size = ((size + (base_addr - page_base) + page_size - 1) / page_size) * page_size;
+
+    lazy_requested = false;
+    void* base = mmap(0, new_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "Failed to mmap anonymous: " << strerror(errno) << std::endl;
         return false;
     }
-    
+
+    if (mapped_base != nullptr) {
+        munmap(mapped_base, mapped_size);
+    }
+    if (mem_fd != -1) {
+        close(mem_fd);
+        mem_fd = -1;
+    }
+
+    mapped_base = base;
+    mapped_size = new_size;
     mapped_address = page_base;
+    backend = nullptr;
+    return true;
+}
+
+bool MemoryWriter::prefault() {
+    if (!ensureInitialized()) return false;
+
+    std::lock_guard<std::mutex> lock(write_mutex);
+
+    if (backend != nullptr) return true;
+    if (mapped_base == nullptr) return false;
+
+    // /dev/mem mapping 은 mmap 때 page table 이 이미 다 만들어진다 (remap_pfn_range).
+    // register 는 read 에도 side effect 가 있을 수 있으니 건드리지 않는다
+    if (mem_fd != -1) return true;
+
+    // anonymous mapping (benchmark) 은 page 마다 한 번 써서 실제 page 를 붙인다
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    volatile uint8_t* p = static_cast<volatile uint8_t*>(mapped_base);
+    for (size_t off = 0; off < mapped_size; off += page_size) {
+        p[off] = p[off];
+    }
     return true;
 }
 
 bool MemoryWriter::readMemory(uintptr_t target_address, uint32_t& out_value) 
 {
+    if (!ensureInitialized()) return false;
+
     std::lock_guard<std::mutex> lock(write_mutex); // write_mutex 재사용
 
     // 정렬 확인
@@ -194,6 +333,10 @@ bool MemoryWriter::readMemory(uintptr_t target_address, uint32_t& out_value)
         return false;
     }
 
+    if (backend != nullptr) {
+        return backend->Read(target_address, out_value);
+    }
+
     volatile uint32_t* addr = reinterpret_cast<volatile uint32_t*>(
         static_cast<uint8_t*>(mapped_base) + (target_address - mapped_address));
 
@@ -204,10 +347,27 @@ bool MemoryWriter::readMemory(uintptr_t target_address, uint32_t& out_value)
     return true;
 }
 
+// 성공한 write 마다. bus 는 lock 없는 layout FIFO table 로 (tx 먼저)
+//   FIFO data register(+0x10) : bus 별 word 수 집계
+//   FIFO 밖 register : warm start journal (FIFO word 는 beam 이 send 될 때 engine 이 한 번에 넘긴다)
+static inline void recordWrite(uintptr_t target_address, uint32_t value) {
+    uint32_t reg = 0;
+    int bus = Layout::Registry::Instance().Fifo().Decode(target_address, reg);
+    if (bus >= 0) {
+        if (reg == 0x10) Stats::Registry::Instance().AddWordsWritten(bus);
+        return;
+    }
+    WarmStart::Journal::Instance().OnWrite(target_address, value);
+}
+
 bool MemoryWriter::writeMemory(uintptr_t target_address, uint32_t value) {
-    if (mem_fd == -1 || mapped_base == nullptr) {
+    if (!ensureInitialized()) return false;
+
+    if (mapped_base == nullptr && backend == nullptr) {
         // 초기화되지 않은 경우 간단한 방식으로 처리
-        return writeMemoryDirect(target_address, value);
+        bool ok = writeMemoryDirect(target_address, value);
+        if (ok) recordWrite(target_address, value);
+        return ok;
     }
     
     std::lock_guard<std::mutex> lock(write_mutex);
@@ -225,6 +385,12 @@ bool MemoryWriter::writeMemory(uintptr_t target_address, uint32_t value) {
         return false;
     }
     
+    if (backend != nullptr) {
+        bool ok = backend->Write(target_address, value);
+        if (ok) recordWrite(target_address, value);
+        return ok;
+    }
+
     volatile uint32_t* addr = reinterpret_cast<volatile uint32_t*>(
         static_cast<uint8_t*>(mapped_base) + (target_address - mapped_address));
         
@@ -234,12 +400,51 @@ bool MemoryWriter::writeMemory(uintptr_t target_address, uint32_t value) {
     __sync_synchronize();
     *addr = value;
     __sync_synchronize();
+
+    recordWrite(target_address, value);
     
     return true;
 }
 
-std::map<int, std::deque<uint8_t>> byte_queues;
-std::map<int, std::mutex> queue_mutexes;
+
+bool MemoryWriter::writeFifo(int bus, uintptr_t base_address, const uint32_t* words, size_t count) {
+    if (count == 0) return true;
+    if (!ensureInitialized()) return false;
+
+    uintptr_t data_address = base_address + 0x10;
+    if (mapped_base == nullptr && backend == nullptr) {
+        for (size_t i = 0; i < count; i++) {
+            if (!writeMemoryDirect(data_address, words[i])) return false;
+        }
+        Stats::Registry::Instance().AddWordsWritten(bus, count);
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex);
+
+    if (data_address % sizeof(uint32_t) != 0 ||
+        data_address < mapped_address ||
+        data_address + sizeof(uint32_t) > mapped_address + mapped_size) {
+        std::cerr << "FIFO address out of mapped range: 0x" << std::hex << data_address << std::endl;
+        return false;
+    }
+
+    size_t written = 0;
+    if (backend != nullptr) {
+        while (written < count && backend->Write(data_address, words[written])) written++;
+    } else {
+        volatile uint32_t* addr = reinterpret_cast<volatile uint32_t*>(
+            static_cast<uint8_t*>(mapped_base) + (data_address - mapped_address));
+        for (; written < count; written++) {
+            __sync_synchronize();
+            *addr = words[written];
+            __sync_synchronize();
+        }
+    }
+
+    Stats::Registry::Instance().AddWordsWritten(bus, written);
+    return written == count;
+}
 
 
 
@@ -259,40 +464,66 @@ struct BinaryWriteCommand {
 };
 
 
-int count__ = 1;
+// 원격 beam 은 첫 datagram 의 수신 시각부터 (session worker 밖에서 부르면 지금부터)
+static uint64_t BeamStartNs()
+{
+    uint64_t t0 = Trace::Tracer::Received();
+    return t0 ? t0 : Trace::NowNs();
+}
+
+static const char* REMOTE_TXN_LOST = "remote transaction expired, beam rejected (send start again)";
+
 Result SpiwriteCommand::parse_binary_commands(const std::vector<uint8_t>& binary_data) {     
-    size_t available_data = binary_data.size() - 3;
-    size_t max_possible_cmds = available_data / 2;    
     size_t offset = 3;
     int parsed_count = 1;
-    uint8_t bus_id = 0;
     uint8_t ucIcAddr = 0;
     uint8_t ucRegisterAddr;
     uint16_t value;
     uintptr_t base_address;
-    int previous_bus_id = 0;
-    uintptr_t prev_base_address;
-    const std::vector<uint8_t> register_addrs = {0x27, 0x3F, 0x47, 0x5F};
-    size_t reg_idx = 0;
     int command_count = 1;
+
+    // payload 의 value 순서는 layout 의 bus 순서 (bus, chip, channel). BINARY 는 tx register 기준
+    auto layout = Layout::Registry::Instance().Get(1);
+    const Layout::Compiled& L = *layout;
+    size_t slot = 0;
+    int bus_id = 0;
+    while (bus_id < L.num_bus && L.BusSize(bus_id) == 0) bus_id++;
+
+    if (RemoteTxnLost()) return Result{REMOTE_TXN_LOST};
+
+    // bus 중간에서 끝난 이전 payload 의 나머지 byte 가 남아 있을 수 있다
+    for (auto& [bus, q] : byte_queues_) q.clear();
+    fifo_word_count_ = 1;
+
+    // pack 과 FIFO write 가 섞여 있으므로 pack 구간만 따로 누적
+    auto parse_t0 = Trace::NowNs();
+    Trace::Span pack_span;
     
-    while (offset + 1 <= binary_data.size()) 
+    while (offset + 1 < binary_data.size() && slot < L.Size()) 
     {
-        ucRegisterAddr = register_addrs[reg_idx];
+        ucIcAddr = L.chip[slot];
+        ucRegisterAddr = L.channel[slot];
         value = (binary_data[offset] << 8) | binary_data[offset + 1];
         
-        base_address = 0x43c40000 + (bus_id * 0x10000);
+        base_address = L.FifoAddress(bus_id);
         printf(";bus_id(%d), base_address(0x%08X)\n", bus_id, base_address);
 
         // 현재 bus_id로 데이터를 큐에 추가
-        byte_queues[bus_id].push_back(0x28);
-        byte_queues[bus_id].push_back(ucIcAddr);
-        byte_queues[bus_id].push_back(ucRegisterAddr);
-        byte_queues[bus_id].push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
-        byte_queues[bus_id].push_back(static_cast<uint8_t>(value & 0xFF));
+        pack_span.Start();
+        byte_queues_[bus_id].push_back(0x28);
+        byte_queues_[bus_id].push_back(ucIcAddr);
+        byte_queues_[bus_id].push_back(ucRegisterAddr);
+        byte_queues_[bus_id].push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+        byte_queues_[bus_id].push_back(static_cast<uint8_t>(value & 0xFF));
 
         // 현재 bus의 큐 처리
-        auto& q = byte_queues[bus_id];
+        auto& q = byte_queues_[bus_id];
+        slot++;
+        bool bus_end = (slot == L.bus_begin[bus_id + 1]);
+
+        // bus 의 마지막 element 에서 4 byte 가 안 되는 나머지는 0 으로 채워서 보낸다
+        while (bus_end && q.size() % 4 != 0) q.push_back(0);
+
         while (q.size() >= 4) 
         {
             uint32_t data = 0;
@@ -301,10 +532,11 @@ Result SpiwriteCommand::parse_binary_commands(const std::vector<uint8_t>& binary
                 data |= q.front();
                 q.pop_front();
             }
+            pack_span.Stop();
             
             wr.writeMemory(base_address + 0x0010, data);
             // std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            printf(";----count : %d ----\n", count__++);
+            printf(";----count : %d ----\n", fifo_word_count_++);
             printf("sendln \"devmem 0x%08x 32 0x%02x%02x%02x%02x\"\n",
                    base_address + 0x0010,
                    (data >> 24) & 0xFF,
@@ -314,112 +546,265 @@ Result SpiwriteCommand::parse_binary_commands(const std::vector<uint8_t>& binary
             printf("mpause 10\n");
             
             // printf("mpause 1\n");
+            pack_span.Start();
         }
+        pack_span.Stop();
 
         // 다음 레지스터/IC/버스 계산
-        reg_idx++;
-        if (reg_idx >= 4) 
+        if (bus_end) 
         {
-            reg_idx = 0;
-            ucIcAddr++;
-            if (ucIcAddr > 0x1F) 
-            {
-                ucIcAddr = 0;
-                
-                // 현재 bus 종료 처리
-                wr.writeMemory(base_address + 0x0014, 0x280);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x280\"\n", base_address + 0x0014);
-                printf("mpause 10\n");
+            // 현재 bus 종료 처리 : length = element 수 x 5 byte (128 element -> 0x280)
+            uint32_t length = (uint32_t)(L.BusSize(bus_id) * 5);
+            wr.writeMemory(base_address + 0x0014, length);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            printf("sendln \"devmem 0x%08x 32 0x%x\"\n", base_address + 0x0014, length);
+            printf("mpause 10\n");
 
-                // 인터럽트 상태 확인
-                uint32_t interrupt_value;
-                wr.readMemory(base_address, interrupt_value);
+            // 인터럽트 상태 확인. 지우기 전에 읽어서 HealthMonitor 가 돌고 있으면 overflow bit 를 넘긴다
+            uint32_t interrupt_value = Health::LatchIsr(wr, bus_id, base_address);
+            if (!Health::Active()) {
                 printf(";base_address => 0X%08x interrupt_value => 0x%08x\n", base_address, interrupt_value);
                 printf("mpause 10\n");
-                // while (true)
-                // {
-                //     uint32_t interrupt_value;
-                //     if (!wr.readMemory(base_address, interrupt_value)) {
-                //         printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(base_address));
-                //         break;
-                //     }
-                
-                //     if (interrupt_value == 0) 
-                //     {
-                //         printf(";interrupt check ok !\n");
-                //         break;
-                //     }
-                
-                //     printf("mpause 100\n");
-                //     std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                // }
-
-                // 인터럽트 초기화
-                wr.writeMemory(base_address, 0xffffffff);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0xffffffff\"\n", base_address);
-                printf("mpause 10\n");
+            }
 
-                // 남은 FIFO DATA SIZE 확인
+            // 인터럽트 초기화
+            wr.writeMemory(base_address, 0xffffffff);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            printf("sendln \"devmem 0x%08x 32 0xffffffff\"\n", base_address);
+            printf("mpause 10\n");
+
+            // 남은 FIFO DATA SIZE 확인
+            if (!Health::Active()) {
                 uint32_t remaining_fifo_data_size;
-                wr.readMemory(base_address + 0xC, remaining_fifo_data_size);
+                if (wr.readMemory(base_address + 0xC, remaining_fifo_data_size) && remaining_fifo_data_size == 0) {
+                    Stats::Inc(Stats::Counter::FifoFullStalls);
+                }
                 printf(";remaining_fifo_data_size => 0x%08x\n", remaining_fifo_data_size);
                 printf("mpause 10\n");
+            }
 
-                // while (true)
-                // {
-                //     uint32_t remaining_fifo_data_size;
-                //     if (!wr.readMemory(base_address + 0xC, remaining_fifo_data_size)) {
-                //         printf("Failed to read memory at address 0x%08lx\n", static_cast<unsigned long>(base_address));
-                //         break;
-                //     }
-                
-                //     if (remaining_fifo_data_size == 0x15E) 
-                //     {
-                //         printf(";remaining_fifo_data_size is 0x15E ok!\n");
-                //         break;
-                //     }
-                
-                //     printf("mpause 100\n");
-                //     std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                // }
-
-                // 다음 bus로 이동
-                bus_id++;
-                if (bus_id > 0x07) {
-                    break;
-                }
-                
-                // 새로운 bus 시작 처리
-                base_address = 0x43c40000 + (bus_id * 0x10000);
-                uint32_t init_value_ = 0x2;
-                wr.writeMemory(base_address + 0x2C, init_value_);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                printf("sendln \"devmem 0x%08x 32 0x%01X\"\n", base_address + 0x2C, init_value_);
-                printf("mpause 10\n");
-                
-                // count 리셋
-                count__ = 1;
+            // 다음 bus로 이동
+            bus_id++;
+            while (bus_id < L.num_bus && L.BusSize(bus_id) == 0) bus_id++;
+            if (bus_id >= L.num_bus) {
+                break;
             }
+
+            // bus 사이에서 transaction 확인 (queue 는 bus 끝에서 비어 있다)
+            if (RemoteTxnLost()) return Result{REMOTE_TXN_LOST};
+            
+            // 새로운 bus 시작 처리
+            base_address = L.FifoAddress(bus_id);
+            uint32_t init_value_ = 0x2;
+            wr.writeMemory(base_address + 0x2C, init_value_);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            printf("sendln \"devmem 0x%08x 32 0x%01X\"\n", base_address + 0x2C, init_value_);
+            printf("mpause 10\n");
+            
+            // count 리셋
+            fifo_word_count_ = 1;
         }
 
         offset += 2;
         parsed_count++;
     }
 
+    pack_span.Commit(Trace::Stage::Pack);
+    Trace::Tracer::Instance().Record(Trace::Stage::FifoFill, Trace::NowNs() - parse_t0 - pack_span.Total());
+
     return Result{"001"};
 }
 
-// 기본 생성자 구현
+Result SpiwriteCommand::parse_phase6_command(const uint8_t* data, size_t size)
+{
+    int is_tx = data[0] == BeamPipeline::PHASE6_MODE_TX;
+    auto layout = Layout::Registry::Instance().Get(is_tx);
+    if (size != 1 + BeamPipeline::Phase6Bytes(layout->Size())) {
+        Stats::Inc(Stats::Counter::DecodeErrors);
+        return Result{Common::string_format("phase6 size mismatch : %zu bytes, expected %zu", size, 1 + BeamPipeline::Phase6Bytes(layout->Size()))};
+    }
+
+    // inflate 도 byte queue 도 없이 phase 를 풀어 바로 bus word 로
+    SwBeamEngine& engine = Engine();
+    PreparedBeam& beam = *phase6_beam_;
+    beam.is_tx = is_tx;
+    beam.layout = layout;
+    beam.phase_idx.resize(layout->Size());
+    auto phase_t0 = Trace::NowNs();
+    BeamPipeline::UnpackPhases6(data + 1, layout->Size(), beam.phase_idx.data());
+    Trace::Tracer::Instance().Record(Trace::Stage::PhaseCompute, Trace::NowNs() - phase_t0);
+    SwBeamEngine::Pack(beam);
+
+    RemoteLease lease;
+    if (!LoadRemote(engine, beam)) return Result{REMOTE_TXN_LOST};
+    return Result{"001"};
+}
+
+// 전체 element 를 담은 raw payload (3 byte header + element 마다 2 byte) 를 bus word 로 만들어 cache 에 넣는다
+static void CacheBinaryPayload(uint64_t hash, const uint8_t* payload, size_t size, const std::vector<uint8_t>& raw)
+{
+    auto& cache = Cache::PayloadCache::Instance();
+    auto layout = Layout::Registry::Instance().Get(1);
+    const Layout::Compiled& L = *layout;
+    if (!cache.Enabled() || raw.size() < 3 + 2 * L.Size()) return;
+
+    auto beam = std::make_shared<PreparedBeam>();
+    beam->is_tx = 1;
+    beam->layout = layout;
+    beam->words.resize(L.num_bus);
+    beam->bytes.assign(L.num_bus, 0);
+    for (int bus = 0; bus < L.num_bus; bus++)
+    {
+        if (L.BusSize(bus) == 0) continue;
+        beam->bytes[bus] = (uint32_t)BeamPipeline::PackBusValues(L, raw.data() + 3, bus, beam->words[bus]);
+    }
+    beam->send_mask = L.SendMask();
+    cache.Insert(hash, payload, size, raw.size(), std::move(beam));
+}
+
+Result SpiwriteCommand::parse_bus_streams(const uint8_t* data, size_t size, std::shared_ptr<const PreparedBeam>* out)
+{
+    // BINARY 는 tx register 기준 (parse_binary_commands 와 같은 layout)
+    auto layout = Layout::Registry::Instance().Get(1);
+    const Layout::Compiled& L = *layout;
+
+    std::vector<BusStreams::Stream> streams;
+    std::string err;
+    if (!BusStreams::Parse(data, size, L.num_bus, streams, &err)) {
+        Stats::Inc(Stats::Counter::DecodeErrors);
+        return Result{"bus stream error : " + err};
+    }
+
+    while ((int)bus_engines_.size() < L.num_bus) {
+        bus_engines_.push_back(std::make_unique<SwBeamEngine>(wr));
+        bus_engines_.back()->SetScript(false);
+    }
+    bus_values_.resize(2 * L.Size());
+
+    auto beam = std::make_shared<PreparedBeam>();
+    beam->is_tx = 1;
+    beam->layout = layout;
+    beam->words.resize(L.num_bus);
+    beam->bytes.assign(L.num_bus, 0);
+    beam->send_mask = L.SendMask();
+    std::vector<uint8_t> failed(L.num_bus, 0);
+    std::vector<std::string> errors(L.num_bus);     // inflate / pack / LoadBus 가 던진 예외
+
+    // bus 마다 inflate -> pack -> FIFO fill 을 따로 진행. 앞 bus 의 inflate 를 기다리지 않는다.
+    // 병렬인 것은 inflate / pack 뿐이고, FIFO write 는 MemoryWriter 의 write_mutex 에서 한 번에 하나씩
+    auto fill_t0 = Trace::NowNs();
+    bool lost = false;
+    {
+        RemoteLease lease;
+        if (RemoteTxnLost()) return Result{REMOTE_TXN_LOST};
+
+        // worker 는 remote_txn_ 을 바꾸지 않고 확인만 한다
+        const RemoteLease* txn = remote_txn_.get();
+        BusStreams::Pool::Instance().Run(L.num_bus, [&](int bus) {
+            if (L.BusSize(bus) == 0) return;
+
+            try {
+                auto inflate_t0 = Trace::NowNs();
+                if (!BusStreams::Inflate(streams[bus], bus_values_.data() + 2 * L.bus_begin[bus], 2 * L.BusSize(bus))) {
+                    failed[bus] = 1;
+                    return;
+                }
+                Trace::Tracer::Instance().Record(Trace::Stage::Decompress, Trace::NowNs() - inflate_t0);
+
+                beam->bytes[bus] = (uint32_t)BeamPipeline::PackBusValues(L, bus_values_.data(), bus, beam->words[bus]);
+                if (txn && !txn->Valid()) return;
+                bus_engines_[bus]->LoadBus(*beam, bus);
+            } catch (const std::exception& e) {
+                failed[bus] = 1;
+                errors[bus] = e.what();
+            } catch (...) {
+                failed[bus] = 1;
+                errors[bus] = "unknown exception";
+            }
+        });
+        lost = RemoteTxnLost();
+    }
+    Trace::Tracer::Instance().Record(Trace::Stage::FifoFill, Trace::NowNs() - fill_t0);
+    if (lost) return Result{REMOTE_TXN_LOST};
+
+    // 실패한 bus 는 FIFO 를 다 채우지 못했다. 나머지는 이미 올라가 있으므로 done 을 보내지 말 것
+    std::string bad;
+    for (int bus = 0; bus < L.num_bus; bus++) {
+        if (!failed[bus]) continue;
+        bad += " " + std::to_string(bus);
+        if (!errors[bus].empty()) bad += " (" + errors[bus] + ")";
+    }
+    if (!bad.empty()) {
+        Stats::Inc(Stats::Counter::DecodeErrors);
+        return Result{"bus stream failed : bus" + bad};
+    }
+
+    if (out) *out = beam;
+    return Result{"001"};
+}
+
+bool SpiwriteCommand::RemoteTxnLost()
+{
+    if (remote_txn_ && !remote_txn_->Valid()) {
+        // 회수된 Lease 의 해제는 아무 일도 하지 않는다
+        remote_txn_.reset();
+        remote_txn_lost_ = true;
+        printf(";remote transaction expired after %d ms\n", REMOTE_TXN_EXPIRE_MS);
+    }
+    // 거부한 beam 은 end_to_end 에 남기지 않는다
+    if (remote_txn_lost_) Trace::Tracer::AbortBeam();
+    return remote_txn_lost_;
+}
+
+bool SpiwriteCommand::LoadRemote(SwBeamEngine& engine, const PreparedBeam& beam)
+{
+    auto fill_t0 = Trace::NowNs();
+    for (int bus = 0; bus < beam.layout->num_bus; bus++) {
+        if (RemoteTxnLost()) return false;
+        engine.LoadBus(beam, bus);
+    }
+    Trace::Tracer::Instance().Record(Trace::Stage::FifoFill, Trace::NowNs() - fill_t0);
+    return true;
+}
+
+bool SpiwriteCommand::HoldsRemote() const
+{
+    return remote_txn_ && remote_txn_->Valid();
+}
+
+void SpiwriteCommand::AbortRemote()
+{
+    remote_txn_.reset();
+    remote_txn_lost_ = false;
+    Trace::Tracer::AbortBeam();
+}
+
+SwBeamEngine& SpiwriteCommand::Engine()
+{
+    if (!engine_) {
+        engine_ = std::make_unique<SwBeamEngine>(wr);
+        engine_->SetScript(false);
+        phase6_beam_ = std::make_unique<PreparedBeam>();
+        text_beam_ = std::make_unique<PreparedBeam>();
+    }
+    return *engine_;
+}
+
+SpiwriteCommand::~SpiwriteCommand() = default;
+
 SpiwriteCommand::SpiwriteCommand(Controller::Transport& transport, 
     Controller::CodeGenerator* cgen, 
     Parser::LineParser* parser)
-: transport_(transport), code_generator_(cgen), parser_(parser)
+: SpiwriteCommand(cgen, parser)
+{
+    transport_ = &transport;
+}
+
+// 기본 생성자 구현
+SpiwriteCommand::SpiwriteCommand(Controller::CodeGenerator* cgen, 
+    Parser::LineParser* parser)
+: wr(HardwareContext::Instance().Writer()), transport_(nullptr), code_generator_(cgen), parser_(parser)
 {
-    // Address total 0x43c00000 => 0x43c40000(bus0) ~ 0x43cb0000(bus7)
-    wr.initialize(BASE_ADDR, 0xC0000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
 
  #if 0
     printf("rx 패널 초기화 시작 !!!!\n");
@@ -936,13 +1321,23 @@ Result SpiwriteCommand::parse_text_commands(const std::vector<std::string_view>&
 
     if ( cmd == "start")
     {
+        // 만료된 transaction 은 버리고 새로 잡는다
+        if (remote_txn_ && !remote_txn_->Valid()) remote_txn_.reset();
+        remote_txn_lost_ = false;
+        if (!remote_txn_) {
+            remote_txn_ = std::make_unique<RemoteLease>(REMOTE_TXN_EXPIRE_MS);
+        }
+
+        // end_to_end / rusage 는 start 부터 done 완료까지 한 beam 으로
+        Trace::Tracer::BeginBeam(BeamStartNs());
+
         printf("\n++++++++++++++++++++++++\n");
         printf("[sch] start\n");
         printf("++++++++++++++++++++++++\n");
 
         count = 0;
-        uintptr_t base_addr = 0x43c40000;
-        uintptr_t init_addr = 0x43c4002c;
+        // BINARY 는 tx register 기준이므로 tx layout 의 첫 FIFO
+        uintptr_t init_addr = Layout::Registry::Instance().Get(1)->FifoAddress(0) + 0x2C;
         uint32_t init_value = 0x2;
         wr.writeMemory(init_addr, init_value);
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -954,10 +1349,23 @@ Result SpiwriteCommand::parse_text_commands(const std::vector<std::string_view>&
 
     if ( cmd == "done")
     {
+        // start 없이 온 done 도 trigger 구간은 다른 경로와 섞이지 않게
+        RemoteLease lease;
+        // FIFO 에 올린 뒤 transaction 을 잃었으면 다른 경로의 data 와 섞였을 수 있으므로 쏘지 않는다
+        if (RemoteTxnLost()) {
+            remote_txn_lost_ = false;
+            return Result{REMOTE_TXN_LOST};
+        }
         printf("++++++++++++++++++++++++\n");
         printf("=======axi_fifo_write_done=====\n");
         printf("++++++++++++++++++++++++\n");
 
+        // send mask 와 vacancy 를 읽을 FIFO 는 BINARY 를 채운 tx layout 에서
+        auto layout = Layout::Registry::Instance().Get(1);
+        const Layout::Compiled& L = *layout;
+
+        auto trigger_t0 = Trace::NowNs();
+
         // Send Length
         uintptr_t length_addr = 0x43c00018; 
         uint32_t length_value = 0x5;
@@ -974,14 +1382,22 @@ Result SpiwriteCommand::parse_text_commands(const std::vector<std::string_view>&
         printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", addr_1c, value_1c);
         printf("mpause 10\n");
 
-        // FIFO 1~8 SEND : 0Xff
+        // trigger 사이의 sleep 동안 잃었는지 한 번 더
+        if (RemoteTxnLost()) {
+            remote_txn_lost_ = false;
+            return Result{REMOTE_TXN_LOST};
+        }
+
+        // layout 의 모든 FIFO SEND
         uintptr_t send_addr = 0x43c00014;
-        uint32_t send_value = 0xff;
+        uint32_t send_value = L.SendMask();
         wr.writeMemory(send_addr, send_value);
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
         printf("sendln \"devmem 0x%08x 32 0x%01x\"\n", send_addr, send_value);
         printf("mpause 10\n");
 
+        auto completion_t0 = Trace::NowNs();
+        Trace::Tracer::Instance().Record(Trace::Stage::Trigger, completion_t0 - trigger_t0);
 
         // 남은 FIFO DATA SIZE 확인
         while (true)
@@ -999,47 +1415,247 @@ Result SpiwriteCommand::parse_text_commands(const std::vector<std::string_view>&
                 printf(";ok fifo send all completed !\n");
                 break;
             }
-        
+
+            Stats::Inc(Stats::Counter::SendBusyPolls);
             printf("mpause 100\n");
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
 
-        uint32_t fifo_1_remaining_size;
-        uint32_t fifo_2_remaining_size;
-        uint32_t fifo_3_remaining_size;
-        uint32_t fifo_4_remaining_size;
-        uint32_t fifo_5_remaining_size;
-        uint32_t fifo_6_remaining_size;
-        uint32_t fifo_7_remaining_size;
-        uint32_t fifo_8_remaining_size;
-        wr.readMemory(0x43c4000c, fifo_1_remaining_size);
-        printf(";now fifo 1 remaining size -> %d\n", fifo_1_remaining_size);
-        printf("mpause 10\n");
-        wr.readMemory(0x43c5000c, fifo_2_remaining_size);
-        printf(";now fifo 2 remaining size -> %d\n", fifo_2_remaining_size);
-        printf("mpause 10\n");
-        wr.readMemory(0x43c6000c, fifo_3_remaining_size);
-        printf(";now fifo 3 remaining size -> %d\n", fifo_3_remaining_size);
-        printf("mpause 10\n");
-        wr.readMemory(0x43c7000c, fifo_4_remaining_size);
-        printf(";now fifo 4 remaining size -> %d\n", fifo_4_remaining_size);
-        printf("mpause 10\n");
-        wr.readMemory(0x43c8000c, fifo_5_remaining_size);
-        printf(";now fifo 5 remaining size -> %d\n", fifo_5_remaining_size);
-        printf("mpause 10\n");
-        wr.readMemory(0x43c9000c, fifo_6_remaining_size);
-        printf(";now fifo 6 remaining size -> %d\n", fifo_6_remaining_size);
-        printf("mpause 10\n");
-        wr.readMemory(0x43ca000c, fifo_7_remaining_size);
-        printf(";now fifo 7 remaining size -> %d\n", fifo_7_remaining_size);
-        printf("mpause 10\n");
-        wr.readMemory(0x43cb000c, fifo_8_remaining_size);
-        printf(";now fifo 8 remaining size -> %d\n", fifo_8_remaining_size);
-        printf("mpause 10\n");
+        Trace::Tracer::Instance().Record(Trace::Stage::Completion, Trace::NowNs() - completion_t0);
+        Trace::Tracer::EndBeam();
+        Stats::Inc(Stats::Counter::BeamsApplied);
+
+        // HealthMonitor 가 돌고 있으면 register 를 다시 읽지 않고 snapshot 을 남긴다
+        if (Health::Active()) {
+            printf(";%s\n", Health::Monitor::Instance().Report().c_str());
+            remote_txn_.reset();
+            return Result{"done complete"};
+        }
+
+        for (int bus = 0; bus < L.num_bus; bus++)
+        {
+            uint32_t remaining_size = 0;
+            wr.readMemory(L.FifoAddress(bus) + 0xc, remaining_size);
+            printf(";now fifo %d remaining size -> %d\n", bus + 1, remaining_size);
+            printf("mpause 10\n");
+        }
 
+        remote_txn_.reset();
         return Result{"done complete"};
 
     }
+
+    if ( cmd == "beam")
+    {
+        // beam <tx|rx> <az> <el> [freq_GHz] : phase 계산부터 send 완료까지 controller 에서 (start / BINARY / done 한 번에)
+        auto number = [](std::string_view s, double& v) {
+            auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+            return r.ec == std::errc() && r.ptr == s.data() + s.size();
+        };
+
+        double az = 0, el = 0, freq_ghz = 0;
+        if (tokens.size() < 4 || (tokens[1] != "tx" && tokens[1] != "rx") ||
+            !number(tokens[2], az) || !number(tokens[3], el) ||
+            (tokens.size() > 4 && !number(tokens[4], freq_ghz))) {
+            return Result{ "usage : beam <tx|rx> <az> <el> [freq_GHz]" };
+        }
+
+        // from_chars 는 nan / inf / 1e300 도 받는다. phase 계산 전에 범위 밖은 거절
+        std::string range_err;
+        if (!BeamPipeline::ValidSteering(az, el, &range_err) ||
+            (tokens.size() > 4 && !BeamPipeline::ValidFreqGHz(freq_ghz, &range_err))) {
+            return Result{ "beam : " + range_err };
+        }
+
+        int is_tx = tokens[1] == "tx";
+        long long unsigned freq = freq_ghz > 0 ? (long long unsigned)(freq_ghz * 1e9 + 0.5) : 0;
+
+        SwBeamEngine& engine = Engine();
+        PreparedBeam& beam = *text_beam_;
+
+        auto t0 = Trace::NowNs();
+        Trace::Tracer::BeginBeam(BeamStartNs());
+
+        bool cached = !beam.words.empty() && beam.is_tx == is_tx && beam.az == (float)az && beam.el == (float)el &&
+                      beam.freq == (freq ? freq : is_tx ? 29500000000ULL : 19700000000ULL) &&
+                      beam.layout == Layout::Registry::Instance().Get(is_tx);
+        if (cached) {
+            Stats::Inc(Stats::Counter::BeamReuseHits);
+        } else {
+            Stats::Inc(Stats::Counter::BeamReuseMisses);
+            SwBeamEngine::Prepare(is_tx, (float)az, (float)el, beam, freq);
+        }
+        auto t1 = Trace::NowNs();
+
+        bool completed;
+        uint64_t t2;
+        {
+            RemoteLease lease;
+            engine.Load(beam);
+            t2 = Trace::NowNs();
+            completed = engine.Fire(beam);
+        }
+        auto t3 = Trace::NowNs();
+        Trace::Tracer::EndBeam();
+
+        return Result{ Common::string_format("beam %s az %.2f el %.2f freq %.3f GHz%s : prepare %.1f us%s, load %.1f us, fire %.1f us, total %.1f us",
+            is_tx ? "tx" : "rx", az, el, beam.freq / 1e9, completed ? "" : " (send not completed)",
+            (t1 - t0) / 1e3, cached ? " (cached)" : "", (t2 - t1) / 1e3, (t3 - t2) / 1e3, (t3 - t0) / 1e3) };
+    }
+
+    if ( cmd == "cache")
+    {
+        // cache [clear | size <entries>] : BINARY payload cache
+        auto& cache = Cache::PayloadCache::Instance();
+        if (tokens.size() > 1 && tokens[1] == "clear")
+        {
+            cache.Clear();
+            return Result{ "cache cleared" };
+        }
+        if (tokens.size() > 2 && tokens[1] == "size")
+        {
+            size_t entries = 0;
+            auto r = std::from_chars(tokens[2].data(), tokens[2].data() + tokens[2].size(), entries);
+            if (r.ec != std::errc() || r.ptr != tokens[2].data() + tokens[2].size() || entries > Cache::PayloadCache::MAX_CAPACITY)
+                return Result{ Common::string_format("usage : cache [clear | size <0 ~ %zu>]", Cache::PayloadCache::MAX_CAPACITY) };
+            cache.SetCapacity(entries);
+        }
+        return Result{ cache.Report() };
+    }
+
+    if ( cmd == "zdict")
+    {
+        // zdict [load <file> | off] : FDICT zlib stream 용 preset dictionary. 응답의 id 가 DICTID
+        auto& dict = ZDict::Dictionary::Instance();
+        if (tokens.size() > 2 && tokens[1] == "load")
+        {
+            std::string err;
+            if (!dict.Load(std::string(tokens[2]), &err))
+                return Result{ "zdict load failed : " + err };
+        }
+        else if (tokens.size() > 1 && tokens[1] == "off")
+        {
+            dict.Clear();
+        }
+        return Result{ dict.Report() };
+    }
+
+    if ( cmd == "stats")
+    {
+        if (tokens.size() > 1 && tokens[1] == "reset")
+        {
+            Stats::Registry::Instance().Reset();
+            return Result{ "stats reset" };
+        }
+
+        return Result{ Stats::Registry::Instance().Report() };
+    }
+
+    if ( cmd == "layout")
+    {
+        // layout [file] : panel layout 다시 읽기 / 현재 layout 출력
+        if (tokens.size() > 1)
+        {
+            std::string err;
+            if (!Layout::Registry::Instance().Load(std::string(tokens[1]), &err))
+            {
+                return Result{ "layout load failed : " + err };
+            }
+        }
+        return Result{ Layout::Registry::Instance().Report() };
+    }
+
+    if ( cmd == "trig")
+    {
+        // trig [az_step] [el_step] : sin/cos table 정확도와 float 경로 대비 kernel 별 phase index 차이.
+        // session worker 에서 동기로 도는 원격 명령이라 5 도 grid (1368 방향) 까지만 받는다.
+        // 촘촘한 grid 전체 비교는 offline 으로 : CodebookCheck --compare=<az_step>:<el_step>
+        constexpr float TRIG_MIN_STEP = 5.0f;
+        auto step = [](std::string_view s, float& v) {
+            auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+            return r.ec == std::errc() && r.ptr == s.data() + s.size() && v >= TRIG_MIN_STEP && v <= 360.0f;
+        };
+
+        float az_step = 10.0f, el_step = 10.0f;
+        if ((tokens.size() > 1 && !step(tokens[1], az_step)) || (tokens.size() > 2 && !step(tokens[2], el_step))) {
+            return Result{ Common::string_format("usage : trig [az_step] [el_step] (%.1f ~ 360 deg)", TRIG_MIN_STEP) };
+        }
+
+        std::string rep = Trig::Check().Report();
+        const std::pair<const char*, BeamPipeline::IndexKernel> kernels[] = {
+            { "table", BeamPipeline::ComputeIndices },
+            { BeamPipeline::FixedKernelName(), BeamPipeline::ComputeIndicesFixed },
+        };
+        for (auto& kernel : kernels)
+        {
+            for (int is_tx = 1; is_tx >= 0; is_tx--)
+            {
+                size_t total = 0;
+                size_t diff = BeamPipeline::CompareIndices(*Layout::Registry::Instance().Get(is_tx), is_tx, az_step, el_step, &total, kernel.second);
+                rep += Common::string_format("\r\n%-6s %s phase index  %zu / %zu differ (%.4f%%)",
+                    kernel.first, is_tx ? "tx" : "rx", diff, total, total ? 100.0 * diff / total : 0.0);
+            }
+        }
+        return Result{ rep };
+    }
+
+    if ( cmd == "predict")
+    {
+        // predict [elements] [div] [clk_MHz] : 현재 FIFO/SPI 구성으로 beam 완료 시간 예측.
+        // 원격에서도 부를 수 있으므로 SimulateFrame 이 오래 돌거나 map 이 커지는 값은 받지 않는다
+        auto integer = [](std::string_view s, int& v, int lo, int hi) {
+            auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+            return r.ec == std::errc() && r.ptr == s.data() + s.size() && v >= lo && v <= hi;
+        };
+        auto clk = [](std::string_view s, double& v) {
+            auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+            return r.ec == std::errc() && r.ptr == s.data() + s.size() && v > 0 && v <= Timing::MAX_CLK_MHZ;
+        };
+
+        const Layout::Compiled& L = *Layout::Registry::Instance().Get(1);
+        Timing::Params params;
+        int elements = 0;
+        double clk_mhz = params.clk_hz / 1e6;
+        if ((tokens.size() > 1 && !integer(tokens[1], elements, 1, Timing::MAX_ELEMENTS)) ||
+            (tokens.size() > 2 && !integer(tokens[2], params.div, Timing::MIN_DIV, Timing::MAX_DIV)) ||
+            (tokens.size() > 3 && !clk(tokens[3], clk_mhz))) {
+            return Result{ Common::string_format("usage : predict [elements 1~%d] [div %d~%d] [clk_MHz 0~%.0f]",
+                Timing::MAX_ELEMENTS, Timing::MIN_DIV, Timing::MAX_DIV, Timing::MAX_CLK_MHZ) };
+        }
+        params.clk_hz = clk_mhz * 1e6;
+
+        Timing::Model model(params);
+        if (elements == 0)
+        {
+            // 현재 tx layout 의 bus 별 element 수 그대로 (length register 에는 element x frame byte)
+            std::map<int, size_t> bytes;
+            for (int b = 0; b < L.num_bus; b++) {
+                if (L.BusSize(b) > 0) bytes[b] = L.BusSize(b) * params.frame_bytes;
+            }
+            return Result{ model.Predict(bytes).Report() };
+        }
+
+        // element 수만 바꾼 가정 : bus 당 element 수는 layout 의 가장 큰 bus 기준
+        size_t per_bus = 0;
+        for (int b = 0; b < L.num_bus; b++) per_bus = std::max(per_bus, L.BusSize(b));
+        return Result{ model.PredictElements(elements, (int)std::max<size_t>(per_bus, 1)).Report() };
+    }
+
+    if ( cmd == "trace")
+    {
+        if (tokens.size() > 1 && tokens[1] == "reset")
+        {
+            Trace::Tracer::Instance().Reset();
+            return Result{ "trace reset" };
+        }
+
+        if (tokens.size() > 1 && tokens[1] == "dump")
+        {
+            Trace::Tracer::Instance().Dump(stdout);
+        }
+
+        return Result{ Trace::Tracer::Instance().Report() };
+    }
     
     return Result {"what?"};
 }
@@ -1105,6 +1721,8 @@ bool validate_zlib_header(const std::vector<uint8_t>& data) {
 
 // 개선된 압축 해제 함수 (상세한 로그 포함)
 std::vector<uint8_t> decompress_zlib_verbose(const std::vector<uint8_t>& compressed_data) {
+    Trace::Probe probe(Trace::Stage::Decompress);
+
     printf("\n=== Starting zlib decompression ===\n");
     printf("Input size: %zu bytes\n", compressed_data.size());
     
@@ -1184,119 +1802,202 @@ std::vector<uint8_t> decompress_zlib_verbose(const std::vector<uint8_t>& compres
 }
  
 
-Result SpiwriteCommand::Execute(const std::string& raw_command) 
+Result SpiwriteCommand::parse_binary_payload(const std::string& raw_command)
 {
-    // 바이너리 명령어 체크
-    if (raw_command.substr(0, 7) == "BINARY:") 
-    {
-        // 압축된 바이너리 데이터 체크
-        size_t binary_start_pos = 7;
-        std::string compression_type = "";
-
-        printf("compressed size = %d\n", raw_command.size());
-        // "BINARY:" + 최소 2바이트 헤더
-        uint8_t first_byte = static_cast<uint8_t>(raw_command[7]);
-        uint8_t second_byte = static_cast<uint8_t>(raw_command[8]);
-        
-        // zlib 매직 헤더 확인 (일반적으로 0x78로 시작)
-        if (first_byte == 0x78 && (second_byte & 0x20) == 0) { // FDICT=0 확인
-            compression_type = "zlib";
-            binary_start_pos = 7; // "BINARY:" 바로 뒤부터
-            printf("Detected zlib compressed data by magic header: %02X %02X\n", first_byte, second_byte);
+    // 압축된 바이너리 데이터 체크
+    size_t binary_start_pos = 7;
+    std::string compression_type = "";
+
+    printf("compressed size = %d\n", raw_command.size());
+
+    // 전에 받은 것과 같은 payload 면 inflate / parse / pack 없이 저장해 둔 bus word 를 바로 FIFO 에
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(raw_command.data()) + 7;
+    size_t payload_size = raw_command.size() - 7;
+    auto& cache = Cache::PayloadCache::Instance();
+    uint64_t payload_hash = 0;
+    if (payload_size > 0 && cache.Enabled()) {
+        payload_hash = Cache::Hash64(payload, payload_size);
+        if (auto beam = cache.Find(payload_hash, payload, payload_size)) {
+            SwBeamEngine& engine = Engine();
+            RemoteLease lease;
+            if (!LoadRemote(engine, *beam)) return Result{REMOTE_TXN_LOST};
+            return Result{"001"};
         }
+    }
 
-        // 바이너리 데이터 추출 (안전한 방법)
-        const char* binary_start = raw_command.data() + binary_start_pos;
-        size_t binary_size = raw_command.size() - binary_start_pos;
-        
-        // 디버깅 정보 출력
-        printf("Raw command size: %zu\n", raw_command.size());
-        printf("Binary start position: %zu\n", binary_start_pos);
-        printf("Binary size: %zu\n", binary_size);
-        
-        if (binary_size == 0) {
-            fprintf(stderr, "No binary data found!\n");
-            return Result{"No binary data found"};
-        }
-        
-        // 바이너리 데이터를 안전하게 복사
-        std::vector<uint8_t> binary_data;
-        binary_data.reserve(binary_size);
-        for (size_t i = 0; i < binary_size; ++i) {
-            binary_data.push_back(static_cast<uint8_t>(binary_start[i]));
+    // bus 별로 따로 압축한 payload. MAGIC 이 맞으면 bus 수나 offset table 이 틀려도 raw 로 넘기지 않고 error
+    if (payload_size > 0 && payload[0] == BusStreams::MAGIC) {
+        std::shared_ptr<const PreparedBeam> beam;
+        Result r = parse_bus_streams(payload, payload_size, &beam);
+        if (payload_hash && beam) {
+            cache.Insert(payload_hash, payload, payload_size, 3 + 2 * beam->layout->Size(), beam);
         }
-        
-        // 바이너리 데이터 헥스 덤프 (처음 16바이트만)
-        printf("Binary data hex dump (first 16 bytes): ");
-        for (size_t i = 0; i < std::min(binary_size, (size_t)16); ++i) {
-            printf("%02X ", binary_data[i]);
+        return r;
+    }
+
+    // compact phase payload (mode byte + 6 bit phase). mode byte 와 길이가 모두 맞을 때만 (zlib 은 0x78, raw 는 2 byte x element)
+    if (raw_command.size() > 7) {
+        uint8_t mode = static_cast<uint8_t>(raw_command[7]);
+        if ((mode == BeamPipeline::PHASE6_MODE_TX || mode == BeamPipeline::PHASE6_MODE_RX) &&
+            raw_command.size() - 7 == 1 + BeamPipeline::Phase6Bytes(Layout::Registry::Instance().Get(mode == BeamPipeline::PHASE6_MODE_TX)->Size())) {
+            Result r = parse_phase6_command(payload, payload_size);
+            if (payload_hash && r.message == "001") {
+                cache.Insert(payload_hash, payload, payload_size, payload_size, std::make_shared<PreparedBeam>(*phase6_beam_));
+            }
+            return r;
         }
-        printf("\n");
-        
-        // 압축된 데이터 처리
-        if (!compression_type.empty()) 
-        {
-            printf("not empty\n");
-            try {
-                printf("Decompressing %s data...\n", compression_type.c_str());
-                printf("Compressed size: %zu bytes\n", binary_data.size());
-                
-                // zlib 헤더 확인
-                if (compression_type == "zlib") {
-                    if (binary_data.size() < 2) {
-                        printf("Invalid zlib data: too short\n");
-                        return Result{"Invalid zlib data: too short"};
-                    }
-                    
-                    // zlib 매직 헤더 확인 (일반적으로 0x78로 시작)
-                    uint8_t cmf = binary_data[0];
-                    uint8_t flg = binary_data[1];
-                    
-                    printf("zlib header: CMF=0x%02X, FLG=0x%02X\n", (int)cmf, (int)flg);
-                    
-                    // zlib 헤더 검증
-                    if ((cmf & 0x0F) != 8) { // deflate method
-                        printf("Invalid zlib compression method\n");
-                        return Result{"Invalid zlib compression method"};
-                    }
-                    
-                    if (((cmf << 8) + flg) % 31 != 0) {
-                        printf("Invalid zlib header checksum\n");
-                        return Result{"Invalid zlib header checksum"};
-                    }
+    }
+
+    // "BINARY:" + 최소 2바이트 헤더
+    uint8_t first_byte = static_cast<uint8_t>(raw_command[7]);
+    uint8_t second_byte = static_cast<uint8_t>(raw_command[8]);
+    
+    // zlib 매직 헤더 확인 (일반적으로 0x78로 시작)
+    if (first_byte == 0x78 && (second_byte & 0x20) == 0) { // FDICT=0 확인
+        compression_type = "zlib";
+        binary_start_pos = 7; // "BINARY:" 바로 뒤부터
+        printf("Detected zlib compressed data by magic header: %02X %02X\n", first_byte, second_byte);
+    }
+    // FDICT=1 : 미리 나눠 가진 preset dictionary 로 압축한 stream (header 에 DICTID)
+    else if (first_byte == 0x78 && ((first_byte << 8) | second_byte) % 31 == 0) {
+        compression_type = "zlib+dict";
+        binary_start_pos = 7;
+        printf("Detected zlib stream with preset dictionary: %02X %02X\n", first_byte, second_byte);
+    }
+
+    // 바이너리 데이터 추출 (안전한 방법)
+    const char* binary_start = raw_command.data() + binary_start_pos;
+    size_t binary_size = raw_command.size() - binary_start_pos;
+    
+    // 디버깅 정보 출력
+    printf("Raw command size: %zu\n", raw_command.size());
+    printf("Binary start position: %zu\n", binary_start_pos);
+    printf("Binary size: %zu\n", binary_size);
+    
+    if (binary_size == 0) {
+        fprintf(stderr, "No binary data found!\n");
+        return Result{"No binary data found"};
+    }
+    
+    // 바이너리 데이터를 안전하게 복사
+    std::vector<uint8_t> binary_data;
+    binary_data.reserve(binary_size);
+    for (size_t i = 0; i < binary_size; ++i) {
+        binary_data.push_back(static_cast<uint8_t>(binary_start[i]));
+    }
+    
+    // 바이너리 데이터 헥스 덤프 (처음 16바이트만)
+    printf("Binary data hex dump (first 16 bytes): ");
+    for (size_t i = 0; i < std::min(binary_size, (size_t)16); ++i) {
+        printf("%02X ", binary_data[i]);
+    }
+    printf("\n");
+    
+    // 압축된 데이터 처리
+    if (!compression_type.empty()) 
+    {
+        printf("not empty\n");
+        try {
+            printf("Decompressing %s data...\n", compression_type.c_str());
+            printf("Compressed size: %zu bytes\n", binary_data.size());
+            
+            // zlib 헤더 확인
+            if (compression_type.compare(0, 4, "zlib") == 0) {
+                if (binary_data.size() < 2) {
+                    printf("Invalid zlib data: too short\n");
+                    return Result{"Invalid zlib data: too short"};
                 }
                 
-                std::vector<uint8_t> decompressed_data;
-                if (compression_type == "zlib") 
-                {
-                    printf("zlib@@\n");
-                    decompressed_data = decompress_zlib_verbose(binary_data);
-                }
+                // zlib 매직 헤더 확인 (일반적으로 0x78로 시작)
+                uint8_t cmf = binary_data[0];
+                uint8_t flg = binary_data[1];
                 
-                printf("Decompressed size: %zu bytes\n", decompressed_data.size());
-                if (binary_data.size() > 0) {
-                    printf("Compression ratio: %.2f%%\n", (double)binary_data.size() / decompressed_data.size() * 100);
-                }
+                printf("zlib header: CMF=0x%02X, FLG=0x%02X\n", (int)cmf, (int)flg);
                 
-                // 압축 해제된 데이터 헥스 덤프 (처음 16바이트만)
-                printf("Decompressed data hex dump (first 16 bytes): ");
-                for (size_t i = 0; i < std::min(decompressed_data.size(), (size_t)16); ++i) {
-                    printf("%02X ", decompressed_data[i]);
+                // zlib 헤더 검증
+                if ((cmf & 0x0F) != 8) { // deflate method
+                    printf("Invalid zlib compression method\n");
+                    return Result{"Invalid zlib compression method"};
                 }
-                printf("\n");
                 
-                // 압축 해제된 바이너리 명령어 처리
-                return parse_binary_commands(decompressed_data);
-                
-            } catch (const std::exception& e) {
-                fprintf(stderr, "Decompression error: %s\n", e.what());
-                return Result{"Decompression error: " + std::string(e.what())};
+                if (((cmf << 8) + flg) % 31 != 0) {
+                    printf("Invalid zlib header checksum\n");
+                    return Result{"Invalid zlib header checksum"};
+                }
             }
-        } else {
-            // 기존 비압축 바이너리 데이터 처리
-            printf("empty !!!\n");
-            return parse_binary_commands(binary_data);
+            
+            std::vector<uint8_t> decompressed_data;
+            if (compression_type == "zlib") 
+            {
+                printf("zlib@@\n");
+                decompressed_data = decompress_zlib_verbose(binary_data);
+            }
+            else if (compression_type == "zlib+dict")
+            {
+                // DICTID 가 지금 dictionary 와 다르면 풀지 않는다 (client 는 "zdict" 로 id 를 확인)
+                Trace::Probe probe(Trace::Stage::Decompress);
+                std::string err;
+                if (!ZDict::Dictionary::Instance().Inflate(binary_data.data(), binary_data.size(), decompressed_data, &err))
+                    throw std::runtime_error(err);
+            }
+            
+            printf("Decompressed size: %zu bytes\n", decompressed_data.size());
+            if (binary_data.size() > 0) {
+                printf("Compression ratio: %.2f%%\n", (double)binary_data.size() / decompressed_data.size() * 100);
+            }
+            
+            // 압축 해제된 데이터 헥스 덤프 (처음 16바이트만)
+            printf("Decompressed data hex dump (first 16 bytes): ");
+            for (size_t i = 0; i < std::min(decompressed_data.size(), (size_t)16); ++i) {
+                printf("%02X ", decompressed_data[i]);
+            }
+            printf("\n");
+            
+            // 압축 해제된 바이너리 명령어 처리 (inflate 와 cache 저장은 lock 밖에서)
+            Result r;
+            {
+                RemoteLease lease;
+                r = parse_binary_commands(decompressed_data);
+            }
+            if (payload_hash) CacheBinaryPayload(payload_hash, payload, payload_size, decompressed_data);
+            return r;
+            
+        } catch (const std::exception& e) {
+            fprintf(stderr, "Decompression error: %s\n", e.what());
+            Stats::Inc(Stats::Counter::DecodeErrors);
+            return Result{"Decompression error: " + std::string(e.what())};
         }
+    } else {
+        // 기존 비압축 바이너리 데이터 처리
+        printf("empty !!!\n");
+        Result r;
+        {
+            RemoteLease lease;
+            r = parse_binary_commands(binary_data);
+        }
+        if (payload_hash) CacheBinaryPayload(payload_hash, payload, payload_size, binary_data);
+        return r;
+    }
+}
+
+Result SpiwriteCommand::Execute(const std::string& raw_command) 
+{
+    Stats::Inc(Stats::Counter::CommandsExecuted);
+
+
+    // 바이너리 명령어 체크
+    if (raw_command.substr(0, 7) == "BINARY:") 
+    {
+        // start 없이 BINARY 부터 보내는 client 는 첫 BINARY 부터. done 이 오지 않아 남은 (transaction 만료보다 오래된) 구간은 새 beam 으로 바꾼다
+        uint64_t pending = Trace::Tracer::BeamStart();
+        if (!pending || Trace::NowNs() - pending > (uint64_t)REMOTE_TXN_EXPIRE_MS * 1000000) {
+            Trace::Tracer::BeginBeam(BeamStartNs());
+        }
+
+        // 실패한 payload 뒤에는 done 이 오지 않을 수 있다. 열린 구간이 다음 beam 의 end_to_end 에 섞이지 않도록 버린다
+        Result r = parse_binary_payload(raw_command);
+        if (r.message != "001") Trace::Tracer::AbortBeam();
+        return r;
     }
 
     // 기존 텍스트 방식 처리
@@ -3,11 +3,16 @@
 
 #include <string.h>
 #include <vector>
+#include <map>
+#include <deque>
 #include <algorithm>
 #include "Transport.h"
 #include "CodeGenerator.h"
 #include "LineParser.h"
+#include "RegisterBackend.h"
+#include "HardwareArbiter.h"
 #include <mutex>        // std::mutex를 위해 필요
+#include <atomic>
 #include <memory>       // std::unique_ptr를 위해 필요
 #include <unistd.h>     // close(), sysconf()를 위해 필요
 #include <sys/mman.h>   // mmap(), munmap()을 위해 필요
@@ -18,6 +23,10 @@
 #include <cerrno>       // errno를 위해 필요
 
 namespace SpiBeam {
+
+class SwBeamEngine;
+struct PreparedBeam;
+
 namespace SpiwriteProtocol {
 
 
@@ -34,11 +43,39 @@ class MemoryWriter {
         uintptr_t mapped_address = 0;
         size_t mapped_size = 0;
         std::mutex write_mutex;
+        RegisterBackend* backend = nullptr;
+
+        // initializeLazy() 로 예약된 영역. 첫 access 때 mapping 한다.
+        // lazy_requested 가 켜져 있으면 모든 access 가 lazy_mutex 를 거쳐 mapping 이 끝난 것 (lazy_mapped) 을 본 뒤에만
+        // mapped_* 를 읽는다. mapping 이 실패하면 false 이고 다음 access 에서 다시 시도한다 (writeMemoryDirect 로 새지 않는다)
+        uintptr_t lazy_address = 0;
+        size_t lazy_size = 0;
+        std::atomic<bool> lazy_requested { false };
+        std::atomic<bool> lazy_mapped { false };
+        std::mutex lazy_mutex;
+        bool ensureInitialized();
+        // default backend 또는 /dev/mem. lazy 상태는 건드리지 않는다
+        bool mapRegion(uintptr_t base_addr, size_t size);
+        bool attachBackend(uintptr_t base_addr, size_t size, RegisterBackend* backend);
     
     public:
         bool initialize(uintptr_t base_addr, size_t size);
+        // 실제 mapping 은 첫 read/write 때 (startup 에서 /dev/mem 을 건드리지 않음)
+        void initializeLazy(uintptr_t base_addr, size_t size);
+        // /dev/mem 대신 anonymous mmap 을 base_addr 에 대응 (benchmark/시뮬레이션용)
+        bool initializeAnonymous(uintptr_t base_addr, size_t size);
+        // base_addr ~ base_addr + size 의 access 를 backend 로 넘김 (co-simulation 용)
+        bool initializeBackend(uintptr_t base_addr, size_t size, RegisterBackend* backend);
+
+        // 설정되어 있으면 이후 initialize() 는 /dev/mem 대신 이 backend 를 사용
+        static void setDefaultBackend(RegisterBackend* backend);
+
+        // lazy mapping 을 지금 만들고 mapping 의 page 를 미리 채운다 (첫 beam 에서 fault 나지 않도록)
+        bool prefault();
         
         bool writeMemory(uintptr_t target_address, uint32_t value);
+        // bus 의 FIFO data register (base_address + 0x10) 에 word 를 이어서 쓴다. lock 한 번, word 집계도 한 번
+        bool writeFifo(int bus, uintptr_t base_address, const uint32_t* words, size_t count);
         bool readMemory(uintptr_t target_address, uint32_t& out_value);
 
         ~MemoryWriter() {
@@ -52,27 +89,73 @@ class MemoryWriter {
 };
 
 
+std::vector<uint8_t> decompress_zlib_verbose(const std::vector<uint8_t>& compressed_data);
+
+
 class SpiwriteCommand
 {
 public:
     SpiwriteCommand( Controller::Transport& transport, Controller::CodeGenerator* cgen, Parser::LineParser* parser );
+    // transport 없이 register path 만 쓰는 경우 (benchmark, offline tool)
+    SpiwriteCommand( Controller::CodeGenerator* cgen, Parser::LineParser* parser );
     SpiwriteCommand( const SpiwriteCommand& rhs ) 
-        : SpiwriteCommand( rhs.transport_, rhs.code_generator_, rhs.parser_ )
-    {}
+        : SpiwriteCommand( rhs.code_generator_, rhs.parser_ )
+    {
+        transport_ = rhs.transport_;
+    }
+    ~SpiwriteCommand();
 
     // Result Execute( const std::vector<std::string_view>& tokens );
     Result Execute(const std::string& raw_command);
 
     void fifo_writer(int bus_id, uintptr_t base_addr, MemoryWriter& wr);
 
+    // "BINARY:" 으로 시작하는 datagram 전체 : cache, bus stream, compact phase, zlib, raw 순으로 판별. 성공하면 "001"
+    Result parse_binary_payload(const std::string& raw_command);
     Result parse_binary_commands(const std::vector<uint8_t>& binary_data);
+    // "BINARY:" + PHASE6_MODE_TX/RX + 6 bit phase (BeamPipeline.h). FIFO 에 올리기만 하고 send 는 done 에서
+    Result parse_phase6_command(const uint8_t* data, size_t size);
+    // "BINARY:" + BusStreams::MAGIC ... : bus 별 stream 을 worker 마다 하나씩 inflate / pack / FIFO fill.
+    // 성공하면 beam 에 bus word 를 돌려준다 (cache 용)
+    Result parse_bus_streams(const uint8_t* data, size_t size, std::shared_ptr<const PreparedBeam>* beam = nullptr);
     Result parse_text_commands(const std::vector<std::string_view>& tokens);
-    MemoryWriter wr;
+    // start 로 잡은 원격 transaction 을 놓는다. Lease 는 잡은 thread 에서만 풀리므로 그 thread (session worker) 에서 부를 것
+    void AbortRemote();
+    // start 로 잡은 원격 transaction 을 아직 들고 있으면 true (만료로 회수됐으면 false). 명령을 실행하는 thread 에서
+    bool HoldsRemote() const;
+    // process 전체가 공유하는 HardwareContext 의 writer
+    MemoryWriter& wr;
 
 private:
-    Controller::Transport& transport_;
+    Controller::Transport* transport_;
     Controller::CodeGenerator* code_generator_;
     Parser::LineParser* parser_;
+
+    // 원격 beam 은 start .. BINARY .. done 이 여러 datagram 으로 온다. 그 동안 hardware 를 잡고 있는 transaction
+    static constexpr int REMOTE_TXN_EXPIRE_MS = 2000;
+    // Remote Lease + 그 동안만 hardware role (SpiwriteCommand.cpp)
+    struct RemoteLease;
+    std::unique_ptr<RemoteLease> remote_txn_;
+    // transaction 이 만료로 회수됐으면 다음 start 까지 BINARY / done 을 거부 (그 사이 다른 경로가 FIFO 를 썼을 수 있다)
+    bool remote_txn_lost_ = false;
+    bool RemoteTxnLost();
+    // bus 마다 transaction 을 확인하며 FIFO 에 올린다. 잃었으면 false
+    bool LoadRemote(SwBeamEngine& engine, const PreparedBeam& beam);
+
+    // compact phase payload 를 bus word 로 만들어 FIFO 에 올리는 engine (script 출력 없이), beam buffer 재사용
+    std::unique_ptr<SwBeamEngine> engine_;
+    std::unique_ptr<PreparedBeam> phase6_beam_;
+    // beam 명령의 마지막 beam. 같은 방향 / 주파수 / layout 이면 phase 계산과 packing 을 건너뛴다
+    std::unique_ptr<PreparedBeam> text_beam_;
+    SwBeamEngine& Engine();
+
+    // bus stream payload 용 : bus 마다 engine 하나 (worker 가 동시에 LoadBus), 풀어 놓은 register 값
+    std::vector<std::unique_ptr<SwBeamEngine>> bus_engines_;
+    std::vector<uint8_t> bus_values_;
+
+    // BINARY (bus, chip, channel, value) payload : bus 별 5 byte 명령 queue 와 bus 안의 FIFO word 번호 (script 출력용)
+    std::map<int, std::deque<uint8_t>> byte_queues_;
+    int fifo_word_count_ = 1;
     
 };
 
@@ -1,5 +1,8 @@
 #include <string.h>
+#include <functional>
 #include "SpiwriteProtocol.h"
+#include "BeamTrace.h"
+#include "SpiStats.h"
 
 namespace SpiBeam {
 namespace SpiwriteProtocol {
@@ -15,13 +18,37 @@ public:
     {
         for(int processed = 0; processed < len; )
         {
-            auto decoded = DecodeFrame( packet+processed, len-processed );
+            auto decode_t0 = Trace::NowNs();
+            auto decoded = [&]() {
+                try
+                {
+                    return DecodeFrame( packet+processed, len-processed );
+                }
+                catch( ... )
+                {
+                    Stats::Inc( Stats::Counter::DecodeErrors );
+                    throw;
+                }
+            }();
+            Trace::Tracer::Instance().Record( Trace::Stage::FrameDecode, Trace::NowNs() - decode_t0 );
             processed += decoded.Length();
 
             if ( decoded.head.start != SpiwriteProtocol::MSG_STRAT_CODE) {
+                Stats::Inc( Stats::Counter::DecodeErrors );
                 continue;
             };
 
+            if ( decoded.head.message_type != MSG_ACK )
+            {
+                // ACK 유실로 client 가 재전송한 frame
+                if ( has_last_sequence_ && decoded.head.sequence == last_sequence_ )
+                {
+                    Stats::Inc( Stats::Counter::DuplicateFrames );
+                }
+                last_sequence_ = decoded.head.sequence;
+                has_last_sequence_ = true;
+            }
+
             OnPreMessage( decoded );
             if( decoded.head.message_type == MSG_LINES)
             {
@@ -67,6 +94,8 @@ public:
 private:
     SendFn on_send_;
     uint32_t sequence_ { 0 };
+    uint32_t last_sequence_ { 0 };
+    bool has_last_sequence_ { false };
 
 };
 
@@ -0,0 +1,138 @@
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "string_util.hpp"
+#include "TrigTable.h"
+
+namespace SpiBeam {
+namespace Trig {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// 처음 사용할 때 한 번 double 로 계산해서 float 로 저장
+const float* QuarterTable()
+{
+    static const std::vector<float> table = []
+    {
+        std::vector<float> t( QUARTER + 1 );
+        for( int i = 0; i <= QUARTER; i++ )
+        {
+            t[i] = (float)std::sin( i * PI / ( 180.0 * STEPS_PER_DEG ) );
+        }
+        t[QUARTER] = 1.0f;
+        return t;
+    }();
+    return table.data();
+}
+
+// q : 0 ~ FULL-1
+inline float SinIndex( const float* t, int q )
+{
+    if( q < QUARTER )     return  t[q];
+    if( q < 2 * QUARTER ) return  t[2 * QUARTER - q];
+    if( q < 3 * QUARTER ) return -t[q - 2 * QUARTER];
+    return -t[FULL - q];
+}
+
+inline int Next( int q, int step )
+{
+    q += step;
+    return q >= FULL ? q - FULL : q;
+}
+
+}
+
+int ToQ9_7( double deg )
+{
+    if( !std::isfinite( deg ) ) return 0;
+
+    // 먼저 한 바퀴 안으로 줄여야 큰 값에서도 lround 가 long 범위 안
+    long q = std::lround( std::fmod( deg, 360.0 ) * STEPS_PER_DEG ) % FULL;
+    return (int)( q < 0 ? q + FULL : q );
+}
+
+float SinQ( int q )
+{
+    q %= FULL;
+    if( q < 0 ) q += FULL;
+    return SinIndex( QuarterTable(), q );
+}
+
+float CosQ( int q )
+{
+    q %= FULL;
+    if( q < 0 ) q += FULL;
+    return SinIndex( QuarterTable(), Next( q, QUARTER ) );
+}
+
+void SinCos( float deg, float& s, float& c )
+{
+    const float* t = QuarterTable();
+
+    // nan / inf 는 0 도로 본다. 유한한 값은 fmod 로 ±360 안에 넣은 뒤 index 로 (큰 값의 long long 변환 overflow 방지)
+    if( !std::isfinite( deg ) )
+    {
+        s = 0.0f;
+        c = 1.0f;
+        return;
+    }
+
+    double pos = std::fmod( (double)deg, 360.0 ) * STEPS_PER_DEG;
+    double base = std::floor( pos );
+    float frac = (float)( pos - base );
+
+    long long b = (long long)base % FULL;
+    int q = (int)( b < 0 ? b + FULL : b );
+    int qc = Next( q, QUARTER );
+
+    float s0 = SinIndex( t, q );
+    float c0 = SinIndex( t, qc );
+    if( frac == 0.0f )
+    {
+        s = s0;
+        c = c0;
+        return;
+    }
+
+    s = s0 + ( SinIndex( t, Next( q, 1 ) ) - s0 ) * frac;
+    c = c0 + ( SinIndex( t, Next( qc, 1 ) ) - c0 ) * frac;
+}
+
+std::string Accuracy::Report() const
+{
+    return Common::string_format( "trig table  max err %.3g (grid), %.3g (interpolated)\r\n"
+                                  "float libm  max err %.3g",
+        table_max_err, interp_max_err, float_max_err );
+}
+
+Accuracy Check()
+{
+    const float FLOAT_PI = 3.14159265359f;   // BeamPipeline 의 float 경로와 같은 값
+
+    Accuracy acc { 0, 0, 0 };
+    for( int q = 0; q < FULL; q++ )
+    {
+        double rad = q * PI / ( 180.0 * STEPS_PER_DEG );
+        double s = std::sin( rad ), c = std::cos( rad );
+
+        acc.table_max_err = std::max( { acc.table_max_err, std::fabs( SinQ( q ) - s ), std::fabs( CosQ( q ) - c ) } );
+
+        float deg = (float)q / STEPS_PER_DEG;
+        float frad = deg * FLOAT_PI / 180.0f;
+        acc.float_max_err = std::max( { acc.float_max_err, std::fabs( std::sin( frad ) - s ), std::fabs( std::cos( frad ) - c ) } );
+
+        // grid 사이 (1/3 지점)
+        float mid = ( q + 1.0f / 3.0f ) / STEPS_PER_DEG;
+        double mrad = (double)mid * PI / 180.0;
+        float ms, mc;
+        SinCos( mid, ms, mc );
+        acc.interp_max_err = std::max( { acc.interp_max_err, std::fabs( ms - std::sin( mrad ) ), std::fabs( mc - std::cos( mrad ) ) } );
+    }
+    return acc;
+}
+
+
+}
+}
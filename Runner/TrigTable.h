@@ -0,0 +1,41 @@
+#ifndef __SPIBEAM_TRIG_TABLE_H__
+#define __SPIBEAM_TRIG_TABLE_H__
+
+#include <string>
+#include <cstdint>
+
+namespace SpiBeam {
+namespace Trig {
+
+// Q9.7 degree (beamforming_calc az/el 입력과 같은 해상도) 기준 sin table.
+// 0 ~ 90 도 quarter wave 만 들고 (11521 float, 45KB) 나머지 사분면은 대칭으로 구한다.
+constexpr int STEPS_PER_DEG = 128;
+constexpr int QUARTER       = 90 * STEPS_PER_DEG;
+constexpr int FULL          = 360 * STEPS_PER_DEG;
+
+// degree 를 0 ~ 360 으로 wrap 한 Q9.7 (반올림). nan / inf 는 0
+int ToQ9_7( double deg );
+
+float SinQ( int q );
+float CosQ( int q );
+
+// Q9.7 grid 위의 값은 table 그대로, 사이 값은 인접 두 entry 를 선형 보간 (float 반올림 포함 오차 < 1e-7)
+// 모든 float 에 대해 정의됨 : nan / inf 는 0 도 (s = 0, c = 1)
+void SinCos( float deg, float& s, float& c );
+
+struct Accuracy
+{
+    double table_max_err;   // table vs double sin/cos
+    double float_max_err;   // 기존 float 경로 (float PI, cosf/sinf) vs double
+    double interp_max_err;  // grid 사이 보간 vs double
+    std::string Report() const;
+};
+
+// 전체 Q9.7 grid 와 grid 사이 점에서 table 을 double / float libm 경로와 비교
+Accuracy Check();
+
+
+}
+}
+
+#endif
@@ -0,0 +1,371 @@
+#include <cstdio>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "string_util.hpp"
+#include "WarmStart.h"
+#include "HealthMonitor.h"
+#include "PanelLayout.h"
+
+namespace SpiBeam {
+namespace WarmStart {
+
+namespace {
+
+constexpr uintptr_t CTRL_SEND   = 0x43c00014;
+constexpr uintptr_t CTRL_LENGTH = 0x43c00018;
+constexpr uintptr_t CTRL_EXEC   = 0x43c0001c;
+constexpr uintptr_t VAIC_RESET  = 0x43c28004;
+constexpr uintptr_t BEAM_CTRL   = 0x43c30000;   // HwBeamEngine::DEFAULT_BASE + REG_CTRL
+
+constexpr uint32_t FILE_MAGIC   = 0x53574253;   // "SBWS"
+constexpr uint16_t FILE_VERSION = 2;     // 2 : bus 수를 words 앞에 저장
+
+// readback 으로 panel 상태를 확인할 수 있는 register (FIFO 쪽은 write only)
+constexpr uintptr_t VERIFY_REGS[] = { VAIC_RESET, CTRL_LENGTH };
+
+struct FileHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t payload_len;
+    uint32_t crc;
+};
+
+std::shared_ptr<const Layout::Compiled> PanelLayout( int panel_mode )
+{
+    return Layout::Registry::Instance().Get( panel_mode == 0 ? 0 : 1 );
+}
+
+template<typename T>
+void Put( std::vector<uint8_t>& out, const T& v )
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>( &v );
+    out.insert( out.end(), p, p + sizeof(T) );
+}
+
+template<typename T>
+bool Get( const std::vector<uint8_t>& in, size_t& pos, T& v )
+{
+    if( pos + sizeof(T) > in.size() ) return false;
+    memcpy( &v, in.data() + pos, sizeof(T) );
+    pos += sizeof(T);
+    return true;
+}
+
+bool WriteAll( int fd, const void* data, size_t len )
+{
+    const uint8_t* p = static_cast<const uint8_t*>( data );
+    while( len > 0 )
+    {
+        ssize_t n = write( fd, p, len );
+        if( n < 0 )
+        {
+            if( errno == EINTR ) continue;
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+}
+
+std::string Snapshot::Report() const
+{
+    size_t total = 0;
+    for( auto& w : words ) total += w.size();
+
+    return Common::string_format( "panel %s, az %.2f el %.2f, %zu shadow regs, %zu words, signature 0x%08x",
+        panel_mode == 1 ? "tx" : panel_mode == 0 ? "rx" : "unknown", az, el, shadow.size(), total, signature );
+}
+
+Journal& Journal::Instance()
+{
+    static Journal journal;
+    return journal;
+}
+
+void Journal::Record( uintptr_t address, uint32_t value )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    if( address == BEAM_CTRL && ( value & 0x1 ) )
+    {
+        // PL 이 phase 를 계산한 beam 은 FIFO word 가 없으므로 replay 대상에서 뺀다
+        for( auto& c : committed_ ) c.clear();
+    }
+
+    shadow_[(uint32_t)address] = value;
+}
+
+void Journal::CommitBeam( const Layout::Compiled& L, uint32_t send_mask,
+                          const std::vector<std::vector<uint32_t>>& words, const std::vector<uint32_t>& bytes )
+{
+    size_t num_bus = std::min( { words.size(), bytes.size(), (size_t)L.num_bus, (size_t)MAX_BUS } );
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+    if( committed_.size() < num_bus ) committed_.resize( num_bus );
+    for( size_t b = 0; b < num_bus; b++ )
+    {
+        if( !( send_mask & ( 1u << b ) ) || words[b].empty() ) continue;
+        committed_[b].assign( words[b].begin(), words[b].end() );
+        shadow_[(uint32_t)( L.FifoAddress( (int)b ) + 0x14 )] = bytes[b];
+    }
+}
+
+void Journal::MarkPanel( int is_tx )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    panel_mode_ = is_tx;
+}
+
+int Journal::PanelMode() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return panel_mode_;
+}
+
+Snapshot Journal::Capture( float az, float el ) const
+{
+    Snapshot snap;
+    std::lock_guard<std::mutex> lock( mutex_ );
+    snap.panel_mode = panel_mode_;
+    snap.az = az;
+    snap.el = el;
+    snap.signature = HardwareSignature();
+    snap.shadow = shadow_;
+    snap.words = committed_;
+    return snap;
+}
+
+void Journal::Restore( const Snapshot& snap )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    panel_mode_ = snap.panel_mode;
+    shadow_ = snap.shadow;
+    committed_ = snap.words;
+}
+
+void Journal::Reset()
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    panel_mode_ = -1;
+    shadow_.clear();
+    committed_.clear();
+}
+
+std::string DefaultPath()
+{
+    const char* env = getenv( "SPIBEAM_WARM_STATE" );
+    return ( env && *env ) ? env : "/var/lib/spibeam/warm_state.bin";
+}
+
+uint32_t HardwareSignature()
+{
+    char boot_id[64] = { 0 };
+    FILE* f = fopen( "/proc/sys/kernel/random/boot_id", "r" );
+    if( !f ) return 0;
+    size_t n = fread( boot_id, 1, sizeof(boot_id) - 1, f );
+    fclose( f );
+    if( n == 0 ) return 0;
+
+    uint32_t crc = crc32( 0L, Z_NULL, 0 );
+    return crc32( crc, reinterpret_cast<const Bytef*>( boot_id ), n );
+}
+
+bool Save( const std::string& path, const Snapshot& snap )
+{
+    std::vector<uint8_t> payload;
+    Put( payload, (int32_t)snap.panel_mode );
+    Put( payload, snap.az );
+    Put( payload, snap.el );
+    Put( payload, snap.signature );
+    Put( payload, (uint32_t)snap.shadow.size() );
+    for( auto& kv : snap.shadow )
+    {
+        Put( payload, kv.first );
+        Put( payload, kv.second );
+    }
+    Put( payload, (uint32_t)snap.words.size() );
+    for( auto& w : snap.words )
+    {
+        Put( payload, (uint32_t)w.size() );
+        payload.insert( payload.end(), reinterpret_cast<const uint8_t*>( w.data() ),
+                        reinterpret_cast<const uint8_t*>( w.data() + w.size() ) );
+    }
+
+    FileHeader hdr;
+    hdr.magic = FILE_MAGIC;
+    hdr.version = FILE_VERSION;
+    hdr.reserved = 0;
+    hdr.payload_len = (uint32_t)payload.size();
+    hdr.crc = crc32( crc32( 0L, Z_NULL, 0 ), payload.data(), payload.size() );
+
+    std::string tmp = path + ".tmp";
+    int fd = open( tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if( fd < 0 )
+    {
+        printf( ";warm state : cannot open %s : %s\n", tmp.c_str(), strerror( errno ) );
+        return false;
+    }
+
+    bool ok = WriteAll( fd, &hdr, sizeof(hdr) ) && WriteAll( fd, payload.data(), payload.size() ) && fsync( fd ) == 0;
+    close( fd );
+
+    if( !ok || rename( tmp.c_str(), path.c_str() ) != 0 )
+    {
+        printf( ";warm state : write %s failed : %s\n", path.c_str(), strerror( errno ) );
+        unlink( tmp.c_str() );
+        return false;
+    }
+
+    // rename 자체도 디스크에 남도록 directory 까지 sync
+    auto slash = path.rfind( '/' );
+    std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr( 0, slash );
+    int dfd = open( dir.c_str(), O_RDONLY | O_DIRECTORY );
+    if( dfd >= 0 )
+    {
+        fsync( dfd );
+        close( dfd );
+    }
+    return true;
+}
+
+bool Load( const std::string& path, Snapshot& snap )
+{
+    FILE* f = fopen( path.c_str(), "rb" );
+    if( !f ) return false;
+
+    FileHeader hdr;
+    std::vector<uint8_t> payload;
+    bool ok = fread( &hdr, sizeof(hdr), 1, f ) == 1
+           && hdr.magic == FILE_MAGIC && hdr.version == FILE_VERSION
+           && hdr.payload_len < ( 1u << 20 );
+    if( ok )
+    {
+        payload.resize( hdr.payload_len );
+        ok = fread( payload.data(), 1, payload.size(), f ) == payload.size();
+    }
+    fclose( f );
+
+    if( !ok || crc32( crc32( 0L, Z_NULL, 0 ), payload.data(), payload.size() ) != hdr.crc )
+    {
+        printf( ";warm state : %s is damaged, ignored\n", path.c_str() );
+        return false;
+    }
+
+    Snapshot s;
+    size_t pos = 0;
+    int32_t mode;
+    uint32_t count;
+    if( !Get( payload, pos, mode ) || !Get( payload, pos, s.az ) || !Get( payload, pos, s.el ) ||
+        !Get( payload, pos, s.signature ) || !Get( payload, pos, count ) )
+        return false;
+    s.panel_mode = mode;
+
+    for( uint32_t i = 0; i < count; i++ )
+    {
+        uint32_t addr, value;
+        if( !Get( payload, pos, addr ) || !Get( payload, pos, value ) ) return false;
+        s.shadow[addr] = value;
+    }
+    if( !Get( payload, pos, count ) || count > (uint32_t)MAX_BUS ) return false;
+    s.words.resize( count );
+    for( auto& w : s.words )
+    {
+        if( !Get( payload, pos, count ) || pos + count * sizeof(uint32_t) > payload.size() ) return false;
+        w.resize( count );
+        memcpy( w.data(), payload.data() + pos, count * sizeof(uint32_t) );
+        pos += count * sizeof(uint32_t);
+    }
+
+    snap = std::move( s );
+    return true;
+}
+
+bool Remove( const std::string& path )
+{
+    return unlink( path.c_str() ) == 0 || errno == ENOENT;
+}
+
+bool Matches( const Snapshot& snap, SpiwriteProtocol::MemoryWriter& writer, std::string* why )
+{
+    auto fail = [why]( const std::string& reason )
+    {
+        if( why ) *why = reason;
+        return false;
+    };
+
+    if( snap.panel_mode < 0 ) return fail( "panel was never initialized" );
+
+    uint32_t sig = HardwareSignature();
+    if( sig == 0 || sig != snap.signature ) return fail( "hardware signature changed (reboot)" );
+
+    auto layout = PanelLayout( snap.panel_mode );
+    if( snap.words.size() > (size_t)layout->num_bus )
+        return fail( Common::string_format( "saved %zu buses, layout %s has %d", snap.words.size(), layout->name.c_str(), layout->num_bus ) );
+
+    for( uintptr_t reg : VERIFY_REGS )
+    {
+        auto it = snap.shadow.find( (uint32_t)reg );
+        if( it == snap.shadow.end() ) continue;
+
+        uint32_t value;
+        if( !writer.readMemory( reg, value ) )
+            return fail( Common::string_format( "cannot read 0x%08x", (unsigned)reg ) );
+        if( value != it->second )
+            return fail( Common::string_format( "0x%08x reads 0x%08x, expected 0x%08x", (unsigned)reg, value, it->second ) );
+    }
+    return true;
+}
+
+bool Replay( const Snapshot& snap, SpiwriteProtocol::MemoryWriter& writer )
+{
+    auto layout = PanelLayout( snap.panel_mode );
+    const Layout::Compiled& L = *layout;
+    if( snap.words.size() > (size_t)std::min( L.num_bus, MAX_BUS ) ) return false;
+
+    uint32_t mask = 0;
+    for( int bus = 0; bus < (int)snap.words.size(); bus++ )
+    {
+        auto& words = snap.words[bus];
+        if( words.empty() ) continue;
+
+        uintptr_t base = L.FifoAddress( bus );
+        writer.writeMemory( base + 0x2C, 0x2 );
+        writer.writeFifo( bus, base, words.data(), words.size() );
+
+        auto len = snap.shadow.find( (uint32_t)( base + 0x14 ) );
+        writer.writeMemory( base + 0x14, len != snap.shadow.end() ? len->second : (uint32_t)( words.size() * 4 ) );
+        Health::LatchIsr( writer, bus, base );
+        writer.writeMemory( base, 0xffffffff );
+        mask |= 1u << bus;
+    }
+    if( mask == 0 ) return false;
+
+    auto length = snap.shadow.find( (uint32_t)CTRL_LENGTH );
+    writer.writeMemory( CTRL_LENGTH, length != snap.shadow.end() ? length->second : 0x5 );
+    writer.writeMemory( CTRL_EXEC, 0x1 );
+    writer.writeMemory( CTRL_SEND, mask );
+
+    // 1024 element 가 SPI 로 빠지는 데 수 ms 이므로 1s 면 충분
+    for( int i = 0; i < 1000; i++ )
+    {
+        uint32_t busy;
+        if( !writer.readMemory( CTRL_SEND, busy ) ) return false;
+        if( busy == 0 ) return true;
+        usleep( 1000 );
+    }
+    return false;
+}
+
+
+}
+}
@@ -0,0 +1,103 @@
+#ifndef __SPIBEAM_WARM_START_H__
+#define __SPIBEAM_WARM_START_H__
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "SpiwriteCommand.h"
+#include "PanelLayout.h"
+
+namespace SpiBeam {
+namespace WarmStart {
+
+// send register 의 bit 수
+constexpr int MAX_BUS = Layout::MAX_BUS;
+
+// restart 이후 panel 초기화 / beam 재계산을 건너뛰기 위해 남겨 두는 상태
+struct Snapshot
+{
+    int      panel_mode = -1;   // 초기화된 panel (1 : tx, 0 : rx, -1 : 모름)
+    float    az = 0;
+    float    el = 0;
+    uint32_t signature = 0;     // 저장 당시 HardwareSignature()
+
+    std::map<uint32_t, uint32_t> shadow;                  // control register 의 마지막 write 값
+    std::vector<std::vector<uint32_t>> words;             // 마지막 beam 의 bus 별 FIFO data word (layout 의 bus 번호)
+
+    std::string Report() const;
+};
+
+// control register 의 마지막 write 값 (shadow) 과 마지막 beam 의 bus 별 packed word 를 유지한다.
+//   OnWrite : MemoryWriter 가 FIFO register 밖의 write 만 넘긴다 (FIFO data word 마다 lock 을 잡지 않음)
+//   OnBeam  : SwBeamEngine 이 send register 를 쓴 직후. mask 에 있는 bus 의 word 와 length 를 마지막 beam 으로 확정
+//   BEAM_CTRL start : PL 이 phase 를 계산한 beam 이므로 확정된 word 를 비움
+// Enable 전에는 write 마다 atomic load 하나만 든다.
+class Journal
+{
+public:
+    static Journal& Instance();
+
+    void Enable( bool on ) { enabled_.store( on, std::memory_order_relaxed ); }
+    bool Enabled() const { return enabled_.load( std::memory_order_relaxed ); }
+
+    void OnWrite( uintptr_t address, uint32_t value )
+    {
+        if( !Enabled() ) return;
+        Record( address, value );
+    }
+
+    // words / bytes 는 L 의 bus 번호 (PreparedBeam 과 같은 모양)
+    void OnBeam( const Layout::Compiled& L, uint32_t send_mask,
+                 const std::vector<std::vector<uint32_t>>& words, const std::vector<uint32_t>& bytes )
+    {
+        if( !Enabled() ) return;
+        CommitBeam( L, send_mask, words, bytes );
+    }
+
+    void MarkPanel( int is_tx );
+    int PanelMode() const;
+
+    Snapshot Capture( float az, float el ) const;
+    void Restore( const Snapshot& snap );
+    void Reset();
+
+private:
+    Journal() {}
+    void Record( uintptr_t address, uint32_t value );
+    void CommitBeam( const Layout::Compiled& L, uint32_t send_mask,
+                     const std::vector<std::vector<uint32_t>>& words, const std::vector<uint32_t>& bytes );
+
+    std::atomic<bool> enabled_ { false };
+
+    mutable std::mutex mutex_;
+    int panel_mode_ = -1;
+    std::map<uint32_t, uint32_t> shadow_;
+    std::vector<std::vector<uint32_t>> committed_;
+};
+
+// 상태 파일 경로 : $SPIBEAM_WARM_STATE, 없으면 /var/lib/spibeam/warm_state.bin
+std::string DefaultPath();
+
+// boot 단위로 바뀌는 값 (PL 은 boot 때 다시 program 되므로 boot 가 바뀌면 무효)
+uint32_t HardwareSignature();
+
+// temp file 에 쓰고 fsync 후 rename. 중간에 죽어도 이전 파일이 그대로 남는다.
+bool Save( const std::string& path, const Snapshot& snap );
+// magic / version / CRC 가 맞지 않으면 false
+bool Load( const std::string& path, Snapshot& snap );
+bool Remove( const std::string& path );
+
+// signature 가 같고, readback 가능한 register 가 shadow 값과 같으면 panel 이 저장된 상태 그대로
+bool Matches( const Snapshot& snap, SpiwriteProtocol::MemoryWriter& writer, std::string* why = nullptr );
+
+// 저장된 packed word 를 다시 FIFO 에 넣고 send (phase 재계산 없음). FIFO 주소는 저장된 panel 의 layout 에서
+bool Replay( const Snapshot& snap, SpiwriteProtocol::MemoryWriter& writer );
+
+
+}
+}
+
+#endif
@@ -0,0 +1,408 @@
+#include <queue>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_map>
+#include <zlib.h>
+#include "string_util.hpp"
+#include "ZDict.h"
+#include "SpiStats.h"
+
+namespace SpiBeam {
+namespace ZDict {
+
+namespace {
+
+// inflate 중 Z_NEED_DICT 가 오면 DICTID 를 확인하고 dictionary 를 건다
+int InflateWithDict( z_stream& strm, const std::vector<uint8_t>* dict, uint32_t id, std::string* err )
+{
+    int ret = inflate( &strm, Z_FINISH );
+    if( ret == Z_NEED_DICT )
+    {
+        // Z_NEED_DICT 일 때 strm.adler 가 stream 의 DICTID
+        if( !dict )
+        {
+            if( err ) *err = Common::string_format( "stream needs dictionary 0x%08lx, none loaded", strm.adler );
+            return Z_NEED_DICT;
+        }
+        if( strm.adler != id )
+        {
+            if( err ) *err = Common::string_format( "stream needs dictionary 0x%08lx, loaded 0x%08x", strm.adler, id );
+            return Z_NEED_DICT;
+        }
+        if( inflateSetDictionary( &strm, dict->data(), (uInt)dict->size() ) != Z_OK )
+        {
+            if( err ) *err = "inflateSetDictionary failed";
+            return Z_DATA_ERROR;
+        }
+        ret = inflate( &strm, Z_FINISH );
+    }
+    return ret;
+}
+
+inline uint64_t Kmer( const uint8_t* p, size_t k )
+{
+    uint64_t v = 0;
+    memcpy( &v, p, k );
+    return v;
+}
+
+}
+
+uint32_t DictId( const uint8_t* dict, size_t size )
+{
+    return (uint32_t)adler32( adler32( 0L, Z_NULL, 0 ), dict, (uInt)size );
+}
+
+bool StreamDictId( const uint8_t* data, size_t size, uint32_t& id )
+{
+    if( size < 6 || ( data[0] & 0x0F ) != 8 || ( ( data[0] << 8 ) | data[1] ) % 31 != 0 || !( data[1] & 0x20 ) ) return false;
+    id = (uint32_t)data[2] << 24 | (uint32_t)data[3] << 16 | (uint32_t)data[4] << 8 | data[5];
+    return true;
+}
+
+std::vector<uint8_t> Compress( const uint8_t* data, size_t size, const std::vector<uint8_t>& dict, int level )
+{
+    z_stream strm;
+    memset( &strm, 0, sizeof(strm) );
+    if( deflateInit2( &strm, level, Z_DEFLATED, 15, 9, Z_DEFAULT_STRATEGY ) != Z_OK ) return {};
+
+    if( !dict.empty() ) deflateSetDictionary( &strm, dict.data(), (uInt)dict.size() );
+
+    std::vector<uint8_t> out( deflateBound( &strm, size ) );
+    strm.next_in = const_cast<Bytef*>( data );
+    strm.avail_in = (uInt)size;
+    strm.next_out = out.data();
+    strm.avail_out = (uInt)out.size();
+    int ret = deflate( &strm, Z_FINISH );
+    out.resize( strm.total_out );
+    deflateEnd( &strm );
+
+    if( ret != Z_STREAM_END ) return {};
+    return out;
+}
+void Gain::Add( const uint8_t* data, size_t size, const std::vector<uint8_t>& dictionary, int level )
+{
+    static const std::vector<uint8_t> none;
+    payloads++;
+    raw += size;
+    plain += Compress( data, size, none, level ).size();
+    with_dict += Compress( data, size, dictionary, level ).size();
+    dict = dictionary.size();
+}
+
+double Gain::Reduction() const
+{
+    return plain ? 1.0 - (double)with_dict / plain : 0.0;
+}
+
+std::string Gain::Report() const
+{
+    double n = payloads ? (double)payloads : 1.0;
+    return Common::string_format( "raw %.0f bytes, zlib %.1f bytes, zlib+dict %.1f bytes (%.1f%% smaller than zlib), "
+        "dictionary %zu bytes, %zu payloads",
+        raw / n, plain / n, with_dict / n, 100.0 * Reduction(), dict, payloads );
+}
+
+
+std::vector<uint8_t> Train( const std::vector<std::vector<uint8_t>>& samples, const TrainParams& params )
+{
+    const size_t k = std::min<size_t>( std::max<size_t>( params.k, 4 ), 8 );
+    const size_t seg_len = std::max( params.segment, k );
+    const size_t dict_size = std::min( params.dict_size, MAX_SIZE );
+
+    // k byte 조각 -> 나오는 sample 수
+    std::unordered_map<uint64_t, uint32_t> freq;
+    std::vector<uint64_t> kmers;
+    for( auto& s : samples )
+    {
+        if( s.size() < k ) continue;
+        kmers.clear();
+        for( size_t i = 0; i + k <= s.size(); i++ ) kmers.push_back( Kmer( s.data() + i, k ) );
+        std::sort( kmers.begin(), kmers.end() );
+        kmers.erase( std::unique( kmers.begin(), kmers.end() ), kmers.end() );
+        for( uint64_t m : kmers ) freq[m]++;
+    }
+
+    struct Segment
+    {
+        const uint8_t* data;
+        size_t size;
+    };
+    std::vector<Segment> segments;
+    for( auto& s : samples )
+    {
+        for( size_t off = 0; off + k <= s.size(); off += seg_len )
+            segments.push_back( { s.data() + off, std::min( seg_len, s.size() - off ) } );
+    }
+
+    // 아직 덮지 않은, 두 개 이상의 sample 에 나오는 조각의 sample 수 합
+    auto score = [&]( const Segment& seg )
+    {
+        uint64_t total = 0;
+        std::vector<uint64_t> seen;
+        for( size_t i = 0; i + k <= seg.size; i++ )
+        {
+            uint64_t m = Kmer( seg.data + i, k );
+            if( std::find( seen.begin(), seen.end(), m ) != seen.end() ) continue;
+            seen.push_back( m );
+            auto it = freq.find( m );
+            if( it != freq.end() && it->second >= 2 ) total += it->second;
+        }
+        return total;
+    };
+
+    // 점수는 고를수록 줄기만 하므로 꺼낼 때 다시 계산해서 여전히 1 등이면 채택 (lazy greedy)
+    std::priority_queue<std::pair<uint64_t, size_t>> queue;
+    for( size_t i = 0; i < segments.size(); i++ )
+    {
+        if( uint64_t s = score( segments[i] ) ) queue.push( { s, i } );
+    }
+
+    std::vector<size_t> picked;
+    size_t bytes = 0;
+    while( bytes < dict_size && !queue.empty() )
+    {
+        auto top = queue.top();
+        queue.pop();
+
+        uint64_t s = score( segments[top.second] );
+        if( s == 0 ) continue;
+        if( !queue.empty() && s < queue.top().first )
+        {
+            queue.push( { s, top.second } );
+            continue;
+        }
+
+        const Segment& seg = segments[top.second];
+        for( size_t i = 0; i + k <= seg.size; i++ ) freq[Kmer( seg.data + i, k )] = 0;
+        picked.push_back( top.second );
+        bytes += seg.size;
+    }
+
+    // 먼저 고른 (점수가 높은) segment 를 뒤에. 넘치는 부분은 앞 (점수가 낮은 쪽) 에서 자른다
+    std::vector<uint8_t> dict;
+    for( auto it = picked.rbegin(); it != picked.rend(); ++it )
+        dict.insert( dict.end(), segments[*it].data, segments[*it].data + segments[*it].size );
+    if( dict.size() > dict_size ) dict.erase( dict.begin(), dict.end() - dict_size );
+    return dict;
+}
+
+Dictionary& Dictionary::Instance()
+{
+    static Dictionary dictionary;
+    return dictionary;
+}
+
+Dictionary::Dictionary()
+{
+    const char* env = getenv( "SPIBEAM_ZDICT" );
+    if( env && *env )
+    {
+        std::string err;
+        if( !Load( env, &err ) ) printf( ";SPIBEAM_ZDICT ignored : %s\n", err.c_str() );
+    }
+
+    Stats::Registry::Instance().AddSection( "zdict", [this]
+    {
+        return Loaded() || streams_ > 0 ? Report() : std::string();
+    });
+}
+
+bool Dictionary::Load( const std::string& path, std::string* err )
+{
+    FILE* fp = fopen( path.c_str(), "rb" );
+    if( !fp )
+    {
+        if( err ) *err = path + " : " + strerror( errno );
+        return false;
+    }
+
+    std::vector<uint8_t> dict( MAX_SIZE + 1 );
+    size_t n = fread( dict.data(), 1, dict.size(), fp );
+    fclose( fp );
+
+    if( n == 0 || n > MAX_SIZE )
+    {
+        if( err ) *err = Common::string_format( "%s : %zu bytes (1 .. %zu)", path.c_str(), n, MAX_SIZE );
+        return false;
+    }
+
+    dict.resize( n );
+    Set( std::move( dict ), path );
+    return true;
+}
+
+void Dictionary::Set( std::vector<uint8_t> dict, const std::string& source )
+{
+    uint32_t id = DictId( dict.data(), dict.size() );
+    auto p = std::make_shared<const std::vector<uint8_t>>( std::move( dict ) );
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+    dict_ = std::move( p );
+    id_ = id;
+    source_ = source;
+    last_.clear();
+}
+
+void Dictionary::Clear()
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    dict_.reset();
+    id_ = 0;
+    source_.clear();
+    last_.clear();
+}
+
+bool Dictionary::Loaded() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return dict_ != nullptr;
+}
+
+uint32_t Dictionary::Id() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return id_;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> Dictionary::Get( uint32_t& id ) const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    id = id_;
+    return dict_;
+}
+
+void Dictionary::Count( bool ok, size_t in, size_t out )
+{
+    if( !ok )
+    {
+        failures_++;
+        return;
+    }
+    streams_++;
+    in_bytes_ += in;
+    out_bytes_ += out;
+}
+
+bool Dictionary::Inflate( const uint8_t* data, size_t size, std::vector<uint8_t>& out, std::string* err )
+{
+    uint32_t id;
+    auto dict = Get( id );
+
+    z_stream strm;
+    memset( &strm, 0, sizeof(strm) );
+    if( inflateInit( &strm ) != Z_OK )
+    {
+        if( err ) *err = "zlib initialization failed";
+        return false;
+    }
+
+    // beam payload 는 수 KB. 모자라면 늘려 가며 계속
+    out.resize( std::max<size_t>( size * 4, 4096 ) );
+    strm.next_in = const_cast<Bytef*>( data );
+    strm.avail_in = (uInt)size;
+    strm.next_out = out.data();
+    strm.avail_out = (uInt)out.size();
+
+    int ret = InflateWithDict( strm, dict.get(), id, err );
+    // 입력을 다 읽었어도 inflate 안에 아직 못 내보낸 출력이 남아 있을 수 있으므로 avail_in 은 보지 않는다.
+    // 출력 buffer 가 찼으면 늘려서 계속, 진짜 error 거나 늘려도 진행이 없으면 멈춤
+    while( ( ret == Z_OK || ret == Z_BUF_ERROR ) && strm.avail_out == 0 )
+    {
+        size_t used = out.size();
+        out.resize( used * 2 );
+        strm.next_out = out.data() + used;
+        strm.avail_out = (uInt)( out.size() - used );
+
+        uLong before = strm.total_out;
+        ret = inflate( &strm, Z_FINISH );
+        if( ret == Z_BUF_ERROR && strm.total_out == before ) break;
+    }
+
+    out.resize( strm.total_out );
+    inflateEnd( &strm );
+
+    bool ok = ret == Z_STREAM_END;
+    if( !ok && err && err->empty() ) *err = Common::string_format( "inflate failed (%d)", ret );
+    Count( ok, size, out.size() );
+    if( ok )
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        if( dict_ == dict ) last_.assign( out.begin(), out.end() );
+    }
+    return ok;
+}
+
+bool Dictionary::Inflate( const uint8_t* data, size_t size, uint8_t* out, size_t out_size, std::string* err )
+{
+    uint32_t id;
+    auto dict = Get( id );
+
+    z_stream strm;
+    memset( &strm, 0, sizeof(strm) );
+    if( inflateInit( &strm ) != Z_OK )
+    {
+        if( err ) *err = "zlib initialization failed";
+        return false;
+    }
+
+    strm.next_in = const_cast<Bytef*>( data );
+    strm.avail_in = (uInt)size;
+    strm.next_out = out;
+    strm.avail_out = (uInt)out_size;
+
+    int ret = InflateWithDict( strm, dict.get(), id, err );
+    bool ok = ret == Z_STREAM_END && strm.total_out == out_size;
+    inflateEnd( &strm );
+
+    if( !ok && err && err->empty() ) *err = Common::string_format( "inflate failed (%d)", ret );
+    Count( ok, size, ok ? out_size : 0 );
+    return ok;
+}
+
+std::string Dictionary::Report() const
+{
+    uint32_t id;
+    auto dict = Get( id );
+
+    std::string rep;
+    std::vector<uint8_t> last;
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        rep = dict ? Common::string_format( "zdict : id 0x%08x, %zu bytes (%s)", id, dict->size(), source_.c_str() )
+                   : std::string( "zdict : none" );
+        if( dict ) last = last_;
+    }
+
+    uint64_t in = in_bytes_, out = out_bytes_;
+    rep += Common::string_format( "\r\n streams %llu, failed %llu, %llu -> %llu bytes (%.1f%% of inflated size)",
+        (unsigned long long)streams_.load(), (unsigned long long)failures_.load(),
+        (unsigned long long)in, (unsigned long long)out, out ? 100.0 * in / out : 0.0 );
+
+    // 받은 stream 은 dictionary 가 있는 것뿐이므로, 없을 때의 크기는 마지막 payload 를 다시 deflate 해 본다
+    if( !last.empty() )
+    {
+        Gain gain;
+        gain.Add( last.data(), last.size(), *dict );
+        rep += "\r\n last payload : " + gain.Report();
+    }
+    return rep;
+}
+
+void Dictionary::ResetStats()
+{
+    streams_ = 0;
+    failures_ = 0;
+    in_bytes_ = 0;
+    out_bytes_ = 0;
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+    last_.clear();
+}
+
+
+}
+}
@@ -0,0 +1,102 @@
+#ifndef __SPIBEAM_ZDICT_H__
+#define __SPIBEAM_ZDICT_H__
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace SpiBeam {
+namespace ZDict {
+
+// zlib preset dictionary (deflateSetDictionary / inflateSetDictionary).
+// client 와 server 가 같은 dictionary 를 가지고 있으면 beam payload 를 그 내용에 대한 참조로 보낼 수 있다.
+// FDICT=1 stream 의 header 에는 dictionary 의 Adler-32 (DICTID) 가 들어 있어, server 는 그 값으로 맞는지 확인한다
+constexpr size_t MAX_SIZE = 32768;     // deflate window 보다 앞은 참조할 수 없다
+
+uint32_t DictId( const uint8_t* dict, size_t size );
+
+// FDICT 가 켜진 zlib header 면 DICTID 를 꺼낸다
+bool StreamDictId( const uint8_t* data, size_t size, uint32_t& id );
+
+// dictionary 와 함께 deflate (client / tool / bench 용). dict 가 비어 있으면 보통 zlib
+std::vector<uint8_t> Compress( const uint8_t* data, size_t size, const std::vector<uint8_t>& dict, int level = 9 );
+
+// dictionary 로 link byte 가 얼마나 줄었는지. 같은 payload 를 dictionary 없이 / 함께 deflate 해 모은다
+struct Gain
+{
+    size_t payloads = 0;
+    size_t raw = 0;             // 원래 payload
+    size_t plain = 0;           // zlib, dictionary 없이
+    size_t with_dict = 0;       // zlib + dictionary
+    size_t dict = 0;            // dictionary 크기 (link 로 보내지 않고 양쪽이 미리 가지고 있는 것)
+
+    void Add( const uint8_t* data, size_t size, const std::vector<uint8_t>& dictionary, int level = 9 );
+    // dictionary 없는 zlib 대비 줄어든 비율 (0..1, 커지면 음수)
+    double Reduction() const;
+    // payload 당 평균
+    std::string Report() const;
+};
+
+// 여러 payload 에 공통으로 나오는 부분을 골라 dictionary 를 만든다.
+// sample 을 segment 단위로 나누고, segment 안의 k byte 조각이 몇 개의 sample 에 나오는지로 점수를 매겨
+// 아직 덮지 않은 조각이 많은 segment 부터 고른다. 점수가 높은 segment 가 dictionary 끝 (가까운 거리) 에 온다
+struct TrainParams
+{
+    size_t dict_size = 16384;
+    size_t k = 4;
+    size_t segment = 64;
+};
+
+std::vector<uint8_t> Train( const std::vector<std::vector<uint8_t>>& samples, const TrainParams& params = TrainParams() );
+
+// server 가 쓰는 dictionary. $SPIBEAM_ZDICT 파일이 있으면 처음 쓸 때 읽는다
+class Dictionary
+{
+public:
+    static Dictionary& Instance();
+
+    bool Load( const std::string& path, std::string* err = nullptr );
+    void Set( std::vector<uint8_t> dict, const std::string& source = "set" );
+    void Clear();
+
+    bool Loaded() const;
+    uint32_t Id() const;
+
+    // FDICT=1 zlib stream 을 푼다. DICTID 가 지금 dictionary 와 다르면 false
+    bool Inflate( const uint8_t* data, size_t size, std::vector<uint8_t>& out, std::string* err = nullptr );
+    // 풀린 크기가 out_size 와 정확히 같아야 true (bus stream 용)
+    bool Inflate( const uint8_t* data, size_t size, uint8_t* out, size_t out_size, std::string* err = nullptr );
+
+    std::string Report() const;
+    void ResetStats();
+
+private:
+    Dictionary();
+    Dictionary( const Dictionary& ) = delete;
+    Dictionary& operator=( const Dictionary& ) = delete;
+
+    std::shared_ptr<const std::vector<uint8_t>> Get( uint32_t& id ) const;
+    void Count( bool ok, size_t in, size_t out );
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<const std::vector<uint8_t>> dict_;
+    uint32_t id_ = 0;
+    std::string source_;
+
+    std::atomic<uint64_t> streams_ { 0 };
+    std::atomic<uint64_t> failures_ { 0 };
+    std::atomic<uint64_t> in_bytes_ { 0 };
+    std::atomic<uint64_t> out_bytes_ { 0 };
+
+    // Report 에서 dictionary 없는 zlib 과 비교할 마지막 BINARY payload (압축은 Report 할 때만)
+    std::vector<uint8_t> last_;
+};
+
+
+}
+}
+
+#endif
@@ -0,0 +1,260 @@
+// ============================================================================
+// ArbiterTests : HardwareArbiter lease ordering, expiry and nesting
+// ----------------------------------------------------------------------------
+// Build:
+//   g++ -O2 -std=c++17 -I.. bench/ArbiterTests.cpp HardwareArbiter.cpp BeamTrace.cpp SpiStats.cpp -lpthread
+//
+// Usage:
+//   ArbiterTests [--filter=<substr>]
+//
+// 기다리는 순서는 짧은 sleep 으로 만든다 (thread 가 줄을 서는 데 SETTLE 이면 충분).
+// 만료는 수십 ms 로 주고, 회수 시각은 넉넉한 상한으로만 본다.
+//   - priority 순, 같은 priority 는 먼저 온 순
+//   - expire_ms 가 지나도록 놓지 않은 Lease 의 회수, 회수된 Lease 의 Valid / 해제 (원격 beam 의 RemoteTxnLost 경로)
+//   - 같은 thread 의 겹친 Lease 는 하나로 세고, 안쪽 Lease 가 있는 동안은 회수하지 않는다
+//   - 다른 thread 에서의 해제는 무시된다
+// ============================================================================
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include "HardwareArbiter.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+using namespace std::chrono_literals;
+using Priority = HardwareArbiter::Priority;
+
+namespace {
+
+constexpr auto SETTLE = 30ms;
+
+double ElapsedMs( std::chrono::steady_clock::time_point t0 )
+{
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - t0 ).count();
+}
+
+// 한 번 열리면 계속 열려 있는 문
+class Gate
+{
+public:
+    void Open()
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        open_ = true;
+        cv_.notify_all();
+    }
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        cv_.wait( lock, [this]{ return open_; } );
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+void PriorityOrder()
+{
+    auto& arbiter = HardwareArbiter::Instance();
+    arbiter.ResetStats();
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto waiter = [&]( Priority p, const char* name )
+    {
+        return std::thread( [&, p, name]{
+            HardwareArbiter::Lease lease( p );
+            std::lock_guard<std::mutex> lock( mutex );
+            order.push_back( name );
+        });
+    };
+
+    std::vector<std::thread> threads;
+    {
+        HardwareArbiter::Lease hold( Priority::Console );
+
+        // 낮은 priority 가 먼저 줄을 선다
+        threads.push_back( waiter( Priority::Console, "console" ) );
+        std::this_thread::sleep_for( SETTLE );
+        threads.push_back( waiter( Priority::Remote, "remote1" ) );
+        std::this_thread::sleep_for( SETTLE );
+        threads.push_back( waiter( Priority::Remote, "remote2" ) );
+        std::this_thread::sleep_for( SETTLE );
+        threads.push_back( waiter( Priority::Tracking, "tracking" ) );
+        std::this_thread::sleep_for( SETTLE );
+
+        CHECK( order.empty() );
+    }
+    for( auto& t : threads ) t.join();
+
+    CHECK( ( order == std::vector<std::string>{ "tracking", "remote1", "remote2", "console" } ) );
+
+    // 먼저 기다리던 낮은 priority 를 앞지른 횟수 : tracking, remote1, remote2 가 console 을
+    std::string rep = arbiter.Report();
+    CHECK( rep.find( "tracking  n=1" ) != std::string::npos );
+    CHECK( rep.find( "overtakes 1" ) != std::string::npos );
+    CHECK( rep.find( "remote    n=2" ) != std::string::npos );
+}
+
+void SerialContinuity()
+{
+    uint64_t first, second;
+    {
+        HardwareArbiter::Lease lease( Priority::Console );
+        first = lease.Serial();
+        CHECK( lease.Valid() );
+    }
+    {
+        HardwareArbiter::Lease lease( Priority::Tracking );
+        second = lease.Serial();
+    }
+    CHECK( second == first + 1 );
+
+    // Run 도 Lease 하나
+    uint64_t inside = 0;
+    int v = HardwareArbiter::Instance().Run( Priority::Remote, [&]{
+        HardwareArbiter::Lease nested( Priority::Remote );
+        inside = nested.Serial();
+        return 7;
+    });
+    CHECK( v == 7 && inside == second + 1 );
+}
+
+void ExpiryReclaim()
+{
+    auto& arbiter = HardwareArbiter::Instance();
+    arbiter.ResetStats();
+
+    // 원격 transaction 처럼 datagram 사이에 Lease 를 들고 쉬는 holder
+    Gate held, release;
+    std::atomic<bool> valid_after_reclaim { true };
+    std::thread holder( [&]{
+        auto lease = std::make_unique<HardwareArbiter::Lease>( Priority::Remote, 50 );
+        held.Open();
+        release.Wait();
+        valid_after_reclaim = lease->Valid();
+        lease.reset();      // 회수된 Lease 의 해제 : 지금 holder 를 풀면 안 된다
+    });
+    held.Wait();
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::optional<HardwareArbiter::Lease> lease;
+    lease.emplace( Priority::Console );
+    double waited = ElapsedMs( t0 );
+    CHECK( waited >= 45.0 );
+    CHECK( waited < 1000.0 );
+    CHECK( lease->Valid() );
+
+    release.Open();
+    holder.join();
+    CHECK( !valid_after_reclaim );
+    CHECK( lease->Valid() );
+
+    // 회수된 Lease 의 해제가 지금 holder 를 풀었다면 여기서 바로 잡힌다
+    std::atomic<bool> got { false };
+    std::thread other( [&]{ HardwareArbiter::Lease l( Priority::Tracking ); got = true; } );
+    std::this_thread::sleep_for( SETTLE );
+    CHECK( !got );
+    lease.reset();
+    other.join();
+    CHECK( got );
+
+    CHECK( arbiter.Report().find( "expired leases 1" ) != std::string::npos );
+}
+
+void NestedLease()
+{
+    auto& arbiter = HardwareArbiter::Instance();
+    arbiter.ResetStats();
+
+    // 같은 thread 의 겹친 Lease 는 같은 transaction
+    std::optional<HardwareArbiter::Lease> outer;
+    outer.emplace( Priority::Console );
+    {
+        HardwareArbiter::Lease inner( Priority::Tracking );
+        CHECK( inner.Serial() == outer->Serial() );
+    }
+    CHECK( outer->Valid() );
+
+    std::atomic<bool> got { false };
+    std::thread other( [&]{ HardwareArbiter::Lease l( Priority::Tracking ); got = true; } );
+    std::this_thread::sleep_for( SETTLE );
+    CHECK( !got );      // 안쪽이 풀려도 바깥 Lease 는 계속
+    outer.reset();
+    other.join();
+    CHECK( got );
+
+    // 안쪽 Lease 가 일하는 동안은 만료가 지나도 회수하지 않고, 안쪽이 풀리면 만료를 다시 센다
+    Gate held, inner_done, finish;
+    std::atomic<bool> inner_valid { false };
+    std::thread holder( [&]{
+        HardwareArbiter::Lease outer( Priority::Remote, 40 );
+        {
+            HardwareArbiter::Lease inner( Priority::Remote );
+            held.Open();
+            std::this_thread::sleep_for( 150ms );
+            inner_valid = inner.Valid();
+        }
+        inner_done.Open();
+        finish.Wait();
+    });
+    held.Wait();
+
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        HardwareArbiter::Lease lease( Priority::Tracking );
+        double waited = ElapsedMs( t0 );
+        inner_done.Wait();
+        CHECK( inner_valid );
+        CHECK( waited >= 170.0 );       // 안쪽 150ms + 안쪽이 풀린 뒤 다시 센 만료 40ms
+        CHECK( waited < 1000.0 );
+    }
+    finish.Open();
+    holder.join();
+
+    CHECK( arbiter.Report().find( "expired leases 1" ) != std::string::npos );
+}
+
+void WrongThreadRelease()
+{
+    auto& arbiter = HardwareArbiter::Instance();
+    arbiter.ResetStats();
+
+    // 다른 thread 에서 소멸시킨 Lease 는 풀리지 않는다 (만료로만 회수)
+    HardwareArbiter::Lease* lease = nullptr;
+    std::thread owner( [&]{ lease = new HardwareArbiter::Lease( Priority::Remote, 60 ); } );
+    owner.join();
+    CHECK( lease->Valid() );
+
+    auto t0 = std::chrono::steady_clock::now();
+    delete lease;
+    {
+        HardwareArbiter::Lease next( Priority::Console );
+        double waited = ElapsedMs( t0 );
+        CHECK( waited >= 50.0 );
+        CHECK( waited < 1000.0 );
+    }
+    CHECK( arbiter.Report().find( "expired leases 1" ) != std::string::npos );
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "Arbiter/PriorityOrder", PriorityOrder },
+        { "Arbiter/SerialContinuity", SerialContinuity },
+        { "Arbiter/ExpiryReclaim", ExpiryReclaim },
+        { "Arbiter/NestedLease", NestedLease },
+        { "Arbiter/WrongThreadRelease", WrongThreadRelease },
+    });
+}
@@ -0,0 +1,518 @@
+// ============================================================================
+// BeamBench : control-plane hot path micro-benchmarks
+// ----------------------------------------------------------------------------
+// Build (same include/link set as the controller, without main.cpp):
+//   g++ -O2 -std=c++17 -I.. bench/BeamBench.cpp BeamPipeline.cpp BeamTrace.cpp SpiStats.cpp
+//       SpiTimingModel.cpp HardwareContext.cpp WarmStart.cpp PanelLayout.cpp TrigTable.cpp SpiwriteCommand.cpp
+//       SpiwriteProtocol.cpp HardwareArbiter.cpp HealthMonitor.cpp BeamEngine.cpp PayloadCache.cpp
+//       BusStreams.cpp RtProfile.cpp ZDict.cpp
+//       -lz -llzma -lcrypto -lpthread
+//
+// Usage:
+//   BeamBench [--filter=<substr>] [--min_time=<sec>] [--out=<file.json>]
+//
+// Output is Google Benchmark compatible JSON (context + benchmarks[]), so
+// results from x86 and the ARM target can be compared with the usual
+// compare.py tooling.
+// ============================================================================
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <unistd.h>
+#include <fcntl.h>
+#include <zlib.h>
+
+#include "BeamPipeline.h"
+#include "PanelLayout.h"
+#include "TrigTable.h"
+#include "SpiwriteCommand.h"
+#include "HardwareContext.h"
+#include "SpiwriteProtocol.h"
+#include "SpiwriteFrameHandler.h"
+#include "PayloadCache.h"
+#include "BusStreams.h"
+#include "ZDict.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+struct BenchResult
+{
+    std::string name;
+    uint64_t iterations = 0;
+    double real_ns = 0.0;       // per iteration
+    double cpu_ns = 0.0;        // per iteration
+    double items_per_iteration = 1.0;
+};
+
+double ThreadCpuNs()
+{
+    timespec ts;
+    clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts );
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 컨트롤러 코드 (zlib / devmem log 등) 의 printf 가 결과 JSON 에 섞이거나 측정값을 왜곡하지 않도록
+// 시작할 때 stdout 을 복제해 결과용으로 남겨 두고, 실행 내내 stdout 은 /dev/null 로 보낸다.
+// setup / 첫 호출 경로처럼 bench.Run 밖에서 불리는 코드도 모두 가려진다.
+FILE* DetachStdout()
+{
+    fflush( stdout );
+    int report_fd = dup( STDOUT_FILENO );
+    int devnull = open( "/dev/null", O_WRONLY );
+    if( report_fd < 0 || devnull < 0 ) return stdout;
+    dup2( devnull, STDOUT_FILENO );
+    close( devnull );
+
+    FILE* report = fdopen( report_fd, "w" );
+    return report ? report : stdout;
+}
+
+class Bench
+{
+public:
+    Bench( std::string filter, double min_time ) : filter_( filter ), min_time_s_( min_time ) {}
+
+    void Run( const std::string& name, std::function<void()> fn, double items_per_iteration = 1.0 )
+    {
+        if( !filter_.empty() && name.find( filter_ ) == std::string::npos ) return;
+
+        using clock = std::chrono::steady_clock;
+        BenchResult r;
+        r.name = name;
+        r.items_per_iteration = items_per_iteration;
+
+        fn(); // warm-up
+
+        uint64_t iters = 1;
+        for(;;)
+        {
+            auto t0 = clock::now();
+            double c0 = ThreadCpuNs();
+            for( uint64_t i = 0; i < iters; i++ ) fn();
+            double c1 = ThreadCpuNs();
+            double real = std::chrono::duration<double, std::nano>( clock::now() - t0 ).count();
+
+            if( real >= min_time_s_ * 1e9 || iters >= (1ULL << 30) )
+            {
+                r.iterations = iters;
+                r.real_ns = real / iters;
+                r.cpu_ns = (c1 - c0) / iters;
+                break;
+            }
+
+            // 목표 시간에 맞게 반복 횟수 증가 (최대 10배)
+            double scale = real > 0 ? (min_time_s_ * 1e9 * 1.4) / real : 10.0;
+            if( scale > 10.0 ) scale = 10.0;
+            if( scale < 2.0 ) scale = 2.0;
+            iters = (uint64_t)(iters * scale);
+        }
+
+        fprintf( stderr, "%-36s %12llu %14.1f ns %14.1f ns\n",
+            r.name.c_str(), (unsigned long long)r.iterations, r.real_ns, r.cpu_ns );
+        results_.push_back( r );
+    }
+
+    std::string ToJson( const char* executable ) const
+    {
+        char host[256] = {0};
+        gethostname( host, sizeof(host) - 1 );
+
+        char date[64];
+        time_t now = time( nullptr );
+        strftime( date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime( &now ) );
+
+#if defined(__aarch64__)
+        const char* arch = "aarch64";
+#elif defined(__arm__)
+        const char* arch = "arm";
+#elif defined(__x86_64__)
+        const char* arch = "x86_64";
+#else
+        const char* arch = "unknown";
+#endif
+
+        std::string json;
+        json += "{\n  \"context\": {\n";
+        json += Format( "    \"date\": \"%s\",\n", date );
+        json += Format( "    \"host_name\": \"%s\",\n", host );
+        json += Format( "    \"executable\": \"%s\",\n", executable );
+        json += Format( "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency() );
+        json += Format( "    \"arch\": \"%s\",\n", arch );
+#ifdef NDEBUG
+        json += "    \"library_build_type\": \"release\"\n";
+#else
+        json += "    \"library_build_type\": \"debug\"\n";
+#endif
+        json += "  },\n  \"benchmarks\": [\n";
+
+        for( size_t i = 0; i < results_.size(); i++ )
+        {
+            auto& r = results_[i];
+            json += "    {\n";
+            json += Format( "      \"name\": \"%s\",\n", r.name.c_str() );
+            json += Format( "      \"run_name\": \"%s\",\n", r.name.c_str() );
+            json += "      \"run_type\": \"iteration\",\n";
+            json += Format( "      \"iterations\": %llu,\n", (unsigned long long)r.iterations );
+            json += Format( "      \"real_time\": %.3f,\n", r.real_ns );
+            json += Format( "      \"cpu_time\": %.3f,\n", r.cpu_ns );
+            json += "      \"time_unit\": \"ns\",\n";
+            json += Format( "      \"items_per_second\": %.3f\n", r.real_ns > 0 ? r.items_per_iteration * 1e9 / r.real_ns : 0.0 );
+            json += (i + 1 < results_.size()) ? "    },\n" : "    }\n";
+        }
+        json += "  ]\n}\n";
+        return json;
+    }
+
+private:
+    template<class... A>
+    static std::string Format( const char* fmt, A... args )
+    {
+        char buf[512];
+        snprintf( buf, sizeof(buf), fmt, args... );
+        return buf;
+    }
+
+    std::string filter_;
+    double min_time_s_;
+    std::vector<BenchResult> results_;
+};
+
+// 실제 beam payload 와 같은 모양 : "BINARY" 뒤 3 byte header + bus 8 x 128 element x 2 byte
+std::vector<uint8_t> MakeBinaryPayload( int is_tx )
+{
+    az_value = 12.5f;
+    el_value = 30.0f;
+    freq_Hz = is_tx ? 29500000000ULL : 19700000000ULL;
+
+    auto entries = BeamPipeline::BuildEntries( is_tx, 5.0f, 5.0f );
+    BeamPipeline::ComputePhases( entries );
+    BeamPipeline::SortByBus( entries );
+
+    std::vector<uint8_t> data( 3, 0 );
+    for( auto& e : entries )
+    {
+        uint16_t v = BeamPipeline::EncodeValue( BeamPipeline::PhaseIndex( e.final_phase ), is_tx );
+        data.push_back( v >> 8 );
+        data.push_back( v & 0xFF );
+    }
+    return data;
+}
+
+// 같은 beam 의 compact payload : mode byte + element 마다 6 bit phase
+std::vector<uint8_t> MakePhase6Payload( int is_tx )
+{
+    auto layout = Layout::Registry::Instance().Get( is_tx );
+    std::vector<uint8_t> idx( layout->Size() );
+    BeamPipeline::ComputeIndicesFixed( *layout, 12.5f, 30.0f, is_tx ? 29500000000ULL : 19700000000ULL, idx.data() );
+
+    std::vector<uint8_t> data( 1 + BeamPipeline::Phase6Bytes( idx.size() ) );
+    data[0] = is_tx ? BeamPipeline::PHASE6_MODE_TX : BeamPipeline::PHASE6_MODE_RX;
+    BeamPipeline::PackPhases6( idx.data(), idx.size(), data.data() + 1 );
+    return data;
+}
+
+// az/el grid 로 학습한 preset dictionary (ZDictTrain 기본값과 같은 방식)
+std::vector<uint8_t> TrainBeamDictionary( int is_tx )
+{
+    auto layout = Layout::Registry::Instance().Get( is_tx );
+    std::vector<uint8_t> idx( layout->Size() );
+    std::vector<std::vector<uint8_t>> samples;
+    for( int el = 0; el <= 60; el += 10 )
+    {
+        for( int az = 0; az < 360; az += 10 )
+        {
+            BeamPipeline::ComputeIndicesFixed( *layout, (float)az, (float)el, is_tx ? 29500000000ULL : 19700000000ULL, idx.data() );
+            std::vector<uint8_t> data( 3, 0 );
+            for( uint8_t i : idx )
+            {
+                uint16_t v = BeamPipeline::EncodeValue( i, is_tx );
+                data.push_back( v >> 8 );
+                data.push_back( v & 0xFF );
+            }
+            samples.push_back( std::move( data ) );
+        }
+    }
+    return ZDict::Train( samples );
+}
+
+std::vector<uint8_t> Compress( const std::vector<uint8_t>& raw )
+{
+    uLongf len = compressBound( raw.size() );
+    std::vector<uint8_t> out( len );
+    compress2( out.data(), &len, raw.data(), raw.size(), Z_BEST_COMPRESSION );
+    out.resize( len );
+    return out;
+}
+
+std::vector<uint8_t> MakeLinesFrame( const char* text, uint32_t sequence )
+{
+    SpiwriteProtocol::MessageLines msg( text );
+    SpiwriteProtocol::Frame f {
+        SpiwriteProtocol::Header{
+            SpiwriteProtocol::MSG_STRAT_CODE, sequence, SpiwriteProtocol::MSG_LINES, (uint32_t)msg.lines.size()
+        }.ToNetwork(),
+        SpiwriteProtocol::MessageRaw( std::move(msg.lines) )
+    };
+    return f.DeepCopy();
+}
+
+class NullFrameHandler : public SpiwriteProtocol::FrameHandler
+{
+public:
+    NullFrameHandler() { SetOnSend( [](const uint8_t*, int){} ); }
+    void OnMessage( const SpiwriteProtocol::Header&, const SpiwriteProtocol::MessageLines& msg ) override
+    {
+        bytes += msg.lines.size();
+    }
+    size_t bytes = 0;
+};
+
+}
+
+int main( int argc, char** argv )
+{
+    std::string filter;
+    std::string out_path;
+    double min_time = 0.5;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        std::string a = argv[i];
+        if( a.rfind( "--filter=", 0 ) == 0 ) filter = a.substr( 9 );
+        else if( a.rfind( "--min_time=", 0 ) == 0 ) min_time = atof( a.c_str() + 11 );
+        else if( a.rfind( "--out=", 0 ) == 0 ) out_path = a.substr( 6 );
+        else
+        {
+            fprintf( stderr, "usage: %s [--filter=<substr>] [--min_time=<sec>] [--out=<file.json>]\n", argv[0] );
+            return 1;
+        }
+    }
+
+    FILE* report = DetachStdout();
+    SpiwriteProtocol::MessageRaw::ShowCopyConstructorMessage( false );
+    Bench bench( filter, min_time );
+
+    // phase() : element 하나
+    {
+        az_value = 12.5f;
+        el_value = 30.0f;
+        freq_Hz = 29500000000ULL;
+        float x = 0.0f;
+        volatile float sink = 0.0f;
+        bench.Run( "BM_Phase", [&]{
+            sink = phase( x, 77.5f );
+            x = (x < 155.0f) ? x + 5.0f : 0.0f;
+        });
+    }
+
+    // per-beam trig 항 : libm float 경로 vs Q9.7 table
+    {
+        volatile float sink = 0.0f;
+        float deg = 0.0f;
+        bench.Run( "BM_SinCosLibm", [&]{
+            float r = deg * 3.14159265359f / 180.0f;
+            sink = std::cos( r ) + std::sin( r );
+            deg = ( deg < 359.0f ) ? deg + 0.37f : 0.0f;
+        });
+        bench.Run( "BM_SinCosTable", [&]{
+            float s, c;
+            Trig::SinCos( deg, s, c );
+            sink = s + c;
+            deg = ( deg < 359.0f ) ? deg + 0.37f : 0.0f;
+        });
+    }
+
+    // ConsoleRunner 의 1024 element beam build (layout + phase + sort + encode)
+    {
+        volatile uint16_t sink = 0;
+        bench.Run( "BM_BeamBuild1024/tx", [&]{
+            az_value = 12.5f; el_value = 30.0f; freq_Hz = 29500000000ULL;
+            auto entries = BeamPipeline::BuildEntries( 1, 5.0f, 5.0f );
+            BeamPipeline::ComputePhases( entries );
+            BeamPipeline::SortByBus( entries );
+            for( auto& e : entries ) sink = BeamPipeline::EncodeValue( BeamPipeline::PhaseIndex( e.final_phase ), 1 );
+        }, 1024 );
+    }
+
+    // byte queue packing : 1024 element x 5 byte -> 1280 word
+    {
+        az_value = 12.5f; el_value = 30.0f; freq_Hz = 29500000000ULL;
+        auto entries = BeamPipeline::BuildEntries( 1, 5.0f, 5.0f );
+        BeamPipeline::ComputePhases( entries );
+        BeamPipeline::SortByBus( entries );
+
+        BeamPipeline::BytePacker packer;
+        volatile uint32_t sink = 0;
+        bench.Run( "BM_BytePack1024", [&]{
+            uint32_t word;
+            for( auto& e : entries )
+            {
+                packer.Push( e.spi_id, e.chip_id, e.channel_id, 0xA5FE );
+                while( packer.PopWord( e.spi_id, word ) ) sink = word;
+            }
+        }, 1024 );
+    }
+
+    // compiled layout flat kernel : 32x32 와 2x2 tile(4096 element, 32 bus) 의 element 당 비용 비교
+    {
+        Layout::Spec spec = Layout::DefaultSpec( 1 );
+        for( int tiles : { 1, 2 } )
+        {
+            spec.tiles_y = spec.tiles_x = tiles;
+            auto L = Layout::Compile( spec );
+            std::vector<uint8_t> idx( L.Size() );
+            std::vector<uint32_t> words;
+            volatile uint32_t sink = 0;
+
+            bench.Run( "BM_ComputeIndices/" + std::to_string( L.Size() ), [&]{
+                BeamPipeline::ComputeIndices( L, 12.5f, 30.0f, 29500000000ULL, idx.data() );
+                sink = idx[0];
+            }, L.Size() );
+
+            bench.Run( std::string( "BM_ComputeIndicesFixed/" ) + BeamPipeline::FixedKernelName() + "/" + std::to_string( L.Size() ), [&]{
+                BeamPipeline::ComputeIndicesFixed( L, 12.5f, 30.0f, 29500000000ULL, idx.data() );
+                sink = idx[0];
+            }, L.Size() );
+
+            bench.Run( "BM_PackBus/" + std::to_string( L.Size() ), [&]{
+                for( int b = 0; b < L.num_bus; b++ ) sink = BeamPipeline::PackBus( L, idx.data(), 1, b, words );
+            }, L.Size() );
+        }
+    }
+
+    // DecodeFrame / FrameHandler::OnReceive
+    {
+        std::string text( 1024, 'a' );
+        auto frame = MakeLinesFrame( text.c_str(), 1 );
+        size_t sink = 0;
+        bench.Run( "BM_DecodeFrame/1k", [&]{
+            auto f = SpiwriteProtocol::DecodeFrame( frame.data(), (int)frame.size() );
+            sink += f.Length();
+        });
+
+        NullFrameHandler handler;
+        bench.Run( "BM_FrameHandlerOnReceive/1k", [&]{
+            handler.OnReceive( frame.data(), (int)frame.size() );
+        });
+    }
+
+    // zlib inflate of a real beam payload
+    {
+        auto compressed = Compress( MakeBinaryPayload( 1 ) );
+        size_t sink = 0;
+        bench.Run( "BM_DecompressZlib/beam", [&]{
+            sink += SpiwriteProtocol::decompress_zlib_verbose( compressed ).size();
+        });
+
+        // compact phase payload 는 inflate 대신 unpack + pack
+        auto phase6 = MakePhase6Payload( 1 );
+        std::vector<uint8_t> idx( Layout::Registry::Instance().Get( 1 )->Size() );
+        bench.Run( "BM_UnpackPhases6/beam", [&]{
+            BeamPipeline::UnpackPhases6( phase6.data() + 1, idx.size(), idx.data() );
+        });
+
+        // bus 별 stream : worker pool 이 bus 마다 하나씩 inflate
+        auto layout = Layout::Registry::Instance().Get( 1 );
+        auto bus_payload = BusStreams::Encode( *layout, MakeBinaryPayload( 1 ) );
+        std::vector<BusStreams::Stream> streams;
+        BusStreams::Parse( bus_payload.data(), bus_payload.size(), layout->num_bus, streams );
+        std::vector<uint8_t> values( 2 * layout->Size() );
+        bench.Run( "BM_InflateBusStreams/beam", [&]{
+            BusStreams::Pool::Instance().Run( layout->num_bus, [&]( int bus ){
+                BusStreams::Inflate( streams[bus], values.data() + 2 * layout->bus_begin[bus], 2 * layout->BusSize( bus ) );
+            });
+        });
+
+        // preset dictionary : FDICT stream 을 inflateSetDictionary 로
+        auto& zdict = ZDict::Dictionary::Instance();
+        auto dict = TrainBeamDictionary( 1 );
+        zdict.Set( dict, "bench" );
+        auto raw = MakeBinaryPayload( 1 );
+        auto dict_compressed = ZDict::Compress( raw.data(), raw.size(), dict );
+        std::vector<uint8_t> inflated;
+        bench.Run( "BM_InflateZlibDict/beam", [&]{
+            zdict.Inflate( dict_compressed.data(), dict_compressed.size(), inflated );
+            sink += inflated.size();
+        });
+        zdict.Clear();
+        zdict.ResetStats();
+
+        fprintf( stderr, "beam payload : raw %zu bytes, zlib %zu bytes, zlib+dict %zu bytes (%zu byte dictionary), phase6 %zu bytes, bus streams %zu bytes (%d workers)\n",
+            raw.size(), compressed.size(), dict_compressed.size(), dict.size(), phase6.size(), bus_payload.size(), BusStreams::Pool::Instance().Workers() );
+    }
+
+    // MemoryWriter / parse_binary_commands against anonymous mmap
+    {
+        Controller::CodeGenerator cgen;
+        Parser::LineParser parser;
+        SpiwriteProtocol::SpiwriteCommand cmd( &cgen, &parser );
+        cmd.wr.initializeAnonymous( HardwareContext::BASE_ADDR, HardwareContext::Instance().MapSize() );
+
+        uint32_t v = 0;
+        bench.Run( "BM_MemoryWriterWrite", [&]{
+            cmd.wr.writeMemory( 0x43C40010, v++ );
+        });
+
+        // 현재 구현은 bus 전환마다 10ms sleep 이 들어가 있어 sleep 이 지배적
+        auto payload = MakeBinaryPayload( 1 );
+        bench.Run( "BM_ParseBinaryCommands/beam", [&]{
+            cmd.parse_binary_commands( payload );
+        }, 1024 );
+
+        // compact phase payload : unpack, pack, FIFO fill 까지 (send 는 done 에서). 같은 payload 이므로 cache 는 끄고
+        auto phase6 = MakePhase6Payload( 1 );
+        std::string phase6_command = "BINARY:" + std::string( reinterpret_cast<const char*>( phase6.data() ), phase6.size() );
+        Cache::PayloadCache::Instance().SetCapacity( 0 );
+        bench.Run( "BM_ExecutePhase6/beam", [&]{
+            cmd.Execute( phase6_command );
+        }, 1024 );
+
+        // bus 별 stream : inflate, pack, FIFO fill 을 bus 마다 동시에
+        auto bus_payload = BusStreams::Encode( *Layout::Registry::Instance().Get( 1 ), MakeBinaryPayload( 1 ) );
+        std::string bus_command = "BINARY:" + std::string( reinterpret_cast<const char*>( bus_payload.data() ), bus_payload.size() );
+        bench.Run( "BM_ExecuteBusStreams/beam", [&]{
+            cmd.Execute( bus_command );
+        }, 1024 );
+        Cache::PayloadCache::Instance().SetCapacity( Cache::PayloadCache::DEFAULT_CAPACITY );
+
+        // 같은 zlib payload 반복 : 첫 번째만 inflate / parse, 나머지는 cache 의 bus word 를 바로 FIFO 에
+        auto zlib = Compress( MakeBinaryPayload( 1 ) );
+        std::string zlib_command = "BINARY:" + std::string( reinterpret_cast<const char*>( zlib.data() ), zlib.size() );
+        cmd.Execute( zlib_command );
+        bench.Run( "BM_ExecuteBinaryCached/beam", [&]{
+            cmd.Execute( zlib_command );
+        }, 1024 );
+
+        size_t sink = 0;
+        bench.Run( "BM_PayloadHash/beam", [&]{
+            sink += Cache::Hash64( zlib.data(), zlib.size() );
+        });
+    }
+
+    std::string json = bench.ToJson( argv[0] );
+    if( out_path.empty() )
+    {
+        fputs( json.c_str(), report );
+        fflush( report );
+    }
+    else
+    {
+        FILE* fp = fopen( out_path.c_str(), "w" );
+        if( !fp )
+        {
+            fprintf( stderr, "cannot open %s\n", out_path.c_str() );
+            return 1;
+        }
+        fputs( json.c_str(), fp );
+        fclose( fp );
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+// ============================================================================
+// BeamCommandTests : server-side beam command input checks and reuse
+// ----------------------------------------------------------------------------
+// Build (same include/link set as BeamBench):
+//   g++ -O2 -std=c++17 -I.. bench/BeamCommandTests.cpp BeamPipeline.cpp BeamTrace.cpp SpiStats.cpp
+//       SpiTimingModel.cpp HardwareContext.cpp WarmStart.cpp PanelLayout.cpp TrigTable.cpp SpiwriteCommand.cpp
+//       SpiwriteProtocol.cpp HardwareArbiter.cpp HealthMonitor.cpp BeamEngine.cpp PayloadCache.cpp
+//       BusStreams.cpp RtProfile.cpp ZDict.cpp
+//       -lz -llzma -lcrypto -lpthread
+//
+// Usage:
+//   BeamCommandTests [--filter=<substr>]
+//
+// ValidSteering / ValidFreqGHz 의 범위와 nan / inf, 원격 beam 명령이 from_chars 가 받는 값
+// (nan, inf, 1e300) 과 범위 밖 각도를 거절하는지 본다. 받아들인 beam 은 send register 를
+// 바로 0 으로 돌려주는 register file backend 위에서 돌리고, 같은 beam 의 재사용이
+// payload cache 가 아닌 beam_reuse counter 로 세어지는지 확인한다.
+// start 로 잡은 원격 transaction 을 HoldsRemote 가 보이는지 (session eviction 이 보는 값),
+// Stats report 의 section 이 RemoveSection 으로 빠지는지도 본다.
+// ============================================================================
+#include <map>
+#include <mutex>
+#include <limits>
+#include <string>
+
+#include "BeamPipeline.h"
+#include "SpiStats.h"
+#include "SpiwriteCommand.h"
+#include "RegisterBackend.h"
+#include "HardwareContext.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+const double Inf = std::numeric_limits<double>::infinity();
+
+// 쓴 값을 그대로 돌려주는 register file. send (0x43c00014) 는 바로 완료된 것으로 0
+class RegisterFile : public SpiwriteProtocol::RegisterBackend
+{
+public:
+    bool Write( uintptr_t address, uint32_t value ) override
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        regs_[address] = address == 0x43c00014 ? 0 : value;
+        return true;
+    }
+    bool Read( uintptr_t address, uint32_t& value ) override
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        auto it = regs_.find( address );
+        value = it == regs_.end() ? 0 : it->second;
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<uintptr_t, uint32_t> regs_;
+};
+
+void SteeringRange()
+{
+    std::string err;
+    CHECK( BeamPipeline::ValidSteering( 0, 0 ) );
+    CHECK( BeamPipeline::ValidSteering( -360, 90 ) );
+    CHECK( BeamPipeline::ValidSteering( 360, 45.5 ) );
+    CHECK( !BeamPipeline::ValidSteering( 360.5, 10, &err ) && !err.empty() );
+    CHECK( !BeamPipeline::ValidSteering( 0, -0.1 ) );
+    CHECK( !BeamPipeline::ValidSteering( 0, 90.1 ) );
+    CHECK( !BeamPipeline::ValidSteering( 1e300, 10 ) );
+    CHECK( !BeamPipeline::ValidSteering( NaN, 10 ) );
+    CHECK( !BeamPipeline::ValidSteering( 10, NaN ) );
+    CHECK( !BeamPipeline::ValidSteering( -Inf, 10 ) );
+
+    CHECK( BeamPipeline::ValidFreqGHz( 29.5 ) );
+    CHECK( !BeamPipeline::ValidFreqGHz( 0 ) );
+    CHECK( !BeamPipeline::ValidFreqGHz( NaN ) );
+    CHECK( !BeamPipeline::ValidFreqGHz( Inf ) );
+    CHECK( !BeamPipeline::ValidFreqGHz( 1e6 ) );
+}
+
+void RemoteBeam()
+{
+    static RegisterFile regs;
+    Controller::CodeGenerator cgen;
+    Parser::LineParser parser;
+    SpiwriteProtocol::SpiwriteCommand cmd( &cgen, &parser );
+    cmd.wr.initializeBackend( HardwareContext::BASE_ADDR, HardwareContext::Instance().MapSize(), &regs );
+
+    auto starts = [&]( const std::string& command, const char* prefix )
+    {
+        return cmd.Execute( command ).message.rfind( prefix, 0 ) == 0;
+    };
+
+    CHECK( starts( "beam tx nan 10", "beam : " ) );
+    CHECK( starts( "beam tx 10 inf", "beam : " ) );
+    CHECK( starts( "beam tx 1e300 10", "beam : " ) );
+    CHECK( starts( "beam tx 361 10", "beam : " ) );
+    CHECK( starts( "beam rx 10 -1", "beam : " ) );
+    CHECK( starts( "beam rx 10 91", "beam : " ) );
+    CHECK( starts( "beam tx 10 10 nan", "beam : " ) );
+    CHECK( starts( "beam tx 10 10 -5", "beam : " ) );
+    CHECK( starts( "beam tx 10x 10", "usage : beam" ) );
+    CHECK( starts( "beam up 10 10", "usage : beam" ) );
+    CHECK( starts( "beam tx 10", "usage : beam" ) );
+
+    // 같은 beam 을 다시 보내면 직전 FIFO word 를 재사용. payload cache counter 는 건드리지 않는다
+    auto& stats = Stats::Registry::Instance();
+    stats.Reset();
+
+    std::string first = cmd.Execute( "beam tx 10 20" ).message;
+    CHECK( first.rfind( "beam tx az 10.00 el 20.00 freq 29.500 GHz :", 0 ) == 0 );
+    CHECK( first.find( "(cached)" ) == std::string::npos );
+
+    std::string again = cmd.Execute( "beam tx 10 20" ).message;
+    CHECK( again.find( "(cached)" ) != std::string::npos );
+    CHECK( again.find( "send not completed" ) == std::string::npos );
+
+    std::string other = cmd.Execute( "beam rx 10 20 19.7" ).message;
+    CHECK( other.rfind( "beam rx az 10.00 el 20.00 freq 19.700 GHz :", 0 ) == 0 );
+
+    CHECK( stats.Get( Stats::Counter::BeamReuseHits ) == 1 );
+    CHECK( stats.Get( Stats::Counter::BeamReuseMisses ) == 2 );
+    CHECK( stats.Get( Stats::Counter::CacheHits ) == 0 );
+    CHECK( stats.Get( Stats::Counter::CacheMisses ) == 0 );
+    CHECK( stats.Report().find( "beam_reuse_hits   1" ) != std::string::npos );
+}
+
+void RemoteLease()
+{
+    static RegisterFile regs;
+    Controller::CodeGenerator cgen;
+    Parser::LineParser parser;
+    SpiwriteProtocol::SpiwriteCommand cmd( &cgen, &parser );
+    cmd.wr.initializeBackend( HardwareContext::BASE_ADDR, HardwareContext::Instance().MapSize(), &regs );
+
+    CHECK( !cmd.HoldsRemote() );
+    cmd.Execute( "start" );
+    CHECK( cmd.HoldsRemote() );
+    cmd.AbortRemote();
+    CHECK( !cmd.HoldsRemote() );
+
+    // 닫힌 session 의 section 은 report 에서 빠진다
+    auto& stats = Stats::Registry::Instance();
+    stats.AddSection( "test_section", []{ return std::string( "test_section_body" ); } );
+    CHECK( stats.Report().find( "test_section_body" ) != std::string::npos );
+    stats.RemoveSection( "test_section" );
+    CHECK( stats.Report().find( "test_section_body" ) == std::string::npos );
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "Beam/SteeringRange", SteeringRange },
+        { "Beam/Remote", RemoteBeam },
+        { "Beam/RemoteLease", RemoteLease },
+    });
+}
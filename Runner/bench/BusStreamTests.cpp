@@ -0,0 +1,225 @@
+// ============================================================================
+// BusStreamTests : per-bus compressed BINARY streams
+// ----------------------------------------------------------------------------
+// Build (same include/link set as BeamBench):
+//   g++ -O2 -std=c++17 -I.. bench/BusStreamTests.cpp BeamPipeline.cpp BeamTrace.cpp SpiStats.cpp
+//       SpiTimingModel.cpp HardwareContext.cpp WarmStart.cpp PanelLayout.cpp TrigTable.cpp SpiwriteCommand.cpp
+//       SpiwriteProtocol.cpp HardwareArbiter.cpp HealthMonitor.cpp BeamEngine.cpp PayloadCache.cpp
+//       BusStreams.cpp RtProfile.cpp ZDict.cpp
+//       -lz -llzma -lcrypto -lpthread
+//
+// Usage:
+//   BusStreamTests [--filter=<substr>]
+//
+// Encode / Parse / Inflate 왕복, 깨진 header (MAGIC, bus 수, 잘린 offset table, 잘못된 offset, 남는 byte) 의 거절,
+// worker pool 이 task 의 예외를 호출한 thread 로 넘기는지, 그리고 원격 BINARY 가 MAGIC 으로 시작하면
+// header 가 틀려도 raw 로 넘기지 않고, FIFO write 가 던지면 그 bus 를 실패로 돌려주는지 본다.
+// ============================================================================
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BusStreams.h"
+#include "PanelLayout.h"
+#include "PayloadCache.h"
+#include "SpiwriteCommand.h"
+#include "RegisterBackend.h"
+#include "HardwareContext.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+std::vector<uint8_t> RawPayload( const Layout::Compiled& L )
+{
+    std::vector<uint8_t> raw( 3 + L.Size() * 2 );
+    raw[0] = 0x01;
+    for( size_t k = 0; k < L.Size(); k++ )
+    {
+        raw[3 + 2 * k] = (uint8_t)( k >> 8 );
+        raw[3 + 2 * k + 1] = (uint8_t)( k * 7 );
+    }
+    return raw;
+}
+
+void BusStreamsRoundTrip()
+{
+    Layout::Compiled L = Layout::Compile( Layout::DefaultSpec( 1 ) );
+    std::vector<uint8_t> raw = RawPayload( L );
+    std::vector<uint8_t> payload = BusStreams::Encode( L, raw );
+
+    std::vector<BusStreams::Stream> streams;
+    std::string err;
+    CHECK( payload[0] == BusStreams::MAGIC );
+    CHECK( BusStreams::Parse( payload.data(), payload.size(), L.num_bus, streams, &err ) );
+    CHECK( (int)streams.size() == L.num_bus );
+
+    for( int b = 0; b < L.num_bus && (int)streams.size() == L.num_bus; b++ )
+    {
+        std::vector<uint8_t> out( L.BusSize( b ) * 2 );
+        CHECK( BusStreams::Inflate( streams[b], out.data(), out.size() ) );
+        CHECK( memcmp( out.data(), raw.data() + 3 + L.bus_begin[b] * 2, out.size() ) == 0 );
+
+        // 길이가 정확히 맞지 않으면 false
+        std::vector<uint8_t> longer( out.size() + 2 );
+        CHECK( !BusStreams::Inflate( streams[b], longer.data(), longer.size() ) );
+    }
+}
+
+void BusStreamsMalformed()
+{
+    Layout::Compiled L = Layout::Compile( Layout::DefaultSpec( 1 ) );
+    const std::vector<uint8_t> good = BusStreams::Encode( L, RawPayload( L ) );
+    const size_t table = 2 + 4 * (size_t)L.num_bus;
+
+    std::vector<BusStreams::Stream> streams;
+    std::string err;
+    auto rejects = [&]( const std::vector<uint8_t>& p, int num_bus, const char* what )
+    {
+        err.clear();
+        return !BusStreams::Parse( p.data(), p.size(), num_bus, streams, &err ) && err.find( what ) != std::string::npos;
+    };
+
+    std::vector<uint8_t> p = good;
+    p[0] = 0x78;
+    CHECK( rejects( p, L.num_bus, "not a bus stream payload" ) );
+    CHECK( rejects( std::vector<uint8_t>{ BusStreams::MAGIC }, L.num_bus, "not a bus stream payload" ) );
+
+    // header 의 bus 수가 layout 과 다르면 raw 로 넘기지 않고 error
+    CHECK( rejects( good, L.num_bus + 1, "bus count 8, layout has 9" ) );
+    p = good;
+    p[1] = 4;
+    CHECK( rejects( p, L.num_bus, "bus count 4, layout has 8" ) );
+
+    p.assign( good.begin(), good.begin() + table - 1 );
+    CHECK( rejects( p, L.num_bus, "offset table truncated" ) );
+
+    // 끝 offset 이 payload 를 넘는다
+    p = good;
+    p[2 + 4 * ( L.num_bus - 1 )] = 0x7f;
+    CHECK( rejects( p, L.num_bus, "bad offset for bus 7" ) );
+
+    // 끝 offset 이 앞 bus 보다 작다
+    p = good;
+    memset( &p[2 + 4 * 2], 0, 4 );
+    CHECK( rejects( p, L.num_bus, "bad offset for bus 2" ) );
+
+    p = good;
+    p.push_back( 0 );
+    CHECK( rejects( p, L.num_bus, "trailing bytes after last stream" ) );
+
+    // stream 이 깨져 있으면 Parse 는 통과해도 Inflate 가 false
+    p = good;
+    CHECK( BusStreams::Parse( p.data(), p.size(), L.num_bus, streams ) );
+    p[table + 4] ^= 0xff;
+    std::vector<uint8_t> out( L.BusSize( 0 ) * 2 );
+    CHECK( !BusStreams::Inflate( streams[0], out.data(), out.size() ) );
+}
+
+void PoolExceptions()
+{
+    auto& pool = BusStreams::Pool::Instance();
+    std::atomic<int> ran { 0 };
+
+    bool caught = false;
+    try
+    {
+        pool.Run( 16, [&]( int i ) {
+            ran++;
+            if( i == 3 || i == 11 ) throw std::runtime_error( "task " + std::to_string( i ) );
+        });
+    }
+    catch( const std::runtime_error& e )
+    {
+        caught = strncmp( e.what(), "task ", 5 ) == 0;
+    }
+    CHECK( caught );
+    CHECK( ran == 16 );     // 던진 task 와 상관없이 모두 돈다
+
+    // 다음 job 은 예외 없이
+    ran = 0;
+    bool threw = false;
+    try
+    {
+        pool.Run( 8, [&]( int ) { ran++; } );
+    }
+    catch( ... )
+    {
+        threw = true;
+    }
+    CHECK( !threw && ran == 8 );
+}
+
+// FIFO write 가 던지는 backend. bus 3 의 data register 만
+class ThrowingRegisters : public SpiwriteProtocol::RegisterBackend
+{
+public:
+    uintptr_t bad_address = 0;
+
+    bool Write( uintptr_t address, uint32_t ) override
+    {
+        if( address == bad_address ) throw std::runtime_error( "fifo write fault" );
+        return true;
+    }
+    bool Read( uintptr_t, uint32_t& value ) override
+    {
+        value = 0;
+        return true;
+    }
+};
+
+void RemoteBusStreams()
+{
+    Controller::CodeGenerator cgen;
+    Parser::LineParser parser;
+    SpiwriteProtocol::SpiwriteCommand cmd( &cgen, &parser );
+    cmd.wr.initializeAnonymous( HardwareContext::BASE_ADDR, HardwareContext::Instance().MapSize() );
+    Cache::PayloadCache::Instance().SetCapacity( 0 );
+
+    const Layout::Compiled& L = *Layout::Registry::Instance().Get( 1 );
+    std::vector<uint8_t> payload = BusStreams::Encode( L, RawPayload( L ) );
+    auto binary = []( const std::vector<uint8_t>& p ) {
+        return "BINARY:" + std::string( reinterpret_cast<const char*>( p.data() ), p.size() );
+    };
+    CHECK( cmd.Execute( binary( payload ) ).message == "001" );
+
+    // MAGIC 로 시작하면 header 가 틀려도 raw 로 넘기지 않고 error
+    std::vector<uint8_t> bad = payload;
+    bad[1] = (uint8_t)( L.num_bus + 1 );
+    std::string message = cmd.Execute( binary( bad ) ).message;
+    CHECK( message.find( "bus stream error : bus count" ) == 0 );
+
+    bad = payload;
+    bad.push_back( 0 );
+    CHECK( cmd.Execute( binary( bad ) ).message.find( "bus stream error : trailing bytes" ) == 0 );
+
+    // 깨진 stream 은 그 bus 만 실패
+    bad = payload;
+    bad[2 + 4 * L.num_bus + 4] ^= 0xff;
+    CHECK( cmd.Execute( binary( bad ) ).message == "bus stream failed : bus 0" );
+
+    // worker 에서 던진 예외도 controller 를 죽이지 않고 그 bus 의 실패로
+    static ThrowingRegisters regs;
+    regs.bad_address = L.FifoAddress( 3 ) + 0x10;
+    cmd.wr.initializeBackend( HardwareContext::BASE_ADDR, HardwareContext::Instance().MapSize(), &regs );
+    CHECK( cmd.Execute( binary( payload ) ).message == "bus stream failed : bus 3 (fifo write fault)" );
+
+    cmd.wr.initializeAnonymous( HardwareContext::BASE_ADDR, HardwareContext::Instance().MapSize() );
+    CHECK( cmd.Execute( binary( payload ) ).message == "001" );
+    Cache::PayloadCache::Instance().SetCapacity( Cache::PayloadCache::DEFAULT_CAPACITY );
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "BusStreams/RoundTrip", BusStreamsRoundTrip },
+        { "BusStreams/Malformed", BusStreamsMalformed },
+        { "BusStreams/PoolExceptions", PoolExceptions },
+        { "BusStreams/Remote", RemoteBusStreams },
+    });
+}
@@ -0,0 +1,145 @@
+// ============================================================================
+// EngineTests : beam engine selection
+// ----------------------------------------------------------------------------
+// Build (same include/link set as BeamBench):
+//   g++ -O2 -std=c++17 -I.. bench/EngineTests.cpp BeamPipeline.cpp BeamTrace.cpp SpiStats.cpp
+//       SpiTimingModel.cpp HardwareContext.cpp WarmStart.cpp PanelLayout.cpp TrigTable.cpp SpiwriteCommand.cpp
+//       SpiwriteProtocol.cpp HardwareArbiter.cpp HealthMonitor.cpp BeamEngine.cpp PayloadCache.cpp
+//       BusStreams.cpp RtProfile.cpp ZDict.cpp
+//       -lz -llzma -lcrypto -lpthread
+//
+// Usage:
+//   EngineTests [--filter=<substr>]
+//
+// auto 가 pole 이 있는 layout 에서는 hw 가 더 빨라도 (재 보지도 않고) sw 를 고르고 이유를 남기는지,
+// pole 이 모두 0 (360 의 배수) 이면 빠른 hw 를 고르는지, 고른 뒤 layout 에 pole 이 생기면 적용할 때 sw 로 돌아가는지 본다.
+// beamforming_calc IP 는 version 과 done 을 바로 돌려주는 register file 로 흉내 낸다.
+// ============================================================================
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "BeamEngine.h"
+#include "PanelLayout.h"
+#include "RegisterBackend.h"
+#include "HardwareContext.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+// send (0x43c00014) 는 바로 0, hw engine 은 version 과 모든 lane done
+class RegisterFile : public SpiwriteProtocol::RegisterBackend
+{
+public:
+    bool Write( uintptr_t address, uint32_t value ) override
+    {
+        // write 마다 bus 접근 시간 : write 가 천 개 넘는 sw 가 몇 개뿐인 hw 보다 확실히 느리도록
+        std::this_thread::sleep_for( std::chrono::microseconds( 1 ) );
+        std::lock_guard<std::mutex> lock( mutex_ );
+        if( address == HwBeamEngine::DEFAULT_BASE + HwBeamEngine::REG_CTRL ) hw_writes_++;
+        regs_[address] = address == 0x43c00014 ? 0 : value;
+        return true;
+    }
+    bool Read( uintptr_t address, uint32_t& value ) override
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        if( address == HwBeamEngine::DEFAULT_BASE + HwBeamEngine::REG_VERSION ) value = HwBeamEngine::VERSION;
+        else if( address == HwBeamEngine::DEFAULT_BASE + HwBeamEngine::REG_STATUS ) value = HwBeamEngine::ALL_LANES;
+        else
+        {
+            auto it = regs_.find( address );
+            value = it == regs_.end() ? 0 : it->second;
+        }
+        return true;
+    }
+
+    int HwWrites()
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        return hw_writes_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<uintptr_t, uint32_t> regs_;
+    int hw_writes_ = 0;
+};
+
+Layout::Spec ZeroPoles( int is_tx )
+{
+    Layout::Spec spec = Layout::DefaultSpec( is_tx );
+    spec.poles = { 0, 360, -360, 720 };
+    return spec;
+}
+
+void HwMatchesLayout()
+{
+    std::string why;
+    CHECK( !BeamEngineSet::HwMatchesLayout( Layout::Compile( Layout::DefaultSpec( 1 ) ), &why ) );
+    CHECK( why.find( "has pole 120 deg" ) != std::string::npos );
+
+    why.clear();
+    CHECK( BeamEngineSet::HwMatchesLayout( Layout::Compile( ZeroPoles( 1 ) ), &why ) && why.empty() );
+
+    Layout::Spec spec = ZeroPoles( 0 );
+    spec.poles[3] = 90;
+    CHECK( !BeamEngineSet::HwMatchesLayout( Layout::Compile( spec ), &why ) );
+    CHECK( why.find( "has pole 90 deg" ) != std::string::npos );
+}
+
+void AutoSelect()
+{
+    static RegisterFile regs;
+    SpiwriteProtocol::MemoryWriter writer;
+    writer.initializeBackend( HardwareContext::BASE_ADDR, HardwareContext::Instance().MapSize(), &regs );
+    auto& layouts = Layout::Registry::Instance();
+
+    BeamEngineSet engines( writer );
+    engines.SetScript( false );
+
+    // 기본 layout 은 pole 이 있으므로 hw 는 재지도 않는다
+    CHECK( engines.Select( "auto", 1, 10, 20 ) );
+    CHECK( std::string( engines.Current().Name() ) == "sw" );
+    CHECK( regs.HwWrites() == 0 );
+    CHECK( engines.Report().find( "has pole" ) != std::string::npos );
+
+    // pole 이 모두 0 이면 빠른 hw
+    layouts.Set( 1, ZeroPoles( 1 ) );
+    layouts.Set( 0, ZeroPoles( 0 ) );
+    CHECK( engines.Select( "auto", 1, 10, 20 ) );
+    CHECK( regs.HwWrites() > 0 );
+    CHECK( std::string( engines.Current().Name() ) == "hw" );
+    CHECK( engines.Report().find( "hw faster, layout poles zero" ) != std::string::npos );
+    CHECK( engines.Apply( 1, 15, 25 ) );
+    CHECK( std::string( engines.Current().Name() ) == "hw" );
+
+    // 고른 뒤 pole 이 생기면 적용할 때 sw 로
+    layouts.Set( 0, Layout::DefaultSpec( 0 ) );
+    CHECK( engines.Apply( 1, 15, 25 ) );
+    CHECK( std::string( engines.Current().Name() ) == "hw" );     // tx layout 은 그대로
+    int before = regs.HwWrites();
+    CHECK( engines.Apply( 0, 15, 25 ) );
+    CHECK( std::string( engines.Current().Name() ) == "sw" );
+    CHECK( regs.HwWrites() == before );
+    CHECK( engines.Report().find( "layout" ) != std::string::npos );
+
+    // 명시적인 hw 는 경고만 하고 그대로
+    CHECK( engines.Select( "hw" ) );
+    CHECK( std::string( engines.Current().Name() ) == "hw" );
+
+    layouts.Set( 1, Layout::DefaultSpec( 1 ) );
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "Engine/HwMatchesLayout", HwMatchesLayout },
+        { "Engine/AutoSelect", AutoSelect },
+    });
+}
@@ -0,0 +1,116 @@
+// ============================================================================
+// KernelTests : phase index kernels against the float path
+// ----------------------------------------------------------------------------
+// Build:
+//   g++ -O2 -std=c++17 -I.. bench/KernelTests.cpp BeamPipeline.cpp PanelLayout.cpp TrigTable.cpp
+//
+// Usage:
+//   KernelTests [--filter=<substr>]
+//
+// table kernel (ComputeIndices) 과 정수 kernel (ComputeIndicesFixed, build flag 의 SIMD 경로) 이
+// float 경로 (PhaseOf + ApplyPoles) 와 5.625 도 경계 근처에서만, 그것도 한 칸만 어긋나는지 본다.
+// TurnStepsOf 는 nan / inf 각도나 비정상 pitch 에서도 정의된 값을 내야 한다.
+// ============================================================================
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "BeamPipeline.h"
+#include "PanelLayout.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+const float NaN = std::numeric_limits<float>::quiet_NaN();
+const float Inf = std::numeric_limits<float>::infinity();
+
+void KernelsMatchFloatPath()
+{
+    for( int is_tx = 1; is_tx >= 0; is_tx-- )
+    {
+        Layout::Compiled L = Layout::Compile( Layout::DefaultSpec( is_tx ) );
+        const long long unsigned freq = is_tx ? 29500000000ULL : 19700000000ULL;
+        size_t total = 0;
+
+        // table trig / 정수 누적이라 경계 근처만 어긋난다 (15 도 grid 에서 0.3% 아래)
+        size_t diff = BeamPipeline::CompareIndices( L, is_tx, 15.0f, 15.0f, &total, BeamPipeline::ComputeIndices );
+        CHECK( total == L.Size() * 7 * 24 );
+        CHECK( diff * 100 <= total );
+        diff = BeamPipeline::CompareIndices( L, is_tx, 15.0f, 15.0f, &total, BeamPipeline::ComputeIndicesFixed );
+        CHECK( diff * 100 <= total );
+
+        // 어긋나도 한 칸 (63 <-> 0 wrap 포함)
+        std::vector<uint8_t> a( L.Size() ), b( L.Size() );
+        for( float az : { 0.0f, 12.5f, 137.0f, 359.0f } )
+        {
+            for( float el : { 0.0f, 33.3f, 89.0f } )
+            {
+                BeamPipeline::ComputeIndices( L, az, el, freq, a.data() );
+                BeamPipeline::ComputeIndicesFixed( L, az, el, freq, b.data() );
+                for( size_t k = 0; k < L.Size(); k++ )
+                {
+                    int d = ( a[k] - b[k] + 64 ) % 64;
+                    CHECK( d <= 1 || d == 63 );
+                }
+            }
+        }
+
+        CHECK( BeamPipeline::CompareIndices( L, is_tx, 0.0f, 15.0f, &total ) == 0 && total == 0 );
+        CHECK( BeamPipeline::CompareIndices( L, is_tx, NaN, 15.0f, &total ) == 0 && total == 0 );
+    }
+}
+
+// SIMD 본체와 scalar 꼬리가 같은 값을 내는지 : element 수가 vector 폭의 배수가 아닌 layout
+void KernelTail()
+{
+    Layout::Spec spec = Layout::DefaultSpec( 1 );
+    spec.tile_rows = 3;
+    spec.tile_cols = 4;
+    spec.bus_cols = 4;
+    spec.chip_base = { 0, 16, 32, 48 };
+    Layout::Compiled L = Layout::Compile( spec );
+    CHECK( L.Size() == 12 );
+
+    std::vector<uint8_t> idx( L.Size() ), one( L.Size() );
+    BeamPipeline::ComputeIndicesFixed( L, 20.0f, 40.0f, 29500000000ULL, idx.data() );
+
+    BeamPipeline::TurnSteps t = BeamPipeline::TurnStepsOf( L, 20.0f, 40.0f, 29500000000ULL );
+    for( size_t k = 0; k < L.Size(); k++ )
+    {
+        uint32_t acc = (uint32_t)L.gx[k] * t.x + (uint32_t)L.gy[k] * t.y + L.pole_turns[k];
+        CHECK( idx[k] == acc >> 26 );
+    }
+}
+
+void TurnStepsNonFinite()
+{
+    Layout::Compiled L = Layout::Compile( Layout::DefaultSpec( 1 ) );
+    BeamPipeline::TurnSteps t = BeamPipeline::TurnStepsOf( L, NaN, Inf, 29500000000ULL );
+    BeamPipeline::TurnSteps zero = BeamPipeline::TurnStepsOf( L, 0, 0, 29500000000ULL );
+    CHECK( t.x == zero.x && t.y == zero.y );
+
+    // 각도는 SinCos 가 한 바퀴 안으로 줄인다
+    t = BeamPipeline::TurnStepsOf( L, 1e30f, -1e30f, 29500000000ULL );
+    std::vector<uint8_t> idx( L.Size(), 0xff );
+    BeamPipeline::ComputeIndicesFixed( L, 1e30f, -1e30f, 29500000000ULL, idx.data() );
+    for( uint8_t v : idx ) CHECK( v < 64 );
+
+    // 비정상 pitch : llround 에 넘기지 않고 0 turn
+    L.dx = Inf;
+    L.dy = NaN;
+    t = BeamPipeline::TurnStepsOf( L, 10, 20, 29500000000ULL );
+    CHECK( t.x == 0 && t.y == 0 );
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "Kernel/MatchFloatPath", KernelsMatchFloatPath },
+        { "Kernel/Tail", KernelTail },
+        { "Kernel/TurnStepsNonFinite", TurnStepsNonFinite },
+    });
+}
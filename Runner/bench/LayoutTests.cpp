@@ -0,0 +1,173 @@
+// ============================================================================
+// LayoutTests : layout spec parsing and compile checks
+// ----------------------------------------------------------------------------
+// Build:
+//   g++ -O2 -std=c++17 -I.. bench/LayoutTests.cpp PanelLayout.cpp
+//
+// Usage:
+//   LayoutTests [--filter=<substr>]
+//
+// 잘못된 layout file / spec (key, 개수, chip/channel 중복, 범위 초과, MAX_BUS 초과 등) 을 거절하는지와
+// compile 된 flat table 의 정렬, bus 구간, FIFO address -> bus decode 를 본다.
+// Registry 의 lock 없는 FIFO table 은 Set 뒤에 새 layout 을 가르고, 이전 table 참조도 그대로 읽을 수 있어야 한다.
+// ============================================================================
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <stdexcept>
+
+#include "PanelLayout.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+// spec 이 Compile 에서 runtime_error 로 거절되는지. 거절 사유에 what 이 들어 있어야 한다
+bool Rejects( const Layout::Spec& spec, const char* what )
+{
+    try
+    {
+        Layout::Compile( spec );
+    }
+    catch( const std::runtime_error& e )
+    {
+        return strstr( e.what(), what ) != nullptr;
+    }
+    return false;
+}
+
+void LayoutParseSpecs()
+{
+    Layout::Spec tx = Layout::DefaultSpec( 1 ), rx = Layout::DefaultSpec( 0 );
+    std::string err;
+
+    // section 없는 key 는 둘 다, [tx] / [rx] 뒤는 그 쪽만
+    CHECK( Layout::ParseSpecs( "tiles = 1 2   # comment\n[tx]\nname = t\npitch = 4.5 4.5\n[rx]\nbus_order = forward\n", tx, rx, &err ) );
+    CHECK( tx.tiles_x == 2 && rx.tiles_x == 2 );
+    CHECK( tx.name == "t" && rx.name == "rx_32x32" );
+    CHECK( tx.dx == 4.5f && rx.dx == 7.5f );
+    CHECK( tx.bus_reverse && !rx.bus_reverse );
+
+    Layout::Spec tx0 = Layout::DefaultSpec( 1 ), rx0 = Layout::DefaultSpec( 0 );
+    auto rejects = [&]( const char* text, const char* what )
+    {
+        Layout::Spec t = tx0, r = rx0;
+        err.clear();
+        return !Layout::ParseSpecs( text, t, r, &err ) && err.find( what ) != std::string::npos;
+    };
+    CHECK( rejects( "tile 32 32\n", "line 1 : expected key = value" ) );
+    CHECK( rejects( "\n\nbogus = 1\n", "line 3 : unknown key bogus" ) );
+    CHECK( rejects( "tile = 32\n", "tile : expected 2 integer(s)" ) );
+    CHECK( rejects( "tile = 32 x\n", "tile : expected 2 integer(s)" ) );
+    CHECK( rejects( "poles = 1 2 3\n", "poles : expected 4 integer(s)" ) );
+    CHECK( rejects( "pitch = 5\n", "pitch : expected dx dy" ) );
+    CHECK( rejects( "bus_order = sideways\n", "bus_order : reverse | forward" ) );
+}
+
+void LayoutCompile()
+{
+    Layout::Compiled L = Layout::Compile( Layout::DefaultSpec( 1 ) );
+    CHECK( L.Size() == 1024 );
+    CHECK( L.num_bus == 8 );
+    CHECK( L.bus_begin.size() == 9 && L.bus_begin.back() == 1024 );
+    for( int b = 0; b < L.num_bus; b++ ) CHECK( L.BusSize( b ) == 128 );
+    CHECK( L.SendMask() == 0xff );
+
+    // (bus, chip, channel) 순 정렬
+    for( size_t k = 1; k < L.Size(); k++ )
+        CHECK( std::tie( L.bus[k - 1], L.chip[k - 1], L.channel[k - 1] ) < std::tie( L.bus[k], L.chip[k], L.channel[k] ) );
+
+    // FIFO register address -> bus
+    uint32_t reg = 0;
+    CHECK( L.FifoBus( L.FifoAddress( 3 ) + 4, reg ) == 3 && reg == 4 );
+    CHECK( L.FifoBus( L.fifo_base - 4, reg ) == -1 );
+    CHECK( L.FifoBus( L.FifoAddress( L.num_bus ), reg ) == -1 );
+
+    Layout::Spec spec = Layout::DefaultSpec( 1 );
+    spec.tiles_y = 2;
+    spec.tiles_x = 2;
+    Layout::Compiled big = Layout::Compile( spec );
+    CHECK( big.num_bus == 32 && big.SendMask() == 0xffffffff );
+
+    spec = Layout::DefaultSpec( 1 );
+    spec.tile_rows = 0;
+    CHECK( Rejects( spec, "tile size must be positive" ) );
+
+    spec = Layout::DefaultSpec( 1 );
+    spec.bus_cols = 5;
+    CHECK( Rejects( spec, "multiple of bus_cols" ) );
+
+    spec = Layout::DefaultSpec( 1 );
+    spec.chip_base = { 16, 16, 0 };
+    CHECK( Rejects( spec, "chip_base needs one entry per bus column" ) );
+
+    spec = Layout::DefaultSpec( 1 );
+    spec.poles = { 0, 90, 180 };
+    CHECK( Rejects( spec, "poles missing" ) );
+
+    spec = Layout::DefaultSpec( 1 );
+    spec.channel_odd.clear();
+    CHECK( Rejects( spec, "channel_odd" ) );
+
+    // 32 bit send register 로 trigger 할 수 없는 bus 수
+    spec = Layout::DefaultSpec( 1 );
+    spec.tiles_x = 5;
+    CHECK( Rejects( spec, "buses" ) );
+
+    spec = Layout::DefaultSpec( 1 );
+    spec.chip_base = { 0x100, 16, 0, 0 };
+    CHECK( Rejects( spec, "out of range" ) );
+
+    spec = Layout::DefaultSpec( 1 );
+    spec.channel_even = { 0x27, 0x27, 0x47, 0x5F };
+    CHECK( Rejects( spec, "used twice" ) );
+}
+
+void LayoutFifoMap()
+{
+    auto& layouts = Layout::Registry::Instance();
+    const Layout::FifoMap& before = layouts.Fifo();
+    auto tx = layouts.Get( 1 );
+    auto rx = layouts.Get( 0 );
+
+    uint32_t reg = 0;
+    int is_tx = -1;
+    CHECK( before.Decode( tx->FifoAddress( 3 ) + 0x10, reg, &is_tx ) == 3 && reg == 0x10 && is_tx == 1 );
+    CHECK( before.Decode( tx->fifo_base - 4, reg ) == -1 );
+    CHECK( before.Decode( std::max( tx->FifoAddress( tx->num_bus ), rx->FifoAddress( rx->num_bus ) ), reg ) == -1 );
+
+    // Compiled::FifoBus 와 같은 답 (tx 먼저)
+    for( uintptr_t a = tx->fifo_base; a < tx->FifoAddress( tx->num_bus ); a += 0x1004 )
+    {
+        uint32_t r1 = 0, r2 = 0;
+        CHECK( before.Decode( a, r1 ) == tx->FifoBus( a, r2 ) && r1 == r2 );
+    }
+
+    // tx 를 4 bus layout 으로 바꾸면 새 table 이 보이고, 이전 table 은 이전 layout 그대로
+    Layout::Spec spec = Layout::DefaultSpec( 1 );
+    spec.tile_cols = 16;
+    spec.fifo_base = 0x43c80000;
+    layouts.Set( 1, spec );
+
+    const Layout::FifoMap& after = layouts.Fifo();
+    CHECK( &after != &before );
+    CHECK( after.Decode( 0x43c80000 + 3 * spec.fifo_stride + 0x10, reg, &is_tx ) == 3 && is_tx == 1 );
+    CHECK( after.Decode( 0x43c80000 + 4 * spec.fifo_stride + 0x10, reg ) == -1 );    // tx 4 bus, rx 8 bus 밖
+    CHECK( before.Decode( tx->FifoAddress( 3 ) + 0x10, reg ) == 3 );
+
+    layouts.Set( 1, Layout::DefaultSpec( 1 ) );
+    CHECK( layouts.Fifo().Decode( tx->FifoAddress( 7 ) + 0x10, reg ) == 7 );
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "Layout/ParseSpecs", LayoutParseSpecs },
+        { "Layout/Compile", LayoutCompile },
+        { "Layout/FifoMap", LayoutFifoMap },
+    });
+}
@@ -0,0 +1,135 @@
+// ============================================================================
+// PayloadCacheTests : content-addressed BINARY payload cache
+// ----------------------------------------------------------------------------
+// Build (same include/link set as BeamBench):
+//   g++ -O2 -std=c++17 -I.. bench/PayloadCacheTests.cpp BeamPipeline.cpp BeamTrace.cpp SpiStats.cpp
+//       SpiTimingModel.cpp HardwareContext.cpp WarmStart.cpp PanelLayout.cpp TrigTable.cpp SpiwriteCommand.cpp
+//       SpiwriteProtocol.cpp HardwareArbiter.cpp HealthMonitor.cpp BeamEngine.cpp PayloadCache.cpp
+//       BusStreams.cpp RtProfile.cpp ZDict.cpp
+//       -lz -llzma -lcrypto -lpthread
+//
+// Usage:
+//   PayloadCacheTests [--filter=<substr>]
+//
+// LRU eviction, hash 충돌 (같은 hash 다른 payload), layout 을 다시 읽은 뒤의 miss, MAX_CAPACITY 로 자르기,
+// 그리고 원격 'cache size' 가 음수 / 범위 초과 / 숫자 아닌 값을 예외 없이 거절하는지 본다.
+// ============================================================================
+#include <memory>
+#include <string>
+
+#include "BeamEngine.h"
+#include "PanelLayout.h"
+#include "PayloadCache.h"
+#include "SpiwriteCommand.h"
+#include "HardwareContext.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+std::shared_ptr<const PreparedBeam> MakeBeam()
+{
+    auto beam = std::make_shared<PreparedBeam>();
+    beam->is_tx = 1;
+    beam->layout = Layout::Registry::Instance().Get( 1 );
+    return beam;
+}
+
+void PayloadCacheEviction()
+{
+    auto& cache = Cache::PayloadCache::Instance();
+    cache.Clear();
+    cache.SetCapacity( 2 );
+    CHECK( cache.Enabled() );
+
+    uint8_t payload[3][4] = { { 1, 2, 3, 4 }, { 5, 6, 7, 8 }, { 9, 10, 11, 12 } };
+    uint64_t hash[3];
+    for( int i = 0; i < 3; i++ ) hash[i] = Cache::Hash64( payload[i], 4 );
+
+    cache.Insert( hash[0], payload[0], 4, 8, MakeBeam() );
+    cache.Insert( hash[1], payload[1], 4, 8, MakeBeam() );
+    CHECK( cache.Find( hash[0], payload[0], 4 ) != nullptr );        // 0 이 가장 최근
+
+    cache.Insert( hash[2], payload[2], 4, 8, MakeBeam() );            // 가장 오래 안 쓴 1 을 버린다
+    CHECK( cache.Find( hash[1], payload[1], 4 ) == nullptr );
+    CHECK( cache.Find( hash[0], payload[0], 4 ) != nullptr );
+    CHECK( cache.Find( hash[2], payload[2], 4 ) != nullptr );
+
+    // hash 가 같아도 payload 가 다르면 miss
+    CHECK( cache.Find( hash[0], payload[2], 4 ) == nullptr );
+    CHECK( cache.Report().find( "2 / 2 entries, hits 3, misses 2" ) != std::string::npos );
+    CHECK( cache.Report().find( "evictions 1" ) != std::string::npos );
+
+    // 용량은 MAX_CAPACITY 로 자른다
+    cache.SetCapacity( (size_t)-1 );
+    CHECK( cache.Report().find( "/ 4096 entries" ) != std::string::npos );
+
+    // 0 이면 끔 : 남은 entry 도 버리고 Insert 는 무시
+    cache.SetCapacity( 0 );
+    CHECK( !cache.Enabled() );
+    cache.Insert( hash[1], payload[1], 4, 8, MakeBeam() );
+    CHECK( cache.Find( hash[1], payload[1], 4 ) == nullptr );
+    CHECK( cache.Report().find( "0 / 0 entries" ) != std::string::npos );
+
+    cache.SetCapacity( Cache::PayloadCache::DEFAULT_CAPACITY );
+    cache.Clear();
+}
+
+
+void PayloadCacheLayoutReload()
+{
+    auto& cache = Cache::PayloadCache::Instance();
+    cache.Clear();
+    cache.SetCapacity( 4 );
+
+    uint8_t payload[4] = { 1, 2, 3, 4 };
+    uint64_t hash = Cache::Hash64( payload, sizeof( payload ) );
+    CHECK( hash == Cache::Hash64( payload, sizeof( payload ) ) );
+    CHECK( hash != Cache::Hash64( payload, sizeof( payload ) - 1 ) );
+
+    cache.Insert( hash, payload, sizeof( payload ), 8, MakeBeam() );
+    CHECK( cache.Find( hash, payload, sizeof( payload ) ) != nullptr );
+
+    // layout 이 바뀌면 그 전 entry 의 FIFO word 는 쓰지 않는다
+    Layout::Registry::Instance().Set( 1, Layout::DefaultSpec( 1 ) );
+    CHECK( cache.Find( hash, payload, sizeof( payload ) ) == nullptr );
+
+    cache.SetCapacity( Cache::PayloadCache::DEFAULT_CAPACITY );
+    cache.Clear();
+}
+
+void RemoteCacheSize()
+{
+    Controller::CodeGenerator cgen;
+    Parser::LineParser parser;
+    SpiwriteProtocol::SpiwriteCommand cmd( &cgen, &parser );
+    cmd.wr.initializeAnonymous( HardwareContext::BASE_ADDR, HardwareContext::Instance().MapSize() );
+
+    auto starts = [&]( const std::string& command, const char* prefix )
+    {
+        return cmd.Execute( command ).message.rfind( prefix, 0 ) == 0;
+    };
+
+    CHECK( starts( "cache size -1", "usage : cache" ) );
+    CHECK( starts( "cache size 4097", "usage : cache" ) );
+    CHECK( starts( "cache size 99999999999999999999999", "usage : cache" ) );
+    CHECK( starts( "cache size 12k", "usage : cache" ) );
+    CHECK( starts( "cache size", "binary cache : " ) );
+    CHECK( cmd.Execute( "cache size 4096" ).message.find( "/ 4096 entries" ) != std::string::npos );
+    CHECK( cmd.Execute( "cache size 0" ).message.find( "/ 0 entries" ) != std::string::npos );
+    CHECK( starts( "cache clear", "cache cleared" ) );
+
+    cmd.Execute( "cache size 32" );
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "PayloadCache/Eviction", PayloadCacheEviction },
+        { "PayloadCache/LayoutReload", PayloadCacheLayoutReload },
+        { "PayloadCache/RemoteSize", RemoteCacheSize },
+    });
+}
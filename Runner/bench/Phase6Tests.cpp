@@ -0,0 +1,103 @@
+// ============================================================================
+// Phase6Tests : compact 6-bit phase payload
+// ----------------------------------------------------------------------------
+// Build (same include/link set as BeamBench):
+//   g++ -O2 -std=c++17 -I.. bench/Phase6Tests.cpp BeamPipeline.cpp BeamTrace.cpp SpiStats.cpp
+//       SpiTimingModel.cpp HardwareContext.cpp WarmStart.cpp PanelLayout.cpp TrigTable.cpp SpiwriteCommand.cpp
+//       SpiwriteProtocol.cpp HardwareArbiter.cpp HealthMonitor.cpp BeamEngine.cpp PayloadCache.cpp
+//       BusStreams.cpp RtProfile.cpp ZDict.cpp
+//       -lz -llzma -lcrypto -lpthread
+//
+// Usage:
+//   Phase6Tests [--filter=<substr>]
+//
+// pack / unpack 의 bit 배치와 왕복, 그리고 "BINARY:" + mode + 6 bit phase 를 BeamBench 와 같이
+// anonymous mmap 위의 MemoryWriter 로 실행해 bus 마다 FIFO 에 마지막으로 쓴 word 가
+// PackBus 결과와 같은지, 길이가 틀린 payload 를 거절하는지 본다.
+// ============================================================================
+#include <string>
+#include <vector>
+
+#include "BeamPipeline.h"
+#include "PanelLayout.h"
+#include "PayloadCache.h"
+#include "SpiwriteCommand.h"
+#include "HardwareContext.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+void Phase6PackUnpack()
+{
+    for( size_t n : { (size_t)1, (size_t)3, (size_t)4, (size_t)5, (size_t)1024, (size_t)1023 } )
+    {
+        std::vector<uint8_t> idx( n ), back( n, 0xff );
+        for( size_t k = 0; k < n; k++ ) idx[k] = (uint8_t)( ( k * 37 + 11 ) & 63 );
+
+        std::vector<uint8_t> packed( BeamPipeline::Phase6Bytes( n ) );
+        BeamPipeline::PackPhases6( idx.data(), n, packed.data() );
+        BeamPipeline::UnpackPhases6( packed.data(), n, back.data() );
+        CHECK( idx == back );
+    }
+    CHECK( BeamPipeline::Phase6Bytes( 1024 ) == 768 );
+    CHECK( BeamPipeline::Phase6Bytes( 1 ) == 1 );
+
+    // MSB first : 첫 element 가 첫 byte 의 상위 6 bit
+    uint8_t idx[4] = { 63, 0, 63, 0 }, out[3] = {};
+    BeamPipeline::PackPhases6( idx, 4, out );
+    CHECK( out[0] == 0xFC && out[1] == 0x0F && out[2] == 0xC0 );
+}
+
+void Phase6Remote()
+{
+    Controller::CodeGenerator cgen;
+    Parser::LineParser parser;
+    SpiwriteProtocol::SpiwriteCommand cmd( &cgen, &parser );
+    cmd.wr.initializeAnonymous( HardwareContext::BASE_ADDR, HardwareContext::Instance().MapSize() );
+    Cache::PayloadCache::Instance().SetCapacity( 0 );
+
+    for( int is_tx = 1; is_tx >= 0; is_tx-- )
+    {
+        const Layout::Compiled& L = *Layout::Registry::Instance().Get( is_tx );
+        std::vector<uint8_t> idx( L.Size() );
+        BeamPipeline::ComputeIndicesFixed( L, 12.5f, 30.0f, is_tx ? 29500000000ULL : 19700000000ULL, idx.data() );
+
+        std::vector<uint8_t> data( 1 + BeamPipeline::Phase6Bytes( idx.size() ) );
+        data[0] = is_tx ? BeamPipeline::PHASE6_MODE_TX : BeamPipeline::PHASE6_MODE_RX;
+        BeamPipeline::PackPhases6( idx.data(), idx.size(), data.data() + 1 );
+
+        std::string command = "BINARY:" + std::string( reinterpret_cast<const char*>( data.data() ), data.size() );
+        CHECK( cmd.Execute( command ).message == "001" );
+
+        // FIFO data register (+0x10) 에 남은 값 = 그 bus 의 마지막 word
+        std::vector<uint32_t> words;
+        for( int bus = 0; bus < L.num_bus; bus++ )
+        {
+            BeamPipeline::PackBus( L, idx.data(), is_tx, bus, words );
+            uint32_t last = 0;
+            CHECK( cmd.wr.readMemory( L.FifoAddress( bus ) + 0x10, last ) );
+            CHECK( !words.empty() && last == words.back() );
+        }
+
+        // 길이가 한 byte 모자라거나 남으면 거절
+        auto short_size = cmd.parse_phase6_command( data.data(), data.size() - 1 );
+        CHECK( short_size.message.find( "phase6 size mismatch" ) == 0 );
+        data.push_back( 0 );
+        auto long_size = cmd.parse_phase6_command( data.data(), data.size() );
+        CHECK( long_size.message.find( "phase6 size mismatch" ) == 0 );
+    }
+
+    Cache::PayloadCache::Instance().SetCapacity( Cache::PayloadCache::DEFAULT_CAPACITY );
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "Phase6/PackUnpack", Phase6PackUnpack },
+        { "Phase6/Remote", Phase6Remote },
+    });
+}
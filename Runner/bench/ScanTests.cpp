@@ -0,0 +1,112 @@
+// ============================================================================
+// ScanTests : scan spec parsing and pattern generation
+// ----------------------------------------------------------------------------
+// Build (ScanEngine pulls in the beam engines, so the controller link set):
+//   g++ -O2 -std=c++17 -I.. bench/ScanTests.cpp ScanEngine.cpp BeamPipeline.cpp BeamTrace.cpp SpiStats.cpp
+//       SpiTimingModel.cpp HardwareContext.cpp WarmStart.cpp PanelLayout.cpp TrigTable.cpp SpiwriteCommand.cpp
+//       SpiwriteProtocol.cpp HardwareArbiter.cpp HealthMonitor.cpp BeamEngine.cpp PayloadCache.cpp
+//       BusStreams.cpp RtProfile.cpp ZDict.cpp
+//       -lz -llzma -lcrypto -lpthread
+//
+// Usage:
+//   ScanTests [--filter=<substr>]
+//
+// ParseSpec 가 형식 오류, min > max, nan / inf, beam 명령 범위 밖 (|az| > 360, el 0 ~ 90) 을 거절하는지,
+// Generate 가 pattern 별로 기대한 점을 내고 max_points 에서 멈추는지 본다.
+// ============================================================================
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "ScanEngine.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+void ScanParseSpec()
+{
+    Scan::Spec spec;
+    std::string err;
+    CHECK( Scan::ParseSpec( "raster tx -30 30 0 60 2 500 3", spec, &err ) );
+    CHECK( spec.pattern == Scan::Pattern::Raster && spec.is_tx == 1 );
+    CHECK( spec.el_max == 60.0f && spec.step == 2.0f && spec.dwell_us == 500 && spec.repeat == 3 );
+    CHECK( Scan::ParseSpec( "conical rx 10 45 5 1 1000", spec, &err ) );
+    CHECK( spec.pattern == Scan::Pattern::Conical && spec.is_tx == 0 && spec.repeat == 1 );
+
+    auto rejects = [&]( const char* text )
+    {
+        Scan::Spec s;
+        err.clear();
+        return !Scan::ParseSpec( text, s, &err ) && !err.empty();
+    };
+    CHECK( rejects( "" ) );
+    CHECK( rejects( "zigzag tx -30 30 0 30 1 1000" ) );
+    CHECK( rejects( "raster up -30 30 0 30 1 1000" ) );
+    CHECK( rejects( "raster tx -30 30 0 30 1" ) );
+    CHECK( rejects( "raster tx 30 -30 0 30 1 1000" ) );       // min > max
+    CHECK( rejects( "raster tx -30 30 40 30 1 1000" ) );
+    CHECK( rejects( "raster tx nan 30 0 30 1 1000" ) );
+    CHECK( rejects( "raster tx -30 inf 0 30 1 1000" ) );
+    CHECK( rejects( "raster tx -400 30 0 30 1 1000" ) );      // |az| > 360
+    CHECK( rejects( "raster tx -30 30 -10 30 1 1000" ) );     // el < 0
+    CHECK( rejects( "raster tx -30 30 0 95 1 1000" ) );       // el > 90
+    CHECK( rejects( "raster tx -30 30 0 30 0 1000" ) );
+    CHECK( rejects( "raster tx -30 30 0 30 nan 1000" ) );
+    CHECK( rejects( "raster tx -30 30 0 30 1 0" ) );
+    CHECK( rejects( "raster tx -30 30 0 30 1 1000 -1" ) );
+    CHECK( rejects( "spiral tx 0 30 0 1 1000" ) );            // radius 0
+    CHECK( rejects( "spiral tx 0 30 inf 1 1000" ) );
+    CHECK( rejects( "spiral tx 0 5 10 1 1000" ) );            // center - radius 가 el < 0
+    CHECK( rejects( "conical tx 355 45 10 1 1000" ) );        // center + radius 가 az > 360
+
+    // 실패하면 spec 은 그대로
+    Scan::Spec keep;
+    keep.step = 3.0f;
+    CHECK( !Scan::ParseSpec( "raster tx -30 30 0 30 nan 1000", keep ) && keep.step == 3.0f );
+}
+
+void ScanGenerate()
+{
+    Scan::Spec spec;
+    CHECK( Scan::ParseSpec( "raster tx -2 2 0 1 1 1000", spec ) );
+
+    // 5 x 2, 두 번째 줄은 거꾸로 (serpentine)
+    auto points = Scan::Generate( spec );
+    CHECK( points.size() == 10 );
+    if( points.size() == 10 )
+    {
+        CHECK( points[0].az == -2.0f && points[0].el == 0.0f );
+        CHECK( points[4].az == 2.0f && points[4].el == 0.0f );
+        CHECK( points[5].az == 2.0f && points[5].el == 1.0f );
+        CHECK( points[9].az == -2.0f && points[9].el == 1.0f );
+    }
+
+    // 넘치면 max_points + 1 개에서 멈춘다 (호출하는 쪽이 초과를 알 수 있게)
+    CHECK( Scan::Generate( spec, 3 ).size() == 4 );
+    CHECK( Scan::Generate( spec, 10 ).size() == 10 );
+
+    CHECK( Scan::ParseSpec( "conical tx 0 45 10 1 1000", spec ) );
+    points = Scan::Generate( spec );
+    CHECK( points.size() == 63 );      // round( 2 pi * 10 / 1 )
+    for( auto& p : points ) CHECK( std::fabs( std::hypot( p.az, p.el - 45.0f ) - 10.0f ) < 1e-3f );
+
+    CHECK( Scan::ParseSpec( "spiral tx 0 45 10 1 1000", spec ) );
+    points = Scan::Generate( spec );
+    CHECK( !points.empty() && points[0].az == 0.0f && points[0].el == 45.0f );
+    for( auto& p : points ) CHECK( std::hypot( p.az, p.el - 45.0f ) <= 10.0f + 1e-3f );
+
+    spec.step = 0;
+    CHECK( Scan::Generate( spec ).empty() );
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "Scan/ParseSpec", ScanParseSpec },
+        { "Scan/Generate", ScanGenerate },
+    });
+}
@@ -0,0 +1,75 @@
+#ifndef __SPIBEAM_BENCH_TEST_CHECK_H__
+#define __SPIBEAM_BENCH_TEST_CHECK_H__
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <functional>
+#include <exception>
+
+// bench/*Tests.cpp 가 같이 쓰는 최소 check harness.
+// 실패한 CHECK 마다 file:line 과 식을 찍고 계속 진행한다. 실패한 test 가 하나라도 있으면 RunTests 는 1
+namespace SpiBeam {
+namespace Check {
+
+inline int& FailedChecks()
+{
+    static int failed = 0;
+    return failed;
+}
+
+struct Test
+{
+    const char* name;
+    std::function<void()> fn;
+};
+
+// Usage : <binary> [--filter=<substr>]
+inline int RunTests( int argc, char** argv, const std::vector<Test>& tests )
+{
+    std::string filter;
+    for( int i = 1; i < argc; i++ )
+    {
+        if( strncmp( argv[i], "--filter=", 9 ) == 0 ) filter = argv[i] + 9;
+        else
+        {
+            fprintf( stderr, "usage: %s [--filter=<substr>]\n", argv[0] );
+            return 2;
+        }
+    }
+
+    int run = 0, failed = 0;
+    for( auto& t : tests )
+    {
+        if( !filter.empty() && std::string( t.name ).find( filter ) == std::string::npos ) continue;
+
+        int before = FailedChecks();
+        try
+        {
+            t.fn();
+        }
+        catch( const std::exception& e )
+        {
+            FailedChecks()++;
+            printf( "    unexpected exception : %s\n", e.what() );
+        }
+
+        bool ok = FailedChecks() == before;
+        printf( "%-6s %s\n", ok ? "ok" : "FAIL", t.name );
+        fflush( stdout );
+        run++;
+        if( !ok ) failed++;
+    }
+
+    printf( "%d tests, %d failed\n", run, failed );
+    return failed ? 1 : 0;
+}
+
+}
+}
+
+#define CHECK( expr ) \
+    do { if( !( expr ) ) { SpiBeam::Check::FailedChecks()++; printf( "    %s:%d : CHECK( %s )\n", __FILE__, __LINE__, #expr ); } } while( 0 )
+
+#endif
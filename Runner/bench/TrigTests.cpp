@@ -0,0 +1,92 @@
+// ============================================================================
+// TrigTests : Q9.7 sine table checks
+// ----------------------------------------------------------------------------
+// Build:
+//   g++ -O2 -std=c++17 -I.. bench/TrigTests.cpp TrigTable.cpp
+//
+// Usage:
+//   TrigTests [--filter=<substr>]
+//
+// table / 보간 값이 libm 과 맞는지, wrap 과 음수 각도, nan / inf / long long 범위를 넘는 값에서도
+// SinCos / ToQ9_7 이 정의된 값을 내는지 본다.
+// ============================================================================
+#include <cmath>
+#include <limits>
+
+#include "TrigTable.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+const float NaN = std::numeric_limits<float>::quiet_NaN();
+const float Inf = std::numeric_limits<float>::infinity();
+
+void TrigTable()
+{
+    // grid 위는 table 그대로
+    CHECK( Trig::SinQ( 0 ) == 0.0f && Trig::CosQ( 0 ) == 1.0f );
+    CHECK( Trig::SinQ( Trig::QUARTER ) == 1.0f );
+    CHECK( Trig::SinQ( Trig::FULL + Trig::QUARTER ) == 1.0f );
+    CHECK( Trig::SinQ( -Trig::QUARTER ) == -1.0f );
+
+    CHECK( Trig::ToQ9_7( 0.0 ) == 0 );
+    CHECK( Trig::ToQ9_7( 90.0 ) == Trig::QUARTER );
+    CHECK( Trig::ToQ9_7( 360.0 ) == 0 );
+    CHECK( Trig::ToQ9_7( -90.0 ) == 3 * Trig::QUARTER );
+    CHECK( Trig::ToQ9_7( 1.0 / 256 ) == 1 );          // 반올림
+
+    // wrap 과 음수 각도
+    float s, c;
+    for( float deg : { 30.0f, 390.0f, -330.0f, 750.0f } )
+    {
+        Trig::SinCos( deg, s, c );
+        CHECK( std::fabs( s - 0.5f ) < 1e-6f );
+        CHECK( std::fabs( c - 0.8660254f ) < 1e-6f );
+    }
+
+    // grid 사이 보간
+    for( float deg = -720.0f; deg <= 720.0f; deg += 0.37f )
+    {
+        Trig::SinCos( deg, s, c );
+        double rad = deg * M_PI / 180.0;
+        CHECK( std::fabs( s - std::sin( rad ) ) < 1e-5 );
+        CHECK( std::fabs( c - std::cos( rad ) ) < 1e-5 );
+    }
+
+    Trig::Accuracy acc = Trig::Check();
+    CHECK( acc.table_max_err < 1e-6 );
+    CHECK( acc.interp_max_err < 1e-6 );
+}
+
+void TrigNonFinite()
+{
+    float s = -2, c = -2;
+    for( float deg : { NaN, Inf, -Inf } )
+    {
+        Trig::SinCos( deg, s, c );
+        CHECK( s == 0.0f && c == 1.0f );
+        CHECK( Trig::ToQ9_7( deg ) == 0 );
+    }
+
+    // long long 범위를 넘는 값도 한 바퀴 안으로 줄여서 계산
+    for( float deg : { 1e30f, -1e30f, 3.4e38f } )
+    {
+        Trig::SinCos( deg, s, c );
+        CHECK( std::isfinite( s ) && std::isfinite( c ) );
+        CHECK( std::fabs( s * s + c * c - 1.0f ) < 1e-3f );
+        int q = Trig::ToQ9_7( deg );
+        CHECK( q >= 0 && q < Trig::FULL );
+    }
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "Trig/Table", TrigTable },
+        { "Trig/NonFinite", TrigNonFinite },
+    });
+}
@@ -0,0 +1,170 @@
+// ============================================================================
+// WarmStartTests : warm start journal commit and replay
+// ----------------------------------------------------------------------------
+// Build (same include/link set as BeamBench):
+//   g++ -O2 -std=c++17 -I.. bench/WarmStartTests.cpp BeamPipeline.cpp BeamTrace.cpp SpiStats.cpp
+//       SpiTimingModel.cpp HardwareContext.cpp WarmStart.cpp PanelLayout.cpp TrigTable.cpp SpiwriteCommand.cpp
+//       SpiwriteProtocol.cpp HardwareArbiter.cpp HealthMonitor.cpp BeamEngine.cpp PayloadCache.cpp
+//       BusStreams.cpp RtProfile.cpp ZDict.cpp
+//       -lz -llzma -lcrypto -lpthread
+//
+// Usage:
+//   WarmStartTests [--filter=<substr>]
+//
+// journal 은 FIFO register write 를 shadow 에 남기지 않고, send 된 beam 의 word / length 만 확정하는지,
+// Enable 전의 beam 과 PL beam (BEAM_CTRL start) 이 어떻게 반영되는지, 확정된 word 를 Replay 가 그대로 다시 쓰는지 본다.
+// send register 를 바로 0 으로 돌려주는 register file backend 위에서 돌린다.
+// ============================================================================
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "BeamEngine.h"
+#include "SpiStats.h"
+#include "WarmStart.h"
+#include "RegisterBackend.h"
+#include "HardwareContext.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+constexpr uintptr_t CTRL_SEND = 0x43c00014;
+constexpr uintptr_t BEAM_CTRL = 0x43c30000;
+
+// 쓴 값을 그대로 돌려주는 register file. send 는 바로 완료된 것으로 0. 쓴 값은 address 별로도 모아 둔다
+class RegisterFile : public SpiwriteProtocol::RegisterBackend
+{
+public:
+    bool Write( uintptr_t address, uint32_t value ) override
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        regs_[address] = address == CTRL_SEND ? 0 : value;
+        fifo_[address].push_back( value );
+        return true;
+    }
+    bool Read( uintptr_t address, uint32_t& value ) override
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        auto it = regs_.find( address );
+        value = it == regs_.end() ? 0 : it->second;
+        return true;
+    }
+
+    std::vector<uint32_t> Take( uintptr_t address )
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        return std::move( fifo_[address] );
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<uintptr_t, uint32_t> regs_;
+    std::map<uintptr_t, std::vector<uint32_t>> fifo_;
+};
+
+RegisterFile regs;
+
+void InitWriter( SpiwriteProtocol::MemoryWriter& writer )
+{
+    writer.initializeBackend( HardwareContext::BASE_ADDR, HardwareContext::Instance().MapSize(), &regs );
+}
+
+void JournalCommit()
+{
+    SpiwriteProtocol::MemoryWriter writer;
+    InitWriter( writer );
+    SwBeamEngine engine( writer );
+    engine.SetScript( false );
+
+    auto& journal = WarmStart::Journal::Instance();
+    journal.Reset();
+
+    // Enable 전의 beam 은 남지 않는다
+    journal.Enable( false );
+    CHECK( engine.Apply( 1, 30, 40 ) );
+    journal.Enable( true );
+    CHECK( journal.Capture( 0, 0 ).words.empty() );
+
+    journal.MarkPanel( 1 );
+    CHECK( engine.Apply( 1, 10, 20 ) );
+
+    PreparedBeam beam;
+    SwBeamEngine::Prepare( 1, 10, 20, beam );
+    const Layout::Compiled& L = *beam.layout;
+
+    WarmStart::Snapshot snap = journal.Capture( 10, 20 );
+    CHECK( snap.panel_mode == 1 );
+    CHECK( (int)snap.words.size() == L.num_bus );
+    for( int b = 0; b < L.num_bus && (int)snap.words.size() == L.num_bus; b++ )
+    {
+        CHECK( snap.words[b] == beam.words[b] );
+
+        // length 는 beam 에서, FIFO data / start / interrupt clear 는 shadow 에 없다
+        auto len = snap.shadow.find( (uint32_t)( L.FifoAddress( b ) + 0x14 ) );
+        CHECK( len != snap.shadow.end() && len->second == beam.bytes[b] );
+        CHECK( snap.shadow.count( (uint32_t)( L.FifoAddress( b ) + 0x10 ) ) == 0 );
+        CHECK( snap.shadow.count( (uint32_t)( L.FifoAddress( b ) + 0x2C ) ) == 0 );
+        CHECK( snap.shadow.count( (uint32_t)L.FifoAddress( b ) ) == 0 );
+    }
+    CHECK( snap.shadow.count( (uint32_t)CTRL_SEND ) == 1 && snap.shadow[(uint32_t)CTRL_SEND] == L.SendMask() );
+
+    // PL 이 계산한 beam 은 replay 할 word 가 없다
+    writer.writeMemory( BEAM_CTRL, 0x1 );
+    snap = journal.Capture( 10, 20 );
+    for( auto& w : snap.words ) CHECK( w.empty() );
+
+    journal.Enable( false );
+    journal.Reset();
+}
+
+void JournalReplay()
+{
+    SpiwriteProtocol::MemoryWriter writer;
+    InitWriter( writer );
+    SwBeamEngine engine( writer );
+    engine.SetScript( false );
+
+    auto& journal = WarmStart::Journal::Instance();
+    journal.Reset();
+    journal.Enable( true );
+    journal.MarkPanel( 0 );
+    CHECK( engine.Apply( 0, 25, 35 ) );
+    WarmStart::Snapshot snap = journal.Capture( 25, 35 );
+
+    // 다른 beam 으로 덮어쓴 뒤 저장된 상태를 replay
+    CHECK( engine.Apply( 0, 50, 60 ) );
+    const Layout::Compiled& L = *Layout::Registry::Instance().Get( 0 );
+    for( int b = 0; b < L.num_bus; b++ ) regs.Take( L.FifoAddress( b ) + 0x10 );
+
+    auto& stats = Stats::Registry::Instance();
+    stats.Reset();
+    journal.Restore( snap );
+    CHECK( WarmStart::Replay( snap, writer ) );
+
+    uint64_t total = 0;
+    for( int b = 0; b < L.num_bus && b < (int)snap.words.size(); b++ )
+    {
+        CHECK( regs.Take( L.FifoAddress( b ) + 0x10 ) == snap.words[b] );
+        CHECK( stats.WordsWritten( b ) == snap.words[b].size() );
+        total += snap.words[b].size();
+    }
+    CHECK( total > 0 );
+
+    // replay 는 beam 을 새로 확정하지 않는다
+    CHECK( journal.Capture( 25, 35 ).words == snap.words );
+
+    journal.Enable( false );
+    journal.Reset();
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "WarmStart/JournalCommit", JournalCommit },
+        { "WarmStart/JournalReplay", JournalReplay },
+    });
+}
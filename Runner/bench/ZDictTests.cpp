@@ -0,0 +1,127 @@
+// ============================================================================
+// ZDictTests : zlib preset dictionary round trip and size report
+// ----------------------------------------------------------------------------
+// Build:
+//   g++ -O2 -std=c++17 -I.. bench/ZDictTests.cpp ZDict.cpp SpiStats.cpp -lz -lpthread
+//
+// Usage:
+//   ZDictTests [--filter=<substr>]
+//
+// 학습한 dictionary 로 deflate 한 stream 을 Dictionary 가 풀고, DICTID 가 다르면 거절하는지,
+// Gain 이 dictionary 없는 zlib / dictionary 크기 / 줄어든 비율을 내는지,
+// Report 가 마지막 payload 로 그 비교를 붙이는지 본다. payload 는 beam 마다 대부분이 같은 모양으로 만든다.
+// ============================================================================
+#include <string>
+#include <vector>
+
+#include "ZDict.h"
+#include "TestCheck.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+// 3 byte header + element 당 2 byte. 위 byte (gain) 와 element 별 calibration 은 모든 beam 이 같고
+// (zlib 혼자서는 못 줄이는 내용), beam 마다 몇 element 만 다르다
+std::vector<uint8_t> MakePayload( int beam )
+{
+    std::vector<uint8_t> data = { 0x01, 0x00, 0x00 };
+    uint32_t seed = 12345;
+    for( int k = 0; k < 1024; k++ )
+    {
+        seed = seed * 1103515245 + 12345;
+        uint8_t phase = (uint8_t)( ( seed >> 16 ) & 0x3F );
+        if( k % 64 == beam % 64 ) phase ^= 0x15;
+        data.push_back( 0xA0 | ( ( seed >> 24 ) & 0x3 ) );
+        data.push_back( phase );
+    }
+    return data;
+}
+
+std::vector<uint8_t> TrainDict()
+{
+    std::vector<std::vector<uint8_t>> samples;
+    for( int beam = 0; beam < 40; beam++ ) samples.push_back( MakePayload( beam ) );
+    return ZDict::Train( samples );
+}
+
+void RoundTrip()
+{
+    auto dict = TrainDict();
+    CHECK( !dict.empty() && dict.size() <= ZDict::MAX_SIZE );
+
+    auto& zdict = ZDict::Dictionary::Instance();
+    zdict.Set( dict, "test" );
+    zdict.ResetStats();
+
+    auto raw = MakePayload( 100 );
+    auto z = ZDict::Compress( raw.data(), raw.size(), dict );
+    uint32_t id = 0;
+    CHECK( ZDict::StreamDictId( z.data(), z.size(), id ) && id == zdict.Id() );
+
+    std::vector<uint8_t> out;
+    std::string err;
+    CHECK( zdict.Inflate( z.data(), z.size(), out, &err ) && out == raw );
+
+    // 다른 dictionary 로 만든 stream
+    std::vector<uint8_t> other( dict.begin(), dict.end() );
+    other[0] ^= 0xFF;
+    auto wrong = ZDict::Compress( raw.data(), raw.size(), other );
+    CHECK( !zdict.Inflate( wrong.data(), wrong.size(), out, &err ) && !err.empty() );
+
+    zdict.Clear();
+    zdict.ResetStats();
+}
+
+void GainReport()
+{
+    auto dict = TrainDict();
+
+    ZDict::Gain gain;
+    CHECK( gain.Reduction() == 0.0 );
+    for( int beam = 100; beam < 104; beam++ )
+    {
+        auto raw = MakePayload( beam );
+        gain.Add( raw.data(), raw.size(), dict );
+    }
+    CHECK( gain.payloads == 4 && gain.raw == 4 * MakePayload( 0 ).size() );
+    CHECK( gain.dict == dict.size() );
+    CHECK( gain.plain > 0 && gain.with_dict < gain.plain );
+    CHECK( gain.Reduction() > 0.0 && gain.Reduction() < 1.0 );
+
+    std::string rep = gain.Report();
+    CHECK( rep.find( "zlib+dict" ) != std::string::npos );
+    CHECK( rep.find( "smaller than zlib" ) != std::string::npos );
+    CHECK( rep.find( "dictionary " + std::to_string( dict.size() ) + " bytes" ) != std::string::npos );
+
+    // server report : 받은 stream 이 없으면 비교 줄도 없다
+    auto& zdict = ZDict::Dictionary::Instance();
+    zdict.Set( dict, "test" );
+    zdict.ResetStats();
+    CHECK( zdict.Report().find( "last payload" ) == std::string::npos );
+
+    auto raw = MakePayload( 100 );
+    auto z = ZDict::Compress( raw.data(), raw.size(), dict );
+    std::vector<uint8_t> out;
+    CHECK( zdict.Inflate( z.data(), z.size(), out ) );
+
+    ZDict::Gain one;
+    one.Add( raw.data(), raw.size(), dict );
+    rep = zdict.Report();
+    CHECK( rep.find( "last payload : " + one.Report() ) != std::string::npos );
+
+    // dictionary 를 바꾸면 이전 payload 로 비교하지 않는다
+    zdict.Clear();
+    CHECK( zdict.Report().find( "last payload" ) == std::string::npos );
+    zdict.ResetStats();
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    return Check::RunTests( argc, argv, {
+        { "ZDict/RoundTrip", RoundTrip },
+        { "ZDict/GainReport", GainReport },
+    });
+}
@@ -0,0 +1,187 @@
+// ============================================================================
+// CosimMain : controller register flows against the verilated beamformer RTL
+// ----------------------------------------------------------------------------
+// Build : make -C cosim (Runner/cosim/Makefile), or by hand from Runner/ (Verilator 5.x):
+//   verilator --cc --exe --build -j 0 -O3 -Wno-fatal -Wno-lint -Wno-style
+//       --top-module beamforming_calc_v1_0 -CFLAGS "-std=c++17 -I../.. -I.."
+//       -LDFLAGS "-lz -llzma -lcrypto -lpthread"
+//       ../hdl/beamforming_calc_v1_0.v ../hdl/beamforming_calc_v1_0_S00_AXI.v
+//       ../src/beamformer_top.sv ../src/beamformer_calc_unit.sv ../src/spi_master_stream.sv ../src/phase_calc.sv
+//       ../src/deg2rad.sv ../src/mul_dsp.sv ../src/delay.sv ../src/cordic_dds.v
+//       cosim/CosimMain.cpp cosim/VerilatedBackend.cpp BeamEngine.cpp BeamPipeline.cpp
+//       BeamTrace.cpp SpiStats.cpp SpiTimingModel.cpp HardwareContext.cpp SpiwriteCommand.cpp
+//       WarmStart.cpp PanelLayout.cpp TrigTable.cpp SpiwriteProtocol.cpp HardwareArbiter.cpp HealthMonitor.cpp
+//       PayloadCache.cpp BusStreams.cpp RtProfile.cpp ZDict.cpp
+//   -> obj_dir/Vbeamforming_calc_v1_0
+//
+// Usage:
+//   Vbeamforming_calc_v1_0 [--mode=tx|rx] [--az=<deg>] [--el=<deg>] [--path=hw|fifo|sw|all]
+//
+// Every MemoryWriter that calls initialize() after MemoryWriter::setDefaultBackend()
+// talks to the simulation, so SpiwriteCommand (start / BINARY / done) and the
+// console beam engines run unchanged. Reported cycles are RTL clock cycles.
+// ============================================================================
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "VerilatedBackend.h"
+#include "BeamEngine.h"
+#include "BeamPipeline.h"
+#include "SpiwriteCommand.h"
+#include "HardwareContext.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+constexpr uintptr_t BASE_ADDR = 0x43C00000;
+
+struct Options
+{
+    int is_tx = 1;
+    float az = 12.5f;
+    float el = 30.0f;
+    std::string path = "all";
+};
+
+// parse_binary_commands 형식 : 3 byte header + bus 순 2 byte value
+std::vector<uint8_t> MakeBinaryPayload( const Options& opt )
+{
+    float pitch = opt.is_tx ? 5.0f : 7.5f;
+    auto entries = BeamPipeline::BuildEntries( opt.is_tx, pitch, pitch );
+    BeamPipeline::ComputePhases( entries, opt.az, opt.el, opt.is_tx ? 29500000000ULL : 19700000000ULL );
+    BeamPipeline::SortByBus( entries );
+
+    std::vector<uint8_t> data( 3, 0 );
+    for( auto& e : entries )
+    {
+        uint16_t v = BeamPipeline::EncodeValue( BeamPipeline::PhaseIndex( e.final_phase ), opt.is_tx );
+        data.push_back( v >> 8 );
+        data.push_back( v & 0xFF );
+    }
+    return data;
+}
+
+std::string MakeBinaryCommand( const std::vector<uint8_t>& raw )
+{
+    uLongf len = compressBound( raw.size() );
+    std::vector<uint8_t> out( len );
+    compress2( out.data(), &len, raw.data(), raw.size(), Z_BEST_COMPRESSION );
+    return "BINARY:" + std::string( reinterpret_cast<const char*>( out.data() ), len );
+}
+
+void PrintResult( const char* name, Cosim::VerilatedBackend& backend, uint64_t c0, bool ok )
+{
+    uint64_t cycles = backend.Cycle() - c0;
+    fprintf( stderr, "[%s] %s : %llu cycles (%.1f us @100MHz)\n", name, ok ? "ok" : "FAILED",
+        (unsigned long long)cycles, cycles / 100.0 );
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    Options opt;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        const char* a = argv[i];
+        if( !strcmp( a, "--mode=tx" ) ) opt.is_tx = 1;
+        else if( !strcmp( a, "--mode=rx" ) ) opt.is_tx = 0;
+        else if( !strncmp( a, "--az=", 5 ) ) opt.az = (float)atof( a + 5 );
+        else if( !strncmp( a, "--el=", 5 ) ) opt.el = (float)atof( a + 5 );
+        else if( !strncmp( a, "--path=", 7 ) ) opt.path = a + 7;
+        else
+        {
+            fprintf( stderr, "unknown option %s\n", a );
+            return 1;
+        }
+    }
+
+    Cosim::VerilatedBackend backend;
+    SpiwriteProtocol::MemoryWriter::setDefaultBackend( &backend );
+
+    bool all_ok = true;
+
+    // 1) PL 에서 phase 계산 : HwBeamEngine
+    if( opt.path == "all" || opt.path == "hw" )
+    {
+        SpiwriteProtocol::MemoryWriter wr;
+        wr.initialize( BASE_ADDR, HardwareContext::Instance().MapSize() );
+
+        HwBeamEngine hw( wr );
+        hw.SetTimeoutMs( 600000 );  // wall clock 기준이라 넉넉하게
+
+        backend.ClearCaptures();
+        uint64_t c0 = backend.Cycle();
+        bool ok = hw.Available() && hw.Apply( opt.is_tx, opt.az, opt.el );
+        PrintResult( "hw", backend, c0, ok );
+        all_ok &= ok;
+
+        for( int lane = 0; lane < 8; lane++ )
+        {
+            auto frames = backend.RtlFrames( lane );
+            if( frames.size() != 128 )
+            {
+                fprintf( stderr, "  lane %d: %zu frames (expected 128)\n", lane, frames.size() );
+                all_ok = false;
+            }
+        }
+    }
+
+    // 2) 기존 FIFO path : SpiwriteCommand start / BINARY / done
+    if( opt.path == "all" || opt.path == "fifo" )
+    {
+        Controller::CodeGenerator cgen;
+        Parser::LineParser parser;
+        SpiwriteProtocol::SpiwriteCommand cmd( &cgen, &parser );
+
+        auto raw = MakeBinaryPayload( opt );
+
+        backend.ClearCaptures();
+        uint64_t c0 = backend.Cycle();
+        cmd.Execute( "start" );
+        cmd.Execute( MakeBinaryCommand( raw ) );
+        cmd.Execute( "done" );
+        PrintResult( "fifo", backend, c0, true );
+
+        // bus 별로 전송된 frame 이 payload 와 같은지
+        size_t offset = 3;
+        for( int bus = 0; bus < 8; bus++ )
+        {
+            auto sent = backend.FifoBytes( bus );
+            size_t bad = 0;
+            for( size_t k = 0; k < 128 && offset + 1 < raw.size(); k++, offset += 2 )
+            {
+                size_t p = k * 5 + 3;
+                if( p + 1 >= sent.size() || sent[p] != raw[offset] || sent[p + 1] != raw[offset + 1] ) bad++;
+            }
+            if( bad )
+            {
+                fprintf( stderr, "  bus %d: %zu of 128 values differ\n", bus, bad );
+                all_ok = false;
+            }
+        }
+    }
+
+    // 3) console 의 software engine
+    if( opt.path == "all" || opt.path == "sw" )
+    {
+        SpiwriteProtocol::MemoryWriter wr;
+        wr.initialize( BASE_ADDR, HardwareContext::Instance().MapSize() );
+        SwBeamEngine sw( wr );
+
+        backend.ClearCaptures();
+        uint64_t c0 = backend.Cycle();
+        bool ok = sw.Apply( opt.is_tx, opt.az, opt.el );
+        PrintResult( "sw", backend, c0, ok );
+        all_ok &= ok;
+    }
+
+    fprintf( stderr, "%s\n", backend.Report().c_str() );
+    SpiwriteProtocol::MemoryWriter::setDefaultBackend( nullptr );
+    return all_ok ? 0 : 1;
+}
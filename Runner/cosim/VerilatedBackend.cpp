@@ -0,0 +1,403 @@
+#include <map>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include "verilated.h"
+#include "Vbeamforming_calc_v1_0.h"
+#include "string_util.hpp"
+#include "VerilatedBackend.h"
+
+namespace SpiBeam {
+namespace Cosim {
+
+namespace {
+
+constexpr uintptr_t BEAM_SPAN = 0x200;   // C_S00_AXI_ADDR_WIDTH = 9
+constexpr uintptr_t BUS_SPAN  = 0x10000;
+constexpr uint32_t  ISR_TC    = 1u << 27; // transmit complete
+constexpr uint32_t  ISR_TPOE  = 1u << 28; // transmit packet overrun
+
+struct SpiMonitor
+{
+    bool sclk = false;
+    bool cs_n = true;
+    int  bits = 0;
+    uint8_t shift = 0;
+    std::vector<uint8_t> bytes;
+    std::vector<VerilatedBackend::Frame> frames;
+
+    void Sample( bool sclk_now, bool cs_now, bool mosi )
+    {
+        if( cs_n && !cs_now )
+        {
+            bytes.clear();
+            bits = 0;
+        }
+
+        if( !cs_now && !sclk && sclk_now )
+        {
+            shift = uint8_t( ( shift << 1 ) | ( mosi ? 1 : 0 ) );
+            if( ++bits == 8 )
+            {
+                bytes.push_back( shift );
+                bits = 0;
+            }
+        }
+
+        if( !cs_n && cs_now && bytes.size() == 5 )
+        {
+            frames.push_back( { bytes[0], bytes[1], bytes[2], bytes[3], bytes[4] } );
+        }
+
+        sclk = sclk_now;
+        cs_n = cs_now;
+    }
+};
+
+struct FifoBus
+{
+    std::deque<uint32_t> words;
+    uint32_t isr = 0;
+    uint32_t start = 0;
+    uint32_t tx_bytes = 0;      // +0x14 로 확정된 전송 길이
+    uint64_t busy_until = 0;
+    bool     pending_tc = false;
+    std::vector<uint8_t> sent;
+};
+
+}
+
+struct VerilatedBackend::Impl
+{
+    Config config;
+    std::unique_ptr<VerilatedContext> context;
+    std::unique_ptr<Vbeamforming_calc_v1_0> top;
+    mutable std::mutex mutex;
+
+    uint64_t cycle = 0;
+    SpiMonitor lanes[8];
+    std::vector<FifoBus> buses;
+    std::map<uintptr_t, uint32_t> shadow;
+    std::map<int, Timing::Model> models;   // frame byte 수 별
+    int frame_bytes = 5;
+
+    uint64_t rtl_accesses = 0;
+    uint64_t fifo_accesses = 0;
+
+    Impl( const Config& c ) : config( c ), context( new VerilatedContext ), buses( c.num_bus )
+    {
+        top.reset( new Vbeamforming_calc_v1_0( context.get() ) );
+
+        top->s00_axi_aresetn = 0;
+        top->s00_axi_awvalid = 0;
+        top->s00_axi_wvalid = 0;
+        top->s00_axi_bready = 0;
+        top->s00_axi_arvalid = 0;
+        top->s00_axi_rready = 0;
+        top->s00_axi_awprot = 0;
+        top->s00_axi_arprot = 0;
+        Tick( 16 );
+        top->s00_axi_aresetn = 1;
+        Tick( 4 );
+    }
+
+    ~Impl()
+    {
+        top->final();
+    }
+
+    void Tick( uint64_t n )
+    {
+        for( uint64_t i = 0; i < n; i++ )
+        {
+            top->s00_axi_aclk = 0;
+            top->eval();
+            top->s00_axi_aclk = 1;
+            top->eval();
+            cycle++;
+
+            for( int l = 0; l < 8; l++ )
+            {
+                lanes[l].Sample( ( top->spi_sclk >> l ) & 1, ( top->spi_cs_n >> l ) & 1, ( top->spi_mosi >> l ) & 1 );
+            }
+        }
+    }
+
+    // ---------------------------------------------------------------- RTL
+    bool AxiWrite( uint32_t offset, uint32_t value )
+    {
+        top->s00_axi_awaddr = offset;
+        top->s00_axi_wdata = value;
+        top->s00_axi_wstrb = 0xF;
+        top->s00_axi_awvalid = 1;
+        top->s00_axi_wvalid = 1;
+        top->s00_axi_bready = 1;
+
+        bool aw = false, w = false, b = false;
+        for( int i = 0; i < 64 && !b; i++ )
+        {
+            bool awready = top->s00_axi_awready;
+            bool wready = top->s00_axi_wready;
+            bool bvalid = top->s00_axi_bvalid;
+            Tick( 1 );
+
+            if( awready ) { aw = true; top->s00_axi_awvalid = 0; }
+            if( wready )  { w = true;  top->s00_axi_wvalid = 0; }
+            if( aw && w && bvalid ) b = true;
+        }
+
+        top->s00_axi_awvalid = 0;
+        top->s00_axi_wvalid = 0;
+        top->s00_axi_bready = 0;
+        rtl_accesses++;
+        return b;
+    }
+
+    bool AxiRead( uint32_t offset, uint32_t& value )
+    {
+        top->s00_axi_araddr = offset;
+        top->s00_axi_arvalid = 1;
+        top->s00_axi_rready = 1;
+
+        bool ar = false;
+        for( int i = 0; i < 64; i++ )
+        {
+            bool arready = top->s00_axi_arready;
+            bool rvalid = top->s00_axi_rvalid;
+            uint32_t rdata = top->s00_axi_rdata;
+            Tick( 1 );
+
+            if( arready ) { ar = true; top->s00_axi_arvalid = 0; }
+            if( ar && rvalid )
+            {
+                value = rdata;
+                top->s00_axi_rready = 0;
+                rtl_accesses++;
+                return true;
+            }
+        }
+
+        top->s00_axi_arvalid = 0;
+        top->s00_axi_rready = 0;
+        return false;
+    }
+
+    // ---------------------------------------------------------------- FIFO
+    const Timing::Model& Model()
+    {
+        auto I = models.find( frame_bytes );
+        if( I == models.end() )
+        {
+            Timing::Params p = config.timing;
+            p.frame_bytes = frame_bytes;
+            I = models.emplace( frame_bytes, Timing::Model( p ) ).first;
+        }
+        return I->second;
+    }
+
+    void Settle( FifoBus& bus )
+    {
+        if( bus.pending_tc && cycle >= bus.busy_until )
+        {
+            bus.isr |= ISR_TC;
+            bus.pending_tc = false;
+        }
+    }
+
+    void Send( uint32_t mask )
+    {
+        for( int b = 0; b < (int)buses.size(); b++ )
+        {
+            if( !( mask & ( 1u << b ) ) ) continue;
+
+            auto& bus = buses[b];
+            size_t bytes = std::min<size_t>( bus.tx_bytes, bus.words.size() * 4 );
+            if( bytes == 0 ) continue;
+
+            size_t n_words = ( bytes + 3 ) / 4;
+            for( size_t i = 0; i < n_words; i++ )
+            {
+                uint32_t w = bus.words.front();
+                bus.words.pop_front();
+                for( int k = 3; k >= 0; k-- ) bus.sent.push_back( uint8_t( w >> ( k * 8 ) ) );
+            }
+            bus.sent.resize( bus.sent.size() - ( n_words * 4 - bytes ) );
+
+            bus.busy_until = cycle + Model().LaneCycles( bytes );
+            bus.pending_tc = true;
+            bus.tx_bytes = 0;
+        }
+    }
+
+    uint32_t BusyMask()
+    {
+        uint32_t mask = 0;
+        for( int b = 0; b < (int)buses.size(); b++ )
+        {
+            Settle( buses[b] );
+            if( cycle < buses[b].busy_until ) mask |= 1u << b;
+        }
+        return mask;
+    }
+
+    bool FifoWrite( int b, uint32_t reg, uint32_t value )
+    {
+        auto& bus = buses[b];
+        Settle( bus );
+
+        switch( reg )
+        {
+            case 0x00: bus.isr &= ~value; break;
+            case 0x10:
+                if( bus.words.size() >= (size_t)config.timing.fifo_depth_words ) bus.isr |= ISR_TPOE;
+                else bus.words.push_back( value );
+                break;
+            case 0x14: bus.tx_bytes = value; break;
+            case 0x2C: bus.start = value; break;
+            default: shadow[config.fifo_base + b * BUS_SPAN + reg] = value; break;
+        }
+        return true;
+    }
+
+    bool FifoRead( int b, uint32_t reg, uint32_t& value )
+    {
+        auto& bus = buses[b];
+        Settle( bus );
+
+        switch( reg )
+        {
+            case 0x00: value = bus.isr; break;
+            case 0x0C: value = config.timing.fifo_depth_words - (uint32_t)bus.words.size(); break;
+            case 0x14: value = bus.tx_bytes; break;
+            case 0x2C: value = bus.start; break;
+            default: value = shadow[config.fifo_base + b * BUS_SPAN + reg]; break;
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------- dispatch
+    bool InBeam( uintptr_t a ) const { return a >= config.beam_base && a < config.beam_base + BEAM_SPAN; }
+
+    int BusOf( uintptr_t a ) const
+    {
+        if( a < config.fifo_base ) return -1;
+        uintptr_t b = ( a - config.fifo_base ) / BUS_SPAN;
+        return b < buses.size() ? (int)b : -1;
+    }
+
+    bool Write( uintptr_t a, uint32_t v )
+    {
+        if( InBeam( a ) ) return AxiWrite( uint32_t( a - config.beam_base ), v );
+
+        Tick( config.axi_cycles );
+        fifo_accesses++;
+
+        if( int b = BusOf( a ); b >= 0 ) return FifoWrite( b, uint32_t( a & 0xFFFF ), v );
+
+        if( a == config.ctrl_base + 0x14 ) { Send( v ); return true; }
+        if( a == config.ctrl_base + 0x18 ) frame_bytes = v > 0 ? (int)v : 1;
+
+        shadow[a] = v;
+        return true;
+    }
+
+    bool Read( uintptr_t a, uint32_t& v )
+    {
+        if( InBeam( a ) )
+        {
+            if( !AxiRead( uint32_t( a - config.beam_base ), v ) ) return false;
+
+            // STATUS 를 polling 중이면 software 의 polling 간격만큼 시간이 흐른다
+            if( a - config.beam_base == 0x0C && ( v & 0xFF ) != 0xFF ) Tick( config.beam_poll_cycles );
+            return true;
+        }
+
+        Tick( config.axi_cycles );
+        fifo_accesses++;
+
+        if( int b = BusOf( a ); b >= 0 ) return FifoRead( b, uint32_t( a & 0xFFFF ), v );
+
+        if( a == config.ctrl_base + 0x14 )
+        {
+            v = BusyMask();
+            if( v != 0 ) Tick( config.send_poll_cycles );
+            return true;
+        }
+
+        auto I = shadow.find( a );
+        v = I == shadow.end() ? 0 : I->second;
+        return true;
+    }
+};
+
+VerilatedBackend::VerilatedBackend() : VerilatedBackend( Config() )
+{
+}
+
+VerilatedBackend::VerilatedBackend( const Config& config ) : impl_( new Impl( config ) )
+{
+}
+
+VerilatedBackend::~VerilatedBackend()
+{
+    delete impl_;
+}
+
+bool VerilatedBackend::Write( uintptr_t address, uint32_t value )
+{
+    std::lock_guard<std::mutex> lock( impl_->mutex );
+    return impl_->Write( address, value );
+}
+
+bool VerilatedBackend::Read( uintptr_t address, uint32_t& value )
+{
+    std::lock_guard<std::mutex> lock( impl_->mutex );
+    return impl_->Read( address, value );
+}
+
+uint64_t VerilatedBackend::Cycle() const
+{
+    std::lock_guard<std::mutex> lock( impl_->mutex );
+    return impl_->cycle;
+}
+
+std::vector<VerilatedBackend::Frame> VerilatedBackend::RtlFrames( int lane ) const
+{
+    std::lock_guard<std::mutex> lock( impl_->mutex );
+    if( lane < 0 || lane >= 8 ) return {};
+    return impl_->lanes[lane].frames;
+}
+
+std::vector<uint8_t> VerilatedBackend::FifoBytes( int bus ) const
+{
+    std::lock_guard<std::mutex> lock( impl_->mutex );
+    if( bus < 0 || bus >= (int)impl_->buses.size() ) return {};
+    return impl_->buses[bus].sent;
+}
+
+void VerilatedBackend::ClearCaptures()
+{
+    std::lock_guard<std::mutex> lock( impl_->mutex );
+    for( auto& l : impl_->lanes ) l.frames.clear();
+    for( auto& b : impl_->buses ) b.sent.clear();
+}
+
+std::string VerilatedBackend::Report() const
+{
+    std::lock_guard<std::mutex> lock( impl_->mutex );
+
+    std::string rep = Common::string_format( "cycle %llu (%.3f ms) rtl_access %llu fifo_access %llu",
+        (unsigned long long)impl_->cycle, impl_->cycle * 1e3 / impl_->config.timing.clk_hz,
+        (unsigned long long)impl_->rtl_accesses, (unsigned long long)impl_->fifo_accesses );
+
+    for( int l = 0; l < 8; l++ )
+    {
+        rep += Common::string_format( "\r\n lane %d: rtl frames %zu fifo bytes %zu",
+            l, impl_->lanes[l].frames.size(), l < (int)impl_->buses.size() ? impl_->buses[l].sent.size() : (size_t)0 );
+    }
+    return rep;
+}
+
+
+}
+}
@@ -0,0 +1,64 @@
+#ifndef __SPIBEAM_VERILATED_BACKEND_H__
+#define __SPIBEAM_VERILATED_BACKEND_H__
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "RegisterBackend.h"
+#include "SpiTimingModel.h"
+
+namespace SpiBeam {
+namespace Cosim {
+
+// 0x43C00000 ~ 0x43CBFFFF 영역을 흉내내는 register backend
+//   beam_base ~ +0x200 : verilated beamforming_calc_v1_0 (AXI-Lite transaction 으로 접근)
+//   fifo_base + N*0x10000 : bus N AXI FIFO (software model, 전송 시간은 Timing::Model)
+//   ctrl_base + 0x14/0x18/0x1c : send / length / execute
+//   그 외 : 단순 shadow register
+// 시간은 RTL clock cycle 하나로 통일. register access 마다 axi_cycles 만큼 진행하고,
+// busy 로 읽히는 polling 은 software 의 polling 간격만큼 진행한다.
+class VerilatedBackend : public SpiwriteProtocol::RegisterBackend
+{
+public:
+    struct Config
+    {
+        uintptr_t beam_base   = 0x43C30000;
+        uintptr_t fifo_base   = 0x43C40000;
+        uintptr_t ctrl_base   = 0x43C00000;
+        int num_bus           = 8;
+        int axi_cycles        = 15;      // register access 1 회 (150ns @100MHz)
+        int beam_poll_cycles  = 5000;    // HwBeamEngine polling 간격 (50us)
+        int send_poll_cycles  = 100000;  // send register polling 간격 (1ms)
+        Timing::Params timing;
+    };
+
+    using Frame = std::array<uint8_t, 5>;
+
+    VerilatedBackend();
+    explicit VerilatedBackend( const Config& config );
+    ~VerilatedBackend();
+
+    bool Write( uintptr_t address, uint32_t value ) override;
+    bool Read( uintptr_t address, uint32_t& value ) override;
+
+    uint64_t Cycle() const;
+
+    // RTL SPI pin 에서 복원한 frame (lane 별)
+    std::vector<Frame> RtlFrames( int lane ) const;
+    // FIFO path 로 전송된 byte (bus 별)
+    std::vector<uint8_t> FifoBytes( int bus ) const;
+    void ClearCaptures();
+
+    std::string Report() const;
+
+private:
+    struct Impl;
+    Impl* impl_;
+};
+
+
+}
+}
+
+#endif
@@ -0,0 +1,203 @@
+// ============================================================================
+// CodebookCheck : array-factor validation of a quantised beam codebook
+// ----------------------------------------------------------------------------
+// Build (-O3 so the separable sums vectorise; add -march/-mcpu for the host):
+//   g++ -O3 -std=c++17 -I.. tools/CodebookCheck.cpp BeamPattern.cpp BeamPipeline.cpp PanelLayout.cpp
+//       TrigTable.cpp -lpthread
+//
+// Usage:
+//   CodebookCheck [--mode=tx|rx|both] [--az=start:stop:step] [--el=start:stop:step]
+//                 [--kernel=fixed|float] [--grid=N] [--threads=N]
+//                 [--max-error=<deg>] [--max-psl=<dB>] [--csv=<file>]
+//   CodebookCheck --compare=<az_step>:<el_step> [--mode=tx|rx|both]
+//
+// Every beam is quantised exactly as the controller does it (--kernel=fixed
+// is ComputeIndicesFixed, float is ComputeIndices) and the array factor of the
+// resulting 6-bit phases is evaluated on an N x N direction-cosine grid of the
+// layout from $SPIBEAM_LAYOUT (or the default panel). For each beam:
+//   pointing error : angle between the requested and the actual peak direction
+//   pointing loss  : gain in the requested direction relative to the peak
+//   psl            : highest sidelobe outside the main lobe, relative to the peak
+//
+// With --max-error / --max-psl the exit code is 1 when any beam is out of
+// limits, so codebook generation can gate on it.
+//
+// --compare runs the exhaustive kernel check instead: the sin/cos table
+// accuracy and, for both kernels, the number of phase indices that differ
+// from the float path (PhaseOf + ApplyPoles) over az 0..360 / el 0..90 at the
+// given steps. The remote 'trig' command only does this on a coarse grid.
+// ============================================================================
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include "BeamPattern.h"
+#include "TrigTable.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+struct Range
+{
+    double start = 0;
+    double stop = 0;
+    double step = 1;
+};
+
+struct Options
+{
+    std::string mode = "both";
+    Range az { 0, 355, 5 };
+    Range el { 30, 90, 2 };
+    bool fixed = true;
+    int grid = 256;
+    int threads = 0;
+    double max_error = -1;      // < 0 이면 검사 안 함
+    double max_psl = 1;         // > 0 이면 검사 안 함
+    std::string csv;
+    float compare_az = 0;       // > 0 이면 --compare
+    float compare_el = 0;
+};
+
+bool ParseRange( const char* s, Range& r )
+{
+    return sscanf( s, "%lf:%lf:%lf", &r.start, &r.stop, &r.step ) == 3 && r.step > 0;
+}
+
+std::vector<Pattern::Beam> EnumerateBeams( const Options& opt )
+{
+    std::vector<Pattern::Beam> beams;
+    for( double el = opt.el.start; el <= opt.el.stop + 1e-9; el += opt.el.step )
+    {
+        for( double az = opt.az.start; az <= opt.az.stop + 1e-9; az += opt.az.step )
+        {
+            beams.push_back( { (float)az, (float)el } );
+        }
+    }
+    return beams;
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    Options opt;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        const char* a = argv[i];
+        if( !strncmp( a, "--mode=", 7 ) ) opt.mode = a + 7;
+        else if( !strncmp( a, "--az=", 5 ) && ParseRange( a + 5, opt.az ) ) {}
+        else if( !strncmp( a, "--el=", 5 ) && ParseRange( a + 5, opt.el ) ) {}
+        else if( !strcmp( a, "--kernel=fixed" ) ) opt.fixed = true;
+        else if( !strcmp( a, "--kernel=float" ) ) opt.fixed = false;
+        else if( !strncmp( a, "--grid=", 7 ) ) opt.grid = atoi( a + 7 );
+        else if( !strncmp( a, "--threads=", 10 ) ) opt.threads = atoi( a + 10 );
+        else if( !strncmp( a, "--max-error=", 12 ) ) opt.max_error = atof( a + 12 );
+        else if( !strncmp( a, "--max-psl=", 10 ) ) opt.max_psl = atof( a + 10 );
+        else if( !strncmp( a, "--csv=", 6 ) ) opt.csv = a + 6;
+        else if( !strncmp( a, "--compare=", 10 ) && sscanf( a + 10, "%f:%f", &opt.compare_az, &opt.compare_el ) == 2 &&
+                 opt.compare_az > 0 && opt.compare_el > 0 ) {}
+        else
+        {
+            fprintf( stderr, "unknown option %s\n", a );
+            return 1;
+        }
+    }
+
+    int threads = opt.threads > 0 ? opt.threads : (int)std::thread::hardware_concurrency();
+    if( threads <= 0 ) threads = 1;
+
+    Pattern::Config cfg;
+    cfg.grid = opt.grid;
+
+    FILE* csv = nullptr;
+    if( !opt.csv.empty() )
+    {
+        csv = fopen( opt.csv.c_str(), "w" );
+        if( !csv ) { perror( opt.csv.c_str() ); return 1; }
+        fprintf( csv, "mode,az,el,peak_az,peak_el,pointing_error_deg,pointing_loss_db,psl_db\n" );
+    }
+
+    std::vector<int> modes;
+    if( opt.mode != "rx" ) modes.push_back( 1 );
+    if( opt.mode != "tx" ) modes.push_back( 0 );
+
+    if( opt.compare_az > 0 )
+    {
+        if( csv ) fclose( csv );
+        fprintf( stderr, "%s\n", Trig::Check().Report().c_str() );
+
+        const std::pair<const char*, BeamPipeline::IndexKernel> kernels[] = {
+            { "table", BeamPipeline::ComputeIndices },
+            { BeamPipeline::FixedKernelName(), BeamPipeline::ComputeIndicesFixed },
+        };
+        for( auto& kernel : kernels )
+        {
+            for( int is_tx : modes )
+            {
+                size_t total = 0;
+                size_t diff = BeamPipeline::CompareIndices( *Layout::Registry::Instance().Get( is_tx ), is_tx,
+                    opt.compare_az, opt.compare_el, &total, kernel.second );
+                fprintf( stderr, "%-6s %s phase index  %zu / %zu differ (%.4f%%)\n",
+                    kernel.first, is_tx ? "tx" : "rx", diff, total, total ? 100.0 * diff / total : 0.0 );
+            }
+        }
+        return 0;
+    }
+
+    auto beams = EnumerateBeams( opt );
+    size_t violations = 0;
+
+    for( int is_tx : modes )
+    {
+        auto layout = Layout::Registry::Instance().Get( is_tx );
+        auto t0 = std::chrono::steady_clock::now();
+
+        auto metrics = Pattern::EvaluateCodebook( *layout, is_tx, beams, cfg, threads,
+            opt.fixed ? BeamPipeline::ComputeIndicesFixed : BeamPipeline::ComputeIndices );
+
+        double sec = std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+        auto summary = Pattern::Summarize( metrics );
+
+        fprintf( stderr, "%s (%s, %s kernel, grid %d, %d threads, %.2f s, %.0f beams/s)\n  %s\n",
+            is_tx ? "tx" : "rx", layout->name.c_str(), opt.fixed ? BeamPipeline::FixedKernelName() : "float",
+            cfg.grid, threads, sec, sec > 0 ? metrics.size() / sec : 0.0, summary.Report().c_str() );
+        if( !metrics.empty() )
+        {
+            fprintf( stderr, "  worst pointing : %s\n", metrics[summary.worst_pointing].Report().c_str() );
+            fprintf( stderr, "  worst psl      : %s\n", metrics[summary.worst_psl].Report().c_str() );
+        }
+
+        for( auto& m : metrics )
+        {
+            bool bad = ( opt.max_error >= 0 && m.pointing_error_deg > opt.max_error ) ||
+                       ( opt.max_psl <= 0 && m.psl_db > opt.max_psl );
+            if( bad )
+            {
+                violations++;
+                fprintf( stderr, "  out of limits  : %s %s\n", is_tx ? "tx" : "rx", m.Report().c_str() );
+            }
+
+            if( csv )
+            {
+                fprintf( csv, "%s,%.3f,%.3f,%.4f,%.4f,%.5f,%.4f,%.3f\n", is_tx ? "tx" : "rx",
+                    m.az, m.el, m.peak_az, m.peak_el, m.pointing_error_deg, m.pointing_loss_db, m.psl_db );
+            }
+        }
+    }
+
+    if( csv ) fclose( csv );
+
+    if( violations )
+    {
+        fprintf( stderr, "%zu beams out of limits\n", violations );
+        return 1;
+    }
+    return 0;
+}
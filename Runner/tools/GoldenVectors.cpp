@@ -0,0 +1,252 @@
+// ============================================================================
+// GoldenVectors : expected per-lane SPI frames for the RTL testbenches
+// ----------------------------------------------------------------------------
+// Build:
+//   g++ -O2 -std=c++17 -I.. tools/GoldenVectors.cpp BeamPipeline.cpp PanelLayout.cpp TrigTable.cpp -lpthread
+//
+// Usage:
+//   GoldenVectors [--mode=tx|rx|both] [--az=start:stop:step] [--el=start:stop:step]
+//                 [--model=rtl|sw] [--split=<beams per file>] [--threads=N]
+//                 [--out=<prefix>]
+//
+// Angles are quantised to Q9.7 first, so every vector is exactly what the
+// RTL sees on az_deg/el_deg. For each beam the 8 lanes are written in lane
+// order, and each lane's 128 frames follow beamformer_calc_unit order
+// (row 0..31, col_idx 0..3, col = (7-lane)*4 + col_idx).
+//
+// Output (one pair of files per split, $readmemh-able):
+//   <prefix>_NNNN_beams.hex  : logic [35:0]  {is_tx[3:0], az_q9_7, el_q9_7}
+//   <prefix>_NNNN_frames.hex : logic [39:0]  {0x28, chip, chan, hi, lo}
+//
+// Each testbench takes the pair with +golden=<prefix>_NNNN:
+//   tb_beamformer_top       : all 8 lanes on the SPI pins
+//   tb_beamformer_calc_unit : the lane of its SPI_ID on the byte stream
+//   tb_phase_calc           : phase_idx of every element (x = col*dx, y = row*dy)
+//
+// --model=rtl (default) follows phase_calc.sv: no pole offset, c = 299792458,
+//             phase_idx = round(frac(turns) * 64). The fixed-point datapath
+//             can differ by one LSB, so the testbench allows +-1 on phase_idx.
+// --model=sw  follows BeamPipeline (poles added, floor to 5.625 deg), i.e.
+//             what the controller pushes through the FIFO path.
+// ============================================================================
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include "BeamPipeline.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+constexpr int NUM_LANES = 8;
+constexpr int ROWS = 32;
+constexpr int FRAMES_PER_LANE = ROWS * 4;
+constexpr int FRAMES_PER_BEAM = NUM_LANES * FRAMES_PER_LANE;
+
+// frame 한 줄 "28xxxxxxxx\n"
+constexpr int FRAME_CHARS = 11;
+
+struct Range
+{
+    double start = 0;
+    double stop = 0;
+    double step = 1;
+};
+
+struct Beam
+{
+    int is_tx;
+    uint16_t az_q;
+    uint16_t el_q;
+};
+
+struct Options
+{
+    std::string mode = "both";
+    Range az { 0, 359, 1 };
+    Range el { 0, 90, 1 };
+    bool rtl = true;
+    int split = 2048;
+    int threads = 0;
+    std::string out = "golden";
+};
+
+bool ParseRange( const char* s, Range& r )
+{
+    return sscanf( s, "%lf:%lf:%lf", &r.start, &r.stop, &r.step ) == 3 && r.step > 0;
+}
+
+uint16_t ToQ9_7( double deg )
+{
+    double d = std::fmod( deg, 360.0 );
+    if( d < 0 ) d += 360.0;
+    return static_cast<uint16_t>( std::lround( d * 128.0 ) & 0xFFFF );
+}
+
+// phase_calc.sv : turns = K * cos(el) * (x cos(az) - y sin(az)), K = -f/c [turns/mm]
+int RtlPhaseIndex( const Beam& b, double x, double y )
+{
+    const double PI = 3.14159265358979323846;
+    const double C_MMPS = 299792458.0 * 1000.0;
+    double f = b.is_tx ? 29.5e9 : 19.7e9;
+
+    double az = b.az_q / 128.0 * PI / 180.0;
+    double el = b.el_q / 128.0 * PI / 180.0;
+    double turns = -f / C_MMPS * std::cos( el ) * ( x * std::cos( az ) - y * std::sin( az ) );
+
+    double frac = turns - std::floor( turns );
+    return int( std::lround( frac * 64.0 ) ) & 0x3F;
+}
+
+// beam 하나의 frame 들을 out 에 hex 문자열로 기록 (FRAMES_PER_BEAM * FRAME_CHARS)
+void RenderBeam( const Beam& b, bool rtl, const std::vector<BeamPipeline::Entry>& layout, char* out )
+{
+    static const char* HEX = "0123456789abcdef";
+
+    std::vector<BeamPipeline::Entry> entries( layout );
+    double az = b.az_q / 128.0;
+    double el = b.el_q / 128.0;
+
+    if( !rtl )
+        BeamPipeline::ComputePhases( entries, az, el, b.is_tx ? 29500000000ULL : 19700000000ULL );
+
+    for( int lane = 0; lane < NUM_LANES; lane++ )
+    {
+        for( int row = 0; row < ROWS; row++ )
+        {
+            for( int col_idx = 0; col_idx < 4; col_idx++ )
+            {
+                int col = ( 7 - lane ) * 4 + col_idx;
+                auto& e = entries[row * 32 + col];
+
+                int idx = rtl ? RtlPhaseIndex( b, e.x_offset, e.y_offset )
+                              : BeamPipeline::PhaseIndex( e.final_phase );
+                uint16_t value = BeamPipeline::EncodeValue( idx, b.is_tx );
+
+                uint8_t bytes[5] = { 0x28, uint8_t( e.chip_id ), uint8_t( e.channel_id ),
+                                     uint8_t( value >> 8 ), uint8_t( value & 0xFF ) };
+                for( int k = 0; k < 5; k++ )
+                {
+                    *out++ = HEX[bytes[k] >> 4];
+                    *out++ = HEX[bytes[k] & 0xF];
+                }
+                *out++ = '\n';
+            }
+        }
+    }
+}
+
+std::vector<Beam> EnumerateBeams( const Options& opt )
+{
+    std::vector<Beam> beams;
+    std::vector<int> modes;
+    if( opt.mode != "rx" ) modes.push_back( 1 );
+    if( opt.mode != "tx" ) modes.push_back( 0 );
+
+    for( int is_tx : modes )
+    {
+        for( double el = opt.el.start; el <= opt.el.stop + 1e-9; el += opt.el.step )
+        {
+            for( double az = opt.az.start; az <= opt.az.stop + 1e-9; az += opt.az.step )
+            {
+                beams.push_back( { is_tx, ToQ9_7( az ), ToQ9_7( el ) } );
+            }
+        }
+    }
+    return beams;
+}
+
+bool WriteChunk( const Options& opt, int chunk, const std::vector<Beam>& beams, size_t begin, size_t end,
+                 const std::vector<BeamPipeline::Entry> layouts[2], int threads )
+{
+    size_t count = end - begin;
+    const size_t beam_chars = (size_t)FRAMES_PER_BEAM * FRAME_CHARS;
+    std::vector<char> text( count * beam_chars );
+
+    // beam 단위로 나눠서 병렬 처리. 각 beam 의 출력 위치가 고정이라 lock 불필요
+    std::atomic<size_t> next { 0 };
+    auto worker = [&]()
+    {
+        for( size_t i = next++; i < count; i = next++ )
+        {
+            const Beam& b = beams[begin + i];
+            RenderBeam( b, opt.rtl, layouts[b.is_tx], text.data() + i * beam_chars );
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for( int t = 1; t < threads; t++ ) pool.emplace_back( worker );
+    worker();
+    for( auto& t : pool ) t.join();
+
+    char name[512];
+    snprintf( name, sizeof(name), "%s_%04d_frames.hex", opt.out.c_str(), chunk );
+    FILE* f = fopen( name, "wb" );
+    if( !f ) { perror( name ); return false; }
+    fwrite( text.data(), 1, text.size(), f );
+    fclose( f );
+
+    snprintf( name, sizeof(name), "%s_%04d_beams.hex", opt.out.c_str(), chunk );
+    f = fopen( name, "w" );
+    if( !f ) { perror( name ); return false; }
+    for( size_t i = begin; i < end; i++ )
+        fprintf( f, "%01x%04x%04x\n", beams[i].is_tx, beams[i].az_q, beams[i].el_q );
+    fclose( f );
+    return true;
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    Options opt;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        const char* a = argv[i];
+        if( !strncmp( a, "--mode=", 7 ) ) opt.mode = a + 7;
+        else if( !strncmp( a, "--az=", 5 ) && ParseRange( a + 5, opt.az ) ) {}
+        else if( !strncmp( a, "--el=", 5 ) && ParseRange( a + 5, opt.el ) ) {}
+        else if( !strcmp( a, "--model=rtl" ) ) opt.rtl = true;
+        else if( !strcmp( a, "--model=sw" ) ) opt.rtl = false;
+        else if( !strncmp( a, "--split=", 8 ) ) opt.split = atoi( a + 8 );
+        else if( !strncmp( a, "--threads=", 10 ) ) opt.threads = atoi( a + 10 );
+        else if( !strncmp( a, "--out=", 6 ) ) opt.out = a + 6;
+        else
+        {
+            fprintf( stderr, "unknown option %s\n", a );
+            return 1;
+        }
+    }
+
+    if( opt.split <= 0 ) opt.split = 2048;
+    int threads = opt.threads > 0 ? opt.threads : (int)std::thread::hardware_concurrency();
+    if( threads <= 0 ) threads = 1;
+
+    // layout 은 az/el 과 무관하므로 한 번만 (index = is_tx)
+    std::vector<BeamPipeline::Entry> layouts[2] = {
+        BeamPipeline::BuildEntries( 0, 7.5f, 7.5f ),
+        BeamPipeline::BuildEntries( 1, 5.0f, 5.0f ),
+    };
+
+    auto beams = EnumerateBeams( opt );
+    auto t0 = std::chrono::steady_clock::now();
+
+    int chunks = 0;
+    for( size_t begin = 0; begin < beams.size(); begin += opt.split, chunks++ )
+    {
+        size_t end = std::min( beams.size(), begin + (size_t)opt.split );
+        if( !WriteChunk( opt, chunks, beams, begin, end, layouts, threads ) ) return 1;
+    }
+
+    double sec = std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+    fprintf( stderr, "%zu beams (%s model), %d files, %d threads : %.2f s (%.0f beams/s)\n",
+        beams.size(), opt.rtl ? "rtl" : "sw", chunks, threads, sec, sec > 0 ? beams.size() / sec : 0.0 );
+    return 0;
+}
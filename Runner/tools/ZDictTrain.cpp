@@ -0,0 +1,211 @@
+// ============================================================================
+// ZDictTrain : zlib preset dictionary for BINARY beam payloads
+// ----------------------------------------------------------------------------
+// Build:
+//   g++ -O2 -std=c++17 -I.. tools/ZDictTrain.cpp ZDict.cpp SpiStats.cpp BeamPipeline.cpp PanelLayout.cpp
+//       TrigTable.cpp -lz -lpthread
+//
+// Usage:
+//   ZDictTrain [--mode=tx|rx|both] [--az=start:stop:step] [--el=start:stop:step]
+//              [--size=<dict bytes>] [--k=<4..8>] [--segment=<bytes>]
+//              [--test-every=N] [--level=0..9] [--out=<file>] [capture ...]
+//
+// Samples are raw BINARY payloads (3 byte header + 2 bytes per element in
+// layout order). Each capture file holds one payload as received, with or
+// without the "BINARY:" prefix; zlib (FDICT=0) captures are inflated first.
+// Without captures the beam grid given by --mode/--az/--el is synthesised
+// with the fixed-point kernel the controller uses.
+//
+// Every N-th sample (--test-every, default 5) is held out; the report compares
+// plain zlib with zlib + dictionary on those (bytes per beam, the relative
+// reduction against plain zlib, and the dictionary size). Load the result on the
+// controller with $SPIBEAM_ZDICT=<file> or "zdict load <file>"; the "zdict"
+// reply carries the id a client puts in DICTID.
+// ============================================================================
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <zlib.h>
+
+#include "BeamPipeline.h"
+#include "PanelLayout.h"
+#include "ZDict.h"
+
+using namespace SpiBeam;
+
+namespace {
+
+struct Range
+{
+    double start = 0;
+    double stop = 0;
+    double step = 1;
+};
+
+struct Options
+{
+    std::string mode = "tx";
+    Range az { 0, 355, 5 };
+    Range el { 0, 60, 5 };
+    ZDict::TrainParams train;
+    int test_every = 5;
+    int level = 9;
+    std::string out = "beam.zdict";
+    std::vector<std::string> captures;
+};
+
+bool ParseRange( const char* s, Range& r )
+{
+    return sscanf( s, "%lf:%lf:%lf", &r.start, &r.stop, &r.step ) == 3 && r.step > 0;
+}
+
+// 컨트롤러가 받는 것과 같은 raw payload
+std::vector<uint8_t> MakePayload( const Layout::Compiled& layout, int is_tx, float az, float el )
+{
+    std::vector<uint8_t> idx( layout.Size() );
+    BeamPipeline::ComputeIndicesFixed( layout, az, el, is_tx ? 29500000000ULL : 19700000000ULL, idx.data() );
+
+    std::vector<uint8_t> data( 3, 0 );
+    data.reserve( 3 + 2 * idx.size() );
+    for( uint8_t i : idx )
+    {
+        uint16_t v = BeamPipeline::EncodeValue( i, is_tx );
+        data.push_back( v >> 8 );
+        data.push_back( v & 0xFF );
+    }
+    return data;
+}
+
+bool ReadCapture( const std::string& path, std::vector<uint8_t>& out )
+{
+    FILE* fp = fopen( path.c_str(), "rb" );
+    if( !fp ) return false;
+
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    for( size_t n; ( n = fread( buf, 1, sizeof(buf), fp ) ) > 0; ) data.insert( data.end(), buf, buf + n );
+    fclose( fp );
+
+    size_t begin = 0;
+    if( data.size() >= 7 && !memcmp( data.data(), "BINARY:", 7 ) ) begin = 7;
+
+    // FDICT=0 zlib 이면 푼 것을 sample 로
+    if( data.size() >= begin + 2 && data[begin] == 0x78 && !( data[begin + 1] & 0x20 ) )
+    {
+        z_stream strm;
+        memset( &strm, 0, sizeof(strm) );
+        if( inflateInit( &strm ) != Z_OK ) return false;
+
+        out.assign( 1 << 16, 0 );
+        strm.next_in = data.data() + begin;
+        strm.avail_in = (uInt)( data.size() - begin );
+        strm.next_out = out.data();
+        strm.avail_out = (uInt)out.size();
+        int ret = inflate( &strm, Z_FINISH );
+        out.resize( strm.total_out );
+        inflateEnd( &strm );
+        return ret == Z_STREAM_END;
+    }
+
+    out.assign( data.begin() + begin, data.end() );
+    return !out.empty();
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    Options opt;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        const char* a = argv[i];
+        if( !strncmp( a, "--mode=", 7 ) ) opt.mode = a + 7;
+        else if( !strncmp( a, "--az=", 5 ) && ParseRange( a + 5, opt.az ) ) {}
+        else if( !strncmp( a, "--el=", 5 ) && ParseRange( a + 5, opt.el ) ) {}
+        else if( !strncmp( a, "--size=", 7 ) ) opt.train.dict_size = (size_t)atoi( a + 7 );
+        else if( !strncmp( a, "--k=", 4 ) ) opt.train.k = (size_t)atoi( a + 4 );
+        else if( !strncmp( a, "--segment=", 10 ) ) opt.train.segment = (size_t)atoi( a + 10 );
+        else if( !strncmp( a, "--test-every=", 13 ) ) opt.test_every = atoi( a + 13 );
+        else if( !strncmp( a, "--level=", 8 ) ) opt.level = atoi( a + 8 );
+        else if( !strncmp( a, "--out=", 6 ) ) opt.out = a + 6;
+        else if( strncmp( a, "--", 2 ) ) opt.captures.push_back( a );
+        else
+        {
+            fprintf( stderr, "unknown option %s\n", a );
+            return 1;
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> samples;
+    if( !opt.captures.empty() )
+    {
+        for( auto& path : opt.captures )
+        {
+            std::vector<uint8_t> data;
+            if( !ReadCapture( path, data ) )
+            {
+                fprintf( stderr, "%s : cannot read payload\n", path.c_str() );
+                return 1;
+            }
+            samples.push_back( std::move( data ) );
+        }
+    }
+    else
+    {
+        for( int is_tx = 0; is_tx < 2; is_tx++ )
+        {
+            if( opt.mode != "both" && opt.mode != ( is_tx ? "tx" : "rx" ) ) continue;
+
+            auto layout = Layout::Registry::Instance().Get( is_tx );
+            for( double el = opt.el.start; el <= opt.el.stop; el += opt.el.step )
+                for( double az = opt.az.start; az <= opt.az.stop; az += opt.az.step )
+                    samples.push_back( MakePayload( *layout, is_tx, (float)az, (float)el ) );
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> train, test;
+    for( size_t i = 0; i < samples.size(); i++ )
+    {
+        if( opt.test_every > 0 && i % opt.test_every == (size_t)opt.test_every - 1 ) test.push_back( samples[i] );
+        else train.push_back( samples[i] );
+    }
+    // 샘플이 너무 적으면 학습한 것으로 평가
+    if( test.empty() ) test = train;
+
+    if( train.empty() )
+    {
+        fprintf( stderr, "no samples\n" );
+        return 1;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto dict = ZDict::Train( train, opt.train );
+    double train_s = std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+
+    if( dict.empty() )
+    {
+        fprintf( stderr, "no repeated content in %zu samples, no dictionary written\n", train.size() );
+        return 1;
+    }
+
+    FILE* fp = fopen( opt.out.c_str(), "wb" );
+    if( !fp || fwrite( dict.data(), 1, dict.size(), fp ) != dict.size() )
+    {
+        fprintf( stderr, "%s : cannot write\n", opt.out.c_str() );
+        if( fp ) fclose( fp );
+        return 1;
+    }
+    fclose( fp );
+
+    ZDict::Gain gain;
+    for( auto& s : test ) gain.Add( s.data(), s.size(), dict, opt.level );
+
+    fprintf( stderr, "%zu train / %zu test samples, dictionary %s : id 0x%08x, %zu bytes (%.2f s)\n",
+        train.size(), test.size(), opt.out.c_str(), ZDict::DictId( dict.data(), dict.size() ), dict.size(), train_s );
+    fprintf( stderr, "per beam : %s\n", gain.Report().c_str() );
+    return 0;
+}
@@ -15,7 +15,9 @@
 	)
 	(
 		// Users to add ports here
-
+		output wire [7:0] spi_sclk,
+		output wire [7:0] spi_cs_n,
+		output wire [7:0] spi_mosi,
 		// User ports ends
 		// Do not modify the ports beyond this line
 
@@ -68,7 +70,10 @@
 		.S_AXI_RDATA(s00_axi_rdata),
 		.S_AXI_RRESP(s00_axi_rresp),
 		.S_AXI_RVALID(s00_axi_rvalid),
-		.S_AXI_RREADY(s00_axi_rready)
+		.S_AXI_RREADY(s00_axi_rready),
+		.spi_sclk(spi_sclk),
+		.spi_cs_n(spi_cs_n),
+		.spi_mosi(spi_mosi)
 	);
 
 	// Add user logic here
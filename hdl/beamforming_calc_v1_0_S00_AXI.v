@@ -15,7 +15,9 @@
 	)
 	(
 		// Users to add ports here
-
+		output wire [7:0] spi_sclk,
+		output wire [7:0] spi_cs_n,
+		output wire [7:0] spi_mosi,
 		// User ports ends
 		// Do not modify the ports beyond this line
 
@@ -236,6 +238,15 @@
 	wire	 slv_reg_wren;
 	reg [C_S_AXI_DATA_WIDTH-1:0]	 reg_data_out;
 	integer	 byte_index;
+
+	// beam engine (user logic 참고)
+	localparam [C_S_AXI_DATA_WIDTH-1:0] BEAM_VERSION = 32'hBEA0_0001;
+	wire [7:0] beam_busy;
+	wire [7:0] beam_done;
+	reg  [7:0] beam_done_l;
+	reg        beam_start_d;
+	wire [C_S_AXI_DATA_WIDTH-1:0] beam_status;
+
 	reg	 aw_en;
 
 	// I/O Connections assignments
@@ -1613,8 +1624,8 @@
 	        7'h00   : reg_data_out <= slv_reg0;
 	        7'h01   : reg_data_out <= slv_reg1;
 	        7'h02   : reg_data_out <= slv_reg2;
-	        7'h03   : reg_data_out <= slv_reg3;
-	        7'h04   : reg_data_out <= slv_reg4;
+	        7'h03   : reg_data_out <= beam_status;
+	        7'h04   : reg_data_out <= BEAM_VERSION;
 	        7'h05   : reg_data_out <= slv_reg5;
 	        7'h06   : reg_data_out <= slv_reg6;
 	        7'h07   : reg_data_out <= slv_reg7;
@@ -1762,23 +1773,50 @@
 	end    
 
 	// Add user logic here
+	// Beam engine register map (byte offset)
+	//   0x00 CTRL    [0] start (rising edge), [1] is_tx
+	//   0x04 AZ      [15:0] Q9.7 deg, 0..360
+	//   0x08 EL      [15:0] Q9.7 deg, 0..90
+	//   0x0C STATUS  [7:0] lane done (sticky, cleared by start), [15:8] lane busy  (read only)
+	//   0x10 VERSION BEAM_VERSION  (read only)
+	wire       beam_start = slv_reg0[0];
+	wire       beam_is_tx = slv_reg0[1];
+
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      beam_done_l  <= 8'h00;
+	      beam_start_d <= 1'b0;
+	    end
+	  else
+	    begin
+	      beam_start_d <= beam_start;
+	      if (beam_start & ~beam_start_d)
+	        beam_done_l <= 8'h00;
+	      else
+	        beam_done_l <= beam_done_l | beam_done;
+	    end
+	end
+
+	assign beam_status = {16'h0000, beam_busy, beam_done_l};
+
     beamformer_top #(
-        .ADDR_WIDTH(32),
-        .DATA_WIDTH(32),
-        .NUM_FIFO(8)
+        .NUM_SPI(8)
     ) beamformer_top (
-        .clk        (clk),
-        .rst_n      (rst_n),
-        .start      (start),
-        .az_value   (az_value),
-        .el_value   (el_value),
-        .is_tx      (isTX),
-        .fifo_addr  (fifo_addr),
-        .fifo_wdata (fifo_wdata),
-        .fifo_wen   (fifo_wen),
-        .fifo_full  (fifo_full),
-        .fifo_remain(fifo_remain),
-        .done       (done)
+        .clk        (S_AXI_ACLK),
+        .rst_n      (S_AXI_ARESETN),
+        .start      (beam_start),
+        .isTX       (beam_is_tx),
+        .az_deg     (slv_reg1[15:0]),
+        .el_deg     (slv_reg2[15:0]),
+        .spi_sclk   (spi_sclk),
+        .spi_cs_n   (spi_cs_n),
+        .spi_mosi   (spi_mosi),
+        .busy       (beam_busy),
+        .done       (beam_done),
+        .phase_turn (),
+        .phase_idx  ()
     );
 	// User logic ends
 
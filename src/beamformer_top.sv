@@ -38,7 +38,7 @@ module beamformer_top #(
 
     logic start_d;
     delay #(.W(1), .N(1)) start_edge_ (.clk(clk), .rst_n(rst_n), .din(start), .dout(start_d));
-    logic start_edge = start & ~start_d;
+    wire  start_edge = start & ~start_d;
     // ------------------------------------------------------------------------
     // 8 beamformer_calc_unit instances
     //   SPI_ID = i
@@ -4,7 +4,7 @@ module tb_beamformer_calc_unit;
 
     // --------- tune for quick sim ----------
     localparam int ROWS_TB   = 4;     // use 32 for full sweep
-    localparam int SPI_ID_TB = 7;     // COL_BASE = (7-7)*4 = 0
+    localparam int SPI_ID_TB = 0;     // COL_BASE = (7-0)*4 = 28, golden lane 0
 
     // --------- clock / reset ----------
     logic clk, rst_n;
@@ -36,7 +36,7 @@ module tb_beamformer_calc_unit;
 
     // --------- instantiate DUT ----------
     beamformer_calc_unit #(
-        .SPI_ID (0),
+        .SPI_ID (SPI_ID_TB),
         .ROWS   (32)
     ) dut (
         .clk        (clk),
@@ -77,6 +77,24 @@ module tb_beamformer_calc_unit;
         end
     endfunction
 
+    // --------- golden vectors (Runner/tools/GoldenVectors, +golden=<prefix>_NNNN) ----------
+    //   <prefix>_beams.hex  : {is_tx[3:0], az_q9_7, el_q9_7} per beam
+    //   <prefix>_frames.hex : 8 lanes x 128 frames {b0,b1,b2,b3,b4} per beam
+    // only lane SPI_ID_TB is checked; phase_idx may differ by +-1 (as in tb_beamformer_top)
+    localparam int NUM_LANES        = 8;
+    localparam int FRAMES_PER_LANE  = 128;
+    localparam int MAX_GOLDEN_BEAMS = 2048;
+    localparam int MAX_PRINT_ERR    = 6;
+
+    logic [35:0] golden_beams  [0:MAX_GOLDEN_BEAMS-1];
+    logic [39:0] golden_frames [0:MAX_GOLDEN_BEAMS*NUM_LANES*FRAMES_PER_LANE-1];
+    bit          golden_en;
+    int          golden_beam;
+    int          golden_frame;
+    int          golden_err;
+    logic [39:0] golden_got, golden_exp;
+    logic [5:0]  golden_dphi;
+
     // --------- simple SPI frame sniffer (5 bytes/frame) ----------
     integer frame_cnt;
     integer byte_cnt;
@@ -89,7 +107,11 @@ module tb_beamformer_calc_unit;
             frame_cnt <= 0;
             byte_cnt  <= 0;
             b0 <= '0; b1 <= '0; b2 <= '0; b3 <= '0; b4 <= '0;
+            golden_frame <= 0;
+            golden_err   <= 0;
         end else begin
+            if (start) golden_frame <= 0;
+
             if (spi_wvalid && spi_wready) begin
                 case (byte_cnt)
                     0: b0 <= spi_wdata;
@@ -109,12 +131,27 @@ module tb_beamformer_calc_unit;
                     chip_id   = b1[5:0];
                     phase_idx = value16[15:10];
 
-                    $display("F%0d : b0=%02h chip=%0d ch=%02h val=%04h idx=%0d  (phase_idx_out=%0d)",
-                              frame_cnt, b0, chip_id, b2, value16, phase_idx, phase_idx_out);
+                    if (!golden_en)
+                        $display("F%0d : b0=%02h chip=%0d ch=%02h val=%04h idx=%0d  (phase_idx_out=%0d)",
+                                  frame_cnt, b0, chip_id, b2, value16, phase_idx, phase_idx_out);
 
                     if (b0 !== 8'h28) begin
                         $display("  NOTE: header != 0x28 (got %02h)", b0);
                     end
+
+                    if (golden_en) begin
+                        golden_got  = {b0, b1, b2, b3, spi_wdata};
+                        golden_exp  = golden_frames[(golden_beam*NUM_LANES + SPI_ID_TB)*FRAMES_PER_LANE + golden_frame];
+                        golden_dphi = golden_got[15:10] - golden_exp[15:10];
+                        if (golden_got[39:16] !== golden_exp[39:16] || golden_got[9:0] !== golden_exp[9:0] ||
+                            !(golden_dphi == 6'd0 || golden_dphi == 6'd1 || golden_dphi == 6'd63)) begin
+                            if (golden_err < MAX_PRINT_ERR)
+                                $display("[%0t] GOLDEN MISMATCH beam%0d LANE%0d FRAME%0d got=%010h exp=%010h",
+                                         $time, golden_beam, SPI_ID_TB, golden_frame, golden_got, golden_exp);
+                            golden_err <= golden_err + 1;
+                        end
+                        golden_frame <= golden_frame + 1;
+                    end
                 end else begin
                     byte_cnt <= byte_cnt + 1;
                 end
@@ -146,6 +183,44 @@ module tb_beamformer_calc_unit;
         end
     endtask
 
+    // --------- golden run : every beam in <prefix>_beams.hex ----------
+    string golden_prefix;
+
+    task automatic run_golden();
+        int n_beams, timeout;
+
+        $readmemh({golden_prefix, "_beams.hex"},  golden_beams);
+        $readmemh({golden_prefix, "_frames.hex"}, golden_frames);
+        golden_en = 1'b1;
+
+        n_beams = 0;
+        while (n_beams < MAX_GOLDEN_BEAMS && !$isunknown(golden_beams[n_beams]))
+            n_beams++;
+
+        for (int k = 0; k < n_beams; k++) begin
+            golden_beam = k;
+            isTX        = golden_beams[k][32];
+            az_deg_q9_7 = golden_beams[k][31:16];
+            el_deg_q9_7 = golden_beams[k][15:0];
+            @(posedge clk);
+
+            start = 1'b1; @(posedge clk); start = 1'b0;
+            @(posedge clk);
+
+            // 이 lane 의 128 frame 을 다 받을 때까지
+            timeout = 0;
+            while (golden_frame < FRAMES_PER_LANE && timeout < 200000) begin
+                @(posedge clk);
+                timeout++;
+            end
+
+            if (golden_frame < FRAMES_PER_LANE) $display("[%0t] GOLDEN TIMEOUT beam%0d", $time, k);
+            repeat (4) @(posedge clk);
+        end
+
+        $display("GOLDEN %s : %0d beams, lane %0d, %0d mismatching frames", golden_prefix, n_beams, SPI_ID_TB, golden_err);
+    endtask
+
     // --------- test sequence ----------
     initial begin
         // defaults
@@ -158,6 +233,12 @@ module tb_beamformer_calc_unit;
         wait (rst_n);
         @(posedge clk);
 
+        if ($value$plusargs("golden=%s", golden_prefix)) begin
+            run_golden();
+            #50;
+            $finish;
+        end
+
         // TX sweep
         $display("\n--- TX sweep: az=30, el=60 ---");
         run_sweep(1'b1, 30.0, 60.0);
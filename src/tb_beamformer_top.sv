@@ -78,6 +78,22 @@ module tb_beamformer_top;
     // ------------------------------------------------------------------------
     localparam int MAX_PRINT_PER_LANE = 6;
 
+    // ------------------------------------------------------------------------
+    // Golden vectors (Runner/tools/GoldenVectors, +golden=<prefix>_NNNN)
+    //   <prefix>_beams.hex  : {is_tx[3:0], az_q9_7, el_q9_7} per beam
+    //   <prefix>_frames.hex : 8 lanes x 128 frames {b0,b1,b2,b3,b4} per beam
+    // phase_idx is allowed to differ by +-1 (fixed-point vs double model)
+    // ------------------------------------------------------------------------
+    localparam int FRAMES_PER_LANE  = 128;
+    localparam int MAX_GOLDEN_BEAMS = 2048;
+
+    logic [35:0] golden_beams  [0:MAX_GOLDEN_BEAMS-1];
+    logic [39:0] golden_frames [0:MAX_GOLDEN_BEAMS*NUM_SPI*FRAMES_PER_LANE-1];
+    bit          golden_en;
+    int          golden_beam;
+    int          lane_err    [NUM_SPI];
+    int          lane_frames [NUM_SPI];
+
     typedef struct packed {
         byte b0, b1, b2, b3, b4;
     } frame5_t;
@@ -89,14 +105,21 @@ module tb_beamformer_top;
             int      byte_idx;
             int      bit_idx;
             int      printed;
+            int      frame_in_beam;
+            int      golden_err;
 
             initial begin
                 cur      = '{default:0};
                 byte_idx = 0;
                 bit_idx  = 7;
                 printed  = 0;
+                frame_in_beam = 0;
+                golden_err    = 0;
             end
 
+            assign lane_err[i]    = golden_err;
+            assign lane_frames[i] = frame_in_beam;
+
             // Detect frame start/end by cs_n transitions
             logic cs_n_q;
             always_ff @(posedge clk or negedge rst_n) begin
@@ -117,6 +140,8 @@ module tb_beamformer_top;
             always_ff @(posedge clk) begin
                 if (!rst_n) begin
                     // already initialized
+                end else if (start) begin
+                    frame_in_beam <= 0;
                 end else if (!spi_cs_n[i]) begin
                     // look for SCLK rising edge
                     // create a simple edge detect for sclk
@@ -154,6 +179,22 @@ module tb_beamformer_top;
                                 end
                                 printed <= printed + 1;
 
+                                if (golden_en) begin
+                                    logic [39:0] exp_f, got_f;
+                                    logic [5:0]  dphi;
+                                    exp_f = golden_frames[(golden_beam*NUM_SPI + i)*FRAMES_PER_LANE + frame_in_beam];
+                                    got_f = {cur.b0, cur.b1, cur.b2, cur.b3, cur.b4[7:1], spi_mosi[i]};
+                                    dphi  = got_f[15:10] - exp_f[15:10];
+                                    if (got_f[39:16] !== exp_f[39:16] || got_f[9:0] !== exp_f[9:0] ||
+                                        !(dphi == 6'd0 || dphi == 6'd1 || dphi == 6'd63)) begin
+                                        if (golden_err < MAX_PRINT_PER_LANE)
+                                            $display("[%0t] GOLDEN MISMATCH beam%0d LANE%0d FRAME%0d got=%010h exp=%010h",
+                                                     $time, golden_beam, i, frame_in_beam, got_f, exp_f);
+                                        golden_err <= golden_err + 1;
+                                    end
+                                end
+                                frame_in_beam <= frame_in_beam + 1;
+
                                 // Prepare for next frame (still under same CS if master continues)
                                 byte_idx <= 0;
                                 cur      <= '{default:0};
@@ -167,6 +208,51 @@ module tb_beamformer_top;
         end
     endgenerate
 
+    // ------------------------------------------------------------------------
+    // Golden run : every beam in <prefix>_beams.hex, compare all lanes
+    // ------------------------------------------------------------------------
+    string golden_prefix;
+
+    task automatic run_golden();
+        int n_beams, total_err, timeout;
+        bit all_done;
+
+        $readmemh({golden_prefix, "_beams.hex"},  golden_beams);
+        $readmemh({golden_prefix, "_frames.hex"}, golden_frames);
+        golden_en = 1'b1;
+
+        n_beams = 0;
+        while (n_beams < MAX_GOLDEN_BEAMS && !$isunknown(golden_beams[n_beams]))
+            n_beams++;
+
+        for (int k = 0; k < n_beams; k++) begin
+            golden_beam = k;
+            isTX        <= golden_beams[k][32];
+            az_deg_q9_7 <= golden_beams[k][31:16];
+            el_deg_q9_7 <= golden_beams[k][15:0];
+            @(posedge clk);
+
+            start <= 1'b1; @(posedge clk); start <= 1'b0;
+
+            // 모든 lane 이 128 frame 을 다 보낼 때까지
+            timeout = 0;
+            do begin
+                @(posedge clk);
+                all_done = 1'b1;
+                for (int l = 0; l < NUM_SPI; l++)
+                    if (lane_frames[l] < FRAMES_PER_LANE) all_done = 1'b0;
+                timeout++;
+            end while (!all_done && timeout < 200000);
+
+            if (!all_done) $display("[%0t] GOLDEN TIMEOUT beam%0d", $time, k);
+            repeat (4) @(posedge clk);
+        end
+
+        total_err = 0;
+        for (int l = 0; l < NUM_SPI; l++) total_err += lane_err[l];
+        $display("GOLDEN %s : %0d beams, %0d mismatching frames", golden_prefix, n_beams, total_err);
+    endtask
+
     // ------------------------------------------------------------------------
     // Stimulus
     // ------------------------------------------------------------------------
@@ -180,6 +266,11 @@ module tb_beamformer_top;
         @(posedge rst_n);
         @(posedge clk);
 
+        if ($value$plusargs("golden=%s", golden_prefix)) begin
+            run_golden();
+            $finish;
+        end
+
         // Sweep #1: TX, az=30°, el=60°
         isTX        <= 1'b1;
         az_deg_q9_7 <= deg_to_q9_7(30.0);
@@ -4,6 +4,8 @@
 // Simple TB for phase_calc (Q9.7 inputs for x,y, az, el)
 //   - Set az/el/x/y/is_tx and see the DUT result.
 //   - Prints Q1.31 "turns", degrees, and the 6-bit index.
+//   - +golden=<prefix>_NNNN : check every element of every beam against
+//     Runner/tools/GoldenVectors (same files as tb_beamformer_top)
 // ---------------------------------------------------------------------------
 module tb_phase_calc;
 
@@ -117,6 +119,88 @@ module tb_phase_calc;
         @(posedge clk); // consume valid
     endtask
 
+    // ------------------------------------------------------------------------
+    // Golden vectors (Runner/tools/GoldenVectors, +golden=<prefix>_NNNN)
+    //   <prefix>_beams.hex  : {is_tx[3:0], az_q9_7, el_q9_7} per beam
+    //   <prefix>_frames.hex : 8 lanes x 128 frames {b0,b1,b2,b3,b4} per beam
+    // Frame order is beamformer_calc_unit's (row 0..31, col_idx 0..3,
+    // col = (7-lane)*4 + col_idx), x = col*dx, y = row*dy; the expected
+    // phase_idx is value16[15:10] and may differ by +-1.
+    // ------------------------------------------------------------------------
+    localparam int NUM_LANES        = 8;
+    localparam int ROWS             = 32;
+    localparam int FRAMES_PER_LANE  = ROWS * 4;
+    localparam int MAX_GOLDEN_BEAMS = 2048;
+    localparam int MAX_PRINT_ERR    = 6;
+
+    logic [35:0] golden_beams  [0:MAX_GOLDEN_BEAMS-1];
+    logic [39:0] golden_frames [0:MAX_GOLDEN_BEAMS*NUM_LANES*FRAMES_PER_LANE-1];
+    string       golden_prefix;
+
+    // run_one 과 같은 handshake, 출력 없이 phase_idx 만
+    task automatic calc_idx (
+        bit tx, logic [15:0] x_q, logic [15:0] y_q, logic [15:0] az_q, logic [15:0] el_q,
+        output logic [5:0] idx
+    );
+        is_tx         <= tx;
+        x_offset_q9_7 <= x_q;
+        y_offset_q9_7 <= y_q;
+        az_deg_q9_7   <= az_q;
+        el_deg_q9_7   <= el_q;
+
+        start <= 1'b1;
+        @(posedge clk);
+        start <= 1'b0;
+
+        @(posedge clk);
+        wait (phase_valid === 1'b1);
+        idx = phase_idx;
+
+        @(posedge clk); // consume valid
+    endtask
+
+    task automatic run_golden();
+        int          n_beams, n_err, col;
+        logic [15:0] pitch;
+        logic [39:0] exp_f;
+        logic [5:0]  idx, dphi;
+        bit          tx;
+
+        $readmemh({golden_prefix, "_beams.hex"},  golden_beams);
+        $readmemh({golden_prefix, "_frames.hex"}, golden_frames);
+
+        n_beams = 0;
+        while (n_beams < MAX_GOLDEN_BEAMS && !$isunknown(golden_beams[n_beams]))
+            n_beams++;
+
+        n_err = 0;
+        for (int k = 0; k < n_beams; k++) begin
+            tx    = golden_beams[k][32];
+            pitch = tx ? 16'd640 : 16'd960;     // 5.0 / 7.5 mm in Q9.7
+
+            for (int lane = 0; lane < NUM_LANES; lane++) begin
+                for (int f = 0; f < FRAMES_PER_LANE; f++) begin
+                    col   = (7 - lane) * 4 + (f % 4);
+                    exp_f = golden_frames[(k*NUM_LANES + lane)*FRAMES_PER_LANE + f];
+
+                    calc_idx(tx, 16'(col) * pitch, 16'(f / 4) * pitch,
+                             golden_beams[k][31:16], golden_beams[k][15:0], idx);
+
+                    dphi = idx - exp_f[15:10];
+                    if (!(dphi == 6'd0 || dphi == 6'd1 || dphi == 6'd63)) begin
+                        if (n_err < MAX_PRINT_ERR)
+                            $display("[%0t] GOLDEN MISMATCH beam%0d row%0d col%0d got=%0d exp=%0d",
+                                     $time, k, f / 4, col, idx, exp_f[15:10]);
+                        n_err++;
+                    end
+                end
+            end
+        end
+
+        $display("GOLDEN %s : %0d beams, %0d elements, %0d mismatching phase_idx",
+                 golden_prefix, n_beams, n_beams * NUM_LANES * FRAMES_PER_LANE, n_err);
+    endtask
+
     // Test sequence
     initial begin
         start         = 1'b0;
@@ -129,6 +213,12 @@ module tb_phase_calc;
         wait (rst_n);
         @(posedge clk);
 
+        if ($value$plusargs("golden=%s", golden_prefix)) begin
+            run_golden();
+            #50;
+            $finish;
+        end
+
         // TX cases
         run_one( 30.0, 60.0, 10.0, 15.0, 1);
         run_one( 80.0, 70.0, 30.0, 40.0, 1);